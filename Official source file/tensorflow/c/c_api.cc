@@ -463,6 +463,48 @@ static bool TF_Run_Inputs(
   return ok;
 }
 
+// Parses 'run_options' into 'run_options_proto' and checks that
+// 'run_metadata' is empty.
+static bool TF_Run_Options(const TF_Buffer* run_options,
+                           const TF_Buffer* run_metadata,
+                           RunOptions* run_options_proto, TF_Status* status) {
+  if (run_options != nullptr &&
+      !run_options_proto->ParseFromArray(run_options->data,
+                                         run_options->length)) {
+    status->status = InvalidArgument("Unparseable RunOptions proto");
+    return false;
+  }
+  if (run_metadata != nullptr && run_metadata->data != nullptr) {
+    status->status =
+        InvalidArgument("Passing non-empty run_metadata is invalid.");
+    return false;
+  }
+  return true;
+}
+
+// Stores 'outputs' in c_outputs[].
+static void TF_Run_Outputs(const std::vector<Tensor>& outputs,
+                           TF_Tensor** c_outputs) {
+  const int noutputs = outputs.size();
+  for (int i = 0; i < noutputs; ++i) {
+    const Tensor& src = outputs[i];
+    if (!src.IsInitialized() || src.NumElements() == 0) {
+      c_outputs[i] = tensorflow::EmptyTensor(
+          static_cast<TF_DataType>(src.dtype()), src.shape());
+      continue;
+    }
+    if (src.dtype() != tensorflow::DT_STRING) {
+      // Share the underlying buffer.
+      TensorBuffer* buf = tensorflow::TensorCApi::Buffer(src);
+      buf->Ref();
+      c_outputs[i] = new TF_Tensor{static_cast<TF_DataType>(src.dtype()),
+                                   src.shape(), buf};
+    } else {
+      c_outputs[i] = tensorflow::TF_Tensor_EncodeStrings(src);
+    }
+  }
+}
+
 static void TF_Run_Helper(
     Session* session, const char* handle, const TF_Buffer* run_options,
     // Input tensors
@@ -479,15 +521,8 @@ static void TF_Run_Helper(
 
   if (handle == nullptr) {
     RunOptions run_options_proto;
-    if (run_options != nullptr &&
-        !run_options_proto.ParseFromArray(run_options->data,
-                                          run_options->length)) {
-      status->status = InvalidArgument("Unparseable RunOptions proto");
-      return;
-    }
-    if (run_metadata != nullptr && run_metadata->data != nullptr) {
-      status->status =
-          InvalidArgument("Passing non-empty run_metadata is invalid.");
+    if (!TF_Run_Options(run_options, run_metadata, &run_options_proto,
+                        status)) {
       return;
     }
 
@@ -509,24 +544,7 @@ static void TF_Run_Helper(
     return;
   }
 
-  // Store results in c_outputs[]
-  for (int i = 0; i < noutputs; ++i) {
-    const Tensor& src = outputs[i];
-    if (!src.IsInitialized() || src.NumElements() == 0) {
-      c_outputs[i] = tensorflow::EmptyTensor(
-          static_cast<TF_DataType>(src.dtype()), src.shape());
-      continue;
-    }
-    if (src.dtype() != tensorflow::DT_STRING) {
-      // Share the underlying buffer.
-      TensorBuffer* buf = tensorflow::TensorCApi::Buffer(src);
-      buf->Ref();
-      c_outputs[i] = new TF_Tensor{static_cast<TF_DataType>(src.dtype()),
-                                   src.shape(), buf};
-    } else {
-      c_outputs[i] = tensorflow::TF_Tensor_EncodeStrings(src);
-    }
-  }
+  TF_Run_Outputs(outputs, c_outputs);
 }
 
 extern "C" {
@@ -1686,12 +1704,17 @@ static bool ExtendSessionGraphHelper(TF_SessionWithGraph* session,
   return true;
 }
 
-void TF_SessionRun(TF_SessionWithGraph* session, const TF_Buffer* run_options,
-                   const TF_Port* inputs, TF_Tensor* const* input_values,
-                   int ninputs, const TF_Port* outputs,
-                   TF_Tensor** output_values, int noutputs,
-                   const TF_Operation* const* target_opers, int ntargets,
-                   TF_Buffer* run_metadata, TF_Status* status) {
+// Converts the arguments of TF_SessionRun() and TF_SessionRunAsync() to
+// names and Tensors, after extending the session with the new nodes of its
+// graph.  Takes ownership of input_values[].
+static bool TF_SessionRun_Setup(
+    TF_SessionWithGraph* session, const TF_Port* inputs,
+    TF_Tensor* const* input_values, int ninputs, const TF_Port* outputs,
+    TF_Tensor** output_values, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets,
+    std::vector<std::pair<tensorflow::string, Tensor>>* input_pairs,
+    std::vector<tensorflow::string>* output_names,
+    std::vector<tensorflow::string>* target_names, TF_Status* status) {
   // TODO(josh11b,mrry): Change Session to be able to use a Graph*
   // directly, instead of requiring us to serialize to a GraphDef and
   // call Session::Extend().
@@ -1699,28 +1722,46 @@ void TF_SessionRun(TF_SessionWithGraph* session, const TF_Buffer* run_options,
     for (int i = 0; i < ninputs; ++i) {
       TF_DeleteTensor(input_values[i]);
     }
-    return;
+    return false;
   }
 
   TF_Run_Setup(noutputs, output_values, status);
 
   // Convert from TF_Port and TF_Tensor to a string and Tensor.
-  std::vector<std::pair<tensorflow::string, Tensor>> input_pairs(ninputs);
-  if (!TF_Run_Inputs(input_values, &input_pairs, status)) return;
+  input_pairs->resize(ninputs);
+  if (!TF_Run_Inputs(input_values, input_pairs, status)) return false;
   for (int i = 0; i < ninputs; ++i) {
-    input_pairs[i].first = PortName(inputs[i]);
+    (*input_pairs)[i].first = PortName(inputs[i]);
   }
 
   // Convert from TF_Port to string names.
-  std::vector<tensorflow::string> output_names(noutputs);
+  output_names->resize(noutputs);
   for (int i = 0; i < noutputs; ++i) {
-    output_names[i] = PortName(outputs[i]);
+    (*output_names)[i] = PortName(outputs[i]);
   }
 
   // Convert from TF_Operation* to string names.
-  std::vector<tensorflow::string> target_names(ntargets);
+  target_names->resize(ntargets);
   for (int i = 0; i < ntargets; ++i) {
-    target_names[i] = target_opers[i]->node.name();
+    (*target_names)[i] = target_opers[i]->node.name();
+  }
+  return true;
+}
+
+void TF_SessionRun(TF_SessionWithGraph* session, const TF_Buffer* run_options,
+                   const TF_Port* inputs, TF_Tensor* const* input_values,
+                   int ninputs, const TF_Port* outputs,
+                   TF_Tensor** output_values, int noutputs,
+                   const TF_Operation* const* target_opers, int ntargets,
+                   TF_Buffer* run_metadata, TF_Status* status) {
+  std::vector<std::pair<tensorflow::string, Tensor>> input_pairs;
+  std::vector<tensorflow::string> output_names;
+  std::vector<tensorflow::string> target_names;
+  if (!TF_SessionRun_Setup(session, inputs, input_values, ninputs, outputs,
+                           output_values, noutputs, target_opers, ntargets,
+                           &input_pairs, &output_names, &target_names,
+                           status)) {
+    return;
   }
 
   // Actually run.
@@ -1729,6 +1770,49 @@ void TF_SessionRun(TF_SessionWithGraph* session, const TF_Buffer* run_options,
                 status);
 }
 
+void TF_SessionRunAsync(TF_SessionWithGraph* session,
+                        const TF_Buffer* run_options, const TF_Port* inputs,
+                        TF_Tensor* const* input_values, int ninputs,
+                        const TF_Port* outputs, TF_Tensor** output_values,
+                        int noutputs, const TF_Operation* const* target_opers,
+                        int ntargets, TF_Buffer* run_metadata,
+                        TF_Status* status, void (*done)(void* done_arg),
+                        void* done_arg) {
+  std::vector<std::pair<tensorflow::string, Tensor>> input_pairs;
+  std::vector<tensorflow::string> output_names;
+  std::vector<tensorflow::string> target_names;
+  RunOptions run_options_proto;
+  if (!TF_SessionRun_Setup(session, inputs, input_values, ninputs, outputs,
+                           output_values, noutputs, target_opers, ntargets,
+                           &input_pairs, &output_names, &target_names,
+                           status) ||
+      !TF_Run_Options(run_options, run_metadata, &run_options_proto, status)) {
+    done(done_arg);
+    return;
+  }
+
+  // Owned by the callback, which runs after this call may have returned.
+  std::vector<Tensor>* outputs_vec = new std::vector<Tensor>(noutputs);
+  RunMetadata* run_metadata_proto = new RunMetadata;
+  session->session->RunAsync(
+      run_options_proto, input_pairs, output_names, target_names, outputs_vec,
+      run_metadata_proto,
+      [outputs_vec, run_metadata_proto, output_values, run_metadata, status,
+       done, done_arg](const Status& result) {
+        // Serialize back to upstream client, who now owns the new buffer
+        if (run_metadata != nullptr) {
+          status->status = MessageToBuffer(*run_metadata_proto, run_metadata);
+        }
+        if (status->status.ok()) {
+          status->status = result;
+          if (result.ok()) TF_Run_Outputs(*outputs_vec, output_values);
+        }
+        delete outputs_vec;
+        delete run_metadata_proto;
+        done(done_arg);
+      });
+}
+
 void TF_SessionPRunSetup(TF_SessionWithGraph* session, const TF_Port* inputs,
                          int ninputs, const TF_Port* outputs, int noutputs,
                          const TF_Operation* const* target_opers, int ntargets,
@@ -824,6 +824,33 @@ extern void TF_SessionRun(TF_SessionWithGraph* session,
                           // Output status
                           TF_Status*);
 
+// EXPERIMENTAL: Like TF_SessionRun(), but returns without waiting for the
+// step to finish, and calls done(done_arg) once `output_values`,
+// `run_metadata` and `status` have been filled.  done() is called exactly
+// once, possibly before TF_SessionRunAsync() returns, and possibly on one of
+// the session's threads, so it must not block.  `output_values`,
+// `run_metadata` and `status` must remain valid until done() is called; the
+// other arguments only need to remain valid until TF_SessionRunAsync()
+// returns.  `run_options` must not set a timeout.
+extern void TF_SessionRunAsync(TF_SessionWithGraph* session,
+                               // RunOptions
+                               const TF_Buffer* run_options,
+                               // Input tensors
+                               const TF_Port* inputs,
+                               TF_Tensor* const* input_values, int ninputs,
+                               // Output tensors
+                               const TF_Port* outputs,
+                               TF_Tensor** output_values, int noutputs,
+                               // Target operations
+                               const TF_Operation* const* target_opers,
+                               int ntargets,
+                               // RunMetadata
+                               TF_Buffer* run_metadata,
+                               // Output status
+                               TF_Status* status,
+                               // Completion callback
+                               void (*done)(void* done_arg), void* done_arg);
+
 // See TF_PRunSetup() below.
 extern void TF_SessionPRunSetup(TF_SessionWithGraph*,
                                 // Input names
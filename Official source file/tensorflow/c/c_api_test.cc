@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
@@ -847,6 +848,59 @@ TEST(CAPI, SessionWithGraph) {
   TF_DeleteStatus(s);
 }
 
+static void DecrementCounter(void* arg) {
+  static_cast<tensorflow::BlockingCounter*>(arg)->DecrementCount();
+}
+
+TEST(CAPI, SessionRunAsync) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+  TF_Operation* feed = Placeholder(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add = Add(feed, two, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_SessionWithGraph* session = TF_NewSessionWithGraph(graph, opts, s);
+  TF_DeleteSessionOptions(opts);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  // Start all the steps before waiting for any of them.
+  const int kSteps = 1000;
+  const TF_Port input = {feed, 0};
+  const TF_Port output = {add, 0};
+  std::vector<TF_Tensor*> output_values(kSteps, nullptr);
+  std::vector<TF_Status*> statuses(kSteps);
+  tensorflow::BlockingCounter done(kSteps);
+  for (int i = 0; i < kSteps; ++i) {
+    TF_Tensor* input_value = Int32Tensor(i);
+    statuses[i] = TF_NewStatus();
+    TF_SessionRunAsync(session, nullptr, &input, &input_value, 1, &output,
+                       &output_values[i], 1, nullptr, 0, nullptr, statuses[i],
+                       &DecrementCounter, &done);
+  }
+  done.Wait();
+
+  for (int i = 0; i < kSteps; ++i) {
+    ASSERT_EQ(TF_OK, TF_GetCode(statuses[i])) << TF_Message(statuses[i]);
+    TF_DeleteStatus(statuses[i]);
+    TF_Tensor* out = output_values[i];
+    ASSERT_TRUE(out != nullptr);
+    EXPECT_EQ(TF_INT32, TF_TensorType(out));
+    EXPECT_EQ(i + 2, *static_cast<int32*>(TF_TensorData(out)));
+    TF_DeleteTensor(out);
+  }
+
+  TF_CloseSessionWithGraph(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSessionWithGraph(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 TEST(CAPI, ColocateWith) {
   TF_Status* s = TF_NewStatus();
   TF_Graph* graph = TF_NewGraph();
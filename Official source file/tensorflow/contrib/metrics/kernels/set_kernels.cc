@@ -26,6 +26,8 @@ limitations under the License.
 // to work with string values.
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -33,9 +35,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -129,66 +133,6 @@ const gtl::InlinedVector<int64, 8> Strides(const TensorShape& shape) {
   return result;
 }
 
-// TODO(ptucker): If memory becomes an issue, consider a 2-pass approach to
-// eliminate the intermediate `values` data structure - iterate once to
-// determine `num_values`, allocate output tensors, then write results directly
-// to output tensors.
-
-// TODO(ptucker): Consider sharding work across multiple threads. See
-// SparseCrossOp for an example.
-
-// Output `SparseTensor` of shape `output_shape`. `sets` contains a map of
-// group indices (i.e., values for all but the last dimension of `output_shape`)
-// to set values, each of which will occupy the last dimension of
-// `output_shape`.
-template <typename T>
-void OutputSparseTensor(OpKernelContext* ctx, const TensorShape& output_shape,
-                        const int64 num_values,
-                        const std::map<std::vector<int64>, std::set<T>>& sets) {
-  // Allocate 3 output tensors for sparse data.
-  Tensor *out_indices_t, *out_values_t, *out_shape_t;
-  OP_REQUIRES_OK(ctx, ctx->allocate_output(
-                          0, TensorShape({num_values, output_shape.dims()}),
-                          &out_indices_t));
-  OP_REQUIRES_OK(
-      ctx, ctx->allocate_output(1, TensorShape({num_values}), &out_values_t));
-  OP_REQUIRES_OK(ctx, ctx->allocate_output(
-                          2, TensorShape({output_shape.dims()}), &out_shape_t));
-  auto out_indices_mat = out_indices_t->matrix<int64>();
-  auto out_values_flat = out_values_t->vec<T>();
-
-  // For each set, write its indices and values to output tensors.
-  int64 value_index = 0;
-  for (auto it = sets.begin(); it != sets.end(); ++it) {
-    const auto& group_indices = it->first;
-    OP_REQUIRES(
-        ctx, group_indices.size() == output_shape.dims() - 1,
-        errors::Internal("Invalid number of indices ", group_indices.size(),
-                         ", expected ", output_shape.dims() - 1, "."));
-    const auto& set = it->second;
-
-    // For each set item, write its indices and value to output tensors.
-    int64 group_value_index = 0;
-    for (auto value = set.begin(); value != set.end();
-         ++value, ++value_index, ++group_value_index) {
-      // First n-1 dimensions are the group, last dimension is the position in
-      // the set.
-      for (int32 i = 0; i < group_indices.size(); ++i) {
-        out_indices_mat(value_index, i) = group_indices[i];
-      }
-      out_indices_mat(value_index, group_indices.size()) = group_value_index;
-
-      out_values_flat(value_index) = *value;
-    }
-  }
-
-  // Write output shape.
-  auto out_shape_flat = out_shape_t->vec<int64>();
-  for (int32 i = 0; i < output_shape.dims(); ++i) {
-    out_shape_flat(i) = output_shape.dim_size(i);
-  }
-}
-
 bool ValidateIndicesFromContext(OpKernelConstruction* ctx) {
   bool result;
   if (ctx->GetAttr("validate_indices", &result).ok()) {
@@ -197,31 +141,6 @@ bool ValidateIndicesFromContext(OpKernelConstruction* ctx) {
   return true;
 }
 
-// Populate `result` set from group in `tensor`. "Group" is defined by
-// `group_indices`, which are values for the first n-1 dimensions of
-// `input_tensor`. `input_strides` is provided to avoid recalculating it
-// multiple times, and is used to calculate the flat index into `input_tensor`
-// values.
-template <typename T>
-void PopulateFromDenseGroup(OpKernelContext* ctx, const Tensor& input_tensor,
-                            const gtl::InlinedVector<int64, 8>& input_strides,
-                            const std::vector<int64>& group_indices,
-                            std::set<T>* result) {
-  OP_REQUIRES(ctx, group_indices.size() == input_strides.size() - 1,
-              errors::Internal("group_indices.size ", group_indices.size(),
-                               ", !=  input_strides.size-1 ",
-                               input_strides.size() - 1, "."));
-  result->clear();
-  auto input_flat = input_tensor.flat<T>();
-  const auto start = std::inner_product(
-      group_indices.begin(), group_indices.end(), input_strides.begin(), 0L);
-  const TensorShape& input_shape = input_tensor.shape();
-  const auto end = start + input_shape.dim_size(input_shape.dims() - 1);
-  for (int64 i = start; i < end; ++i) {
-    result->insert(input_flat(i));
-  }
-}
-
 // Populate `result` set from `group`. `sparse_tensor_shape` is the shape of the
 // `SparseTensor` from which group was created, and is used to sanity check the
 // indices in `group'.
@@ -326,6 +245,101 @@ SetOperation SetOperationFromContext(OpKernelConstruction* ctx) {
   return UNION;
 }
 
+// The values of one group of each input, as [start, limit) ranges into the
+// flat values of the input. `group` is the row-major index of the group in
+// the group shape, i.e., the first n-1 dimensions of the inputs.
+struct GroupRanges {
+  int64 group;
+  int64 set1_start;
+  int64 set1_limit;
+  int64 set2_start;
+  int64 set2_limit;
+};
+
+// A run of consecutive values of a `SparseTensor` in the same group.
+struct SparseGroup {
+  int64 group;
+  int64 start;
+  int64 limit;
+};
+
+// Split the values of `st` into runs of values in the same group, in
+// increasing group order. This fails if the indices of `st` are out of bounds,
+// or are not in row-major order across groups.
+Status SparseGroupsFromTensor(const sparse::SparseTensor& st,
+                              const TensorShape& group_shape,
+                              std::vector<SparseGroup>* groups) {
+  groups->clear();
+  const auto indices = st.indices().matrix<int64>();
+  const TensorShape& shape = st.shape();
+  const int32 rank = shape.dims();
+  const auto group_strides = Strides(group_shape);
+  const int64 num_values = st.num_entries();
+  for (int64 i = 0; i < num_values; ++i) {
+    int64 group = 0;
+    for (int32 j = 0; j < rank; ++j) {
+      const int64 index = indices(i, j);
+      if (!FastBoundsCheck(index, shape.dim_size(j))) {
+        return errors::InvalidArgument("indices[", i, ", ", j, "] = ", index,
+                                       " is out of bounds for shape ",
+                                       shape.DebugString(), ".");
+      }
+      if (j < rank - 1) {
+        group += index * group_strides[j];
+      }
+    }
+    if (groups->empty() || group > groups->back().group) {
+      groups->push_back({group, i, i + 1});
+    } else if (group == groups->back().group) {
+      ++groups->back().limit;
+    } else {
+      return errors::InvalidArgument("indices[", i, "] is out of order.");
+    }
+  }
+  return Status::OK();
+}
+
+// Copy `values[start, limit)` to the same positions of `sorted`, and sort and
+// remove duplicates from them. Return the end of the distinct values.
+template <typename T>
+int64 SortUnique(const T* values, int64 start, int64 limit, T* sorted) {
+  std::copy(values + start, values + limit, sorted + start);
+  std::sort(sorted + start, sorted + limit);
+  return std::unique(sorted + start, sorted + limit) - sorted;
+}
+
+// Call `emit` on each value of the result of `set_operation` on the sorted,
+// distinct values [set1, set1_end) and [set2, set2_end), in increasing order.
+template <typename T, typename Emit>
+void ApplySetOperation(SetOperation set_operation, const T* set1,
+                       const T* set1_end, const T* set2, const T* set2_end,
+                       Emit emit) {
+  if (set_operation == B_MINUS_A) {
+    std::swap(set1, set2);
+    std::swap(set1_end, set2_end);
+    set_operation = A_MINUS_B;
+  }
+  while (set1 != set1_end && set2 != set2_end) {
+    if (*set1 < *set2) {
+      if (set_operation != INTERSECTION) emit(*set1);
+      ++set1;
+    } else if (*set2 < *set1) {
+      if (set_operation == UNION) emit(*set2);
+      ++set2;
+    } else {
+      if (set_operation != A_MINUS_B) emit(*set1);
+      ++set1;
+      ++set2;
+    }
+  }
+  if (set_operation != INTERSECTION) {
+    for (; set1 != set1_end; ++set1) emit(*set1);
+  }
+  if (set_operation == UNION) {
+    for (; set2 != set2_end; ++set2) emit(*set2);
+  }
+}
+
 // Abstract base class for performing set operations across the last dimension
 // of 2 input tensors.
 template <typename T>
@@ -340,40 +354,17 @@ class SetOperationOp : public OpKernel {
   void Compute(OpKernelContext* ctx) override;
 
  private:
-  void ApplySetOperation(const std::set<T>& set1, const std::set<T>& set2,
-                         std::set<T>* result) const;
   void ComputeDenseToDense(OpKernelContext* ctx) const;
   void ComputeDenseToSparse(OpKernelContext* ctx) const;
   void ComputeSparseToSparse(OpKernelContext* ctx) const;
+  void ComputeGroups(OpKernelContext* ctx, const TensorShape& group_shape,
+                     const Tensor& set1_values, const Tensor& set2_values,
+                     const std::vector<GroupRanges>& groups) const;
   const SetOperation set_operation_;
   const bool validate_indices_;
   const InputTypes input_types_;
 };
 
-template <typename T>
-void SetOperationOp<T>::ApplySetOperation(const std::set<T>& set1,
-                                          const std::set<T>& set2,
-                                          std::set<T>* result) const {
-  switch (set_operation_) {
-    case A_MINUS_B:
-      std::set_difference(set1.begin(), set1.end(), set2.begin(), set2.end(),
-                          std::inserter(*result, result->begin()));
-      break;
-    case B_MINUS_A:
-      std::set_difference(set2.begin(), set2.end(), set1.begin(), set1.end(),
-                          std::inserter(*result, result->begin()));
-      break;
-    case INTERSECTION:
-      std::set_intersection(set1.begin(), set1.end(), set2.begin(), set2.end(),
-                            std::inserter(*result, result->begin()));
-      break;
-    case UNION:
-      std::set_union(set1.begin(), set1.end(), set2.begin(), set2.end(),
-                     std::inserter(*result, result->begin()));
-      break;
-  }
-}
-
 // Validate shapes have the same dimensions.
 void CheckShapesMatch(OpKernelContext* ctx, const TensorShape& shape1,
                       const TensorShape& shape2) {
@@ -393,25 +384,123 @@ const TensorShape GroupShapeFromInputs(OpKernelContext* ctx,
   return group_shape;
 }
 
-// Split `flat_group_index` into separate dimensions based on `group_shape`.
-void PopulateGroupIndices(const int64 flat_group_index,
-                          const TensorShape& group_shape,
-                          std::vector<int64>* group_indices) {
-  group_indices->clear();
-  int64 running_flat_group_index = flat_group_index;
-  for (auto group_dim_index = group_shape.dims() - 1; group_dim_index >= 0;
-       --group_dim_index) {
-    const auto group_dim = group_shape.dim_size(group_dim_index);
-    group_indices->insert(group_indices->begin(),
-                          running_flat_group_index % group_dim);
-    running_flat_group_index /= group_dim;
+// Apply the set operation to each group in `groups`, whose ranges are into
+// `set1_values` and `set2_values`, and output the result `SparseTensor`.
+// Groups are processed in parallel in 2 passes: the first sorts the values of
+// each group and counts the values of its result, which gives the position of
+// each result in the output tensors; the second writes the results directly
+// to the output tensors. Values in each output set are in increasing order.
+template <typename T>
+void SetOperationOp<T>::ComputeGroups(
+    OpKernelContext* ctx, const TensorShape& group_shape,
+    const Tensor& set1_values, const Tensor& set2_values,
+    const std::vector<GroupRanges>& groups) const {
+  const int64 num_groups = groups.size();
+  const T* set1 = set1_values.flat<T>().data();
+  const T* set2 = set2_values.flat<T>().data();
+
+  // Sorted, distinct values of each group, at the same positions as in the
+  // inputs. The limits of `sorted_groups` are the ends of the distinct values.
+  std::vector<T> sorted1(set1_values.NumElements());
+  std::vector<T> sorted2(set2_values.NumElements());
+  std::vector<GroupRanges> sorted_groups(groups);
+  // `result_offsets[i]` is the position of the result of group i in the
+  // output, and `result_offsets[num_groups]` is the number of output values.
+  std::vector<int64> result_offsets(num_groups + 1, 0);
+
+  // Rough cost of sorting and merging one value.
+  static const int64 kCostPerValue = 100;
+  const int64 num_input_values = sorted1.size() + sorted2.size();
+  const int64 cost_per_group =
+      kCostPerValue * (1 + num_input_values / std::max<int64>(1, num_groups));
+  const auto& worker_threads =
+      *(ctx->device()->tensorflow_cpu_worker_threads());
+
+  auto count_results = [&](int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      GroupRanges& group = sorted_groups[i];
+      group.set1_limit = SortUnique(set1, group.set1_start, group.set1_limit,
+                                    sorted1.data());
+      group.set2_limit = SortUnique(set2, group.set2_start, group.set2_limit,
+                                    sorted2.data());
+      int64 set_size = 0;
+      ApplySetOperation(set_operation_, sorted1.data() + group.set1_start,
+                        sorted1.data() + group.set1_limit,
+                        sorted2.data() + group.set2_start,
+                        sorted2.data() + group.set2_limit,
+                        [&set_size](const T&) { ++set_size; });
+      result_offsets[i + 1] = set_size;
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_groups,
+        cost_per_group, count_results);
+
+  int64 max_set_size = 0;
+  for (int64 i = 0; i < num_groups; ++i) {
+    max_set_size = std::max(max_set_size, result_offsets[i + 1]);
+    result_offsets[i + 1] += result_offsets[i];
+  }
+  const int64 num_values = result_offsets[num_groups];
+
+  TensorShape output_shape(group_shape);
+  output_shape.AddDim(max_set_size);
+
+  // Allocate 3 output tensors for sparse data.
+  Tensor *out_indices_t, *out_values_t, *out_shape_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                          0, TensorShape({num_values, output_shape.dims()}),
+                          &out_indices_t));
+  OP_REQUIRES_OK(
+      ctx, ctx->allocate_output(1, TensorShape({num_values}), &out_values_t));
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                          2, TensorShape({output_shape.dims()}), &out_shape_t));
+  auto out_indices_mat = out_indices_t->matrix<int64>();
+  auto out_values_flat = out_values_t->vec<T>();
+
+  // For each set, write its indices and values to output tensors. The first
+  // n-1 dimensions of each index are the group, and the last dimension is the
+  // position in the set.
+  const int32 group_rank = group_shape.dims();
+  const auto group_strides = Strides(group_shape);
+  auto write_results = [&](int64 start, int64 limit) {
+    gtl::InlinedVector<int64, 8> group_indices(group_rank);
+    for (int64 i = start; i < limit; ++i) {
+      const GroupRanges& group = sorted_groups[i];
+      for (int32 j = 0; j < group_rank; ++j) {
+        group_indices[j] =
+            (group.group / group_strides[j]) % group_shape.dim_size(j);
+      }
+      const int64 group_start = result_offsets[i];
+      int64 value_index = group_start;
+      ApplySetOperation(set_operation_, sorted1.data() + group.set1_start,
+                        sorted1.data() + group.set1_limit,
+                        sorted2.data() + group.set2_start,
+                        sorted2.data() + group.set2_limit,
+                        [&](const T& value) {
+                          for (int32 j = 0; j < group_rank; ++j) {
+                            out_indices_mat(value_index, j) = group_indices[j];
+                          }
+                          out_indices_mat(value_index, group_rank) =
+                              value_index - group_start;
+                          out_values_flat(value_index) = value;
+                          ++value_index;
+                        });
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_groups,
+        cost_per_group, write_results);
+
+  // Write output shape.
+  auto out_shape_flat = out_shape_t->vec<int64>();
+  for (int32 i = 0; i < output_shape.dims(); ++i) {
+    out_shape_flat(i) = output_shape.dim_size(i);
   }
 }
 
 // `ctx` contains set1 and set2 dense tensors.
-// Iterate over groups in set1 and set2, applying `ApplySetOperation` to each,
-// and outputing the result `SparseTensor`. A "group" is a collection of values
-// with the same first n-1 dimensions in set1 and set2.
+// Apply the set operation to each group of set1 and set2, and output the
+// result `SparseTensor`. A "group" is a collection of values with the same
+// first n-1 dimensions in set1 and set2.
 template <typename T>
 void SetOperationOp<T>::ComputeDenseToDense(OpKernelContext* ctx) const {
   const Tensor& set1_t = ctx->input(0);
@@ -421,231 +510,110 @@ void SetOperationOp<T>::ComputeDenseToDense(OpKernelContext* ctx) const {
   // `DenseToDenseSetOperation` in ops/set_ops.cc.
   const TensorShape group_shape =
       GroupShapeFromInputs(ctx, set1_t.shape(), set2_t.shape());
-
-  const auto set1_strides = Strides(set1_t.shape());
-  const auto set2_strides = Strides(set2_t.shape());
-
-  std::map<std::vector<int64>, std::set<T>> group_sets;
-  int64 num_result_values = 0;
-  int64 max_set_size = 0;
-
-  std::set<T> set1_group_set;
-  std::set<T> set2_group_set;
-  std::vector<int64> group_indices;
-  for (int64 flat_group_index = 0;
-       flat_group_index < group_shape.num_elements(); ++flat_group_index) {
-    PopulateGroupIndices(flat_group_index, group_shape, &group_indices);
-    PopulateFromDenseGroup<T>(ctx, set1_t, set1_strides, group_indices,
-                              &set1_group_set);
-    PopulateFromDenseGroup<T>(ctx, set2_t, set2_strides, group_indices,
-                              &set2_group_set);
-
-    std::set<T> group_set;
-    ApplySetOperation(set1_group_set, set2_group_set, &group_set);
-    if (!group_set.empty()) {
-      group_sets[group_indices] = group_set;
-      const auto set_size = group_set.size();
-      if (set_size > max_set_size) {
-        max_set_size = set_size;
-      }
-      num_result_values += set_size;
-    }
+  if (!ctx->status().ok()) return;
+
+  const int64 set1_size = set1_t.dim_size(set1_t.dims() - 1);
+  const int64 set2_size = set2_t.dim_size(set2_t.dims() - 1);
+  const int64 num_groups = group_shape.num_elements();
+  std::vector<GroupRanges> groups(num_groups);
+  for (int64 group = 0; group < num_groups; ++group) {
+    groups[group] = {group, group * set1_size, (group + 1) * set1_size,
+                     group * set2_size, (group + 1) * set2_size};
   }
-
-  TensorShape output_shape(group_shape);
-  output_shape.AddDim(max_set_size);
-  OutputSparseTensor<T>(ctx, output_shape, num_result_values, group_sets);
+  ComputeGroups(ctx, group_shape, set1_t, set2_t, groups);
 }
 
 // `ctx` contains dense set1 and sparse set2 tensors.
-// Iterate over groups in set1 and set2, applying `ApplySetOperation` to each,
-// and outputing the result `SparseTensor`. A "group" is a collection of values
-// with the same first n-1 dimensions in set1 and set2.
+// Apply the set operation to each group of set1 and set2, and output the
+// result `SparseTensor`. A "group" is a collection of values with the same
+// first n-1 dimensions in set1 and set2.
 template <typename T>
 void SetOperationOp<T>::ComputeDenseToSparse(OpKernelContext* ctx) const {
   const Tensor& set1_t = ctx->input(0);
   const sparse::SparseTensor set2_st =
       SparseTensorFromContext(ctx, 1, validate_indices_);
+  if (!ctx->status().ok()) return;
   // The following should stay in sync with `_dense_to_sparse_shape` shape
   // assertions in python/ops/set_ops.py, and `SetShapeFn` for
   // `DenseToSparseSetOperation` in ops/set_ops.cc.
   const TensorShape group_shape =
       GroupShapeFromInputs(ctx, set1_t.shape(), set2_st.shape());
-
-  const auto set1_strides = Strides(set1_t.shape());
-
-  std::map<std::vector<int64>, std::set<T>> group_sets;
-  int64 num_result_values = 0;
-  int64 max_set_size = 0;
-
-  std::set<T> set1_group_set;
-  std::set<T> set2_group_set;
-  auto set2_grouper = set2_st.group(sparse::SparseTensor::VarDimArray(
-      set2_st.order(), 0, set2_st.order().size() - 1));
-  auto set2_group_it = set2_grouper.begin();
-  std::vector<int64> group_indices;
-  for (int64 flat_group_index = 0;
-       flat_group_index < group_shape.num_elements(); ++flat_group_index) {
-    PopulateGroupIndices(flat_group_index, group_shape, &group_indices);
-
-    // Get values from set1.
-    PopulateFromDenseGroup<T>(ctx, set1_t, set1_strides, group_indices,
-                              &set1_group_set);
-
-    // Get values from set2, if applicable.
-    set2_group_set.clear();
-    if (set2_group_it != set2_grouper.end()) {
-      const auto& group = *set2_group_it;
-      const auto set2_group_indices = group.group();
-      OP_REQUIRES(
-          ctx, set2_group_indices.size() == group_indices.size(),
-          errors::InvalidArgument("Invalid number of group indices ",
-                                  set2_group_indices.size(), ", expected ",
-                                  group_indices.size(), "."));
-      bool group_match = true;
-      for (int32 i = 0; group_match && (i < set2_group_indices.size()); ++i) {
-        if (set2_group_indices[i] != group_indices[i]) {
-          group_match = false;
-        }
-      }
-      if (group_match) {
-        PopulateFromSparseGroup<T>(ctx, group, set2_st.shape(),
-                                   &set2_group_set);
-        ++set2_group_it;
-      }
-    }
-
-    std::set<T> group_set;
-    ApplySetOperation(set1_group_set, set2_group_set, &group_set);
-    if (!group_set.empty()) {
-      group_sets[group_indices] = group_set;
-      const auto set_size = group_set.size();
-      if (set_size > max_set_size) {
-        max_set_size = set_size;
-      }
-      num_result_values += set_size;
-    }
-  }
-
-  TensorShape output_shape(group_shape);
-  output_shape.AddDim(max_set_size);
-  OutputSparseTensor<T>(ctx, output_shape, num_result_values, group_sets);
-}
-
-// This is used to determine which group iterator is less than the other, based
-// on row-major ordering of indices.
-// An empty index list indicates end of iteration, which is interpreted as "max"
-// for the purposes of comparison; i.e., non-empty < empty.
-// Return 0 if both groups are empty, or both non-empty with the same values.
-// Return <0 if set1 <= set2, or set2 is empty.
-// Return >0 if set2 <= set1, or set1 is empty.
-void CompareGroups(OpKernelContext* ctx,
-                   const std::vector<int64>& set1_group_indices,
-                   const std::vector<int64>& set2_group_indices,
-                   int64* result) {
-  if (set1_group_indices.empty()) {
-    *result = set2_group_indices.empty() ? 0 : 1;
-    return;
-  }
-  if (set2_group_indices.empty()) {
-    *result = set1_group_indices.empty() ? 0 : -1;
-    return;
-  }
-  OP_REQUIRES(ctx, set1_group_indices.size() == set2_group_indices.size(),
-              errors::InvalidArgument("Mismatched group dims ",
-                                      set1_group_indices.size(), " vs ",
-                                      set2_group_indices.size(), "."));
-  for (int32 i = 0; i < set1_group_indices.size(); ++i) {
-    *result = set1_group_indices[i] - set2_group_indices[i];
-    if (*result != 0) {
-      return;
+  if (!ctx->status().ok()) return;
+
+  std::vector<SparseGroup> set2_groups;
+  OP_REQUIRES_OK(ctx,
+                 SparseGroupsFromTensor(set2_st, group_shape, &set2_groups));
+
+  const int64 set1_size = set1_t.dim_size(set1_t.dims() - 1);
+  const int64 num_groups = group_shape.num_elements();
+  std::vector<GroupRanges> groups(num_groups);
+  auto set2_group_it = set2_groups.begin();
+  for (int64 group = 0; group < num_groups; ++group) {
+    groups[group] = {group, group * set1_size, (group + 1) * set1_size, 0, 0};
+    if (set2_group_it != set2_groups.end() && set2_group_it->group == group) {
+      groups[group].set2_start = set2_group_it->start;
+      groups[group].set2_limit = set2_group_it->limit;
+      ++set2_group_it;
     }
   }
+  ComputeGroups(ctx, group_shape, set1_t, set2_st.values(), groups);
 }
 
-// Empty indices vector represents iteration end in `CompareGroups`.
-const std::vector<int64> GROUP_ITER_END;
-
 // `ctx` contains set1 and set2 sparse tensors.
-// Iterate over groups in set1 and set2, applying `ApplySetOperation` to each,
-// and outputing the result `SparseTensor`. A "group" is a collection of values
-// with the same first n-1 dimensions in set1 and set2.
+// Apply the set operation to each group present in set1 or set2, and output
+// the result `SparseTensor`. A "group" is a collection of values with the same
+// first n-1 dimensions in set1 and set2.
 template <typename T>
 void SetOperationOp<T>::ComputeSparseToSparse(OpKernelContext* ctx) const {
   const sparse::SparseTensor set1_st =
       SparseTensorFromContext(ctx, 0, validate_indices_);
   const sparse::SparseTensor set2_st =
       SparseTensorFromContext(ctx, 3, validate_indices_);
+  if (!ctx->status().ok()) return;
   // The following should stay in sync with `_sparse_to_sparse_shape` shape
   // assertions in python/ops/set_ops.py, and `SetShapeFn` for
   // `SparseToSparseSetOperation` in ops/set_ops.cc.
   const TensorShape group_shape =
       GroupShapeFromInputs(ctx, set1_st.shape(), set2_st.shape());
-
-  const auto set1_strides = Strides(set1_st.shape());
-  const auto set2_strides = Strides(set2_st.shape());
-
-  std::map<std::vector<int64>, std::set<T>> group_sets;
-  int64 num_result_values = 0;
-  int64 max_set_size = 0;
-
-  std::set<T> set1_group_set;
-  std::set<T> set2_group_set;
-  auto set1_grouper = set1_st.group(sparse::SparseTensor::VarDimArray(
-      set1_st.order(), 0, set1_st.order().size() - 1));
-  auto set1_group_it = set1_grouper.begin();
-  auto set2_grouper = set2_st.group(sparse::SparseTensor::VarDimArray(
-      set2_st.order(), 0, set2_st.order().size() - 1));
-  auto set2_group_it = set2_grouper.begin();
-
-  // Group by rows, and iterate over rows of both sets in parallel, creating a
-  // set for each row.
-  while ((set1_group_it != set1_grouper.end()) ||
-         (set2_group_it != set2_grouper.end())) {
-    const std::vector<int64>& set1_group_indices =
-        (set1_group_it == set1_grouper.end()) ? GROUP_ITER_END
-                                              : (*set1_group_it).group();
-    const std::vector<int64>& set2_group_indices =
-        (set2_group_it == set2_grouper.end()) ? GROUP_ITER_END
-                                              : (*set2_group_it).group();
-
-    int64 compare_groups;
-    CompareGroups(ctx, set1_group_indices, set2_group_indices, &compare_groups);
-    const std::vector<int64>* group_indices;
-
-    // Get values from set1, if applicable.
-    set1_group_set.clear();
-    if (compare_groups <= 0) {
-      PopulateFromSparseGroup<T>(ctx, *set1_group_it, set1_st.shape(),
-                                 &set1_group_set);
+  if (!ctx->status().ok()) return;
+
+  std::vector<SparseGroup> set1_groups;
+  OP_REQUIRES_OK(ctx,
+                 SparseGroupsFromTensor(set1_st, group_shape, &set1_groups));
+  std::vector<SparseGroup> set2_groups;
+  OP_REQUIRES_OK(ctx,
+                 SparseGroupsFromTensor(set2_st, group_shape, &set2_groups));
+
+  // Merge the groups of both sets, which are in increasing group order.
+  std::vector<GroupRanges> groups;
+  auto set1_group_it = set1_groups.begin();
+  auto set2_group_it = set2_groups.begin();
+  while (set1_group_it != set1_groups.end() ||
+         set2_group_it != set2_groups.end()) {
+    const bool in_set1 =
+        set1_group_it != set1_groups.end() &&
+        (set2_group_it == set2_groups.end() ||
+         set1_group_it->group <= set2_group_it->group);
+    const bool in_set2 =
+        set2_group_it != set2_groups.end() &&
+        (set1_group_it == set1_groups.end() ||
+         set2_group_it->group <= set1_group_it->group);
+    GroupRanges group = {0, 0, 0, 0, 0};
+    if (in_set1) {
+      group.group = set1_group_it->group;
+      group.set1_start = set1_group_it->start;
+      group.set1_limit = set1_group_it->limit;
       ++set1_group_it;
-      group_indices = &set1_group_indices;
     }
-
-    // Get values from set2, if applicable.
-    set2_group_set.clear();
-    if (compare_groups >= 0) {
-      PopulateFromSparseGroup<T>(ctx, *set2_group_it, set2_st.shape(),
-                                 &set2_group_set);
+    if (in_set2) {
+      group.group = set2_group_it->group;
+      group.set2_start = set2_group_it->start;
+      group.set2_limit = set2_group_it->limit;
       ++set2_group_it;
-      group_indices = &set2_group_indices;
-    }
-
-    std::set<T> group_set;
-    ApplySetOperation(set1_group_set, set2_group_set, &group_set);
-    if (!group_set.empty()) {
-      group_sets[*group_indices] = group_set;
-      const auto set_size = group_set.size();
-      if (set_size > max_set_size) {
-        max_set_size = set_size;
-      }
-      num_result_values += set_size;
     }
+    groups.push_back(group);
   }
-
-  TensorShape output_shape(group_shape);
-  output_shape.AddDim(max_set_size);
-  OutputSparseTensor<T>(ctx, output_shape, num_result_values, group_sets);
+  ComputeGroups(ctx, group_shape, set1_st.values(), set2_st.values(), groups);
 }
 
 // Given set1 of shape [b, n1] and data_2 of shape [b, n2], populate result
@@ -961,6 +961,41 @@ class SetOpsTest(test_util.TensorFlowTestCase):
     with self.test_session() as sess:
       return sess.run(op)
 
+  def test_set_operations_many_rows(self):
+    # Enough rows for the kernels to split them across threads.
+    np.random.seed(7)
+    num_rows = 1000
+    a_rows = np.random.randint(0, 30, size=[num_rows, 20]).astype(np.int64)
+    b_rows = [list(np.random.randint(0, 30, size=[np.random.randint(0, 20)]))
+              for _ in range(num_rows)]
+    a = tf.constant(a_rows, tf.int64)
+    sp_a = _dense_to_sparse(a_rows, tf.int64)
+    sp_b = _dense_to_sparse(b_rows, tf.int64)
+    operations = [
+        (tf.contrib.metrics.set_intersection, lambda x, y: x & y),
+        (tf.contrib.metrics.set_union, lambda x, y: x | y),
+        (lambda x, y: tf.contrib.metrics.set_difference(x, y, aminusb=True),
+         lambda x, y: x - y),
+        (lambda x, y: tf.contrib.metrics.set_difference(x, y, aminusb=False),
+         lambda x, y: y - x),
+    ]
+    for set_op, python_set_op in operations:
+      expected_indices = []
+      expected_values = []
+      max_set_size = 0
+      for row in range(num_rows):
+        result = sorted(python_set_op(set(a_rows[row]), set(b_rows[row])))
+        expected_indices.extend([row, i] for i in range(len(result)))
+        expected_values.extend(result)
+        max_set_size = max(max_set_size, len(result))
+      for x in (a, sp_a):
+        with self.test_session() as sess:
+          result = sess.run(set_op(x, sp_b))
+        # Values of each set are in increasing order.
+        self.assertAllEqual(expected_indices, result.indices)
+        self.assertAllEqual(expected_values, result.values)
+        self.assertAllEqual([num_rows, max_set_size], result.shape)
+
   def _assert_set_operation(self, expected_indices, expected_values,
                             expected_shape, sparse_tensor, dtype):
     self.assertAllEqual(expected_indices, sparse_tensor.indices)
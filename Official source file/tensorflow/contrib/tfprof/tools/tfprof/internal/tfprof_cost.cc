@@ -0,0 +1,238 @@
+/* Copyright 2016 The TensorFlow Authors All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/tfprof/tools/tfprof/internal/tfprof_cost.h"
+
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <set>
+#include <string>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+namespace tfprof {
+namespace {
+
+typedef std::function<int64(const NodeDef&, const std::vector<TensorInfo>&,
+                            const std::vector<TensorInfo>&)>
+    FloatOpsFn;
+
+// Ops that only forward, alias or describe tensors. They neither compute nor
+// move tensor data.
+const std::set<string>& NoCostOps() {
+  static const std::set<string>* ops = new std::set<string>({
+      "Const", "ExpandDims", "Identity", "NoOp", "Placeholder", "Rank",
+      "RefIdentity", "Reshape", "Shape", "ShapeN", "Size", "Squeeze",
+      "StopGradient", "Variable", "VariableV2", "_Recv", "_Send",
+  });
+  return *ops;
+}
+
+bool GetBoolAttr(const NodeDef& node, const string& name) {
+  auto it = node.attr().find(name);
+  return it != node.attr().end() && it->second.b();
+}
+
+// Returns dimension 'dim' of 'shape'; negative 'dim' counts from the end.
+// Returns -1 if out of range or unknown.
+int64 Dim(const std::vector<int64>& shape, int dim) {
+  if (dim < 0) dim += shape.size();
+  if (dim < 0 || dim >= static_cast<int>(shape.size())) return -1;
+  return shape[dim];
+}
+
+// Returns -1 if any factor is unknown.
+int64 KnownProduct(std::initializer_list<int64> factors) {
+  int64 product = 1;
+  for (int64 f : factors) {
+    if (f < 0) return -1;
+    product *= f;
+  }
+  return product;
+}
+
+int64 OutputElements(const std::vector<TensorInfo>& outputs) {
+  if (outputs.empty()) return -1;
+  return NumElements(outputs[0].shape);
+}
+
+int64 InputElements(const std::vector<TensorInfo>& inputs, int i) {
+  if (i >= static_cast<int>(inputs.size())) return -1;
+  return NumElements(inputs[i].shape);
+}
+
+// One float op per output element.
+int64 ElementwiseFloatOps(const NodeDef& node,
+                          const std::vector<TensorInfo>& inputs,
+                          const std::vector<TensorInfo>& outputs) {
+  return OutputElements(outputs);
+}
+
+// One float op per input element.
+int64 ReductionFloatOps(const NodeDef& node,
+                        const std::vector<TensorInfo>& inputs,
+                        const std::vector<TensorInfo>& outputs) {
+  return InputElements(inputs, 0);
+}
+
+int64 MatMulFloatOps(const NodeDef& node, const std::vector<TensorInfo>& inputs,
+                     const std::vector<TensorInfo>& outputs) {
+  if (inputs.empty()) return -1;
+  const int64 k =
+      Dim(inputs[0].shape, GetBoolAttr(node, "transpose_a") ? 0 : 1);
+  return KnownProduct({2, OutputElements(outputs), k});
+}
+
+int64 BatchMatMulFloatOps(const NodeDef& node,
+                          const std::vector<TensorInfo>& inputs,
+                          const std::vector<TensorInfo>& outputs) {
+  if (inputs.empty()) return -1;
+  const int64 k = Dim(inputs[0].shape, GetBoolAttr(node, "adj_x") ? -2 : -1);
+  return KnownProduct({2, OutputElements(outputs), k});
+}
+
+// Each element of the convolution output ('out_elements') is a dot product of
+// length filter_rows * filter_cols * in_depth.
+int64 ConvFloatOps(int64 out_elements, const std::vector<int64>& filter) {
+  return KnownProduct(
+      {2, out_elements, Dim(filter, 0), Dim(filter, 1), Dim(filter, 2)});
+}
+
+int64 Conv2DFloatOps(const NodeDef& node, const std::vector<TensorInfo>& inputs,
+                     const std::vector<TensorInfo>& outputs) {
+  if (inputs.size() < 2) return -1;
+  return ConvFloatOps(OutputElements(outputs), inputs[1].shape);
+}
+
+// Inputs: input_sizes, filter, out_backprop.
+int64 Conv2DBackpropInputFloatOps(const NodeDef& node,
+                                  const std::vector<TensorInfo>& inputs,
+                                  const std::vector<TensorInfo>& outputs) {
+  if (inputs.size() < 3) return -1;
+  return ConvFloatOps(InputElements(inputs, 2), inputs[1].shape);
+}
+
+// Inputs: input, filter_sizes, out_backprop. The output is the filter.
+int64 Conv2DBackpropFilterFloatOps(const NodeDef& node,
+                                   const std::vector<TensorInfo>& inputs,
+                                   const std::vector<TensorInfo>& outputs) {
+  if (inputs.size() < 3 || outputs.empty()) return -1;
+  return ConvFloatOps(InputElements(inputs, 2), outputs[0].shape);
+}
+
+// Filter: [filter_rows, filter_cols, in_depth, depth_multiplier].
+int64 DepthwiseConv2dFloatOps(const NodeDef& node,
+                              const std::vector<TensorInfo>& inputs,
+                              const std::vector<TensorInfo>& outputs) {
+  if (inputs.size() < 2) return -1;
+  return KnownProduct({2, OutputElements(outputs), Dim(inputs[1].shape, 0),
+                       Dim(inputs[1].shape, 1)});
+}
+
+int64 PoolFloatOps(const NodeDef& node, const std::vector<TensorInfo>& inputs,
+                   const std::vector<TensorInfo>& outputs) {
+  auto it = node.attr().find("ksize");
+  if (it == node.attr().end()) return -1;
+  int64 window = 1;
+  for (int64 k : it->second.list().i()) {
+    window *= k;
+  }
+  return KnownProduct({OutputElements(outputs), window});
+}
+
+// max, subtract, exp, sum and divide per element.
+int64 SoftmaxFloatOps(const NodeDef& node,
+                      const std::vector<TensorInfo>& inputs,
+                      const std::vector<TensorInfo>& outputs) {
+  return KnownProduct({5, OutputElements(outputs)});
+}
+
+int64 AddNFloatOps(const NodeDef& node, const std::vector<TensorInfo>& inputs,
+                   const std::vector<TensorInfo>& outputs) {
+  if (inputs.empty()) return -1;
+  return KnownProduct({static_cast<int64>(inputs.size()) - 1,
+                       OutputElements(outputs)});
+}
+
+const std::map<string, FloatOpsFn>& FloatOpsFns() {
+  static const std::map<string, FloatOpsFn>* fns = [] {
+    auto* m = new std::map<string, FloatOpsFn>;
+    for (const char* op :
+         {"Abs", "Add", "BiasAdd", "Div", "Exp", "Log", "Maximum", "Minimum",
+          "Mul", "Neg", "RealDiv", "Relu", "Relu6", "Rsqrt", "Sigmoid", "Sqrt",
+          "Square", "SquaredDifference", "Sub", "Tanh"}) {
+      (*m)[op] = ElementwiseFloatOps;
+    }
+    for (const char* op : {"Max", "Mean", "Min", "Prod", "Sum"}) {
+      (*m)[op] = ReductionFloatOps;
+    }
+    (*m)["AddN"] = AddNFloatOps;
+    (*m)["AvgPool"] = PoolFloatOps;
+    (*m)["BatchMatMul"] = BatchMatMulFloatOps;
+    (*m)["Conv2D"] = Conv2DFloatOps;
+    (*m)["Conv2DBackpropFilter"] = Conv2DBackpropFilterFloatOps;
+    (*m)["Conv2DBackpropInput"] = Conv2DBackpropInputFloatOps;
+    (*m)["DepthwiseConv2dNative"] = DepthwiseConv2dFloatOps;
+    (*m)["LogSoftmax"] = SoftmaxFloatOps;
+    (*m)["MatMul"] = MatMulFloatOps;
+    (*m)["MaxPool"] = PoolFloatOps;
+    (*m)["Softmax"] = SoftmaxFloatOps;
+    return m;
+  }();
+  return *fns;
+}
+
+int64 TensorBytes(const std::vector<TensorInfo>& tensors) {
+  int64 bytes = 0;
+  for (const TensorInfo& t : tensors) {
+    const int64 elements = NumElements(t.shape);
+    if (elements < 0 || t.dtype == DT_INVALID) continue;
+    bytes += elements * DataTypeSize(BaseType(t.dtype));
+  }
+  return bytes;
+}
+
+}  // namespace
+
+int64 NumElements(const std::vector<int64>& shape) {
+  int64 n = 1;
+  for (int64 d : shape) {
+    if (d < 0) return -1;
+    n *= d;
+  }
+  return n;
+}
+
+bool EstimateOpCost(const NodeDef& node, const std::vector<TensorInfo>& inputs,
+                    const std::vector<TensorInfo>& outputs, OpCost* cost) {
+  *cost = OpCost();
+  if (NoCostOps().count(node.op())) return true;
+
+  cost->input_bytes = TensorBytes(inputs);
+  cost->output_bytes = TensorBytes(outputs);
+
+  auto fn = FloatOpsFns().find(node.op());
+  if (fn == FloatOpsFns().end()) return true;
+  const int64 float_ops = fn->second(node, inputs, outputs);
+  if (float_ops < 0) return false;
+  cost->float_ops = float_ops;
+  return true;
+}
+
+}  // namespace tfprof
+}  // namespace tensorflow
@@ -0,0 +1,65 @@
+/* Copyright 2016 The TensorFlow Authors All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// C++-side cost model for tfprof: estimates float operations and bytes
+// moved by an op from its input and output tensor shapes. Used when no
+// Python-registered statistics (OpLog float_ops) are available, and to
+// compute achieved FLOP/s, bandwidth and roofline efficiency.
+
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_TFPROF_TOOLS_TFPROF_INTERNAL_TFPROF_COST_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_TFPROF_TOOLS_TFPROF_INTERNAL_TFPROF_COST_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace tfprof {
+
+// dtype and shape of one tensor consumed or produced by an op. A dimension
+// < 0 means unknown.
+struct TensorInfo {
+  TensorInfo() : dtype(DT_INVALID) {}
+  TensorInfo(DataType dtype, const std::vector<int64>& shape)
+      : dtype(dtype), shape(shape) {}
+
+  DataType dtype;
+  std::vector<int64> shape;
+};
+
+struct OpCost {
+  OpCost() : float_ops(0), input_bytes(0), output_bytes(0) {}
+
+  int64 float_ops;
+  int64 input_bytes;
+  int64 output_bytes;
+};
+
+// Number of elements of 'shape', or -1 if any dimension is unknown.
+int64 NumElements(const std::vector<int64>& shape);
+
+// Estimates the cost of running 'node' on tensors 'inputs' (in input order)
+// producing 'outputs' (indexed by output slot). Inputs or outputs with
+// unknown shapes contribute no bytes. Returns false if the op type has a
+// float_ops cost function but the shapes it needs are not known.
+bool EstimateOpCost(const NodeDef& node, const std::vector<TensorInfo>& inputs,
+                    const std::vector<TensorInfo>& outputs, OpCost* cost);
+
+}  // namespace tfprof
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_TFPROF_TOOLS_TFPROF_INTERNAL_TFPROF_COST_H_
@@ -0,0 +1,95 @@
+/* Copyright 2016 The TensorFlow Authors All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/tfprof/tools/tfprof/internal/tfprof_cost.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tfprof {
+namespace {
+
+NodeDef MakeNode(const string& op) {
+  NodeDef node;
+  node.set_name("n");
+  node.set_op(op);
+  return node;
+}
+
+TEST(TFProfCostTest, MatMul) {
+  NodeDef node = MakeNode("MatMul");
+  (*node.mutable_attr())["transpose_a"].set_b(true);
+  OpCost cost;
+  EXPECT_TRUE(EstimateOpCost(node,
+                             {TensorInfo(DT_FLOAT, {5, 2}),
+                              TensorInfo(DT_FLOAT, {5, 3})},
+                             {TensorInfo(DT_FLOAT, {2, 3})}, &cost));
+  EXPECT_EQ(2 * 2 * 5 * 3, cost.float_ops);
+  EXPECT_EQ((10 + 15) * 4, cost.input_bytes);
+  EXPECT_EQ(6 * 4, cost.output_bytes);
+}
+
+TEST(TFProfCostTest, Conv2D) {
+  OpCost cost;
+  EXPECT_TRUE(EstimateOpCost(MakeNode("Conv2D"),
+                             {TensorInfo(DT_FLOAT, {2, 6, 6, 3}),
+                              TensorInfo(DT_FLOAT, {3, 3, 3, 6})},
+                             {TensorInfo(DT_FLOAT, {2, 3, 3, 6})}, &cost));
+  EXPECT_EQ(5832, cost.float_ops);
+  EXPECT_EQ(864 + 648, cost.input_bytes);
+  EXPECT_EQ(432, cost.output_bytes);
+}
+
+TEST(TFProfCostTest, Elementwise) {
+  OpCost cost;
+  EXPECT_TRUE(EstimateOpCost(MakeNode("Add"),
+                             {TensorInfo(DT_DOUBLE, {4, 8}),
+                              TensorInfo(DT_DOUBLE, {8})},
+                             {TensorInfo(DT_DOUBLE, {4, 8})}, &cost));
+  EXPECT_EQ(32, cost.float_ops);
+  EXPECT_EQ((32 + 8) * 8, cost.input_bytes);
+  EXPECT_EQ(32 * 8, cost.output_bytes);
+}
+
+TEST(TFProfCostTest, NoCostOps) {
+  OpCost cost;
+  EXPECT_TRUE(EstimateOpCost(MakeNode("Identity"),
+                             {TensorInfo(DT_FLOAT, {100})},
+                             {TensorInfo(DT_FLOAT, {100})}, &cost));
+  EXPECT_EQ(0, cost.float_ops);
+  EXPECT_EQ(0, cost.input_bytes);
+  EXPECT_EQ(0, cost.output_bytes);
+}
+
+TEST(TFProfCostTest, UnknownShapes) {
+  OpCost cost;
+  // Unknown output shape: no float ops can be derived.
+  EXPECT_FALSE(EstimateOpCost(MakeNode("Conv2D"),
+                              {TensorInfo(DT_FLOAT, {2, 6, 6, 3}),
+                               TensorInfo(DT_FLOAT, {3, 3, 3, 6})},
+                              {TensorInfo(DT_FLOAT, {-1, 3, 3, 6})}, &cost));
+  // Ops without a float ops function only account bytes of known tensors.
+  EXPECT_TRUE(EstimateOpCost(MakeNode("Transpose"),
+                             {TensorInfo(DT_FLOAT, {2, 3}), TensorInfo()},
+                             {TensorInfo(DT_FLOAT, {3, 2})}, &cost));
+  EXPECT_EQ(0, cost.float_ops);
+  EXPECT_EQ(24, cost.input_bytes);
+  EXPECT_EQ(24, cost.output_bytes);
+}
+
+}  // namespace
+}  // namespace tfprof
+}  // namespace tensorflow
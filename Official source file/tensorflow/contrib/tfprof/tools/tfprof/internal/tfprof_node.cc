@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/contrib/tfprof/tools/tfprof/internal/tfprof_node.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor_description.pb.h"
 
@@ -41,6 +43,43 @@ void TFNode::AddStepStat(const string& device, const NodeExecStats* step_stat) {
                               .allocation_description()
                               .requested_bytes();
     }
+    if (output.has_tensor_description() &&
+        output.tensor_description().has_shape()) {
+      const TensorDescription& desc = output.tensor_description();
+      std::vector<int64> shape;
+      for (const auto& d : desc.shape().dim()) {
+        shape.push_back(d.size());
+      }
+      output_tensors_[output.slot()] = TensorInfo(desc.dtype(), shape);
+    }
+  }
+}
+
+const TensorInfo* TFNode::output_tensor(int32 output_idx) const {
+  auto it = output_tensors_.find(output_idx);
+  if (it == output_tensors_.end()) return nullptr;
+  return &it->second;
+}
+
+void TFNode::ComputeCost() {
+  if (!node_ || output_tensors_.empty()) return;
+
+  std::vector<TensorInfo> inputs;
+  for (const auto& input : data_inputs_) {
+    const TensorInfo* t = input.first->output_tensor(input.second);
+    inputs.push_back(t ? *t : TensorInfo());
+  }
+  const int32 num_outputs = std::max(0, output_tensors_.rbegin()->first + 1);
+  std::vector<TensorInfo> outputs(num_outputs);
+  for (const auto& output : output_tensors_) {
+    if (output.first >= 0) outputs[output.first] = output.second;
+  }
+
+  OpCost cost;
+  if (!EstimateOpCost(*node_, inputs, outputs, &cost)) return;
+  bytes_accessed_ = cost.input_bytes + cost.output_bytes;
+  if (float_ops_ == 0) {
+    float_ops_ = cost.float_ops;
   }
 }
 }  // namespace tfprof
@@ -19,8 +19,10 @@ limitations under the License.
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "tensorflow/contrib/tfprof/tools/tfprof/internal/tfprof_cost.h"
 #include "tensorflow/contrib/tfprof/tools/tfprof/internal/tfprof_options.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -42,7 +44,8 @@ class TFNode {
         op_exec_micros_(0),
         all_spent_micros_(0),
         requested_bytes_(0),
-        float_ops_(0) {
+        float_ops_(0),
+        bytes_accessed_(0) {
     if (!node) return;
 
     for (const auto& attr : node->attr()) {
@@ -66,12 +69,29 @@ class TFNode {
 
   void AddInput(TFNode* input) { inputs_[input->node_def()->name()] = input; }
 
+  // Records a data input, in input order, consuming output 'output_idx' of
+  // 'input'. Used to find input tensor shapes for the cost model.
+  void AddDataInput(TFNode* input, int32 output_idx) {
+    AddInput(input);
+    data_inputs_.push_back(std::make_pair(input, output_idx));
+  }
+
   void AddOpType(const string& op_type) { op_types_.insert(op_type); }
 
   void AddStepStat(const string& device, const NodeExecStats* step_stat);
 
   void AddFloatOps(int64 float_ops) { float_ops_ = float_ops; }
 
+  // Estimates float ops and bytes accessed from the input/output tensors
+  // recorded in RunMetadata. Must be called after all step stats and op logs
+  // are added. float_ops() registered through OpLog take precedence over the
+  // estimate.
+  void ComputeCost();
+
+  // Returns the output tensor at 'output_idx' recorded from RunMetadata, or
+  // nullptr if unknown.
+  const TensorInfo* output_tensor(int32 output_idx) const;
+
   const NodeDef* node_def() { return node_; }
   const std::map<string, TFNode*>& inputs() { return inputs_; }
   int64 op_start_micros() { return op_start_micros_; }
@@ -79,6 +99,7 @@ class TFNode {
   int64 all_spent_micros() { return all_spent_micros_; }
   int64 requested_byptes() { return requested_bytes_; }
   int64 float_ops() { return float_ops_; }
+  int64 bytes_accessed() { return bytes_accessed_; }
   string device() { return device_; }
   const std::set<string>& op_types() { return op_types_; }
 
@@ -87,6 +108,8 @@ class TFNode {
 
  private:
   std::map<string, TFNode*> inputs_;
+  std::vector<std::pair<TFNode*, int32>> data_inputs_;
+  std::map<int32, TensorInfo> output_tensors_;
   const NodeDef* node_;
   const NodeExecStats* step_stat_;
 
@@ -98,6 +121,7 @@ class TFNode {
   int64 all_spent_micros_;
   int64 requested_bytes_;
   int64 float_ops_;
+  int64 bytes_accessed_;
 };
 
 }  // namespace tfprof
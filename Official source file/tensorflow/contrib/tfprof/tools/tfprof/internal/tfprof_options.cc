@@ -37,7 +37,9 @@ string Options::ToString() const {
       "%-28s%s\n"
       "%-28s%s\n"
       "%-28s%s\n"
-      "%-28s%s\n",
+      "%-28s%s\n"
+      "%-28s%g\n"
+      "%-28s%g\n",
       kOptions[0], max_depth, kOptions[1], min_bytes, kOptions[2], min_micros,
       kOptions[3], min_params, kOptions[4], min_float_ops, kOptions[5],
       str_util::Join(device_regexes, ",").c_str(), kOptions[6],
@@ -49,7 +51,8 @@ string Options::ToString() const {
       str_util::Join(hide_name_regexes, ",").c_str(), kOptions[12],
       (account_displayed_op_only ? "true" : "false"), kOptions[13],
       str_util::Join(select, ",").c_str(), kOptions[14],
-      (viz ? "true" : "false"), kOptions[15], dump_to_file.c_str());
+      (viz ? "true" : "false"), kOptions[15], dump_to_file.c_str(),
+      kOptions[16], peak_gflops, kOptions[17], peak_gbps);
   return s;
 }
 
@@ -44,6 +44,8 @@ static const char* const kOptions[] = {
     "-select",
     "-viz",
     "-dump_to_file",
+    "-peak_gflops",
+    "-peak_gbps",
 };
 
 static const char* const kOrderBy[] = {
@@ -54,6 +56,7 @@ static const char* const kOrderBy[] = {
 static const char* const kShown[] = {
     "bytes",          "micros",       "params", "float_ops",
     "num_hidden_ops", "tensor_value", "device", "op_types",
+    "roofline",
 };
 
 static const char* const kCmds[] = {
@@ -73,7 +76,8 @@ struct Options {
           const std::vector<string>& show_name_regexes,
           const std::vector<string>& hide_name_regexes,
           bool account_displayed_op_only, const std::vector<string>& select,
-          bool viz, const string& dump_to_file = "")
+          bool viz, const string& dump_to_file = "",
+          double peak_gflops = 0, double peak_gbps = 0)
       : max_depth(max_depth),
         min_bytes(min_bytes),
         min_micros(min_micros),
@@ -89,7 +93,9 @@ struct Options {
         account_displayed_op_only(account_displayed_op_only),
         select(select.begin(), select.end()),
         viz(viz),
-        dump_to_file(dump_to_file) {}
+        dump_to_file(dump_to_file),
+        peak_gflops(peak_gflops),
+        peak_gbps(peak_gbps) {}
 
   string ToString() const;
 
@@ -111,6 +117,10 @@ struct Options {
   std::set<string> select;
   bool viz;
   string dump_to_file;
+  // Host peak compute and memory bandwidth used for the roofline. 0 means
+  // unknown.
+  double peak_gflops;
+  double peak_gbps;
 };
 
 }  // namespace tfprof
@@ -33,6 +33,7 @@ ShowNode::ShowNode(TFNode* node) : node(node), account(true) {
   mutable_proto()->set_exec_micros(node->op_exec_micros());
   mutable_proto()->set_requested_bytes(node->requested_byptes());
   mutable_proto()->set_float_ops(node->float_ops());
+  mutable_proto()->set_bytes_accessed(node->bytes_accessed());
 
   if (!node->shape().empty()) {
     int64 params = 1;
@@ -103,6 +104,9 @@ string ShowNode::FormatMeta(const Options& opts) {
     }
     info.push_back(time);
   }
+  if (opts.select.find(kShown[8]) != opts.select.end()) {
+    info.push_back(FormatRoofline(opts));
+  }
   if (opts.select.find(kShown[6]) != opts.select.end()) {
     if (!proto().device().empty()) {
       info.push_back(proto().device());
@@ -119,6 +123,38 @@ string ShowNode::FormatMeta(const Options& opts) {
   return str_util::Join(info, ", ");
 }
 
+string ShowNode::FormatRoofline(const Options& opts) {
+  // Rates are computed over the accounted descendants as well, so that a
+  // scope shows the achieved throughput of everything below it.
+  const int64 micros = proto().total_exec_micros();
+  const int64 float_ops = proto().total_float_ops();
+  const int64 bytes = proto().total_bytes_accessed();
+  if (micros <= 0) {
+    return "--GFLOP/s, --GB/s";
+  }
+  // flops per microsecond == MFLOP/s; bytes per microsecond == MB/s.
+  const double gflops = float_ops / 1000.0 / micros;
+  const double gbps = bytes / 1000.0 / micros;
+  string roofline = strings::Printf("%.2fGFLOP/s, %.2fGB/s", gflops, gbps);
+  if (opts.peak_gflops <= 0 || opts.peak_gbps <= 0 || bytes <= 0) {
+    return roofline;
+  }
+  // Arithmetic intensity and the roof the op runs under at that intensity.
+  const double intensity = static_cast<double>(float_ops) / bytes;
+  const double memory_roof = intensity * opts.peak_gbps;
+  double efficiency;
+  if (memory_roof < opts.peak_gflops) {
+    strings::Appendf(&roofline, ", memory-bound");
+    efficiency = float_ops > 0 ? gflops / memory_roof : gbps / opts.peak_gbps;
+  } else {
+    strings::Appendf(&roofline, ", compute-bound");
+    efficiency = gflops / opts.peak_gflops;
+  }
+  strings::Appendf(&roofline, " (%.2f flops/B), %.1f%% of roofline",
+                   intensity, efficiency * 100);
+  return roofline;
+}
+
 TFProfNode* ShowNode::mutable_proto() { return &proto_; }
 
 const TFProfNode& ShowNode::proto() const { return proto_; }
@@ -133,6 +169,8 @@ void ShowNode::AggregateTotalStats(ShowNode* node) {
                                         node_pb->total_parameters());
   mutable_proto()->set_total_float_ops(proto().total_float_ops() +
                                        node_pb->total_float_ops());
+  mutable_proto()->set_total_bytes_accessed(proto().total_bytes_accessed() +
+                                            node_pb->total_bytes_accessed());
 }
 
 void ShowNode::AddSelfToTotalStats() {
@@ -144,6 +182,8 @@ void ShowNode::AddSelfToTotalStats() {
                                         proto().parameters());
   mutable_proto()->set_total_float_ops(proto().total_float_ops() +
                                        proto().float_ops());
+  mutable_proto()->set_total_bytes_accessed(proto().total_bytes_accessed() +
+                                            proto().bytes_accessed());
 }
 
 void ShowNode::ResetTotalStats() {
@@ -151,6 +191,7 @@ void ShowNode::ResetTotalStats() {
   mutable_proto()->set_total_requested_bytes(0);
   mutable_proto()->set_total_parameters(0);
   mutable_proto()->set_total_float_ops(0);
+  mutable_proto()->set_total_bytes_accessed(0);
 }
 
 const TFProfNode& TFShow::Show(const Options& opts) {
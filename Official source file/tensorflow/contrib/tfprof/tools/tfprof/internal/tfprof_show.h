@@ -48,6 +48,10 @@ class ShowNode {
 
   string FormatMeta(const Options& opts);
 
+  // Achieved GFLOP/s and GB/s and, if the peak rates are given in 'opts',
+  // whether the op is compute or memory bound and its roofline efficiency.
+  string FormatRoofline(const Options& opts);
+
   TFNode* node;
   bool account;
   string formatted_str;
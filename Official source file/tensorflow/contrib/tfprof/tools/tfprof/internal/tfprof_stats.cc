@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 
 #include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 
 namespace tensorflow {
 namespace tfprof {
@@ -43,6 +44,10 @@ TFStats::TFStats(std::unique_ptr<GraphDef> graph,
     ParseOpLog();
   }
 
+  for (auto it = nodes_map_.begin(); it != nodes_map_.end(); it++) {
+    it->second.ComputeCost();
+  }
+
   if (ckpt_reader_) {
     printf("Parsing Checkpoint...\n");
     for (const auto& v : ckpt_reader_->GetVariableToShapeMap()) {
@@ -84,18 +89,28 @@ void TFStats::ParseGraph() {
     const NodeDef* node_def = it->second.node_def();
     for (string node_input : node_def->input()) {
       // input name format can be: "^node:src_output"
+      int32 output_idx = 0;
       auto prefix_pos = node_input.find(":");
       if (prefix_pos != node_input.npos) {
-        node_input.substr(0, prefix_pos);
+        if (!strings::safe_strto32(node_input.substr(prefix_pos + 1),
+                                   &output_idx)) {
+          output_idx = 0;
+        }
+        node_input = node_input.substr(0, prefix_pos);
       }
-      if (node_input.substr(0, 1) == "^") {
+      const bool control_input = node_input.substr(0, 1) == "^";
+      if (control_input) {
         node_input = node_input.substr(1);
       }
       auto input_node = nodes_map_.find(node_input);
       if (input_node == nodes_map_.end()) {
         continue;
       }
-      it->second.AddInput(&input_node->second);
+      if (control_input) {
+        it->second.AddInput(&input_node->second);
+      } else {
+        it->second.AddDataInput(&input_node->second, output_idx);
+      }
     }
   }
 }
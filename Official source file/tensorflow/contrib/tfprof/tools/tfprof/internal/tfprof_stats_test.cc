@@ -87,11 +87,14 @@ TEST_F(TFProfStatsTest, CustomOpType) {
       "648\n  parameters: 162\n  total_exec_micros: 0\n  "
       "total_requested_bytes: 648\n  total_parameters: 162\n  device: "
       "\"/job:localhost/replica:0/task:0/cpu:0\"\n  float_ops: 0\n  "
-      "total_float_ops: 0\n}\nchildren {\n  name: \"DW2\"\n  exec_micros: 0\n  "
+      "total_float_ops: 0\n  bytes_accessed: 0\n  total_bytes_accessed: 0\n}\n"
+      "children {\n  name: \"DW2\"\n  exec_micros: 0\n  "
       "requested_bytes: 1152\n  parameters: 288\n  total_exec_micros: 0\n  "
       "total_requested_bytes: 1152\n  total_parameters: 288\n  device: "
       "\"/job:localhost/replica:0/task:0/cpu:0\"\n  float_ops: 0\n  "
-      "total_float_ops: 0\n}\nfloat_ops: 0\ntotal_float_ops: 0\n",
+      "total_float_ops: 0\n  bytes_accessed: 0\n  total_bytes_accessed: 0\n}\n"
+      "float_ops: 0\ntotal_float_ops: 0\n"
+      "bytes_accessed: 0\ntotal_bytes_accessed: 0\n",
       &expected));
   EXPECT_EQ(expected.DebugString(), root.DebugString());
 }
@@ -111,11 +114,14 @@ TEST_F(TFProfStatsTest, CheckPointOpType) {
       "648\n  parameters: 162\n  total_exec_micros: 0\n  "
       "total_requested_bytes: 648\n  total_parameters: 162\n  device: "
       "\"/job:localhost/replica:0/task:0/cpu:0\"\n  float_ops: 0\n  "
-      "total_float_ops: 0\n}\nchildren {\n  name: \"DW2\"\n  exec_micros: 0\n  "
+      "total_float_ops: 0\n  bytes_accessed: 0\n  total_bytes_accessed: 0\n}\n"
+      "children {\n  name: \"DW2\"\n  exec_micros: 0\n  "
       "requested_bytes: 1152\n  parameters: 288\n  total_exec_micros: 0\n  "
       "total_requested_bytes: 1152\n  total_parameters: 288\n  device: "
       "\"/job:localhost/replica:0/task:0/cpu:0\"\n  float_ops: 0\n  "
-      "total_float_ops: 0\n}\nfloat_ops: 0\ntotal_float_ops: 0\n",
+      "total_float_ops: 0\n  bytes_accessed: 0\n  total_bytes_accessed: 0\n}\n"
+      "float_ops: 0\ntotal_float_ops: 0\n"
+      "bytes_accessed: 0\ntotal_bytes_accessed: 0\n",
       &expected));
   EXPECT_EQ(expected.DebugString(), root.DebugString());
 }
@@ -132,7 +138,8 @@ TEST_F(TFProfStatsTest, TestGraph) {
   CHECK(protobuf::TextFormat::ParseFromString(
       "name: \"_TFProfRoot\"\nexec_micros: 0\nrequested_bytes: 0\ninputs: "
       "0\ntotal_exec_micros: 0\ntotal_requested_bytes: 0\ntotal_parameters: "
-      "0\ntotal_inputs: 0\nfloat_ops: 0\ntotal_float_ops: 0\n",
+      "0\ntotal_inputs: 0\nfloat_ops: 0\ntotal_float_ops: 0\nbytes_accessed: "
+      "0\ntotal_bytes_accessed: 0\n",
       &expected));
   EXPECT_EQ(expected.DebugString(), root.DebugString());
 }
@@ -150,11 +157,14 @@ TEST_F(TFProfStatsTest, TestFloatOps) {
       "exec_micros: 0\n  requested_bytes: 432\n  total_exec_micros: 0\n  "
       "total_requested_bytes: 432\n  total_parameters: 0\n  device: "
       "\"/job:localhost/replica:0/task:0/cpu:0\"\n  float_ops: 5832\n  "
-      "total_float_ops: 5832\n}\nchildren {\n  name: \"Conv2D_1\"\n  "
+      "total_float_ops: 5832\n  bytes_accessed: 1944\n  "
+      "total_bytes_accessed: 1944\n}\nchildren {\n  name: \"Conv2D_1\"\n  "
       "exec_micros: 10\n  requested_bytes: 384\n  total_exec_micros: 10\n  "
       "total_requested_bytes: 384\n  total_parameters: 0\n  device: "
       "\"/job:localhost/replica:0/task:0/cpu:0\"\n  float_ops: 4608\n  "
-      "total_float_ops: 4608\n}\nfloat_ops: 0\ntotal_float_ops: 10440\n",
+      "total_float_ops: 4608\n  bytes_accessed: 1968\n  "
+      "total_bytes_accessed: 1968\n}\nfloat_ops: 0\ntotal_float_ops: 10440\n"
+      "bytes_accessed: 0\ntotal_bytes_accessed: 3912\n",
       &expected));
   EXPECT_EQ(expected.DebugString(), root.DebugString());
 }
@@ -170,7 +180,8 @@ TEST_F(TFProfStatsTest, TestAccountShownNameOnly) {
   CHECK(protobuf::TextFormat::ParseFromString(
       "name: \"_TFProfRoot\"\nexec_micros: 0\nrequested_bytes: "
       "0\ntotal_exec_micros: 0\ntotal_requested_bytes: 0\ntotal_parameters: "
-      "0\nfloat_ops: 0\ntotal_float_ops: 0\n",
+      "0\nfloat_ops: 0\ntotal_float_ops: 0\nbytes_accessed: 0\n"
+      "total_bytes_accessed: 0\n",
       &expected));
   EXPECT_EQ(expected.DebugString(), root.DebugString());
 }
@@ -185,7 +196,8 @@ TEST_F(TFProfStatsTest, TestShowTensorValue) {
   CHECK(protobuf::TextFormat::ParseFromString(
       "name: \"_TFProfRoot\"\nexec_micros: 0\nrequested_bytes: "
       "0\ntotal_exec_micros: 11\ntotal_requested_bytes: "
-      "5280\ntotal_parameters: 450\nfloat_ops: 0\ntotal_float_ops: 10440\n",
+      "5280\ntotal_parameters: 450\nfloat_ops: 0\ntotal_float_ops: 10440\n"
+      "bytes_accessed: 0\ntotal_bytes_accessed: 3912\n",
       &expected));
   EXPECT_EQ(expected.DebugString(), root.DebugString());
 }
@@ -262,6 +262,18 @@ tensorflow::Status ParseCmdLine(const string& line, string* cmd,
       }
       opts->dump_to_file = StripQuote(pieces[i + 1]);
       ++i;
+    } else if (pieces[i] == tensorflow::tfprof::kOptions[16]) {
+      if (pieces.size() <= i + 1 ||
+          !strings::safe_strtod(pieces[i + 1].c_str(), &opts->peak_gflops)) {
+        return ReturnError(pieces, i);
+      }
+      ++i;
+    } else if (pieces[i] == tensorflow::tfprof::kOptions[17]) {
+      if (pieces.size() <= i + 1 ||
+          !strings::safe_strtod(pieces[i + 1].c_str(), &opts->peak_gbps)) {
+        return ReturnError(pieces, i);
+      }
+      ++i;
     } else {
       return ReturnError(pieces, i);
     }
@@ -329,9 +341,15 @@ void PrintHelp() {
       "ops eventually displayed. If False, account all "
       "op statistics matching -account_type_regexes recursively.\n\n"
       "  -select: Comma-separated list of metrics to show: [bytes|micros|"
-      "params|float_ops|num_hidden_ops|tensor_value|device|op_types]."
-      "\n\n"
+      "params|float_ops|num_hidden_ops|tensor_value|device|op_types|"
+      "roofline]. roofline shows achieved GFLOP/s and GB/s, computed from "
+      "float ops and bytes accessed estimated from tensor shapes in "
+      "RunMetadata.\n\n"
       "  -dump_to_file: Dump the output to a file, instead of terminal.\n\n"
+      "  -peak_gflops: Peak GFLOP/s of the device. With -peak_gbps, "
+      "roofline also reports whether ops are compute or memory bound and "
+      "their efficiency against the roofline.\n\n"
+      "  -peak_gbps: Peak memory bandwidth of the device in GB/s.\n\n"
       ""
       "Examples\n"
       "  Assuming a toy model:\n"
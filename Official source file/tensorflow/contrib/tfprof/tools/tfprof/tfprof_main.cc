@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/init_main.h"
@@ -84,6 +85,8 @@ int main(int argc, char** argv) {
   tensorflow::string FLAGS_select = "params";
   bool FLAGS_viz = false;
   tensorflow::string FLAGS_dump_to_file = "";
+  tensorflow::string FLAGS_peak_gflops = "0";
+  tensorflow::string FLAGS_peak_gbps = "0";
   for (int i = 0; i < argc; i++) {
     fprintf(stderr, "%s\n", argv[i]);
   }
@@ -108,7 +111,9 @@ int main(int argc, char** argv) {
        tensorflow::Flag("account_displayed_op_only",
                         &FLAGS_account_displayed_op_only),
        tensorflow::Flag("select", &FLAGS_select),
-       tensorflow::Flag("dump_to_file", &FLAGS_dump_to_file)}));
+       tensorflow::Flag("dump_to_file", &FLAGS_dump_to_file),
+       tensorflow::Flag("peak_gflops", &FLAGS_peak_gflops),
+       tensorflow::Flag("peak_gbps", &FLAGS_peak_gbps)}));
   tensorflow::port::InitMain(argv[0], &argc, &argv);
 
   fprintf(stderr, "%s\n", FLAGS_graph_path.c_str());
@@ -128,6 +133,14 @@ int main(int argc, char** argv) {
   std::vector<tensorflow::string> select =
       Split(FLAGS_select, ',', tensorflow::str_util::SkipEmpty());
 
+  double peak_gflops = 0;
+  double peak_gbps = 0;
+  CHECK(tensorflow::strings::safe_strtod(FLAGS_peak_gflops.c_str(),
+                                         &peak_gflops))
+      << "Invalid --peak_gflops: " << FLAGS_peak_gflops;
+  CHECK(tensorflow::strings::safe_strtod(FLAGS_peak_gbps.c_str(), &peak_gbps))
+      << "Invalid --peak_gbps: " << FLAGS_peak_gbps;
+
   tensorflow::string cmd = "";
   if (argc == 1 && FLAGS_graph_path.empty()) {
     printf("1) go/tfprof: Tutorial.\n");
@@ -196,7 +209,7 @@ int main(int argc, char** argv) {
       FLAGS_min_float_ops, device_regexes, FLAGS_order_by, account_type_regexes,
       start_name_regexes, trim_name_regexes, show_name_regexes,
       hide_name_regexes, FLAGS_account_displayed_op_only, select, FLAGS_viz,
-      FLAGS_dump_to_file);
+      FLAGS_dump_to_file, peak_gflops, peak_gbps);
 
   if (!cmd.empty()) {
     tf_stat.PrintGraph(cmd, opts);
@@ -14,7 +14,19 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 
@@ -22,6 +34,52 @@ namespace {
 
 static const string kCostModelLogTag = "COST_MODEL";
 
+// Per-session attributes that differ between identical graphs, such as the
+// random incarnation numbers that _Send and _Recv nodes get from their
+// devices.
+static bool IsPerSessionAttr(const string& name) {
+  return StringPiece(name).ends_with("_device_incarnation");
+}
+
+// Returns the name of the file holding the saved cost graph of "graph".
+// Files are keyed by a fingerprint of the nodes of the graph, sorted by
+// name, with their ops, devices, inputs and attributes, so a cost graph is
+// only ever reused for an identical graph, including in another session.
+static string CostGraphFileName(const Graph* graph, const string& dir) {
+  GraphDef graph_def;
+  graph->ToGraphDef(&graph_def);
+  std::vector<const NodeDef*> nodes;
+  for (const NodeDef& node : graph_def.node()) {
+    nodes.push_back(&node);
+  }
+  std::sort(nodes.begin(), nodes.end(),
+            [](const NodeDef* a, const NodeDef* b) {
+              return a->name() < b->name();
+            });
+  string signature;
+  for (const NodeDef* node : nodes) {
+    strings::StrAppend(&signature, node->name(), ";", node->op(), ";",
+                       node->device(), ";",
+                       str_util::Join(node->input(), ","), ";");
+    // Attributes are a map, whose serialization order is unspecified.
+    std::map<string, const AttrValue*> attrs;
+    for (const auto& attr : node->attr()) {
+      if (!IsPerSessionAttr(attr.first)) {
+        attrs[attr.first] = &attr.second;
+      }
+    }
+    for (const auto& attr : attrs) {
+      string value;
+      attr.second->SerializeToString(&value);
+      strings::StrAppend(&signature, attr.first, "=", value, ";");
+    }
+    signature.push_back('\n');
+  }
+  const uint64 fingerprint = Fingerprint64(signature);
+  return io::JoinPath(
+      dir, strings::StrCat("cost_graph_", strings::Hex(fingerprint), ".pb"));
+}
+
 }  // namespace
 
 CostModelManager::~CostModelManager() {
@@ -55,4 +113,42 @@ Status CostModelManager::AddToCostGraphDef(const Graph* graph,
   return Status::OK();
 }
 
+Status CostModelManager::LoadCostModel(Env* env, const Graph* graph,
+                                       const string& dir) {
+  const string fname = CostGraphFileName(graph, dir);
+  if (!env->FileExists(fname)) {
+    return Status::OK();
+  }
+  CostGraphDef cost_graph;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env, fname, &cost_graph));
+  VLOG(1) << "Loaded cost model estimates from " << fname;
+  mutex_lock l(mu_);
+  saved_costs_[graph].Swap(&cost_graph);
+  return Status::OK();
+}
+
+Status CostModelManager::SaveCostModel(Env* env, const Graph* graph,
+                                       const string& dir, double decay) {
+  if (decay < 0.0 || decay > 1.0) {
+    return errors::InvalidArgument("Cost model decay must be in [0, 1], got ",
+                                   decay);
+  }
+  CostGraphDef cost_graph;
+  {
+    mutex_lock l(mu_);
+    auto it = cost_models_.find(graph);
+    if (it == cost_models_.end()) {
+      return errors::InvalidArgument("The cost model graph doesn't exist.");
+    }
+    it->second->AddToCostGraphDef(graph, &cost_graph);
+    // Merge into the saved copy only, so that the live cost model keeps its
+    // own measurements and saving again does not decay them twice.
+    auto saved = saved_costs_.find(graph);
+    if (saved != saved_costs_.end()) {
+      CostModel::MergeCostGraphDef(saved->second, decay, &cost_graph);
+    }
+  }
+  return WriteBinaryProto(env, CostGraphFileName(graph, dir), cost_graph);
+}
+
 }  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/iterator_range.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
@@ -43,9 +44,24 @@ class CostModelManager {
 
   Status AddToCostGraphDef(const Graph* graph, CostGraphDef* cost_graph);
 
+  // Loads the estimates that a previous session saved in "dir" for a graph
+  // with the same fingerprint as "graph", for SaveCostModel() to update.
+  // Does nothing if no such estimates exist.
+  Status LoadCostModel(Env* env, const Graph* graph, const string& dir);
+
+  // Folds the estimates loaded by LoadCostModel() into the measurements
+  // recorded for "graph", decaying the old estimates by "decay" (see
+  // CostModel::MergeCostGraphDef), and saves the result in "dir".  The cost
+  // model of "graph" itself is left unchanged, so every save is one decay
+  // step from the loaded estimates.
+  Status SaveCostModel(Env* env, const Graph* graph, const string& dir,
+                       double decay);
+
  private:
   mutex mu_;
   CostModelMap cost_models_ GUARDED_BY(mu_);
+  // Estimates loaded by LoadCostModel(), keyed by graph.
+  std::unordered_map<const Graph*, CostGraphDef> saved_costs_ GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
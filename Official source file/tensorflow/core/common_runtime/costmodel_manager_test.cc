@@ -0,0 +1,99 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/costmodel_manager.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class CostModelManagerTest : public ::testing::Test {
+ protected:
+  CostModelManagerTest() : graph_(OpRegistry::Global()) {
+    Tensor x(DT_FLOAT, TensorShape({4}));
+    x.flat<float>().setZero();
+    square_ = test::graph::Unary(&graph_, "Square",
+                                 test::graph::Constant(&graph_, x));
+  }
+
+  // Returns a new empty directory for the saved cost graphs of "test_name".
+  string NewCostModelDir(const string& test_name) {
+    const string dir = io::JoinPath(testing::TmpDir(), test_name);
+    Env* env = Env::Default();
+    if (env->FileExists(dir)) {
+      int64 undeleted_files, undeleted_dirs;
+      TF_CHECK_OK(env->DeleteRecursively(dir, &undeleted_files,
+                                         &undeleted_dirs));
+    }
+    TF_CHECK_OK(env->RecursivelyCreateDir(dir));
+    return dir;
+  }
+
+  // Returns the compute cost of "square_" in the only cost graph in "dir".
+  int64 SavedComputeCost(const string& dir) {
+    std::vector<string> children;
+    TF_CHECK_OK(Env::Default()->GetChildren(dir, &children));
+    CHECK_EQ(1, children.size());
+    CostGraphDef cost_graph;
+    TF_CHECK_OK(ReadBinaryProto(Env::Default(),
+                                io::JoinPath(dir, children[0]), &cost_graph));
+    for (const CostGraphDef::Node& cnode : cost_graph.node()) {
+      if (cnode.name() == square_->name()) return cnode.compute_cost();
+    }
+    LOG(FATAL) << "No cost for " << square_->name();
+    return -1;
+  }
+
+  Graph graph_;
+  Node* square_;
+};
+
+TEST_F(CostModelManagerTest, SaveDecaysLoadedEstimatesOnce) {
+  const string dir = NewCostModelDir("SaveDecaysLoadedEstimatesOnce");
+  Env* env = Env::Default();
+  {
+    CostModelManager previous_session;
+    CostModel* cm = previous_session.FindOrCreateCostModel(&graph_);
+    cm->RecordMaxExecutionTime(square_, Microseconds(1000));
+    TF_ASSERT_OK(previous_session.SaveCostModel(env, &graph_, dir, 0.5));
+  }
+  EXPECT_EQ(1000, SavedComputeCost(dir));
+
+  CostModelManager manager;
+  TF_ASSERT_OK(manager.LoadCostModel(env, &graph_, dir));
+  CostModel* cm = manager.FindOrCreateCostModel(&graph_);
+  cm->RecordMaxExecutionTime(square_, Microseconds(200));
+
+  // Saving twice gives the same single decay step from the loaded estimate,
+  // and leaves the measurements of the live cost model alone.
+  for (int save = 0; save < 2; ++save) {
+    TF_ASSERT_OK(manager.SaveCostModel(env, &graph_, dir, 0.5));
+    EXPECT_EQ(600, SavedComputeCost(dir));
+    EXPECT_EQ(200, cm->MaxExecutionTime(square_).value());
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb_text.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/log_memory.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
@@ -98,6 +99,49 @@ thread::ThreadPool* GlobalThreadPool(const SessionOptions& options) {
   return thread_pool;
 }
 
+// Shares the global pool between the sessions that use it, by
+// inter_op_scheduling_weight.
+FairScheduler* GlobalFairScheduler(const SessionOptions& options) {
+  static FairScheduler* const scheduler =
+      new FairScheduler(GlobalThreadPool(options));
+  return scheduler;
+}
+
+// Records "closures_run" closures that kept "num_threads" threads busy for
+// "busy_nanos" over "wall_micros" into "step_stats".
+ThreadPoolStepStats* AddThreadPoolStepStats(const string& name,
+                                            int num_threads,
+                                            int64 closures_run,
+                                            int64 busy_nanos,
+                                            int64 wall_micros,
+                                            StepStats* step_stats) {
+  ThreadPoolStepStats* stats = step_stats->add_thread_pool_stats();
+  stats->set_name(name);
+  stats->set_num_threads(num_threads);
+  stats->set_closures_run(closures_run);
+  stats->set_busy_micros(busy_nanos / 1000);
+  stats->set_wall_micros(wall_micros);
+  if (wall_micros > 0) {
+    const double busy_fraction =
+        static_cast<double>(stats->busy_micros()) /
+        (static_cast<double>(wall_micros) * num_threads);
+    stats->set_idle_fraction(std::min(1.0, std::max(0.0, 1.0 - busy_fraction)));
+  }
+  return stats;
+}
+
+// Records the utilization of "pool" since "start" was snapshotted,
+// "wall_micros" ago, into "step_stats".
+void AddThreadPoolStepStats(const string& name, thread::ThreadPool* pool,
+                            const thread::ThreadPool::Stats& start,
+                            int64 wall_micros, StepStats* step_stats) {
+  const thread::ThreadPool::Stats end = pool->GetStats();
+  AddThreadPoolStepStats(name, pool->NumThreads(),
+                         end.closures_run - start.closures_run,
+                         end.busy_nanos - start.busy_nanos, wall_micros,
+                         step_stats);
+}
+
 // TODO(vrv): Figure out how to unify the many different functions
 // that generate RendezvousKey, since many of them have to be
 // consistent with each other.
@@ -211,7 +255,11 @@ void DirectSession::SchedClosure(thread::ThreadPool* pool,
   // safe given the reasoning above.
   c();
 #else
-  pool->Schedule(c);
+  if (inter_op_queue_ != nullptr) {
+    inter_op_scheduler_->Schedule(inter_op_queue_, std::move(c));
+  } else {
+    pool->Schedule(c);
+  }
 #endif  // __ANDROID__
 }
 
@@ -236,6 +284,13 @@ DirectSession::DirectSession(const SessionOptions& options,
   } else {
     thread_pools_.push_back(GlobalThreadPool(options));
     owns_thread_pools_ = false;
+    // Every session on the global pool gets a queue, so that sessions with
+    // a weight cannot keep the pool's threads away from the others.
+    const int32 weight = options_.config.inter_op_scheduling_weight();
+    inter_op_scheduler_ = GlobalFairScheduler(options);
+    inter_op_queue_ = inter_op_scheduler_->AddQueue(
+        weight > 0 ? weight : 1,
+        weight > 0 ? options_.config.inter_op_scheduling_priority() : 0);
   }
   // NOTE(mrry): We do not need to use a unique string for the session
   // handle, because DirectSession owns its devices. This may change
@@ -267,6 +322,13 @@ DirectSession::DirectSession(const SessionOptions& options,
 
 DirectSession::~DirectSession() {
   if (!closed_) Close();
+  {
+    // Close() cancelled the steps still running asynchronously.
+    mutex_lock l(async_steps_lock_);
+    while (num_async_steps_ > 0) {
+      async_steps_done_.wait(l);
+    }
+  }
   for (auto& it : partial_runs_) {
     it.second.reset(nullptr);
   }
@@ -277,6 +339,9 @@ DirectSession::~DirectSession() {
     d->op_segment()->RemoveHold(session_handle_);
   }
   delete cancellation_manager_;
+  if (inter_op_queue_ != nullptr) {
+    inter_op_scheduler_->RemoveQueue(inter_op_queue_);
+  }
   if (owns_thread_pools_) {
     for (auto* p : thread_pools_) delete p;
   }
@@ -335,12 +400,105 @@ Status DirectSession::Run(const NamedTensorList& inputs,
              &run_metadata);
 }
 
+struct DirectSession::StepState {
+  ~StepState() {
+    if (collecting_pool_stats) {
+      pool->StopCollectingStats();
+      if (intra_op_pool) intra_op_pool->StopCollectingStats();
+    }
+  }
+
+  // Set for RunAsync() calls that pass no RunMetadata.  Declared first so
+  // that it outlives run_state->collector, which writes to it.
+  std::unique_ptr<RunMetadata> owned_run_metadata;
+
+  std::unique_ptr<RunState> run_state;
+  thread::ThreadPool* pool = nullptr;
+  ExecutorsAndKeys* executors_and_keys = nullptr;
+  Executor::Args args;
+  int64 build_cost_model = 0;
+  std::unique_ptr<GPUTracer> tracer;
+
+  // Snapshots of the thread pools, to report their utilization over the
+  // step.
+  thread::ThreadPool* intra_op_pool = nullptr;
+  // Whether pool and intra_op_pool count their closures for this step.
+  bool collecting_pool_stats = false;
+  thread::ThreadPool::Stats inter_op_pool_start;
+  thread::ThreadPool::Stats intra_op_pool_start;
+  FairScheduler::Stats inter_op_queue_start;
+  uint64 step_start_micros = 0;
+};
+
 Status DirectSession::Run(const RunOptions& run_options,
                           const NamedTensorList& inputs,
                           const std::vector<string>& output_names,
                           const std::vector<string>& target_nodes,
                           std::vector<Tensor>* outputs,
                           RunMetadata* run_metadata) {
+  StepState step;
+  TF_RETURN_IF_ERROR(StartStep(run_options, inputs, output_names,
+                               target_nodes, run_metadata, &step, nullptr));
+  WaitForNotification(step.run_state.get(),
+                      run_options.timeout_in_ms() > 0
+                          ? run_options.timeout_in_ms()
+                          : operation_timeout_in_ms_);
+  return FinishStep(run_options, output_names, &step, outputs, run_metadata);
+}
+
+void DirectSession::RunAsync(const RunOptions& run_options,
+                             const NamedTensorList& inputs,
+                             const std::vector<string>& output_names,
+                             const std::vector<string>& target_nodes,
+                             std::vector<Tensor>* outputs,
+                             RunMetadata* run_metadata,
+                             std::function<void(const Status&)> done) {
+  if (run_options.timeout_in_ms() > 0) {
+    // Enforcing a deadline would need a thread per step to wait for it.
+    done(errors::InvalidArgument(
+        "RunAsync does not support RunOptions.timeout_in_ms"));
+    return;
+  }
+  {
+    mutex_lock l(async_steps_lock_);
+    ++num_async_steps_;
+  }
+  auto finish = [this, done](const Status& s) {
+    {
+      mutex_lock l(async_steps_lock_);
+      if (--num_async_steps_ == 0) async_steps_done_.notify_all();
+    }
+    done(s);
+  };
+
+  StepState* step = new StepState;
+  if (run_metadata == nullptr) {
+    step->owned_run_metadata.reset(new RunMetadata);
+    run_metadata = step->owned_run_metadata.get();
+  }
+  // Runs once the executors are done, when the arguments of this call may
+  // no longer be alive, so it holds copies of the ones it needs.
+  auto executors_done = [this, step, run_options, output_names, outputs,
+                         run_metadata, finish]() {
+    Status s =
+        FinishStep(run_options, output_names, step, outputs, run_metadata);
+    delete step;
+    finish(s);
+  };
+  Status s = StartStep(run_options, inputs, output_names, target_nodes,
+                       run_metadata, step, std::move(executors_done));
+  if (!s.ok()) {
+    delete step;
+    finish(s);
+  }
+}
+
+Status DirectSession::StartStep(const RunOptions& run_options,
+                                const NamedTensorList& inputs,
+                                const std::vector<string>& output_names,
+                                const std::vector<string>& target_nodes,
+                                RunMetadata* run_metadata, StepState* step,
+                                std::function<void()> executors_done) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   direct_session_runs->GetCell()->IncrementBy(1);
   {
@@ -364,9 +522,9 @@ Status DirectSession::Run(const RunOptions& run_options,
                                    run_options.inter_op_thread_pool());
   }
   thread::ThreadPool* pool = thread_pools_[run_options.inter_op_thread_pool()];
+  step->pool = pool;
 
   // Check if we already have an executor for these arguments.
-  ExecutorsAndKeys* executors_and_keys;
   RunStateArgs run_state_args;
 
   // EXPERIMENTAL: Options that allow the client to insert nodes into partition
@@ -375,88 +533,140 @@ Status DirectSession::Run(const RunOptions& run_options,
     run_state_args.debug_tensor_watches = run_options.debug_tensor_watch_opts();
   }
 
-  TF_RETURN_IF_ERROR(
-      GetOrCreateExecutors(pool, input_tensor_names, output_names, target_nodes,
-                           &executors_and_keys, &run_state_args));
+  TF_RETURN_IF_ERROR(GetOrCreateExecutors(pool, input_tensor_names,
+                                          output_names, target_nodes,
+                                          &step->executors_and_keys,
+                                          &run_state_args));
+  ExecutorsAndKeys* executors_and_keys = step->executors_and_keys;
 
   // Create a run state and start execution.
-  RunState run_state(input_tensor_names, output_names);
-  run_state.rendez = new IntraProcessRendezvous(device_mgr_.get());
+  step->run_state.reset(new RunState(input_tensor_names, output_names));
+  RunState* run_state = step->run_state.get();
+  run_state->rendez = new IntraProcessRendezvous(device_mgr_.get());
 
   // Send inputs.
-  TF_RETURN_IF_ERROR(SendInputs(inputs, executors_and_keys, run_state.rendez));
+  TF_RETURN_IF_ERROR(
+      SendInputs(inputs, executors_and_keys, run_state->rendez));
 
   // Start parallel Executors.
   const int num_executors = executors_and_keys->items.size();
   ExecutorBarrier* barrier = new ExecutorBarrier(
-      num_executors, run_state.rendez, [&run_state](const Status& ret) {
+      num_executors, run_state->rendez,
+      [run_state, executors_done](const Status& ret) {
         {
-          mutex_lock l(run_state.mu_);
-          run_state.status.Update(ret);
+          mutex_lock l(run_state->mu_);
+          run_state->status.Update(ret);
         }
-        run_state.executors_done.Notify();
+        run_state->executors_done.Notify();
+        if (executors_done) executors_done();
       });
 
-  Executor::Args args;
+  Executor::Args& args = step->args;
   args.step_id = step_id_counter_.fetch_add(1);
-  args.rendezvous = run_state.rendez;
+  args.rendezvous = run_state->rendez;
   args.cancellation_manager = cancellation_manager_;
   args.runner = [this, pool](Executor::Args::Closure c) {
     SchedClosure(pool, c);
   };
   args.session_state = &session_state_;
-  args.tensor_store = &run_state.tensor_store;
-  args.step_resource_manager = &run_state.step_resource_manager;
+  args.tensor_store = &run_state->tensor_store;
+  args.step_resource_manager = &run_state->step_resource_manager;
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(args.step_id, run_state_args.handle);
   }
 
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
-  const int64 build_cost_model =
-      options_.config.graph_options().build_cost_model();
-  if (do_trace || build_cost_model > 0) {
-    run_state.collector.reset(
+  step->build_cost_model = options_.config.graph_options().build_cost_model();
+  if (do_trace || step->build_cost_model > 0) {
+    run_state->collector.reset(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
-    args.stats_collector = run_state.collector.get();
+    args.stats_collector = run_state->collector.get();
   }
 
-  std::unique_ptr<GPUTracer> tracer;
   if (run_options.trace_level() >= RunOptions::HARDWARE_TRACE) {
-    tracer.reset(CreateGPUTracer());
+    step->tracer.reset(CreateGPUTracer());
     // tracer will be NULL on non-GPU platforms.
-    if (tracer) tracer->Start();
+    if (step->tracer) step->tracer->Start();
+  }
+
+  if (args.stats_collector) {
+    step->intra_op_pool =
+        device_set_.client_device()->tensorflow_cpu_worker_threads()->workers;
+    step->collecting_pool_stats = true;
+    pool->StartCollectingStats();
+    step->inter_op_pool_start = pool->GetStats();
+    if (step->intra_op_pool) {
+      step->intra_op_pool->StartCollectingStats();
+      step->intra_op_pool_start = step->intra_op_pool->GetStats();
+    }
+    if (inter_op_queue_ != nullptr) {
+      step->inter_op_queue_start =
+          inter_op_scheduler_->GetStats(inter_op_queue_);
+    }
+    step->step_start_micros = options_.env->NowMicros();
   }
 
   for (const auto& item : executors_and_keys->items) {
     item.executor->RunAsync(args, barrier->Get());
   }
+  return Status::OK();
+}
 
-  WaitForNotification(&run_state, run_options.timeout_in_ms() > 0
-                                      ? run_options.timeout_in_ms()
-                                      : operation_timeout_in_ms_);
-
-  if (tracer) {
-    tracer->Stop();
-    tracer->Collect(args.stats_collector);
+Status DirectSession::FinishStep(const RunOptions& run_options,
+                                 const std::vector<string>& output_names,
+                                 StepState* step, std::vector<Tensor>* outputs,
+                                 RunMetadata* run_metadata) {
+  RunState* run_state = step->run_state.get();
+  ExecutorsAndKeys* executors_and_keys = step->executors_and_keys;
+  Executor::Args& args = step->args;
+
+  if (step->tracer) {
+    step->tracer->Stop();
+    step->tracer->Collect(args.stats_collector);
   }
 
   {
-    mutex_lock l(run_state.mu_);
-    TF_RETURN_IF_ERROR(run_state.status);
+    mutex_lock l(run_state->mu_);
+    TF_RETURN_IF_ERROR(run_state->status);
+  }
+
+  if (args.stats_collector) {
+    const int64 wall_micros =
+        options_.env->NowMicros() - step->step_start_micros;
+    StepStats* step_stats = run_metadata->mutable_step_stats();
+    AddThreadPoolStepStats("inter_op", step->pool, step->inter_op_pool_start,
+                           wall_micros, step_stats);
+    if (step->intra_op_pool) {
+      AddThreadPoolStepStats("intra_op", step->intra_op_pool,
+                             step->intra_op_pool_start, wall_micros,
+                             step_stats);
+    }
+    if (inter_op_queue_ != nullptr) {
+      // The share of the global pool used by this session, which also
+      // includes closures of other steps run concurrently.
+      const FairScheduler::Stats end =
+          inter_op_scheduler_->GetStats(inter_op_queue_);
+      const FairScheduler::Stats& start = step->inter_op_queue_start;
+      ThreadPoolStepStats* stats = AddThreadPoolStepStats(
+          "inter_op_session", inter_op_scheduler_->NumThreads(),
+          end.closures_run - start.closures_run,
+          end.busy_nanos - start.busy_nanos, wall_micros, step_stats);
+      stats->set_queued_micros((end.queued_nanos - start.queued_nanos) / 1000);
+    }
   }
 
   // Receive outputs.
   TF_RETURN_IF_ERROR(
-      RecvOutputs(output_names, executors_and_keys, &run_state, outputs));
+      RecvOutputs(output_names, executors_and_keys, run_state, outputs));
 
   // Save the output tensors of this run we choose to keep.
   TF_RETURN_IF_ERROR(
-      run_state.tensor_store.SaveTensors(output_names, &session_state_));
+      run_state->tensor_store.SaveTensors(output_names, &session_state_));
 
   // Build and return the cost model as instructed.
   mutex_lock l(executor_lock_);
   ++executors_and_keys->step_count;
-  if (executors_and_keys->step_count == build_cost_model) {
+  if (executors_and_keys->step_count == step->build_cost_model) {
     // Build the cost model
     std::unordered_map<string, const Graph*> device_to_graph;
     for (const PerPartitionExecutorsAndLib& partition :
@@ -473,6 +683,17 @@ Status DirectSession::Run(const RunOptions& run_options,
       TF_RETURN_IF_ERROR(
           cost_model_manager_.AddToCostGraphDef(item.graph, cost_graph));
     }
+
+    // Persist the cost model, averaged with the estimates of earlier
+    // sessions.
+    const GraphOptions& graph_options = options_.config.graph_options();
+    if (!graph_options.cost_model_dir().empty()) {
+      for (const auto& item : executors_and_keys->items) {
+        TF_RETURN_IF_ERROR(cost_model_manager_.SaveCostModel(
+            options_.env, item.graph, graph_options.cost_model_dir(),
+            graph_options.cost_model_decay()));
+      }
+    }
   }
 
   // If requested via RunOptions, output the partition graphs.
@@ -917,6 +1138,12 @@ Status DirectSession::GetOrCreateExecutors(
                                          device->name(), partition_graph));
     // NewLocalExecutor takes ownership of partition_graph.
     item->graph = partition_graph;
+    const string& cost_model_dir =
+        options_.config.graph_options().cost_model_dir();
+    if (!cost_model_dir.empty()) {
+      TF_RETURN_IF_ERROR(cost_model_manager_.LoadCostModel(
+          options_.env, partition_graph, cost_model_dir));
+    }
     item->executor = nullptr;
     Executor* executor;
     TF_RETURN_IF_ERROR(
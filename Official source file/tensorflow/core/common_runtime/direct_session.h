@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/fair_scheduler.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
 #include "tensorflow/core/common_runtime/simple_graph_execution_state.h"
@@ -81,6 +82,16 @@ class DirectSession : public Session {
                            std::vector<Tensor>* outputs,
                            RunMetadata* run_metadata) override;
 
+  // NOTE: Experimental and subject to change.  RunAsync does not enforce
+  // timeouts: the session's operation timeout does not apply, and a step
+  // with RunOptions.timeout_in_ms set fails with InvalidArgument.
+  void RunAsync(const ::tensorflow::RunOptions& run_options,
+                const NamedTensorList& inputs,
+                const std::vector<string>& output_names,
+                const std::vector<string>& target_nodes,
+                std::vector<Tensor>* outputs, RunMetadata* run_metadata,
+                std::function<void(const ::tensorflow::Status&)> done) override;
+
   // NOTE: PRunSetup and PRun are added to support partial execution. This
   // feature is experimental and subject to change.
   ::tensorflow::Status PRunSetup(const std::vector<string>& input_names,
@@ -155,6 +166,9 @@ class DirectSession : public Session {
     ~RunState();
   };
 
+  // The state of a step of Run() or RunAsync() while its executors run.
+  struct StepState;
+
   struct RunStateArgs {
     bool is_partial_run = false;
     string handle;
@@ -186,6 +200,24 @@ class DirectSession : public Session {
   ::tensorflow::Status ExtendLocked(const GraphDef& graph)
       EXCLUSIVE_LOCKS_REQUIRED(graph_def_lock_);
 
+  // Prepares 'step' and starts its executors.  Once they are done,
+  // notifies step->run_state->executors_done and then calls
+  // 'executors_done' if it is set.  If an error is returned, no executor
+  // was started.
+  ::tensorflow::Status StartStep(const RunOptions& run_options,
+                                 const NamedTensorList& inputs,
+                                 const std::vector<string>& output_names,
+                                 const std::vector<string>& target_nodes,
+                                 RunMetadata* run_metadata, StepState* step,
+                                 std::function<void()> executors_done);
+
+  // Receives the outputs of 'step' and fills 'run_metadata', once the
+  // executors started by StartStep() are done.
+  ::tensorflow::Status FinishStep(const RunOptions& run_options,
+                                  const std::vector<string>& output_names,
+                                  StepState* step, std::vector<Tensor>* outputs,
+                                  RunMetadata* run_metadata);
+
   // Feeds more inputs to the executors, triggering further execution.
   ::tensorflow::Status SendInputs(
       const std::vector<std::pair<string, Tensor>>& inputs,
@@ -233,6 +265,11 @@ class DirectSession : public Session {
   std::vector<thread::ThreadPool*> thread_pools_;
   bool owns_thread_pools_ = false;
 
+  // If set, closures are scheduled on the global pool through this queue
+  // of inter_op_scheduler_.
+  FairScheduler* inter_op_scheduler_ = nullptr;
+  FairScheduler::Queue* inter_op_queue_ = nullptr;
+
   // Schedules 'c' for execution on pool.
   void SchedClosure(thread::ThreadPool* pool, std::function<void()> c);
 
@@ -273,6 +310,11 @@ class DirectSession : public Session {
   mutex closed_lock_;
   bool closed_ GUARDED_BY(closed_lock_) = false;
 
+  // Number of RunAsync() steps whose done callback has not been called yet.
+  mutex async_steps_lock_;
+  int num_async_steps_ GUARDED_BY(async_steps_lock_) = 0;
+  condition_variable async_steps_done_;
+
   // For generating unique names for this session instance.
   std::atomic<int64> edge_name_counter_ = {0};
   std::atomic<int64> handle_name_counter_ = {0};
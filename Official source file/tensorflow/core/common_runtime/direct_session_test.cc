@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <unordered_map>
@@ -31,10 +32,14 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
@@ -203,6 +208,168 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestInterOpSchedulingWeight) {
+  Initialize({1, 2, 3, 4});
+
+  // Two sessions with different weights share the global pool.
+  std::vector<std::unique_ptr<Session>> sessions;
+  for (int weight : {1, 3}) {
+    SessionOptions options;
+    options.config.set_inter_op_scheduling_weight(weight);
+    (*options.config.mutable_device_count())["CPU"] = 2;
+    sessions.emplace_back(NewSession(options));
+    ASSERT_TRUE(sessions.back() != nullptr);
+    TF_ASSERT_OK(sessions.back()->Create(def_));
+  }
+
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+  std::vector<string> output_names = {y_ + ":0"};
+  for (int i = 0; i < 4; ++i) {
+    Session* session = sessions[i % 2].get();
+    tp->Schedule([session, output_names]() {
+      for (int j = 0; j < 500; ++j) {
+        std::vector<Tensor> outputs;
+        TF_ASSERT_OK(session->Run({}, output_names, {}, &outputs));
+        ASSERT_EQ(1, outputs.size());
+        EXPECT_FLOAT_EQ(3.0, outputs[0].matrix<float>()(0, 0));
+      }
+    });
+  }
+  delete tp;
+
+  // The session's share of the pool is reported with the step stats.
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::FULL_TRACE);
+  RunMetadata run_metadata;
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(sessions[0]->Run(run_options, {}, output_names, {}, &outputs,
+                                &run_metadata));
+  const StepStats& step_stats = run_metadata.step_stats();
+  ASSERT_EQ(3, step_stats.thread_pool_stats_size());
+  const ThreadPoolStepStats& session_stats = step_stats.thread_pool_stats(2);
+  EXPECT_EQ("inter_op_session", session_stats.name());
+  EXPECT_GT(session_stats.closures_run(), 0);
+  EXPECT_GE(session_stats.queued_micros(), 0);
+}
+
+TEST_F(DirectSessionMinusAXTest, TestInterOpSchedulingUnweightedSession) {
+  Initialize({1, 2, 3, 4});
+
+  SessionOptions weighted_options;
+  weighted_options.config.set_inter_op_scheduling_weight(100);
+  (*weighted_options.config.mutable_device_count())["CPU"] = 2;
+  std::unique_ptr<Session> weighted(NewSession(weighted_options));
+  ASSERT_TRUE(weighted != nullptr);
+  TF_ASSERT_OK(weighted->Create(def_));
+
+  SessionOptions unweighted_options;
+  (*unweighted_options.config.mutable_device_count())["CPU"] = 2;
+  std::unique_ptr<Session> unweighted(NewSession(unweighted_options));
+  ASSERT_TRUE(unweighted != nullptr);
+  TF_ASSERT_OK(unweighted->Create(def_));
+
+  // Keep the weighted session busy until the unweighted one is done.
+  std::vector<string> output_names = {y_ + ":0"};
+  std::atomic<bool> stop(false);
+  std::atomic<int64> weighted_steps(0);
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+  for (int i = 0; i < 4; ++i) {
+    tp->Schedule([&weighted, &stop, &weighted_steps, output_names]() {
+      while (!stop) {
+        std::vector<Tensor> outputs;
+        TF_ASSERT_OK(weighted->Run({}, output_names, {}, &outputs));
+        ++weighted_steps;
+      }
+    });
+  }
+  while (weighted_steps == 0) Env::Default()->SleepForMicroseconds(100);
+
+  // The unweighted session is served from a queue of weight 1 rather than
+  // waiting for the weighted session to run out of work.
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::FULL_TRACE);
+  for (int i = 0; i < 20; ++i) {
+    RunMetadata run_metadata;
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(unweighted->Run(run_options, {}, output_names, {}, &outputs,
+                                 &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(3.0, outputs[0].matrix<float>()(0, 0));
+    const StepStats& step_stats = run_metadata.step_stats();
+    ASSERT_EQ(3, step_stats.thread_pool_stats_size());
+    EXPECT_EQ("inter_op_session", step_stats.thread_pool_stats(2).name());
+    EXPECT_GT(step_stats.thread_pool_stats(2).closures_run(), 0);
+  }
+  stop = true;
+  delete tp;
+}
+
+TEST_F(DirectSessionMinusAXTest, TestRunAsyncConcurrency) {
+  Initialize({1, 2, 3, 4});
+  std::unique_ptr<Session> session(CreateSession());
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // Keep all the steps in flight at once from a single thread.
+  const int kSteps = 5000;
+  std::vector<std::vector<Tensor>> outputs(kSteps);
+  std::vector<Status> statuses(kSteps);
+  std::vector<string> output_names = {y_ + ":0"};
+  BlockingCounter done(kSteps);
+  const uint64 start_micros = Env::Default()->NowMicros();
+  for (int i = 0; i < kSteps; ++i) {
+    Tensor t(DT_FLOAT, TensorShape({2, 1}));
+    test::FillValues<float>(&t, {static_cast<float>(i), 1});
+    Status* status = &statuses[i];
+    session->RunAsync(RunOptions(), {{x_, t}}, output_names, {}, &outputs[i],
+                      nullptr, [status, &done](const Status& s) {
+                        *status = s;
+                        done.DecrementCount();
+                      });
+  }
+  done.Wait();
+  const uint64 elapsed_micros = Env::Default()->NowMicros() - start_micros;
+  LOG(INFO) << kSteps << " asynchronous steps in " << elapsed_micros << "us";
+
+  for (int i = 0; i < kSteps; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+    ASSERT_EQ(1, outputs[i].size());
+    auto mat = outputs[i][0].matrix<float>();
+    EXPECT_FLOAT_EQ(i + 2, mat(0, 0));
+    EXPECT_FLOAT_EQ(3 * i + 4, mat(1, 0));
+  }
+}
+
+TEST_F(DirectSessionMinusAXTest, TestRunAsyncErrors) {
+  Initialize({1, 2, 3, 4});
+  std::unique_ptr<Session> session(CreateSession());
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  auto run_async = [&session](const RunOptions& run_options,
+                              const string& output) {
+    std::vector<Tensor> outputs;
+    Status status;
+    Notification done;
+    session->RunAsync(run_options, {}, {output}, {}, &outputs, nullptr,
+                      [&status, &done](const Status& s) {
+                        status = s;
+                        done.Notify();
+                      });
+    done.WaitForNotification();
+    return status;
+  };
+
+  RunOptions timeout_options;
+  timeout_options.set_timeout_in_ms(1000);
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(run_async(timeout_options, y_ + ":0")));
+  EXPECT_TRUE(errors::IsNotFound(run_async(RunOptions(), "unknown:0")));
+
+  TF_ASSERT_OK(session->Close());
+  EXPECT_TRUE(errors::IsCancelled(run_async(RunOptions(), y_ + ":0")));
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   std::unique_ptr<Session> session(CreateSession());
@@ -293,6 +460,102 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts) {
   // Checks RunMetadata is well-formed
   ASSERT_TRUE(run_metadata.has_step_stats());
   EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
+
+  // The root nodes are always handed to the inter-op thread pool.
+  int64 scheduled_nodes = 0;
+  for (const auto& dev_stats : run_metadata.step_stats().dev_stats()) {
+    const ExecutorSchedulingStats& sched = dev_stats.scheduling_stats();
+    scheduled_nodes += sched.scheduled_nodes();
+    EXPECT_LE(sched.max_ready_to_start_micros(),
+              sched.total_ready_to_start_micros());
+    EXPECT_LE(sched.max_ready_queue_depth(), sched.total_ready_queue_depth());
+  }
+  EXPECT_GT(scheduled_nodes, 0);
+  ASSERT_EQ(3, run_metadata.step_stats().thread_pool_stats_size());
+  const ThreadPoolStepStats& inter_op =
+      run_metadata.step_stats().thread_pool_stats(0);
+  EXPECT_EQ("inter_op", inter_op.name());
+  EXPECT_GT(inter_op.num_threads(), 0);
+  EXPECT_GE(inter_op.idle_fraction(), 0.0);
+  EXPECT_LE(inter_op.idle_fraction(), 1.0);
+  EXPECT_EQ("intra_op", run_metadata.step_stats().thread_pool_stats(1).name());
+  EXPECT_EQ("inter_op_session",
+            run_metadata.step_stats().thread_pool_stats(2).name());
+}
+
+TEST_F(DirectSessionMinusAXTest, TestCostModelPersistsAcrossSessions) {
+  Initialize({1, 2, 3, 4});
+  Env* env = Env::Default();
+  const string dir =
+      io::JoinPath(testing::TmpDir(), "TestCostModelPersistsAcrossSessions");
+  if (env->FileExists(dir)) {
+    int64 undeleted_files, undeleted_dirs;
+    TF_ASSERT_OK(env->DeleteRecursively(dir, &undeleted_files,
+                                        &undeleted_dirs));
+  }
+  TF_ASSERT_OK(env->RecursivelyCreateDir(dir));
+
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  GraphOptions* graph_options = options.config.mutable_graph_options();
+  graph_options->set_build_cost_model(1);
+  graph_options->set_cost_model_dir(dir);
+  // Keep the loaded estimates as they are, so that a session that loaded
+  // them saves them unchanged.
+  graph_options->set_cost_model_decay(1.0);
+
+  // Runs one step, with a feed and a fetch, in a new session, and returns
+  // the saved cost graphs by file name.
+  auto run_session = [this, &options, env, &dir](
+      std::map<string, CostGraphDef>* cost_graphs) {
+    std::unique_ptr<Session> session(NewSession(options));
+    ASSERT_TRUE(session != nullptr);
+    TF_ASSERT_OK(session->Create(def_));
+    Tensor t(DT_FLOAT, TensorShape({2, 1}));
+    test::FillValues<float>(&t, {5, 6});
+    std::vector<Tensor> outputs;
+    RunMetadata run_metadata;
+    TF_ASSERT_OK(session->Run(RunOptions(), {{x_, t}}, {y_ + ":0"},
+                              {y_neg_}, &outputs, &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(17.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_GT(run_metadata.cost_graph().node_size(), 0);
+
+    std::vector<string> children;
+    TF_ASSERT_OK(env->GetChildren(dir, &children));
+    cost_graphs->clear();
+    for (const string& child : children) {
+      TF_ASSERT_OK(ReadBinaryProto(env, io::JoinPath(dir, child),
+                                   &(*cost_graphs)[child]));
+    }
+  };
+
+  std::map<string, CostGraphDef> saved_by_a;
+  run_session(&saved_by_a);
+  // One cost graph per partition, i.e. per device.
+  ASSERT_EQ(2, saved_by_a.size());
+
+  // The partition graphs of the second session contain _Send and _Recv
+  // nodes with other device incarnations, but they map to the same files,
+  // and the second session loads and keeps their estimates.
+  std::map<string, CostGraphDef> saved_by_b;
+  run_session(&saved_by_b);
+  ASSERT_EQ(2, saved_by_b.size());
+  for (const auto& it : saved_by_a) {
+    ASSERT_EQ(1, saved_by_b.count(it.first)) << it.first;
+    const CostGraphDef& a = it.second;
+    const CostGraphDef& b = saved_by_b[it.first];
+    ASSERT_EQ(a.node_size(), b.node_size());
+    for (int i = 0; i < a.node_size(); ++i) {
+      EXPECT_EQ(a.node(i).name(), b.node(i).name());
+      // A node that took no measurable time in the first session gets the
+      // measurement of the second.
+      if (a.node(i).compute_cost() > 0) {
+        EXPECT_EQ(a.node(i).compute_cost(), b.node(i).compute_cost())
+            << a.node(i).name();
+      }
+    }
+  }
 }
 
 TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
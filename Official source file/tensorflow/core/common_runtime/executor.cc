@@ -574,6 +574,17 @@ class ExecutorState {
     int dead_count(int id) { return counts_.dead_count(id); }
     void increment_dead_count(int id) { counts_.increment_dead_count(id); }
 
+    // Returns a done iteration to the state of a new one, without
+    // reallocating its arrays.
+    void Reset(const ExecutorImpl* impl) {
+      for (int i = 0; i < impl->total_input_tensors_; ++i) {
+        input_tensors[i] = Entry();
+      }
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts_.InitializeFrom(impl->initial_pending_counts_);
+    }
+
     ~IterationState() { delete[] input_tensors; }
 
    private:
@@ -668,6 +679,23 @@ class ExecutorState {
       iterations[index] = state;
     }
 
+    // Returns a done frame to the state of a new one. All its iterations
+    // have already been freed.
+    void Reset() {
+      frame_name.clear();
+      frame_id = 0;
+      parent_iter = -1;
+      parent_frame = nullptr;
+      iteration_count = 0;
+      num_pending_inputs = 0;
+      num_outstanding_iterations = 0;
+      max_parallel_iterations = 1;
+      iterations.clear();
+      next_iter_roots.clear();
+      inv_values.clear();
+      dead_exits.clear();
+    }
+
     ~FrameState() {
       for (size_t i = 0; i < iterations.size(); ++i) {
         delete iterations[i];
@@ -767,6 +795,22 @@ class ExecutorState {
 
   std::atomic_int_fast32_t num_outstanding_ops_;
 
+  // Scheduling statistics of this step. Only maintained if stats_collector_
+  // is set, and saved into it by Finish().
+  struct SchedulingCounters {
+    std::atomic<int64> inline_nodes{0};
+    std::atomic<int64> scheduled_nodes{0};
+    std::atomic<int64> total_ready_to_start_micros{0};
+    std::atomic<int64> max_ready_to_start_micros{0};
+    // Nodes handed to runner_ whose Process() has not started yet.
+    std::atomic<int64> ready_queue_depth{0};
+    std::atomic<int64> total_ready_queue_depth{0};
+    std::atomic<int64> max_ready_queue_depth{0};
+    std::atomic<int64> iterations_reused{0};
+    std::atomic<int64> frames_reused{0};
+  };
+  SchedulingCounters sched_counters_;
+
   mutex mu_;
   Status status_ GUARDED_BY(mu_);
 
@@ -777,6 +821,20 @@ class ExecutorState {
   // name of the new frame from nodedef.
   std::unordered_map<string, FrameState*> outstanding_frames_ GUARDED_BY(mu_);
 
+  // Iterations and frames that are done, kept for reuse. Loops create and
+  // free one iteration per step of the loop, and nested loops one frame per
+  // iteration of the outer loop, so recycling them avoids reallocating the
+  // input tensors and pending counts sized to the whole graph each time.
+  std::vector<IterationState*> free_iterations_ GUARDED_BY(mu_);
+  std::vector<FrameState*> free_frames_ GUARDED_BY(mu_);
+
+  // Returns a new or recycled iteration and frame, and makes a done iteration
+  // or frame available for reuse.
+  IterationState* NewIteration() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void FreeIteration(IterationState* iter_state) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  FrameState* NewFrame() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void FreeFrame(FrameState* frame) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // The unique name of a frame.
   inline string MakeFrameName(FrameState* frame, int64 iter_id, string name) {
     return strings::StrCat(frame->frame_name, ";", iter_id, ";", name);
@@ -858,6 +916,12 @@ class ExecutorState {
   void ScheduleReady(const TaggedNodeSeq& ready,
                      TaggedNodeReadyQueue* inline_ready);
 
+  // Hands 'tagged_node' to runner_, updating the scheduling statistics.
+  void Dispatch(const TaggedNode& tagged_node, int64 scheduled_usec);
+
+  // Saves the scheduling statistics of this step into stats_collector_.
+  void SaveSchedulingStats();
+
   // Provide debugging output about an outstanding node in the executor.
   void DumpCompletedNodeState(const int node_id, const Entry* input_vector);
   void DumpPendingNodeState(const int node_id, const Entry* input_vector,
@@ -925,6 +989,12 @@ ExecutorState::~ExecutorState() {
   for (auto name_frame : outstanding_frames_) {
     delete name_frame.second;
   }
+  for (IterationState* iter_state : free_iterations_) {
+    delete iter_state;
+  }
+  for (FrameState* frame : free_frames_) {
+    delete frame;
+  }
 
   for (auto it : device_context_map_) {
     it->Unref();
@@ -1033,11 +1103,32 @@ struct ExecutorState::AsyncState {
   }
 };
 
+namespace {
+
+// Atomically sets "*max" to the maximum of its value and "value".
+void UpdateMax(std::atomic<int64>* max, int64 value) {
+  int64 current = max->load(std::memory_order_relaxed);
+  while (value > current &&
+         !max->compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
 void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
   const NodeItem* nodes = impl_->nodes_;
   TaggedNodeSeq ready;
   TaggedNodeReadyQueue inline_ready;
 
+  if (stats_collector_) {
+    const int64 delay_usec = nodestats::NowInUsec() - scheduled_usec;
+    sched_counters_.ready_queue_depth.fetch_sub(1, std::memory_order_relaxed);
+    sched_counters_.total_ready_to_start_micros.fetch_add(
+        delay_usec, std::memory_order_relaxed);
+    UpdateMax(&sched_counters_.max_ready_to_start_micros, delay_usec);
+  }
+
   // Parameters passed to OpKernel::Compute.
   TensorValueVec inputs;
   DeviceContextVec input_device_contexts;
@@ -1661,10 +1752,11 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
   if (inline_ready == nullptr) {
     // Schedule to run all the ready ops in thread pool.
     for (auto& tagged_node : ready) {
-      runner_(std::bind(&ME::Process, this, tagged_node, scheduled_usec));
+      Dispatch(tagged_node, scheduled_usec);
     }
     return;
   }
+  const size_t num_inline_before = inline_ready->size();
   const NodeItem* nodes = impl_->nodes_;
   const TaggedNode* curr_expensive_node = nullptr;
   for (auto& tagged_node : ready) {
@@ -1676,8 +1768,7 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
       if (curr_expensive_node) {
         // Dispatch to another thread since there is plenty of work to
         // do for this thread.
-        runner_(std::bind(&ME::Process, this, *curr_expensive_node,
-                          scheduled_usec));
+        Dispatch(*curr_expensive_node, scheduled_usec);
       }
       curr_expensive_node = &tagged_node;
     }
@@ -1689,10 +1780,44 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
     } else {
       // There are inline nodes to run already. We dispatch this expensive
       // node to other thread.
-      runner_(
-          std::bind(&ME::Process, this, *curr_expensive_node, scheduled_usec));
+      Dispatch(*curr_expensive_node, scheduled_usec);
     }
   }
+  if (stats_collector_) {
+    sched_counters_.inline_nodes.fetch_add(
+        inline_ready->size() - num_inline_before, std::memory_order_relaxed);
+  }
+}
+
+void ExecutorState::Dispatch(const TaggedNode& tagged_node,
+                             int64 scheduled_usec) {
+  if (stats_collector_) {
+    const int64 depth =
+        sched_counters_.ready_queue_depth.fetch_add(
+            1, std::memory_order_relaxed) +
+        1;
+    sched_counters_.scheduled_nodes.fetch_add(1, std::memory_order_relaxed);
+    sched_counters_.total_ready_queue_depth.fetch_add(
+        depth, std::memory_order_relaxed);
+    UpdateMax(&sched_counters_.max_ready_queue_depth, depth);
+  }
+  runner_(std::bind(&ME::Process, this, tagged_node, scheduled_usec));
+}
+
+void ExecutorState::SaveSchedulingStats() {
+  ExecutorSchedulingStats stats;
+  stats.set_inline_nodes(sched_counters_.inline_nodes.load());
+  stats.set_scheduled_nodes(sched_counters_.scheduled_nodes.load());
+  stats.set_total_ready_to_start_micros(
+      sched_counters_.total_ready_to_start_micros.load());
+  stats.set_max_ready_to_start_micros(
+      sched_counters_.max_ready_to_start_micros.load());
+  stats.set_total_ready_queue_depth(
+      sched_counters_.total_ready_queue_depth.load());
+  stats.set_max_ready_queue_depth(sched_counters_.max_ready_queue_depth.load());
+  stats.set_iterations_reused(sched_counters_.iterations_reused.load());
+  stats.set_frames_reused(sched_counters_.frames_reused.load());
+  stats_collector_->SaveSchedulingStats(impl_->params_.device->name(), stats);
 }
 
 const Tensor* ExecutorState::GetTensorValueForDump(const Entry& input) {
@@ -1820,6 +1945,7 @@ void ExecutorState::DumpState() {
 }
 
 void ExecutorState::Finish() {
+  if (stats_collector_) SaveSchedulingStats();
   mu_.lock();
   auto status = status_;
   auto done_cb = std::move(done_cb_);
@@ -1850,6 +1976,37 @@ bool ExecutorState::IsIterationDone(FrameState* frame, int64 iter) {
   return false;
 }
 
+ExecutorState::IterationState* ExecutorState::NewIteration() {
+  if (free_iterations_.empty()) {
+    return new IterationState(impl_);
+  }
+  IterationState* iter_state = free_iterations_.back();
+  free_iterations_.pop_back();
+  if (stats_collector_) ++sched_counters_.iterations_reused;
+  return iter_state;
+}
+
+void ExecutorState::FreeIteration(IterationState* iter_state) {
+  // Releases any remaining input tensors now rather than on reuse.
+  iter_state->Reset(impl_);
+  free_iterations_.push_back(iter_state);
+}
+
+ExecutorState::FrameState* ExecutorState::NewFrame() {
+  if (free_frames_.empty()) {
+    return new FrameState;
+  }
+  FrameState* frame = free_frames_.back();
+  free_frames_.pop_back();
+  if (stats_collector_) ++sched_counters_.frames_reused;
+  return frame;
+}
+
+void ExecutorState::FreeFrame(FrameState* frame) {
+  frame->Reset();
+  free_frames_.push_back(frame);
+}
+
 void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
                                            const Node* node,
                                            FrameState** child) {
@@ -1868,7 +2025,7 @@ void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
       VLOG(2) << "Create frame: " << child_name;
     }
 
-    FrameState* temp = new FrameState;
+    FrameState* temp = NewFrame();
     temp->frame_name = child_name;
     temp->frame_id = Hash64(child_name);
     temp->parent_frame = frame;
@@ -1879,7 +2036,7 @@ void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
     // 'iterations' is a fixed-length circular buffer.
     temp->iterations.resize(temp->max_parallel_iterations + 1);
     // Initialize the first iteration.
-    IterationState* iter_state = new IterationState(impl_);
+    IterationState* iter_state = NewIteration();
     temp->iterations[0] = iter_state;
 
     auto frame_pending = impl_->frame_input_count_.find(enter_name);
@@ -1904,7 +2061,7 @@ void ExecutorState::IncrementIteration(FrameState* frame,
   }
 
   // Initialize the next iteration.
-  IterationState* iter_state = new IterationState(impl_);
+  IterationState* iter_state = NewIteration();
   frame->SetIteration(next_iter, iter_state);
   frame->num_outstanding_iterations++;
   frame->dead_exits.clear();
@@ -1981,7 +2138,7 @@ void ExecutorState::CleanupFramesIterations(FrameState* frame, int64 iter,
               << "].";
     }
 
-    delete frame->GetIteration(curr_iter);
+    FreeIteration(frame->GetIteration(curr_iter));
     frame->SetIteration(curr_iter, nullptr);
     --frame->num_outstanding_iterations;
     ++curr_iter;
@@ -2038,7 +2195,7 @@ void ExecutorState::CleanupFramesIterations(FrameState* frame, int64 iter,
       VLOG(2) << "Delete frame " << frame_name;
     }
     outstanding_frames_.erase(frame_name);
-    delete frame;
+    FreeFrame(frame);
 
     // Cleanup recursively
     if (parent_frame != nullptr) {
@@ -0,0 +1,145 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/fair_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+int64 NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+FairScheduler::FairScheduler(thread::ThreadPool* pool)
+    : pool_(pool),
+      max_running_(pool->NumThreads()),
+      num_dispatchers_(0),
+      virtual_time_(0) {}
+
+FairScheduler::~FairScheduler() {
+  mutex_lock l(mu_);
+  while (num_dispatchers_ > 0) {
+    dispatchers_done_.wait(l);
+  }
+  CHECK(queues_.empty());
+}
+
+FairScheduler::Queue* FairScheduler::AddQueue(int32 weight, int32 priority) {
+  CHECK_GT(weight, 0);
+  Queue* queue = new Queue(weight, priority);
+  mutex_lock l(mu_);
+  queues_.push_back(queue);
+  return queue;
+}
+
+void FairScheduler::RemoveQueue(Queue* queue) {
+  mutex_lock l(mu_);
+  CHECK(!queue->removed);
+  queue->removed = true;
+  if (queue->closures.empty() && queue->num_running == 0) {
+    queues_.erase(std::find(queues_.begin(), queues_.end(), queue));
+    delete queue;
+  }
+}
+
+void FairScheduler::Schedule(Queue* queue, std::function<void()> fn) {
+  const int64 now = NowNanos();
+  bool start_dispatcher = false;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!queue->removed);
+    if (queue->closures.empty() && queue->num_running == 0) {
+      // An idle queue does not keep the credit it built up while idle.
+      queue->virtual_time = std::max(queue->virtual_time, virtual_time_);
+    }
+    queue->closures.push_back({std::move(fn), now});
+    if (num_dispatchers_ < max_running_) {
+      ++num_dispatchers_;
+      start_dispatcher = true;
+    }
+  }
+  if (start_dispatcher) {
+    pool_->Schedule([this]() { Dispatch(); });
+  }
+}
+
+FairScheduler::Stats FairScheduler::GetStats(const Queue* queue) const {
+  mutex_lock l(mu_);
+  return queue->stats;
+}
+
+FairScheduler::Queue* FairScheduler::PickLocked() {
+  Queue* best = nullptr;
+  for (Queue* queue : queues_) {
+    if (queue->closures.empty()) continue;
+    if (best == nullptr || queue->priority > best->priority ||
+        (queue->priority == best->priority &&
+         queue->virtual_time < best->virtual_time)) {
+      best = queue;
+    }
+  }
+  return best;
+}
+
+void FairScheduler::Dispatch() {
+  Queue* queue = nullptr;
+  Closure closure;
+  int64 start_nanos = 0;
+  int64 end_nanos = 0;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      if (queue != nullptr) {
+        // Charge the closure that just ran to its queue.
+        const int64 busy_nanos = end_nanos - start_nanos;
+        --queue->num_running;
+        queue->virtual_time += static_cast<double>(busy_nanos) / queue->weight;
+        ++queue->stats.closures_run;
+        queue->stats.busy_nanos += busy_nanos;
+        queue->stats.queued_nanos += start_nanos - closure.scheduled_nanos;
+        if (queue->removed && queue->closures.empty() &&
+            queue->num_running == 0) {
+          queues_.erase(std::find(queues_.begin(), queues_.end(), queue));
+          delete queue;
+        }
+      }
+      queue = PickLocked();
+      if (queue == nullptr) {
+        if (--num_dispatchers_ == 0) dispatchers_done_.notify_all();
+        return;
+      }
+      virtual_time_ = std::max(virtual_time_, queue->virtual_time);
+      closure = std::move(queue->closures.front());
+      queue->closures.pop_front();
+      ++queue->num_running;
+    }
+    start_nanos = NowNanos();
+    closure.fn();
+    closure.fn = nullptr;
+    end_nanos = NowNanos();
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,126 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_FAIR_SCHEDULER_H_
+#define TENSORFLOW_COMMON_RUNTIME_FAIR_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Runs the closures of several queues, typically one per session, on a
+// shared ThreadPool.
+//
+// At most pool->NumThreads() closures of the scheduler run at once.  When
+// a thread becomes free, it runs the oldest closure of the queue with the
+// highest priority that has closures waiting; among queues of equal
+// priority, it picks the one that has received the least running time
+// relative to its weight.  Queues of equal priority therefore share the
+// pool in proportion to their weights while they all have work, and a
+// queue that was idle does not get to catch up on the time it did not use.
+//
+// All methods are thread-safe.
+class FairScheduler {
+ public:
+  class Queue;
+
+  // Does not take ownership of 'pool', which must outlive the scheduler.
+  explicit FairScheduler(thread::ThreadPool* pool);
+
+  // Waits for running closures to finish.  REQUIRES: Every queue has been
+  // removed.
+  ~FairScheduler();
+
+  // Returns a new queue.  REQUIRES: weight > 0.
+  Queue* AddQueue(int32 weight, int32 priority);
+
+  // Deletes 'queue' once its pending closures have run.  No closure may be
+  // scheduled on 'queue' afterwards.
+  void RemoveQueue(Queue* queue);
+
+  // Schedules 'fn' to run on the pool after the closures scheduled on
+  // 'queue' before it.
+  void Schedule(Queue* queue, std::function<void()> fn);
+
+  // Cumulative counters of the closures of a queue since its creation.
+  struct Stats {
+    // Number of closures run.
+    int64 closures_run = 0;
+    // Total time spent running the closures.
+    int64 busy_nanos = 0;
+    // Total time the closures waited between Schedule() and running.
+    int64 queued_nanos = 0;
+  };
+  Stats GetStats(const Queue* queue) const;
+
+  int NumThreads() const { return max_running_; }
+
+ private:
+  struct Closure {
+    std::function<void()> fn;
+    int64 scheduled_nanos;
+  };
+
+  // Runs closures until no queue has any waiting.
+  void Dispatch();
+
+  // Returns the queue whose next closure should run, or nullptr.
+  Queue* PickLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  thread::ThreadPool* const pool_;
+  const int max_running_;
+
+  mutable mutex mu_;
+  std::vector<Queue*> queues_ GUARDED_BY(mu_);
+  // Number of closures scheduled on pool_ that are running or waiting to
+  // run Dispatch().
+  int num_dispatchers_ GUARDED_BY(mu_);
+  // Notified when num_dispatchers_ drops to 0.
+  condition_variable dispatchers_done_;
+  // The largest virtual time of any queue when it was picked.
+  double virtual_time_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FairScheduler);
+};
+
+class FairScheduler::Queue {
+ private:
+  friend class FairScheduler;
+
+  Queue(int32 weight, int32 priority) : weight(weight), priority(priority) {}
+
+  const int32 weight;
+  const int32 priority;
+  std::deque<Closure> closures;
+  // Running time received so far, divided by weight.
+  double virtual_time = 0;
+  int num_running = 0;
+  bool removed = false;
+  Stats stats;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Queue);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_FAIR_SCHEDULER_H_
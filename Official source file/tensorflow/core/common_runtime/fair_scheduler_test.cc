@@ -0,0 +1,168 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/fair_scheduler.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(FairScheduler, RunsAllClosures) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  FairScheduler scheduler(&pool);
+  const int kQueues = 3;
+  const int kClosures = 1000;
+  std::vector<FairScheduler::Queue*> queues;
+  for (int i = 0; i < kQueues; ++i) {
+    queues.push_back(scheduler.AddQueue(i + 1, 0));
+  }
+  std::atomic<int> count(0);
+  BlockingCounter done(kQueues * kClosures);
+  for (int c = 0; c < kClosures; ++c) {
+    for (FairScheduler::Queue* queue : queues) {
+      scheduler.Schedule(queue, [&count, &done]() {
+        ++count;
+        done.DecrementCount();
+      });
+    }
+  }
+  done.Wait();
+  EXPECT_EQ(kQueues * kClosures, count);
+  for (FairScheduler::Queue* queue : queues) {
+    // The closure may still be finishing, so poll until it is counted.
+    while (scheduler.GetStats(queue).closures_run < kClosures) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+    EXPECT_EQ(kClosures, scheduler.GetStats(queue).closures_run);
+    scheduler.RemoveQueue(queue);
+  }
+}
+
+// Blocks the only thread of the scheduler's pool, with a closure of 'queue',
+// until the returned notification is notified.
+std::unique_ptr<Notification> BlockScheduler(FairScheduler* scheduler,
+                                             FairScheduler::Queue* queue) {
+  std::unique_ptr<Notification> release(new Notification);
+  Notification blocked;
+  Notification* release_ptr = release.get();
+  scheduler->Schedule(queue, [&blocked, release_ptr]() {
+    blocked.Notify();
+    release_ptr->WaitForNotification();
+  });
+  blocked.WaitForNotification();
+  return release;
+}
+
+TEST(FairScheduler, HigherPriorityRunsFirst) {
+  thread::ThreadPool pool(Env::Default(), "test", 1);
+  FairScheduler scheduler(&pool);
+  FairScheduler::Queue* blocker = scheduler.AddQueue(1, 0);
+  FairScheduler::Queue* low = scheduler.AddQueue(1, 0);
+  FairScheduler::Queue* high = scheduler.AddQueue(1, 1);
+
+  std::unique_ptr<Notification> release = BlockScheduler(&scheduler, blocker);
+  mutex mu;
+  std::vector<int> order;
+  BlockingCounter done(20);
+  for (int i = 0; i < 10; ++i) {
+    scheduler.Schedule(low, [&mu, &order, &done]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(0);
+      }
+      done.DecrementCount();
+    });
+    scheduler.Schedule(high, [&mu, &order, &done]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(1);
+      }
+      done.DecrementCount();
+    });
+  }
+  release->Notify();
+  done.Wait();
+
+  mutex_lock l(mu);
+  ASSERT_EQ(20, order.size());
+  for (int i = 0; i < 10; ++i) EXPECT_EQ(1, order[i]);
+  for (int i = 10; i < 20; ++i) EXPECT_EQ(0, order[i]);
+  scheduler.RemoveQueue(blocker);
+  scheduler.RemoveQueue(low);
+  scheduler.RemoveQueue(high);
+}
+
+TEST(FairScheduler, SharesThreadsByWeight) {
+  thread::ThreadPool pool(Env::Default(), "test", 1);
+  FairScheduler scheduler(&pool);
+  FairScheduler::Queue* blocker = scheduler.AddQueue(1, 0);
+  FairScheduler::Queue* heavy = scheduler.AddQueue(3, 0);
+  FairScheduler::Queue* light = scheduler.AddQueue(1, 0);
+
+  std::unique_ptr<Notification> release = BlockScheduler(&scheduler, blocker);
+  mutex mu;
+  std::vector<int> order;
+  const int kClosures = 40;
+  BlockingCounter done(2 * kClosures);
+  for (int i = 0; i < kClosures; ++i) {
+    for (FairScheduler::Queue* queue : {heavy, light}) {
+      const int id = queue == heavy ? 1 : 0;
+      scheduler.Schedule(queue, [&mu, &order, &done, id]() {
+        Env::Default()->SleepForMicroseconds(500);
+        {
+          mutex_lock l(mu);
+          order.push_back(id);
+        }
+        done.DecrementCount();
+      });
+    }
+  }
+  release->Notify();
+  done.Wait();
+
+  // While both queues had work, the heavy queue ran about three closures
+  // for every closure of the light queue.
+  mutex_lock l(mu);
+  int heavy_count = 0;
+  for (int i = 0; i < kClosures; ++i) heavy_count += order[i];
+  EXPECT_GT(heavy_count, kClosures / 2);
+  EXPECT_LT(heavy_count, kClosures);
+  scheduler.RemoveQueue(blocker);
+  scheduler.RemoveQueue(heavy);
+  scheduler.RemoveQueue(light);
+}
+
+TEST(FairScheduler, RemoveQueueWithPendingClosures) {
+  thread::ThreadPool pool(Env::Default(), "test", 1);
+  FairScheduler scheduler(&pool);
+  FairScheduler::Queue* queue = scheduler.AddQueue(1, 0);
+  std::unique_ptr<Notification> release = BlockScheduler(&scheduler, queue);
+  Notification ran;
+  scheduler.Schedule(queue, [&ran]() { ran.Notify(); });
+  scheduler.RemoveQueue(queue);
+  release->Notify();
+  ran.WaitForNotification();
+}
+
+}  // namespace
+}  // namespace tensorflow
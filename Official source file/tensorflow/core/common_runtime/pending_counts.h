@@ -16,6 +16,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <string.h>
 #include <unordered_map>
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -166,14 +167,16 @@ class PendingCounts {
     }
   }
 
-  // Initialize the state from "b".
+  // Initialize the state from "b". Also used to reset the counts of a
+  // recycled iteration, so the packed counts are copied in one block.
   // REQUIRES: "num_nodes_ == b.num_nodes_"
   void InitializeFrom(const PendingCounts& b) {
     DCHECK_EQ(num_nodes_, b.num_nodes_);
-    for (int id = 0; id < num_nodes_; id++) {
-      counts_[id] = b.counts_[id];
+    static_assert(sizeof(PackedCounts) == 1, "PackedCounts must be one byte");
+    memcpy(counts_, b.counts_, num_nodes_ * sizeof(PackedCounts));
+    if (!overflow_.empty() || !b.overflow_.empty()) {
+      overflow_ = b.overflow_;
     }
-    overflow_ = b.overflow_;
   }
 
  private:
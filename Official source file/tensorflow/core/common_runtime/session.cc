@@ -35,6 +35,16 @@ Status Session::Run(const RunOptions& run_options,
       "Run with options is not supported for this session.");
 }
 
+void Session::RunAsync(const RunOptions& run_options,
+                       const std::vector<std::pair<string, Tensor> >& inputs,
+                       const std::vector<string>& output_tensor_names,
+                       const std::vector<string>& target_node_names,
+                       std::vector<Tensor>* outputs, RunMetadata* run_metadata,
+                       std::function<void(const Status&)> done) {
+  done(errors::Unimplemented(
+      "Asynchronous run is not supported for this session."));
+}
+
 Status Session::PRunSetup(const std::vector<string>& input_names,
                           const std::vector<string>& output_names,
                           const std::vector<string>& target_nodes,
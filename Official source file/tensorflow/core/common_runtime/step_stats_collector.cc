@@ -183,25 +183,48 @@ void StepStatsCollector::Save(const string& device, NodeExecStats* nt) {
       delete nt;
       return;
     }
-    DeviceStepStats* dss = nullptr;
-    // Slow linear scan, but it should only be called
-    // by a Worker in a context with < ~10 devices.
-    // TODO(tucker): consider adding a std::unordered_map.
-    for (auto& ds : *step_stats_->mutable_dev_stats()) {
-      if (ds.device() == device) {
-        dss = &ds;
-        break;
-      }
-    }
-    if (dss == nullptr) {
-      dss = step_stats_->add_dev_stats();
-      dss->set_device(device);
-    }
-    nt->Swap(dss->add_node_stats());
+    nt->Swap(FindOrAddDeviceStats(device)->add_node_stats());
   }
   delete nt;
 }
 
+void StepStatsCollector::SaveSchedulingStats(
+    const string& device, const ExecutorSchedulingStats& stats) {
+  mutex_lock l(mu_);
+  if (!step_stats_) return;
+  ExecutorSchedulingStats* total =
+      FindOrAddDeviceStats(device)->mutable_scheduling_stats();
+  total->set_inline_nodes(total->inline_nodes() + stats.inline_nodes());
+  total->set_scheduled_nodes(total->scheduled_nodes() +
+                             stats.scheduled_nodes());
+  total->set_total_ready_to_start_micros(total->total_ready_to_start_micros() +
+                                         stats.total_ready_to_start_micros());
+  total->set_max_ready_to_start_micros(std::max(
+      total->max_ready_to_start_micros(), stats.max_ready_to_start_micros()));
+  total->set_total_ready_queue_depth(total->total_ready_queue_depth() +
+                                     stats.total_ready_queue_depth());
+  total->set_max_ready_queue_depth(
+      std::max(total->max_ready_queue_depth(), stats.max_ready_queue_depth()));
+  total->set_iterations_reused(total->iterations_reused() +
+                               stats.iterations_reused());
+  total->set_frames_reused(total->frames_reused() + stats.frames_reused());
+}
+
+DeviceStepStats* StepStatsCollector::FindOrAddDeviceStats(
+    const string& device) {
+  // Slow linear scan, but it should only be called
+  // by a Worker in a context with < ~10 devices.
+  // TODO(tucker): consider adding a std::unordered_map.
+  for (auto& ds : *step_stats_->mutable_dev_stats()) {
+    if (ds.device() == device) {
+      return &ds;
+    }
+  }
+  DeviceStepStats* dss = step_stats_->add_dev_stats();
+  dss->set_device(device);
+  return dss;
+}
+
 void StepStatsCollector::Swap(StepStats* ss) {
   mutex_lock l(mu_);
   CHECK(step_stats_);
@@ -23,6 +23,8 @@ limitations under the License.
 namespace tensorflow {
 
 class CostModelManager;
+class DeviceStepStats;
+class ExecutorSchedulingStats;
 class Graph;
 class NodeExecStats;
 class StepStats;
@@ -37,9 +39,18 @@ class StepStatsCollector {
 
   void Save(const string& device, NodeExecStats* nt);
 
+  // Adds the scheduling statistics of one executor of "device" to the
+  // statistics of the device.
+  void SaveSchedulingStats(const string& device,
+                           const ExecutorSchedulingStats& stats);
+
   void Swap(StepStats* ss);
 
  private:
+  // Returns the stats of "device", adding them if needed.
+  DeviceStepStats* FindOrAddDeviceStats(const string& device)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   mutex mu_;
   StepStats* step_stats_ GUARDED_BY(mu_);
 };
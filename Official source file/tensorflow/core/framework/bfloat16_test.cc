@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/framework/bfloat16.h"
 
+#include <string.h>
+#include <vector>
+
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -42,6 +45,27 @@ TEST(Bfloat16Test, Conversion) {
   }
 }
 
+TEST(Bfloat16Test, ConversionKeepsHighBits) {
+  // Odd lengths exercise the tail after the vectorized loops.
+  for (int size = 0; size <= 37; ++size) {
+    std::vector<float> a(size);
+    for (int i = 0; i < size; ++i) {
+      a[i] = (i % 2 ? -1.0f : 1.0f) * (i * 12345.678f + 0.001f);
+    }
+    std::vector<bfloat16> b(size);
+    std::vector<float> c(size);
+    FloatToBFloat16(a.data(), b.data(), size);
+    BFloat16ToFloat(b.data(), c.data(), size);
+    for (int i = 0; i < size; ++i) {
+      uint32 a_bits, c_bits;
+      memcpy(&a_bits, &a[i], sizeof(a_bits));
+      memcpy(&c_bits, &c[i], sizeof(c_bits));
+      EXPECT_EQ(a_bits >> 16, b[i].value);
+      EXPECT_EQ(a_bits & 0xffff0000u, c_bits);
+    }
+  }
+}
+
 static void BM_FloatToBFloat16(int iters) {
   testing::StopTiming();
   static const int N = 32 << 20;
@@ -0,0 +1,85 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/half.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TF_HALF_USE_F16C 1
+#include <immintrin.h>
+#endif
+
+#include "tensorflow/core/platform/cpu_info.h"
+
+namespace tensorflow {
+
+namespace {
+
+#ifdef TF_HALF_USE_F16C
+
+// These are compiled for F16C whatever the target flags of the build, and
+// must only be called once TestCPUFeature(F16C) has returned true.  They
+// return the number of elements converted, a multiple of 8.
+__attribute__((target("avx,f16c"))) int64 FloatToHalfF16C(const float* src,
+                                                           Eigen::half* dst,
+                                                           int64 size) {
+  int64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i),
+        _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+  }
+  return i;
+}
+
+__attribute__((target("avx,f16c"))) int64 HalfToFloatF16C(
+    const Eigen::half* src, float* dst, int64 size) {
+  int64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(
+                                  reinterpret_cast<const __m128i*>(src + i))));
+  }
+  return i;
+}
+
+bool UseF16C() {
+  static const bool use_f16c = port::TestCPUFeature(port::F16C);
+  return use_f16c;
+}
+
+#endif  // TF_HALF_USE_F16C
+
+}  // namespace
+
+void FloatToHalf(const float* src, Eigen::half* dst, int64 size) {
+  int64 i = 0;
+#ifdef TF_HALF_USE_F16C
+  if (UseF16C()) i = FloatToHalfF16C(src, dst, size);
+#endif
+  for (; i < size; ++i) {
+    dst[i] = Eigen::half(src[i]);
+  }
+}
+
+void HalfToFloat(const Eigen::half* src, float* dst, int64 size) {
+  int64 i = 0;
+#ifdef TF_HALF_USE_F16C
+  if (UseF16C()) i = HalfToFloatF16C(src, dst, size);
+#endif
+  for (; i < size; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,35 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_FRAMEWORK_HALF_H_
+#define TENSORFLOW_FRAMEWORK_HALF_H_
+
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Conversion routines between an array of float and Eigen::half of "size".
+//
+// They produce the same values as converting each element with Eigen::half's
+// round-to-nearest-even conversions, except that NaNs may keep different
+// payload bits.  On x86 CPUs with F16C the conversions run eight elements at a
+// time.
+void FloatToHalf(const float* src, Eigen::half* dst, int64 size);
+void HalfToFloat(const Eigen::half* src, float* dst, int64 size);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_FRAMEWORK_HALF_H_
@@ -0,0 +1,124 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/half.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(HalfTest, HalfToFloatAllValues) {
+  std::vector<Eigen::half> halves(1 << 16);
+  for (int i = 0; i < halves.size(); ++i) {
+    halves[i].x = static_cast<uint16>(i);
+  }
+  std::vector<float> floats(halves.size());
+  HalfToFloat(halves.data(), floats.data(), halves.size());
+  for (int i = 0; i < halves.size(); ++i) {
+    const float expected = static_cast<float>(halves[i]);
+    if (std::isnan(expected)) {
+      EXPECT_TRUE(std::isnan(floats[i])) << i;
+    } else {
+      EXPECT_EQ(expected, floats[i]) << i;
+    }
+  }
+}
+
+void ExpectConvertedLikeEigen(float f, Eigen::half h) {
+  if (std::isnan(f)) {
+    EXPECT_TRUE(std::isnan(static_cast<float>(h)));
+  } else {
+    EXPECT_EQ(Eigen::half(f).x, h.x) << f;
+  }
+}
+
+TEST(HalfTest, FloatToHalf) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<float> floats = {0.0f,
+                               -0.0f,
+                               1.0f,
+                               65504.0f,
+                               65520.0f,
+                               -1e9f,
+                               5.96e-8f,
+                               2.98e-8f,
+                               1.0f + 1.0f / 2048,
+                               std::numeric_limits<float>::infinity(),
+                               -std::numeric_limits<float>::infinity(),
+                               std::numeric_limits<float>::quiet_NaN()};
+  for (int i = 0; i < 1000; ++i) {
+    // Spread the exponents over the half range, including subnormals.
+    floats.push_back(std::ldexp(rnd.RandFloat() - 0.5f, rnd.Uniform(50) - 30));
+  }
+  // Every length up to 20 covers both the vector and the scalar loops.
+  for (int size = 0; size <= 20; ++size) {
+    std::vector<Eigen::half> halves(size);
+    FloatToHalf(floats.data(), halves.data(), size);
+    for (int i = 0; i < size; ++i) {
+      ExpectConvertedLikeEigen(floats[i], halves[i]);
+    }
+  }
+  std::vector<Eigen::half> halves(floats.size());
+  FloatToHalf(floats.data(), halves.data(), floats.size());
+  for (int i = 0; i < floats.size(); ++i) {
+    ExpectConvertedLikeEigen(floats[i], halves[i]);
+  }
+}
+
+static void BM_FloatToHalf(int iters) {
+  testing::StopTiming();
+  static const int N = 32 << 20;
+  const int64 tot = static_cast<int64>(iters) * N;
+  testing::ItemsProcessed(tot);
+  testing::BytesProcessed(tot * (sizeof(float) + sizeof(Eigen::half)));
+
+  std::vector<float> inp(N, 1.5f);
+  std::vector<Eigen::half> out(N);
+
+  testing::StartTiming();
+  while (iters--) {
+    FloatToHalf(inp.data(), out.data(), N);
+  }
+}
+BENCHMARK(BM_FloatToHalf);
+
+static void BM_HalfToFloat(int iters) {
+  testing::StopTiming();
+  static const int N = 32 << 20;
+  const int64 tot = static_cast<int64>(iters) * N;
+  testing::ItemsProcessed(tot);
+  testing::BytesProcessed(tot * (sizeof(float) + sizeof(Eigen::half)));
+
+  std::vector<Eigen::half> inp(N, Eigen::half(1.5f));
+  std::vector<float> out(N);
+
+  testing::StartTiming();
+  while (iters--) {
+    HalfToFloat(inp.data(), out.data(), N);
+  }
+}
+BENCHMARK(BM_HalfToFloat);
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/costmodel.h"
 
+#include <unordered_map>
 #include <vector>
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/graph/graph.h"
@@ -119,6 +120,52 @@ void CostModel::MergeFromStats(const NodeNameToCostIdMap& map,
   }
 }
 
+namespace {
+
+typedef std::unordered_map<string, const CostGraphDef::Node*> CostNodeMap;
+
+static CostNodeMap BuildCostNodeMap(const CostGraphDef& cost_graph) {
+  CostNodeMap map;
+  for (const CostGraphDef::Node& cnode : cost_graph.node()) {
+    map[cnode.name()] = &cnode;
+  }
+  return map;
+}
+
+static int64 Decay(int64 previous, int64 measured, double decay) {
+  if (measured <= 0) return previous;
+  if (previous <= 0) return measured;
+  return static_cast<int64>(decay * previous + (1.0 - decay) * measured);
+}
+
+}  // namespace
+
+void CostModel::MergeCostGraphDef(const CostGraphDef& previous, double decay,
+                                  CostGraphDef* cost_graph) {
+  CHECK_GE(decay, 0.0);
+  CHECK_LE(decay, 1.0);
+  const CostNodeMap map = BuildCostNodeMap(previous);
+  for (CostGraphDef::Node& cnode : *cost_graph->mutable_node()) {
+    auto it = map.find(cnode.name());
+    if (it == map.end() ||
+        it->second->output_info_size() != cnode.output_info_size()) {
+      continue;
+    }
+    const CostGraphDef::Node& prev = *it->second;
+    cnode.set_compute_cost(
+        Decay(prev.compute_cost(), cnode.compute_cost(), decay));
+    cnode.set_temporary_memory_size(Decay(prev.temporary_memory_size(),
+                                          cnode.temporary_memory_size(),
+                                          decay));
+    for (int i = 0; i < cnode.output_info_size(); ++i) {
+      CostGraphDef::Node::OutputInfo* output_info =
+          cnode.mutable_output_info(i);
+      output_info->set_size(
+          Decay(prev.output_info(i).size(), output_info->size(), decay));
+    }
+  }
+}
+
 void CostModel::Ensure(int id) {
   if (slot_bytes_.size() <= static_cast<size_t>(id)) {
     slot_bytes_.resize(id + 1);
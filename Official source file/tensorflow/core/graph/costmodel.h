@@ -72,6 +72,15 @@ class CostModel {
 
   void MergeFromStats(const NodeNameToCostIdMap& map, const StepStats& ss);
 
+  // Exponential-decay update of the compute cost and memory sizes of the
+  // nodes of "cost_graph" against the estimates of the nodes with the same
+  // name in "previous":
+  //   estimate = decay * previous + (1 - decay) * measured.
+  // Nodes without a measurement keep their previous estimate.
+  // REQUIRES: 0 <= decay <= 1.
+  static void MergeCostGraphDef(const CostGraphDef& previous, double decay,
+                                CostGraphDef* cost_graph);
+
   // Sets the number of outputs of "node".
   void SetNumOutputs(const Node* node, int num_outputs);
 
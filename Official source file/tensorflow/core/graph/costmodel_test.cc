@@ -0,0 +1,83 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/graph/costmodel.h"
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class CostModelTest : public ::testing::Test {
+ protected:
+  CostModelTest() : graph_(OpRegistry::Global()) {
+    Tensor x(DT_FLOAT, TensorShape({4}));
+    x.flat<float>().setZero();
+    input_ = test::graph::Constant(&graph_, x);
+    square_ = test::graph::Unary(&graph_, "Square", input_);
+  }
+
+  // Returns the cost graph of a model in which "square_" ran for "micros"
+  // and produced "bytes" bytes.
+  CostGraphDef MeasuredCostGraph(int64 micros, int64 bytes) {
+    CostModel cm(false);
+    cm.InitFromGraph(graph_);
+    cm.RecordMaxExecutionTime(square_, Microseconds(micros));
+    cm.RecordMaxMemorySize(square_, 0, Bytes(bytes));
+    CostGraphDef cost_graph;
+    cm.AddToCostGraphDef(&graph_, &cost_graph);
+    return cost_graph;
+  }
+
+  Graph graph_;
+  Node* input_;
+  Node* square_;
+};
+
+TEST_F(CostModelTest, MergeCostGraphDefDecays) {
+  CostGraphDef saved = MeasuredCostGraph(1000, 64);
+
+  // Every new session measures 200us; the saved estimate moves towards it
+  // by a factor of (1 - decay) per session.
+  int64 previous_error = 800;
+  for (int session = 0; session < 5; ++session) {
+    CostModel cm(false);
+    cm.InitFromGraph(graph_);
+    cm.RecordMaxExecutionTime(square_, Microseconds(200));
+    CostGraphDef merged;
+    cm.AddToCostGraphDef(&graph_, &merged);
+    CostModel::MergeCostGraphDef(saved, 0.5, &merged);
+    const CostGraphDef::Node* square = nullptr;
+    for (const CostGraphDef::Node& cnode : merged.node()) {
+      if (cnode.name() == square_->name()) square = &cnode;
+    }
+    ASSERT_NE(nullptr, square);
+    const int64 error = square->compute_cost() - 200;
+    EXPECT_EQ(previous_error / 2, error);
+    // Nothing was measured for the output size, so it is kept as is.
+    EXPECT_EQ(64, square->output_info(0).size());
+    // The cost model itself still holds the latest measurement.
+    EXPECT_EQ(200, cm.MaxExecutionTime(square_).value());
+    previous_error = error;
+    saved.Swap(&merged);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
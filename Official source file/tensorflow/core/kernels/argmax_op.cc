@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/kernels/row_reduction_cpu.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 
@@ -40,6 +41,35 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+// Writes the index of the extremum of every row of a row-major [rows, cols]
+// matrix.  Returns false if the device has no specialized implementation,
+// in which case ArgFunctor is used.
+template <typename Device, typename T, typename ArgFunctor>
+struct ArgReduceRows {
+  static bool Run(OpKernelContext* context, int64 rows, int64 cols,
+                  const T* in, int64* out) {
+    return false;
+  }
+};
+
+template <typename T>
+struct ArgReduceRows<CPUDevice, T, functor::ArgMax<CPUDevice, T>> {
+  static bool Run(OpKernelContext* context, int64 rows, int64 cols,
+                  const T* in, int64* out) {
+    ArgMaxRowsCPU(context->device(), rows, cols, in, out);
+    return true;
+  }
+};
+
+template <typename T>
+struct ArgReduceRows<CPUDevice, T, functor::ArgMin<CPUDevice, T>> {
+  static bool Run(OpKernelContext* context, int64 rows, int64 cols,
+                  const T* in, int64* out) {
+    ArgMinRowsCPU(context->device(), rows, cols, in, out);
+    return true;
+  }
+};
+
 template <typename Device, typename T, typename ArgFunctor>
 class ArgOp : public OpKernel {
  public:
@@ -73,6 +103,20 @@ class ArgOp : public OpKernel {
     }
     Tensor* output = nullptr;
     OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    // When every dimension after "dim" has size 1, the input is a matrix
+    // whose rows are reduced.
+    int64 inner_size = 1;
+    for (int d = dim + 1; d < input_dims; ++d) {
+      inner_size *= input_shape.dim_size(d);
+    }
+    if (inner_size == 1 &&
+        ArgReduceRows<Device, T, ArgFunctor>::Run(
+            context, output->NumElements(), input.dim_size(dim),
+            input.flat<T>().data(), output->flat<int64>().data())) {
+      return;
+    }
 
 #define HANDLE_DIM(NDIM)                                         \
   case NDIM:                                                     \
@@ -0,0 +1,680 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// See docs in ../ops/data_flow_ops.cc.
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace batch {
+
+// Runs closures at given times on a thread of its own, so that waiting for a
+// deadline does not hold a thread of the inter-op pool.  Closures should be
+// short; longer work should be handed to a runner.
+class DeadlineTimer {
+ public:
+  // Returns the timer shared by the batching kernels.  It is never deleted.
+  static DeadlineTimer* Global() {
+    static DeadlineTimer* timer = new DeadlineTimer;
+    return timer;
+  }
+
+  // Calls 'fn' once Env::Default()->NowMicros() >= 'deadline_micros'.
+  void Schedule(uint64 deadline_micros, std::function<void()> fn) {
+    mutex_lock l(mu_);
+    const bool earliest =
+        pending_.empty() || deadline_micros < pending_.begin()->first;
+    pending_.emplace(deadline_micros, std::move(fn));
+    if (earliest) cv_.notify_one();
+  }
+
+ private:
+  DeadlineTimer() {
+    thread_.reset(Env::Default()->StartThread(ThreadOptions(), "batch_timer",
+                                              [this]() { Loop(); }));
+  }
+
+  void Loop() {
+    mutex_lock l(mu_);
+    for (;;) {
+      if (pending_.empty()) {
+        cv_.wait(l);
+        continue;
+      }
+      const uint64 now = Env::Default()->NowMicros();
+      auto first = pending_.begin();
+      if (now < first->first) {
+        const int64 wait_ms = (first->first - now + 999) / 1000;
+        WaitForMilliseconds(&l, &cv_, wait_ms);
+        continue;
+      }
+      std::function<void()> fn = std::move(first->second);
+      pending_.erase(first);
+      l.unlock();
+      fn();
+      l.lock();
+    }
+  }
+
+  mutex mu_;
+  condition_variable cv_;
+  std::multimap<uint64, std::function<void()>> pending_ GUARDED_BY(mu_);
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeadlineTimer);
+};
+
+// Collects the inputs of concurrent invocations of a Batch op into batches
+// of at most max_batch_size rows.  A batch is closed when it is full, when
+// an input arrives that does not fit in it, or batch_timeout_micros after
+// its first input arrived.  The first invocation in a closed batch outputs
+// the concatenated inputs of all of them; the others output empty Tensors.
+class Batcher : public ResourceBase {
+ public:
+  typedef AsyncOpKernel::DoneCallback DoneCallback;
+
+  Batcher(const DataTypeVector& component_types, int32 max_batch_size,
+          int64 batch_timeout_micros)
+      : component_types_(component_types),
+        max_batch_size_(max_batch_size),
+        batch_timeout_micros_(batch_timeout_micros),
+        open_batch_size_(0),
+        open_batch_deadline_micros_(0),
+        num_batches_closed_(0) {}
+
+  const DataTypeVector& component_types() const { return component_types_; }
+  int32 max_batch_size() const { return max_batch_size_; }
+  int64 batch_timeout_micros() const { return batch_timeout_micros_; }
+
+  // Adds the inputs of 'ctx' to the open batch.  Calls 'callback' once the
+  // outputs of 'ctx' are set, which may happen on another thread.
+  void Enqueue(OpKernelContext* ctx, DoneCallback callback) {
+    OpInputList in_tensors;
+    OP_REQUIRES_OK_ASYNC(ctx, ctx->input_list("in_tensors", &in_tensors),
+                         callback);
+    Task task;
+    task.ctx = ctx;
+    task.callback = callback;
+    task.id = static_cast<int64>(random::New64() >> 1);
+    task.size = 0;
+    for (int i = 0; i < in_tensors.size(); ++i) {
+      const Tensor& t = in_tensors[i];
+      OP_REQUIRES_ASYNC(ctx, TensorShapeUtils::IsVectorOrHigher(t.shape()),
+                        errors::InvalidArgument(
+                            "Batch input ", i,
+                            " must be at least a vector, but saw shape: ",
+                            t.shape().DebugString()),
+                        callback);
+      OP_REQUIRES_ASYNC(
+          ctx, i == 0 || t.dim_size(0) == task.size,
+          errors::InvalidArgument(
+              "All Batch inputs must have the same size in the 0th "
+              "dimension, but input 0 has size ",
+              task.size, " and input ", i, " has size ", t.dim_size(0)),
+          callback);
+      task.size = t.dim_size(0);
+      task.inputs.push_back(t);
+    }
+    OP_REQUIRES_ASYNC(ctx, task.size <= max_batch_size_,
+                      errors::InvalidArgument(
+                          "Batch input of size ", task.size,
+                          " exceeds max_batch_size ", max_batch_size_),
+                      callback);
+
+    std::vector<std::vector<Task>> closed_batches;
+    bool start_timer = false;
+    int64 batch_number = 0;
+    uint64 deadline_micros = 0;
+    {
+      mutex_lock l(mu_);
+      if (!open_batch_.empty() &&
+          (open_batch_size_ + task.size > max_batch_size_ ||
+           !SameElementShapes(open_batch_[0], task))) {
+        closed_batches.emplace_back();
+        CloseBatchLocked(&closed_batches.back());
+      }
+      if (open_batch_.empty()) {
+        open_batch_deadline_micros_ =
+            Env::Default()->NowMicros() + batch_timeout_micros_;
+      }
+      open_batch_size_ += task.size;
+      open_batch_.push_back(std::move(task));
+      if (open_batch_size_ >= max_batch_size_ || batch_timeout_micros_ == 0) {
+        closed_batches.emplace_back();
+        CloseBatchLocked(&closed_batches.back());
+      } else if (open_batch_.size() == 1) {
+        start_timer = true;
+        batch_number = num_batches_closed_;
+        deadline_micros = open_batch_deadline_micros_;
+      }
+    }
+
+    if (start_timer) {
+      Ref();
+      DeadlineTimer::Global()->Schedule(deadline_micros,
+                                        [this, batch_number]() {
+                                          CloseBatchAtDeadline(batch_number);
+                                          Unref();
+                                        });
+    }
+    for (std::vector<Task>& batch : closed_batches) {
+      ProcessBatch(&batch);
+    }
+  }
+
+  string DebugString() override {
+    mutex_lock l(mu_);
+    return strings::StrCat("A Batcher with ", open_batch_.size(),
+                           " pending inputs");
+  }
+
+ private:
+  struct Task {
+    OpKernelContext* ctx;
+    DoneCallback callback;
+    int64 id;
+    int64 size;
+    std::vector<Tensor> inputs;
+  };
+
+  // Returns true if the inputs of 'a' and 'b' can be concatenated.
+  static bool SameElementShapes(const Task& a, const Task& b) {
+    for (size_t i = 0; i < a.inputs.size(); ++i) {
+      const TensorShape& sa = a.inputs[i].shape();
+      const TensorShape& sb = b.inputs[i].shape();
+      if (sa.dims() != sb.dims()) return false;
+      for (int d = 1; d < sa.dims(); ++d) {
+        if (sa.dim_size(d) != sb.dim_size(d)) return false;
+      }
+    }
+    return true;
+  }
+
+  void CloseBatchLocked(std::vector<Task>* batch)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    batch->swap(open_batch_);
+    open_batch_size_ = 0;
+    ++num_batches_closed_;
+  }
+
+  // Called by the timer at the deadline of the batch opened after
+  // 'batch_number' batches had been closed.  Closes it if it is still open,
+  // and processes it on the runner of the execution that opened it, which
+  // stays alive until the batch is processed.
+  void CloseBatchAtDeadline(int64 batch_number) {
+    auto batch = std::make_shared<std::vector<Task>>();
+    {
+      mutex_lock l(mu_);
+      if (num_batches_closed_ != batch_number) return;
+      CloseBatchLocked(batch.get());
+    }
+    (*(*batch)[0].ctx->runner())([batch]() { ProcessBatch(batch.get()); });
+  }
+
+  // Sets the outputs of every Task in '*batch' and calls their callbacks.
+  // Does not touch the Batcher, which may be deleted by a callback.
+  static void ProcessBatch(std::vector<Task>* batch) {
+    const int num_components = (*batch)[0].inputs.size();
+    std::vector<Tensor> batched(num_components);
+    if (batch->size() == 1) {
+      batched = (*batch)[0].inputs;
+    } else {
+      std::vector<Tensor> to_concatenate(batch->size());
+      for (int c = 0; c < num_components; ++c) {
+        for (size_t i = 0; i < batch->size(); ++i) {
+          to_concatenate[i] = (*batch)[i].inputs[c];
+        }
+        batched[c] = tensor::Concat(to_concatenate);
+      }
+    }
+
+    for (size_t i = 0; i < batch->size(); ++i) {
+      Task& task = (*batch)[i];
+      OpKernelContext* ctx = task.ctx;
+      Status s = SetOutputs(ctx, task, i == 0 ? batch : nullptr, batched);
+      if (!s.ok()) ctx->SetStatus(s);
+      task.callback();
+    }
+  }
+
+  // Sets the outputs of 'task'.  If 'batch' is not null, 'task' is the
+  // first Task of 'batch' and outputs 'batched'; otherwise it outputs
+  // empty Tensors.
+  static Status SetOutputs(OpKernelContext* ctx, const Task& task,
+                           const std::vector<Task>* batch,
+                           const std::vector<Tensor>& batched) {
+    OpOutputList batched_tensors;
+    TF_RETURN_IF_ERROR(ctx->output_list("batched_tensors", &batched_tensors));
+    const int64 num_rows = batch == nullptr ? 0 : batch->size();
+    Tensor* batch_index = nullptr;
+    TF_RETURN_IF_ERROR(ctx->allocate_output(
+        "batch_index", TensorShape({num_rows, 3}), &batch_index));
+    Tensor* id = nullptr;
+    TF_RETURN_IF_ERROR(ctx->allocate_output("id", TensorShape({}), &id));
+    id->scalar<int64>()() = task.id;
+
+    if (batch == nullptr) {
+      for (size_t c = 0; c < task.inputs.size(); ++c) {
+        TensorShape empty_shape = task.inputs[c].shape();
+        empty_shape.set_dim(0, 0);
+        Tensor* unused;
+        TF_RETURN_IF_ERROR(batched_tensors.allocate(c, empty_shape, &unused));
+      }
+      return Status::OK();
+    }
+
+    for (size_t c = 0; c < batched.size(); ++c) {
+      batched_tensors.set(c, batched[c]);
+    }
+    auto index = batch_index->matrix<int64>();
+    int64 offset = 0;
+    for (int64 i = 0; i < num_rows; ++i) {
+      const Task& t = (*batch)[i];
+      index(i, 0) = t.id;
+      index(i, 1) = offset;
+      offset += t.size;
+      index(i, 2) = offset;
+    }
+    return Status::OK();
+  }
+
+  const DataTypeVector component_types_;
+  const int32 max_batch_size_;
+  const int64 batch_timeout_micros_;
+
+  mutex mu_;
+  std::vector<Task> open_batch_ GUARDED_BY(mu_);
+  int64 open_batch_size_ GUARDED_BY(mu_);
+  uint64 open_batch_deadline_micros_ GUARDED_BY(mu_);
+  int64 num_batches_closed_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Batcher);
+};
+
+class BatchOp : public AsyncOpKernel {
+ public:
+  explicit BatchOp(OpKernelConstruction* context)
+      : AsyncOpKernel(context), batcher_set_(false) {
+    OP_REQUIRES_OK(context, context->GetAttr("T", &component_types_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("max_batch_size", &max_batch_size_));
+    OP_REQUIRES_OK(context, context->GetAttr("batch_timeout_micros",
+                                             &batch_timeout_micros_));
+  }
+
+  ~BatchOp() override {
+    // If the batcher was not shared, delete it.
+    if (batcher_set_ && cinfo_.resource_is_private_to_kernel()) {
+      TF_CHECK_OK(cinfo_.resource_manager()->Delete<Batcher>(cinfo_.container(),
+                                                             cinfo_.name()));
+    }
+  }
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback callback) override {
+    Batcher* batcher = nullptr;
+    OP_REQUIRES_OK_ASYNC(ctx, GetBatcher(ctx, &batcher), callback);
+    batcher->Enqueue(ctx, [batcher, callback]() {
+      batcher->Unref();
+      callback();
+    });
+  }
+
+ private:
+  Status GetBatcher(OpKernelContext* ctx, Batcher** batcher) {
+    mutex_lock l(mu_);
+    if (!batcher_set_) {
+      TF_RETURN_IF_ERROR(cinfo_.Init(ctx->resource_manager(), def()));
+    }
+    auto creator = [this](Batcher** ret) {
+      *ret = new Batcher(component_types_, max_batch_size_,
+                         batch_timeout_micros_);
+      return Status::OK();
+    };
+    TF_RETURN_IF_ERROR(cinfo_.resource_manager()->LookupOrCreate<Batcher>(
+        cinfo_.container(), cinfo_.name(), batcher, creator));
+    batcher_set_ = true;
+    Status s;
+    if ((*batcher)->component_types() != component_types_) {
+      s = errors::InvalidArgument(
+          "Shared batcher '", cinfo_.name(), "' has component types ",
+          DataTypeSliceString((*batcher)->component_types()),
+          " but requested component types were ",
+          DataTypeSliceString(component_types_));
+    } else if ((*batcher)->max_batch_size() != max_batch_size_ ||
+               (*batcher)->batch_timeout_micros() != batch_timeout_micros_) {
+      s = errors::InvalidArgument(
+          "Shared batcher '", cinfo_.name(), "' has max_batch_size ",
+          (*batcher)->max_batch_size(), " and batch_timeout_micros ",
+          (*batcher)->batch_timeout_micros(),
+          " but requested max_batch_size was ", max_batch_size_,
+          " and batch_timeout_micros was ", batch_timeout_micros_);
+    }
+    if (!s.ok()) {
+      (*batcher)->Unref();
+      *batcher = nullptr;
+    }
+    return s;
+  }
+
+  DataTypeVector component_types_;
+  int32 max_batch_size_;
+  int64 batch_timeout_micros_;
+
+  mutex mu_;
+  ContainerInfo cinfo_ GUARDED_BY(mu_);
+  bool batcher_set_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BatchOp);
+};
+
+REGISTER_KERNEL_BUILDER(Name("Batch").Device(DEVICE_CPU), BatchOp);
+
+// Hands the slices of a batched Tensor to the Unbatch invocations that
+// contributed its rows.  A slice may arrive before or after the invocation
+// that waits for it.  Slices for cancelled invocations are dropped, and a
+// slice or invocation that is still unmatched timeout_micros after it
+// arrived is dropped or fails, so that neither is kept forever.
+class Unbatcher : public ResourceBase {
+ public:
+  typedef AsyncOpKernel::DoneCallback DoneCallback;
+
+  explicit Unbatcher(int64 timeout_micros) : timeout_micros_(timeout_micros) {}
+
+  int64 timeout_micros() const { return timeout_micros_; }
+
+  // Outputs the slice for 'id' from 'ctx', as soon as it is delivered.
+  void Wait(OpKernelContext* ctx, int64 id, DoneCallback callback) {
+    CancellationManager* cm = ctx->cancellation_manager();
+    CancellationToken token = CancellationManager::kInvalidToken;
+    bool already_cancelled = false;
+    Tensor slice;
+    bool have_slice = false;
+    {
+      mutex_lock l(mu_);
+      auto it = slices_.find(id);
+      if (it != slices_.end()) {
+        slice = it->second;
+        slices_.erase(it);
+        have_slice = true;
+      } else if (waiters_.count(id) > 0) {
+        l.unlock();
+        ctx->SetStatus(errors::InvalidArgument(
+            "Unbatch is already waiting for id ", id));
+        callback();
+        return;
+      } else {
+        if (cm != nullptr) {
+          token = cm->get_cancellation_token();
+          already_cancelled =
+              !cm->RegisterCallback(token, [this, id]() { Cancel(id); });
+        }
+        if (already_cancelled) {
+          cancelled_.insert(id);
+        } else {
+          waiters_[id] = Waiter{ctx, callback, token};
+        }
+        ExpireAfterTimeout(id);
+      }
+    }
+    if (have_slice) {
+      ctx->set_output(0, slice);
+      callback();
+    } else if (already_cancelled) {
+      ctx->SetStatus(errors::Cancelled("Unbatch operation was cancelled"));
+      callback();
+    }
+  }
+
+  // Outputs 'slice' from the invocation waiting for 'id', or keeps it until
+  // that invocation arrives.  Drops it if that invocation was cancelled.
+  void Deliver(int64 id, const Tensor& slice) {
+    Waiter waiter;
+    {
+      mutex_lock l(mu_);
+      auto it = waiters_.find(id);
+      if (it == waiters_.end()) {
+        if (cancelled_.erase(id) == 0) {
+          slices_[id] = slice;
+          ExpireAfterTimeout(id);
+        }
+        return;
+      }
+      waiter = it->second;
+      waiters_.erase(it);
+    }
+    if (waiter.token != CancellationManager::kInvalidToken) {
+      waiter.ctx->cancellation_manager()->DeregisterCallback(waiter.token);
+    }
+    waiter.ctx->set_output(0, slice);
+    waiter.callback();
+  }
+
+  string DebugString() override {
+    mutex_lock l(mu_);
+    return strings::StrCat("An Unbatcher with ", waiters_.size(),
+                           " waiting invocations and ", slices_.size(),
+                           " undelivered slices");
+  }
+
+ private:
+  struct Waiter {
+    OpKernelContext* ctx;
+    DoneCallback callback;
+    CancellationToken token;
+  };
+
+  void Cancel(int64 id) {
+    Waiter waiter;
+    {
+      mutex_lock l(mu_);
+      auto it = waiters_.find(id);
+      if (it == waiters_.end()) return;
+      waiter = it->second;
+      waiters_.erase(it);
+      // The slice for 'id' may still be delivered; remember to drop it.
+      cancelled_.insert(id);
+    }
+    waiter.ctx->SetStatus(errors::Cancelled("Unbatch operation was cancelled"));
+    waiter.callback();
+  }
+
+  // Calls Expire(id) timeout_micros from now.
+  void ExpireAfterTimeout(int64 id) {
+    Ref();
+    DeadlineTimer::Global()->Schedule(
+        Env::Default()->NowMicros() + timeout_micros_, [this, id]() {
+          Expire(id);
+          Unref();
+        });
+  }
+
+  // Forgets 'id': drops its undelivered slice, and fails the invocation
+  // still waiting for it.
+  void Expire(int64 id) {
+    Waiter waiter;
+    {
+      mutex_lock l(mu_);
+      slices_.erase(id);
+      cancelled_.erase(id);
+      auto it = waiters_.find(id);
+      if (it == waiters_.end()) return;
+      waiter = it->second;
+      waiters_.erase(it);
+    }
+    if (waiter.token != CancellationManager::kInvalidToken) {
+      waiter.ctx->cancellation_manager()->DeregisterCallback(waiter.token);
+    }
+    waiter.ctx->SetStatus(errors::DeadlineExceeded(
+        "Unbatch did not receive the rows of id ", id, " within ",
+        timeout_micros_, " microseconds"));
+    waiter.callback();
+  }
+
+  const int64 timeout_micros_;
+
+  mutex mu_;
+  std::unordered_map<int64, Waiter> waiters_ GUARDED_BY(mu_);
+  std::unordered_map<int64, Tensor> slices_ GUARDED_BY(mu_);
+  // Ids whose invocation was cancelled before its slice was delivered.
+  std::unordered_set<int64> cancelled_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Unbatcher);
+};
+
+class UnbatchOp : public AsyncOpKernel {
+ public:
+  explicit UnbatchOp(OpKernelConstruction* context)
+      : AsyncOpKernel(context), unbatcher_set_(false) {
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("timeout_micros", &timeout_micros_));
+  }
+
+  ~UnbatchOp() override {
+    // If the unbatcher was not shared, delete it.
+    if (unbatcher_set_ && cinfo_.resource_is_private_to_kernel()) {
+      TF_CHECK_OK(cinfo_.resource_manager()->Delete<Unbatcher>(
+          cinfo_.container(), cinfo_.name()));
+    }
+  }
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback callback) override {
+    const Tensor& batched_tensor = ctx->input(0);
+    const Tensor& batch_index = ctx->input(1);
+    const Tensor& id_t = ctx->input(2);
+    OP_REQUIRES_ASYNC(
+        ctx, TensorShapeUtils::IsVectorOrHigher(batched_tensor.shape()),
+        errors::InvalidArgument(
+            "batched_tensor must be at least a vector, but saw shape: ",
+            batched_tensor.shape().DebugString()),
+        callback);
+    OP_REQUIRES_ASYNC(ctx, TensorShapeUtils::IsMatrix(batch_index.shape()) &&
+                               batch_index.dim_size(1) == 3,
+                      errors::InvalidArgument(
+                          "batch_index must be a matrix with 3 columns, but "
+                          "saw shape: ",
+                          batch_index.shape().DebugString()),
+                      callback);
+    OP_REQUIRES_ASYNC(ctx, TensorShapeUtils::IsScalar(id_t.shape()),
+                      errors::InvalidArgument("id must be a scalar, but saw "
+                                              "shape: ",
+                                              id_t.shape().DebugString()),
+                      callback);
+    const int64 id = id_t.scalar<int64>()();
+
+    Unbatcher* unbatcher = nullptr;
+    OP_REQUIRES_OK_ASYNC(ctx, GetUnbatcher(ctx, &unbatcher), callback);
+    core::ScopedUnref unref_me(unbatcher);
+
+    if (batch_index.dim_size(0) == 0) {
+      // Another invocation received the batch containing our rows.
+      unbatcher->Ref();
+      unbatcher->Wait(ctx, id, [unbatcher, callback]() {
+        unbatcher->Unref();
+        callback();
+      });
+      return;
+    }
+
+    auto index = batch_index.matrix<int64>();
+    const int64 num_rows = batched_tensor.dim_size(0);
+    bool found_id = false;
+    for (int64 i = 0; i < batch_index.dim_size(0); ++i) {
+      const int64 start = index(i, 1);
+      const int64 end = index(i, 2);
+      OP_REQUIRES_ASYNC(
+          ctx, 0 <= start && start <= end && end <= num_rows,
+          errors::InvalidArgument("batch_index row ", i, " selects rows [",
+                                  start, ", ", end,
+                                  ") of a batched_tensor with ", num_rows,
+                                  " rows"),
+          callback);
+    }
+    for (int64 i = 0; i < batch_index.dim_size(0); ++i) {
+      Tensor slice = batched_tensor.Slice(index(i, 1), index(i, 2));
+      if (!slice.IsAligned()) slice = tensor::DeepCopy(slice);
+      if (index(i, 0) == id) {
+        ctx->set_output(0, slice);
+        found_id = true;
+      } else {
+        unbatcher->Deliver(index(i, 0), slice);
+      }
+    }
+    OP_REQUIRES_ASYNC(ctx, found_id,
+                      errors::InvalidArgument("id ", id,
+                                              " does not appear in batch_index"),
+                      callback);
+    callback();
+  }
+
+ private:
+  Status GetUnbatcher(OpKernelContext* ctx, Unbatcher** unbatcher) {
+    mutex_lock l(mu_);
+    if (!unbatcher_set_) {
+      TF_RETURN_IF_ERROR(cinfo_.Init(ctx->resource_manager(), def()));
+    }
+    auto creator = [this](Unbatcher** ret) {
+      *ret = new Unbatcher(timeout_micros_);
+      return Status::OK();
+    };
+    TF_RETURN_IF_ERROR(cinfo_.resource_manager()->LookupOrCreate<Unbatcher>(
+        cinfo_.container(), cinfo_.name(), unbatcher, creator));
+    unbatcher_set_ = true;
+    if ((*unbatcher)->timeout_micros() != timeout_micros_) {
+      Status s = errors::InvalidArgument(
+          "Shared unbatcher '", cinfo_.name(), "' has timeout_micros ",
+          (*unbatcher)->timeout_micros(), " but requested timeout_micros was ",
+          timeout_micros_);
+      (*unbatcher)->Unref();
+      *unbatcher = nullptr;
+      return s;
+    }
+    return Status::OK();
+  }
+
+  int64 timeout_micros_;
+
+  mutex mu_;
+  ContainerInfo cinfo_ GUARDED_BY(mu_);
+  bool unbatcher_set_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(UnbatchOp);
+};
+
+REGISTER_KERNEL_BUILDER(Name("Unbatch").Device(DEVICE_CPU), UnbatchOp);
+
+}  // namespace batch
+
+}  // namespace tensorflow
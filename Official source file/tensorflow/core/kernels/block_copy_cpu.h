@@ -0,0 +1,359 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_BLOCK_COPY_CPU_H_
+#define TENSORFLOW_KERNELS_BLOCK_COPY_CPU_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// A run of output indices along one dimension of a block copy: "length"
+// indices holding the input indices input_begin, input_begin + step, ..., or
+// padding if step is 0, repeated "repeat" times back to back.
+struct BlockCopyRange {
+  int64 input_begin;
+  int64 length;
+  int step;
+  int64 repeat;
+};
+
+typedef std::vector<BlockCopyRange> BlockCopyRanges;
+
+// The ranges of a dimension of size "size" padded by "before" and "after"
+// indices.
+inline BlockCopyRanges PadRanges(int64 size, int64 before, int64 after) {
+  return {{0, before, 0, 1}, {0, size, 1, 1}, {0, after, 0, 1}};
+}
+
+// The ranges of a dimension of size "size" padded by "before" and "after"
+// indices reflected about its first and last index, skipping that index if
+// "offset" is 1.
+inline BlockCopyRanges MirrorPadRanges(int64 size, int64 before, int64 after,
+                                       int offset) {
+  return {{before - 1 + offset, before, -1, 1},
+          {0, size, 1, 1},
+          {size - 1 - offset, after, -1, 1}};
+}
+
+// The ranges of a dimension of size "size" tiled "multiple" times.
+inline BlockCopyRanges TileRanges(int64 size, int64 multiple) {
+  return {{0, size, 1, multiple}};
+}
+
+// Copies a row-major input tensor into an output tensor in which every
+// dimension is described by BlockCopyRanges.  Tile, Pad and MirrorPad are
+// all such copies.
+//
+// Instead of computing an input index per output element, the copy is
+// decomposed into blocks: trailing dimensions that are copied unchanged
+// form contiguous chunks, ranges of the innermost remaining dimension are
+// copied at once, padding is filled in whole blocks, and the repetitions of
+// a range are copied from its first repetition in the output.  Work is
+// sharded across the outermost dimension.  Everything is computed per
+// range, never per output index, so tiling by a huge multiple costs no
+// more to set up than tiling by 2.
+template <typename T>
+class BlockCopier {
+ public:
+  // Requires ranges.size() == input_dims.size() and the input indices of
+  // every range of dimension d to be in [0, input_dims[d]).
+  BlockCopier(const std::vector<int64>& input_dims,
+              const std::vector<BlockCopyRanges>& ranges);
+
+  // Returns true if the block copies are long enough to beat the
+  // coefficient-wise Eigen expressions.
+  bool efficient() const { return efficient_; }
+
+  // Copies "input" into "output", which must not overlap.
+  void Run(DeviceBase* d, const T* input, const T& pad_value, T* output) const;
+
+ private:
+  // A dimension that is not copied unchanged.  Strides are in elements.
+  struct Dim {
+    BlockCopyRanges ranges;
+    // begin[r] is the first output index of ranges[r].
+    std::vector<int64> begin;
+    int64 size;
+    int64 input_stride;
+    int64 output_stride;
+  };
+
+  // Sets "*src" to the input index held by output index "i" of "dim", or -1
+  // for padding, and "*first" to the same index in the first repetition of
+  // its range.
+  static void Locate(const Dim& dim, int64 i, int64* src, int64* first);
+
+  // Copies the block of dims_[level] starting at "input" and "output".
+  void Build(int level, const T* input, const T& pad_value, T* output) const;
+  // Copies the innermost indices [start, limit) of the row at "input" and
+  // "output".
+  void BuildRowRange(const T* input, const T& pad_value, T* output,
+                     int64 start, int64 limit) const;
+
+  // Number of contiguous elements copied unchanged per innermost index.
+  int64 chunk_ = 1;
+  std::vector<Dim> dims_;
+  bool efficient_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockCopier);
+};
+
+// Implementation details follow.
+
+namespace block_copy_internal {
+
+// Drops empty ranges, turns single indices into forward ranges and repeated
+// padding into one range, and merges ranges that continue each other.
+inline BlockCopyRanges Normalize(const BlockCopyRanges& ranges) {
+  BlockCopyRanges result;
+  for (BlockCopyRange r : ranges) {
+    if (r.length == 0 || r.repeat == 0) continue;
+    if (r.length == 1 && r.step != 0) r.step = 1;
+    if (r.step == 0) {
+      r.length *= r.repeat;
+      r.repeat = 1;
+    }
+    if (!result.empty()) {
+      BlockCopyRange& p = result.back();
+      if (p.repeat == 1 && r.repeat == 1 && p.step == r.step &&
+          (r.step == 0 ||
+           r.input_begin == p.input_begin + p.length * p.step)) {
+        p.length += r.length;
+        continue;
+      }
+    }
+    result.push_back(r);
+  }
+  return result;
+}
+
+inline bool IsIdentity(int64 input_dim, const BlockCopyRanges& ranges) {
+  if (ranges.empty()) return input_dim == 0;
+  return ranges.size() == 1 && ranges[0].input_begin == 0 &&
+         ranges[0].length == input_dim && ranges[0].step == 1 &&
+         ranges[0].repeat == 1;
+}
+
+// Copies of fewer bytes than this are left to Eigen.
+const int64 kMinBytesPerCopy = 64;
+
+}  // namespace block_copy_internal
+
+template <typename T>
+BlockCopier<T>::BlockCopier(const std::vector<int64>& input_dims,
+                            const std::vector<BlockCopyRanges>& ranges) {
+  using block_copy_internal::IsIdentity;
+  CHECK_EQ(input_dims.size(), ranges.size());
+  std::vector<BlockCopyRanges> normalized;
+  for (const BlockCopyRanges& r : ranges) {
+    normalized.push_back(block_copy_internal::Normalize(r));
+  }
+  int last = static_cast<int>(input_dims.size()) - 1;
+  while (last >= 0 && IsIdentity(input_dims[last], normalized[last])) {
+    chunk_ *= input_dims[last];
+    --last;
+  }
+  if (last < 0) {
+    efficient_ = true;
+    return;
+  }
+
+  // The copies are as long as the ranges of the innermost remaining
+  // dimension, or single indices for reversed ranges.
+  int64 copies_per_row = 0;
+  int64 row_length = 0;
+  for (const BlockCopyRange& r : normalized[last]) {
+    copies_per_row += (r.step < 0 ? r.length : 1) * r.repeat;
+    row_length += r.length * r.repeat;
+  }
+  const int64 row_bytes = row_length * chunk_ * sizeof(T);
+  efficient_ =
+      row_bytes >= block_copy_internal::kMinBytesPerCopy * copies_per_row;
+
+  // Dimensions of size 1 copied unchanged do not affect the layout.
+  // Consecutive unchanged dimensions are merged into one.
+  bool previous_identity = false;
+  for (int d = 0; d <= last; ++d) {
+    const bool identity = IsIdentity(input_dims[d], normalized[d]);
+    if (identity && input_dims[d] == 1) continue;
+    if (identity && previous_identity) {
+      dims_.back().size *= input_dims[d];
+      dims_.back().ranges = {{0, dims_.back().size, 1, 1}};
+      continue;
+    }
+    Dim dim;
+    dim.size = input_dims[d];
+    dim.ranges = normalized[d];
+    dims_.push_back(std::move(dim));
+    previous_identity = identity;
+  }
+
+  int64 input_stride = chunk_;
+  int64 output_stride = chunk_;
+  for (int d = static_cast<int>(dims_.size()) - 1; d >= 0; --d) {
+    Dim& dim = dims_[d];
+    int64 output_size = 0;
+    for (const BlockCopyRange& r : dim.ranges) {
+      dim.begin.push_back(output_size);
+      output_size += r.length * r.repeat;
+    }
+    dim.input_stride = input_stride;
+    dim.output_stride = output_stride;
+    input_stride *= dim.size;
+    output_stride *= output_size;
+    dim.size = output_size;
+  }
+}
+
+template <typename T>
+void BlockCopier<T>::Locate(const Dim& dim, int64 i, int64* src,
+                            int64* first) {
+  const int r =
+      std::upper_bound(dim.begin.begin(), dim.begin.end(), i) -
+      dim.begin.begin() - 1;
+  const BlockCopyRange& range = dim.ranges[r];
+  const int64 offset = (i - dim.begin[r]) % range.length;
+  *first = range.step == 0 ? i : dim.begin[r] + offset;
+  *src = range.step == 0 ? -1 : range.input_begin + offset * range.step;
+}
+
+template <typename T>
+void BlockCopier<T>::Run(DeviceBase* d, const T* input, const T& pad_value,
+                         T* output) const {
+  if (dims_.empty()) {
+    std::copy(input, input + chunk_, output);
+    return;
+  }
+  auto worker_threads = d->tensorflow_cpu_worker_threads();
+  if (dims_.size() == 1) {
+    // The outermost dimension is also the innermost one: shard the row.
+    auto build_row = [this, input, &pad_value, output](int64 start,
+                                                        int64 limit) {
+      BuildRowRange(input, pad_value, output, start, limit);
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, dims_[0].size,
+          chunk_ * sizeof(T), build_row);
+    return;
+  }
+  // Blocks that repeat an earlier block are copied in a second pass, once
+  // the blocks they repeat have been built.
+  const Dim& outer = dims_[0];
+  auto build = [this, &outer, input, &pad_value, output](int64 start,
+                                                          int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      T* out = output + i * outer.output_stride;
+      int64 src, first;
+      Locate(outer, i, &src, &first);
+      if (src < 0) {
+        std::fill_n(out, outer.output_stride, pad_value);
+      } else if (first == i) {
+        Build(1, input + src * outer.input_stride, pad_value, out);
+      }
+    }
+  };
+  auto repeat = [&outer, output](int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      int64 src, first;
+      Locate(outer, i, &src, &first);
+      if (src < 0 || first == i) continue;
+      const T* from = output + first * outer.output_stride;
+      std::copy(from, from + outer.output_stride,
+                output + i * outer.output_stride);
+    }
+  };
+  const int64 cost = outer.output_stride * sizeof(T);
+  Shard(worker_threads->num_threads, worker_threads->workers, outer.size,
+        cost, build);
+  Shard(worker_threads->num_threads, worker_threads->workers, outer.size,
+        cost, repeat);
+}
+
+template <typename T>
+void BlockCopier<T>::Build(int level, const T* input, const T& pad_value,
+                           T* output) const {
+  if (level + 1 == static_cast<int>(dims_.size())) {
+    BuildRowRange(input, pad_value, output, 0, dims_.back().size);
+    return;
+  }
+  const Dim& dim = dims_[level];
+  for (size_t r = 0; r < dim.ranges.size(); ++r) {
+    const BlockCopyRange& range = dim.ranges[r];
+    T* out = output + dim.begin[r] * dim.output_stride;
+    const int64 block = range.length * dim.output_stride;
+    if (range.step == 0) {
+      std::fill_n(out, block * range.repeat, pad_value);
+      continue;
+    }
+    for (int64 k = 0; k < range.length; ++k) {
+      Build(level + 1,
+            input + (range.input_begin + k * range.step) * dim.input_stride,
+            pad_value, out + k * dim.output_stride);
+    }
+    for (int64 k = 1; k < range.repeat; ++k) {
+      std::copy(out, out + block, out + k * block);
+    }
+  }
+}
+
+template <typename T>
+void BlockCopier<T>::BuildRowRange(const T* input, const T& pad_value,
+                                   T* output, int64 start,
+                                   int64 limit) const {
+  const Dim& dim = dims_.back();
+  for (size_t r = 0; r < dim.ranges.size(); ++r) {
+    const BlockCopyRange& range = dim.ranges[r];
+    const int64 range_begin = dim.begin[r];
+    const int64 range_end = range_begin + range.length * range.repeat;
+    if (range_end <= start || limit <= range_begin) continue;
+    if (range.step == 0) {
+      const int64 begin = std::max(start, range_begin);
+      const int64 end = std::min(limit, range_end);
+      std::fill_n(output + begin * chunk_, (end - begin) * chunk_, pad_value);
+      continue;
+    }
+    // Copy the part of every repetition of the range within the limits.
+    int64 rep_begin =
+        range_begin +
+        std::max<int64>(0, (start - range_begin) / range.length) * range.length;
+    for (; rep_begin < std::min(limit, range_end); rep_begin += range.length) {
+      const int64 begin = std::max(start, rep_begin);
+      const int64 end = std::min(limit, rep_begin + range.length);
+      const int64 offset = begin - rep_begin;
+      const int64 length = end - begin;
+      T* out = output + begin * chunk_;
+      if (range.step > 0) {
+        const T* in = input + (range.input_begin + offset) * chunk_;
+        std::copy(in, in + length * chunk_, out);
+      } else {
+        for (int64 k = 0; k < length; ++k) {
+          const T* in = input + (range.input_begin - offset - k) * chunk_;
+          std::copy(in, in + chunk_, out + k * chunk_);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_BLOCK_COPY_CPU_H_
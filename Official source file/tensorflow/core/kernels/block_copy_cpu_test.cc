@@ -0,0 +1,271 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/block_copy_cpu.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class TestDevice : public DeviceBase {
+ public:
+  TestDevice() : DeviceBase(Env::Default()), pool_(Env::Default(), "test", 4) {
+    threads_.num_threads = 4;
+    threads_.workers = &pool_;
+    set_tensorflow_cpu_worker_threads(&threads_);
+  }
+
+ private:
+  thread::ThreadPool pool_;
+  CpuWorkerThreads threads_;
+};
+
+// Returns the input index held by every output index of "ranges", or -1 for
+// padding.
+std::vector<int64> ExpandRanges(const BlockCopyRanges& ranges) {
+  std::vector<int64> map;
+  for (const BlockCopyRange& r : ranges) {
+    for (int64 rep = 0; rep < r.repeat; ++rep) {
+      for (int64 i = 0; i < r.length; ++i) {
+        map.push_back(r.step == 0 ? -1 : r.input_begin + i * r.step);
+      }
+    }
+  }
+  return map;
+}
+
+// Computes the copy element by element.
+std::vector<int> NaiveCopy(const std::vector<int64>& input_dims,
+                           const std::vector<BlockCopyRanges>& ranges,
+                           const std::vector<int>& input, int pad_value) {
+  const int ndims = input_dims.size();
+  std::vector<std::vector<int64>> maps;
+  for (const BlockCopyRanges& r : ranges) maps.push_back(ExpandRanges(r));
+  int64 num_outputs = 1;
+  for (const auto& map : maps) num_outputs *= map.size();
+  std::vector<int> output(num_outputs);
+  for (int64 o = 0; o < num_outputs; ++o) {
+    int64 rest = o;
+    int64 input_index = 0;
+    int64 input_stride = 1;
+    bool pad = false;
+    for (int d = ndims - 1; d >= 0; --d) {
+      const int64 src = maps[d][rest % maps[d].size()];
+      rest /= maps[d].size();
+      if (src < 0) pad = true;
+      input_index += src * input_stride;
+      input_stride *= input_dims[d];
+    }
+    output[o] = pad ? pad_value : input[input_index];
+  }
+  return output;
+}
+
+void CheckCopy(const std::vector<int64>& input_dims,
+               const std::vector<BlockCopyRanges>& ranges) {
+  int64 num_inputs = 1;
+  for (int64 dim : input_dims) num_inputs *= dim;
+  std::vector<int> input(num_inputs);
+  for (int64 i = 0; i < num_inputs; ++i) input[i] = i;
+  const std::vector<int> expected = NaiveCopy(input_dims, ranges, input, -1);
+
+  TestDevice device;
+  BlockCopier<int> copier(input_dims, ranges);
+  std::vector<int> output(expected.size());
+  copier.Run(&device, input.data(), -1, output.data());
+  EXPECT_EQ(expected, output);
+}
+
+TEST(BlockCopierTest, Pad) {
+  CheckCopy({4, 5, 6, 3}, {PadRanges(4, 0, 0), PadRanges(5, 2, 1),
+                           PadRanges(6, 1, 3), PadRanges(3, 0, 0)});
+  CheckCopy({100}, {PadRanges(100, 7, 9)});
+  CheckCopy({0, 3}, {PadRanges(0, 1, 2), PadRanges(3, 0, 1)});
+}
+
+TEST(BlockCopierTest, MirrorPad) {
+  for (int offset = 0; offset < 2; ++offset) {
+    CheckCopy({3, 5, 7, 2}, {MirrorPadRanges(3, 1, 1, offset),
+                             MirrorPadRanges(5, 2, 1, offset),
+                             MirrorPadRanges(7, 3, 2, offset),
+                             MirrorPadRanges(2, 0, 0, offset)});
+    CheckCopy({40}, {MirrorPadRanges(40, 4, 5, offset)});
+  }
+}
+
+TEST(BlockCopierTest, Tile) {
+  CheckCopy({3, 4, 5},
+            {TileRanges(3, 2), TileRanges(4, 1), TileRanges(5, 3)});
+  CheckCopy({1, 8}, {TileRanges(1, 6), TileRanges(8, 1)});
+  CheckCopy({7, 1}, {TileRanges(7, 1), TileRanges(1, 9)});
+  CheckCopy({2, 3}, {TileRanges(2, 1), TileRanges(3, 1)});
+}
+
+TEST(BlockCopierTest, ShardsSingleDimension) {
+  // Only one dimension is not copied unchanged, and it is long enough for
+  // its indices to be split across threads.
+  CheckCopy({100000}, {PadRanges(100000, 3000, 5000)});
+  CheckCopy({100000}, {MirrorPadRanges(100000, 7000, 9000, 1)});
+  CheckCopy({30000, 4}, {TileRanges(30000, 3), TileRanges(4, 1)});
+  CheckCopy({30000, 4}, {PadRanges(30000, 100, 20000), TileRanges(4, 1)});
+}
+
+TEST(BlockCopierTest, Random) {
+  random::PhiloxRandom philox(7, 13);
+  random::SimplePhilox rnd(&philox);
+  for (int trial = 0; trial < 200; ++trial) {
+    const int ndims = 1 + rnd.Uniform(4);
+    std::vector<int64> input_dims(ndims);
+    std::vector<BlockCopyRanges> ranges(ndims);
+    for (int d = 0; d < ndims; ++d) {
+      const int64 size = 1 + rnd.Uniform(6);
+      input_dims[d] = size;
+      switch (rnd.Uniform(4)) {
+        case 0:
+          ranges[d] = PadRanges(size, rnd.Uniform(3), rnd.Uniform(3));
+          break;
+        case 1:
+          ranges[d] =
+              MirrorPadRanges(size, rnd.Uniform(size), rnd.Uniform(size), 1);
+          break;
+        case 2:
+          ranges[d] = TileRanges(size, rnd.Uniform(4));
+          break;
+        default:
+          ranges[d] = TileRanges(size, 1);
+      }
+    }
+    CheckCopy(input_dims, ranges);
+  }
+}
+
+TEST(BlockCopierTest, Efficient) {
+  // Padding NHWC images copies whole rows of pixels.
+  EXPECT_TRUE(BlockCopier<float>({8, 32, 32, 3},
+                                 {PadRanges(8, 0, 0), PadRanges(32, 2, 2),
+                                  PadRanges(32, 2, 2), PadRanges(3, 0, 0)})
+                  .efficient());
+  // Tiling single elements along the innermost dimension copies one element
+  // at a time.
+  EXPECT_FALSE(
+      BlockCopier<float>({1000, 1}, {TileRanges(1000, 1), TileRanges(1, 16)})
+          .efficient());
+}
+
+TEST(BlockCopierTest, HugeMultiple) {
+  // Setting up a copy costs the same for any multiple.  These outputs
+  // would need terabytes if anything were set up per output index.
+  const int64 kHuge = int64{1} << 40;
+  EXPECT_FALSE(BlockCopier<float>({1}, {TileRanges(1, kHuge)}).efficient());
+  EXPECT_TRUE(
+      BlockCopier<float>({1, 64}, {TileRanges(1, kHuge), TileRanges(64, 1)})
+          .efficient());
+  // A tiny input tiled many times along the outer dimension.
+  CheckCopy({1, 16}, {TileRanges(1, 100000), TileRanges(16, 1)});
+  CheckCopy({2, 3}, {TileRanges(2, 20000), TileRanges(3, 2)});
+}
+
+// Benchmarks of the ops that use BlockCopier on the CPU.
+
+static Graph* TileGraph(int batch, int depth, int batch_multiple,
+                        int depth_multiple) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({batch, depth}));
+  input.flat<float>().setRandom();
+  Tensor multiples(DT_INT32, TensorShape({2}));
+  multiples.flat<int32>()(0) = batch_multiple;
+  multiples.flat<int32>()(1) = depth_multiple;
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Tile")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, multiples))
+                  .Finalize(g, &node));
+  return g;
+}
+
+// Tiles a 256 x depth matrix 8 times along the outer dimension.
+static void BM_TileOuter(int iters, int depth) {
+  testing::BytesProcessed(static_cast<int64>(iters) * 8 * 256 * depth *
+                          sizeof(float));
+  test::Benchmark("cpu", TileGraph(256, depth, 8, 1)).Run(iters);
+}
+BENCHMARK(BM_TileOuter)->Arg(16)->Arg(128)->Arg(1024);
+
+// Tiles a 256 x depth matrix 8 times along the inner dimension.
+static void BM_TileInner(int iters, int depth) {
+  testing::BytesProcessed(static_cast<int64>(iters) * 8 * 256 * depth *
+                          sizeof(float));
+  test::Benchmark("cpu", TileGraph(256, depth, 1, 8)).Run(iters);
+}
+BENCHMARK(BM_TileInner)->Arg(16)->Arg(128)->Arg(1024);
+
+static Graph* PadGraph(const string& op, int size, int channels, int pad,
+                       const string& mode) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({8, size, size, channels}));
+  input.flat<float>().setRandom();
+  Tensor paddings(DT_INT32, TensorShape({4, 2}));
+  auto p = paddings.matrix<int32>();
+  p.setZero();
+  p(1, 0) = p(1, 1) = p(2, 0) = p(2, 1) = pad;
+  NodeBuilder builder(g->NewName("n"), op);
+  builder.Input(test::graph::Constant(g, input))
+      .Input(test::graph::Constant(g, paddings));
+  if (!mode.empty()) builder.Attr("mode", mode);
+  Node* node;
+  TF_CHECK_OK(builder.Finalize(g, &node));
+  return g;
+}
+
+// Pads the spatial dimensions of a batch of 8 NHWC images by 3 on each side.
+static void BM_PadSpatial(int iters, int size, int channels) {
+  const int out = size + 6;
+  testing::BytesProcessed(static_cast<int64>(iters) * 8 * out * out *
+                          channels * sizeof(float));
+  test::Benchmark("cpu", PadGraph("Pad", size, channels, 3, "")).Run(iters);
+}
+BENCHMARK(BM_PadSpatial)
+    ->ArgPair(32, 3)
+    ->ArgPair(32, 64)
+    ->ArgPair(128, 3)
+    ->ArgPair(128, 64);
+
+static void BM_MirrorPadSpatial(int iters, int size, int channels) {
+  const int out = size + 6;
+  testing::BytesProcessed(static_cast<int64>(iters) * 8 * out * out *
+                          channels * sizeof(float));
+  test::Benchmark("cpu", PadGraph("MirrorPad", size, channels, 3, "REFLECT"))
+      .Run(iters);
+}
+BENCHMARK(BM_MirrorPadSpatial)
+    ->ArgPair(32, 3)
+    ->ArgPair(32, 64)
+    ->ArgPair(128, 3)
+    ->ArgPair(128, 64);
+
+}  // namespace
+}  // namespace tensorflow
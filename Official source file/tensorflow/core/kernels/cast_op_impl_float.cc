@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/cast_op_impl.h"
 
+#include "tensorflow/core/framework/half.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -24,6 +25,17 @@ typedef Eigen::GpuDevice GPUDevice;
 
 std::function<void(OpKernelContext*, const Tensor&, Tensor*)>
 GetCpuCastFromFloat(DataType dst_dtype) {
+  if (dst_dtype == DT_HALF) {
+    return [](OpKernelContext* ctx, const Tensor& inp, Tensor* out) {
+      int64 N = out->NumElements();
+      auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+      auto work = [&inp, &out](int64 start, int64 end) {
+        FloatToHalf(inp.flat<float>().data() + start,
+                    out->flat<Eigen::half>().data() + start, end - start);
+      };
+      Shard(worker_threads->num_threads, worker_threads->workers, N, 4, work);
+    };
+  }
   CURRY_TYPES3(CAST_CASE, CPUDevice, float);
   if (dst_dtype == DT_BFLOAT16) {
     return [](OpKernelContext* ctx, const Tensor& inp, Tensor* out) {
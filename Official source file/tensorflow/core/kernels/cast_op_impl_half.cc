@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/cast_op_impl.h"
 
+#include "tensorflow/core/framework/half.h"
+#include "tensorflow/core/util/work_sharder.h"
+
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
@@ -22,6 +25,17 @@ typedef Eigen::GpuDevice GPUDevice;
 
 std::function<void(OpKernelContext*, const Tensor&, Tensor*)>
 GetCpuCastFromHalf(DataType dst_dtype) {
+  if (dst_dtype == DT_FLOAT) {
+    return [](OpKernelContext* ctx, const Tensor& inp, Tensor* out) {
+      int64 N = out->NumElements();
+      auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+      auto work = [&inp, &out](int64 start, int64 end) {
+        HalfToFloat(inp.flat<Eigen::half>().data() + start,
+                    out->flat<float>().data() + start, end - start);
+      };
+      Shard(worker_threads->num_threads, worker_threads->workers, N, 4, work);
+    };
+  }
   CURRY_TYPES3(CAST_CASE, CPUDevice, Eigen::half);
   return nullptr;
 }
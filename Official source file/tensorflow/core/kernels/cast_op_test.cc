@@ -88,6 +88,32 @@ TEST_ALL_CASTS_FROM(double)
 #undef TEST_ALL_CASTS_FROM
 #undef TEST_CAST
 
+// Large enough to be split over several threads, with a size that leaves a
+// tail after the vectorized loops.
+TEST_F(CastOpTest, FloatToHalfLarge) {
+  const int N = 10001;
+  MakeOp(DT_FLOAT, DT_HALF);
+  AddInput<float>(TensorShape({N}), [](int i) { return i * 0.37f - 100; });
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_HALF, TensorShape({N}));
+  for (int i = 0; i < N; ++i) {
+    expected.flat<half>()(i) = half(i * 0.37f - 100);
+  }
+  test::ExpectTensorEqual<half>(expected, *GetOutput(0));
+}
+
+TEST_F(CastOpTest, HalfToFloatLarge) {
+  const int N = 10001;
+  MakeOp(DT_HALF, DT_FLOAT);
+  AddInput<half>(TensorShape({N}), [](int i) { return half(i * 0.37f - 100); });
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({N}));
+  for (int i = 0; i < N; ++i) {
+    expected.flat<float>()(i) = static_cast<float>(half(i * 0.37f - 100));
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
 // TODO(wicke): check conversions from/to bool, and bfloat16
 
 static void BM_cpu_float_int64(int iters, int num) {
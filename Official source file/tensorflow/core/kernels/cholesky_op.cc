@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/linalg_ops_common.h"
+#include "tensorflow/core/kernels/small_matrix_linalg_cpu.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -36,10 +37,13 @@ class CholeskyOp : public LinearAlgebraOp<Scalar> {
 
   explicit CholeskyOp(OpKernelConstruction* context) : Base(context) {}
 
+  using TensorShapes = typename Base::TensorShapes;
   using Matrix = typename Base::Matrix;
   using MatrixMaps = typename Base::MatrixMaps;
   using ConstMatrixMap = typename Base::ConstMatrixMap;
   using ConstMatrixMaps = typename Base::ConstMatrixMaps;
+  using ConstScalarPtrs = typename Base::ConstScalarPtrs;
+  using ScalarPtrs = typename Base::ScalarPtrs;
 
   void ComputeMatrix(OpKernelContext* context, const ConstMatrixMaps& inputs,
                      MatrixMaps* outputs) final {
@@ -63,6 +67,23 @@ class CholeskyOp : public LinearAlgebraOp<Scalar> {
                 errors::InvalidArgument("LLT decomposition was not successful. "
                                         "The input might not be valid."));
   }
+
+  bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const final {
+    return IsSmallMatrixSize(input_matrix_shapes[0].dim_size(0));
+  }
+
+  void ComputeMatrixBatch(OpKernelContext* context, int64 num_matrices,
+                          const TensorShapes& input_matrix_shapes,
+                          const ConstScalarPtrs& inputs,
+                          const ScalarPtrs& outputs) final {
+    const bool success =
+        SmallMatrixCholeskys(input_matrix_shapes[0].dim_size(0), num_matrices,
+                             inputs[0], outputs[0]);
+    OP_REQUIRES(context, success,
+                errors::InvalidArgument("LLT decomposition was not successful. "
+                                        "The input might not be valid."));
+  }
 };
 
 REGISTER_LINALG_OP("Cholesky", (CholeskyOp<float>), float);
@@ -22,6 +22,28 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Copying between one wide matrix and the narrow matrices ("pieces") whose
+// concatenation along dimension 1 it is, for types that can be copied with
+// memcpy.  The wide matrix has "num_rows" rows, and piece i has rows of
+// piece_bytes[i] bytes starting at pieces[i].
+//
+// Rows are copied in blocks that fit in the L1 cache, one piece at a time
+// within a block with a copy specialized for the common piece widths, and
+// blocks are sharded over the device's worker threads.  This avoids the
+// per-row, per-piece overhead of ConcatCPUImpl when the pieces are narrow.
+
+// Returns true if ConcatRowsCPU and SplitRowsCPU are expected to be faster
+// than copying each row one piece at a time.
+bool UseBlockedRowCopy(int64 num_rows, int64 row_bytes, int64 num_pieces);
+
+void ConcatRowsCPU(DeviceBase* d, int64 num_rows,
+                   const std::vector<const char*>& pieces,
+                   const std::vector<int64>& piece_bytes, char* output);
+
+void SplitRowsCPU(DeviceBase* d, int64 num_rows, const char* input,
+                  const std::vector<char*>& pieces,
+                  const std::vector<int64>& piece_bytes);
+
 // ElementCopier must be a struct with a single Copy function, which is passed
 // the output pointer, input pointer, input index, and number of elements to
 // copy from input to output.
@@ -126,6 +126,48 @@ static void BM_ConcatManyDim1bfloat16(int iters, int dim2) {
 
 BENCHMARK(BM_ConcatManyDim1bfloat16)->Arg(18)->Arg(34)->Arg(60);
 
+// Concatenates "num_inputs" inputs of kDim1 x dim2 floats along dimension 1,
+// like the assembly of many narrow features into one batch of examples.
+static void BM_ConcatNarrowDim1Float(int iters, int num_inputs, int dim2) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  const int kDim1 = 1024;
+  Tensor concat_dim(DT_INT32, TensorShape({}));
+  concat_dim.scalar<int32>()() = 1;
+  std::vector<NodeBuilder::NodeOut> inputs;
+  inputs.reserve(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    Tensor in(DT_FLOAT, TensorShape({kDim1, dim2}));
+    in.flat<float>().setRandom();
+    inputs.push_back(test::graph::Constant(g, in));
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Concat")
+                  .Input(test::graph::Constant(g, concat_dim))
+                  .Input(inputs)
+                  .Attr("N", num_inputs)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+  testing::BytesProcessed(static_cast<int64>(iters) * kDim1 * dim2 *
+                          num_inputs * sizeof(float));
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+  testing::UseRealTime();
+}
+
+BENCHMARK(BM_ConcatNarrowDim1Float)
+    ->ArgPair(16, 1)
+    ->ArgPair(16, 4)
+    ->ArgPair(16, 32)
+    ->ArgPair(64, 1)
+    ->ArgPair(64, 4)
+    ->ArgPair(64, 32)
+    ->ArgPair(256, 1)
+    ->ArgPair(256, 4)
+    ->ArgPair(256, 32);
+
 static void MemcpyAlternativeHelper(int iters, int concat_dimension, int dim2) {
   testing::StopTiming();
 
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/conv_ops.h"
 #include <string.h>
+#include <algorithm>
 #include <map>
 #include <vector>
 #include "tensorflow/core/framework/numeric_op.h"
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/conv_2d.h"
 #include "tensorflow/core/kernels/deep_conv2d.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/kernels/reduced_precision_gemm_cpu.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -105,6 +107,70 @@ class LaunchConv2DOp<CPUDevice, T> {
   }
 };
 
+// Half and bfloat16 convolutions are computed as a float GEMM of the image
+// patches with the filter.  The patches and the filter are converted to float
+// a block at a time inside the GEMM, and products are accumulated in float.
+template <typename T>
+class LaunchReducedPrecisionConv2D {
+ public:
+  void launch(OpKernelContext* ctx, bool use_cudnn, bool cudnn_use_autotune,
+              const Tensor& input, const Tensor& filter, int row_stride,
+              int col_stride, const Eigen::PaddingType& padding, Tensor* output,
+              TensorFormat data_format) {
+    CHECK(data_format == FORMAT_NHWC) << "Generic conv implementation only "
+                                         "supports NHWC tensor format for now.";
+    typename ReducedPrecisionConv2DPatchPacker<T>::Geometry geometry;
+    geometry.in_rows = input.dim_size(1);
+    geometry.in_cols = input.dim_size(2);
+    geometry.in_depth = input.dim_size(3);
+    geometry.filter_rows = filter.dim_size(0);
+    geometry.filter_cols = filter.dim_size(1);
+    geometry.stride_rows = row_stride;
+    geometry.stride_cols = col_stride;
+    geometry.out_rows = output->dim_size(1);
+    geometry.out_cols = output->dim_size(2);
+    // Matches GetWindowedOutputSize: SAME padding puts the smaller half of
+    // the padding before the image.
+    geometry.pad_rows = 0;
+    geometry.pad_cols = 0;
+    if (padding == Eigen::PADDING_SAME) {
+      geometry.pad_rows =
+          std::max<int64>(0, (geometry.out_rows - 1) * row_stride +
+                                 geometry.filter_rows - geometry.in_rows) /
+          2;
+      geometry.pad_cols =
+          std::max<int64>(0, (geometry.out_cols - 1) * col_stride +
+                                 geometry.filter_cols - geometry.in_cols) /
+          2;
+    }
+
+    const int64 depth =
+        geometry.filter_rows * geometry.filter_cols * geometry.in_depth;
+    T* out = output->template flat<T>().data();
+    if (depth == 0) {
+      // Zero is all zero bits in both types.
+      memset(out, 0, output->NumElements() * sizeof(T));
+      return;
+    }
+    ReducedPrecisionConv2DPatchPacker<T> patches(
+        input.template flat<T>().data(), geometry);
+    ReducedPrecisionMatrixPacker<T> filter_matrix(
+        filter.template flat<T>().data(), depth, filter.dim_size(3), false);
+    ReducedPrecisionGemm(
+        ctx->device(),
+        input.dim_size(0) * geometry.out_rows * geometry.out_cols,
+        filter.dim_size(3), depth, patches, filter_matrix, out);
+  }
+};
+
+template <>
+class LaunchConv2DOp<CPUDevice, Eigen::half>
+    : public LaunchReducedPrecisionConv2D<Eigen::half> {};
+
+template <>
+class LaunchConv2DOp<CPUDevice, bfloat16>
+    : public LaunchReducedPrecisionConv2D<bfloat16> {};
+
 template <typename Device, typename T>
 class LaunchDeepConvOp {
  public:
@@ -307,6 +373,7 @@ class Conv2DOp : public BinaryOp<T> {
 // CPU implementation, don't register this EigenTensor-based version.
 #if !defined(USE_GEMM_FOR_CONV)
 TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
 TF_CALL_float(REGISTER_CPU);
 #endif  // USE_GEMM_FOR_CONV
 
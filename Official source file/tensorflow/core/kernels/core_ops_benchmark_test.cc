@@ -0,0 +1,359 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Regression-tracking benchmarks for the hot CPU kernels.
+//
+// Unlike the per-op benchmarks in the individual *_test.cc files, the shapes
+// here are fixed, production-representative and must not be changed once
+// checked in: results are compared across builds with
+// //tensorflow/tools/test:compare_benchmarks, and a changed shape silently
+// invalidates every historical datapoint.  Add a new benchmark instead.
+//
+// Every benchmark reports ItemsProcessed (flops or elements) and
+// BytesProcessed, which end up as "items_per_second" / "bytes_per_second" in
+// the BenchmarkEntry extras when run under run_and_gather_logs.
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor RandomFloats(const TensorShape& shape) {
+  Tensor t(DT_FLOAT, shape);
+  t.flat<float>().setRandom();
+  return t;
+}
+
+Node* RandomConstant(Graph* g, const TensorShape& shape) {
+  return test::graph::Constant(g, RandomFloats(shape));
+}
+
+Node* Int32Vector(Graph* g, const std::vector<int32>& values) {
+  Tensor t(DT_INT32, TensorShape({static_cast<int64>(values.size())}));
+  for (size_t i = 0; i < values.size(); ++i) {
+    t.vec<int32>()(i) = values[i];
+  }
+  return test::graph::Constant(g, t);
+}
+
+void RunCpu(int iters, Graph* g, int64 items_per_iter, int64 bytes_per_iter) {
+  testing::UseRealTime();
+  testing::ItemsProcessed(static_cast<int64>(iters) * items_per_iter);
+  testing::BytesProcessed(static_cast<int64>(iters) * bytes_per_iter);
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+// ----------------------------------------------------------------------------
+// MatMul: items are flops.
+
+void MatMulHelper(int iters, int m, int k, int n) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(g, RandomConstant(g, TensorShape({m, k})),
+                      RandomConstant(g, TensorShape({k, n})), false, false);
+  RunCpu(iters, g, 2LL * m * k * n,
+         sizeof(float) * (static_cast<int64>(m) * k + k * n + m * n));
+}
+
+#define BM_CORE_MATMUL(M, K, N)                                 \
+  void BM_Core_MatMul_##M##_##K##_##N(int iters) {              \
+    MatMulHelper(iters, M, K, N);                               \
+  }                                                             \
+  BENCHMARK(BM_Core_MatMul_##M##_##K##_##N)
+
+BM_CORE_MATMUL(1, 1024, 1024);     // Single-example inference.
+BM_CORE_MATMUL(128, 1024, 4096);   // Fully-connected layer, training batch.
+BM_CORE_MATMUL(1024, 1024, 1024);  // Square, compute bound.
+BM_CORE_MATMUL(4096, 512, 128);    // Tall-skinny projection.
+
+// ----------------------------------------------------------------------------
+// Conv2D (NHWC, SAME, stride 1): items are flops.
+
+void Conv2DHelper(int iters, int batch, int rows, int cols, int in_depth,
+                  int filter_size, int out_depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Conv2D(
+      g, RandomConstant(g, TensorShape({batch, rows, cols, in_depth})),
+      RandomConstant(g,
+                     TensorShape({filter_size, filter_size, in_depth,
+                                  out_depth})));
+  const int64 output_elements =
+      static_cast<int64>(batch) * rows * cols * out_depth;
+  RunCpu(iters, g,
+         2 * output_elements * filter_size * filter_size * in_depth,
+         sizeof(float) *
+             (static_cast<int64>(batch) * rows * cols * in_depth +
+              filter_size * filter_size * in_depth * out_depth +
+              output_elements));
+}
+
+#define BM_CORE_CONV2D(B, R, C, ID, FS, OD)                                \
+  void BM_Core_Conv2D_##B##_##R##_##C##_##ID##_##FS##_##OD(int iters) {    \
+    Conv2DHelper(iters, B, R, C, ID, FS, OD);                              \
+  }                                                                        \
+  BENCHMARK(BM_Core_Conv2D_##B##_##R##_##C##_##ID##_##FS##_##OD)
+
+BM_CORE_CONV2D(32, 56, 56, 64, 3, 64);    // ResNet conv2_x.
+BM_CORE_CONV2D(32, 28, 28, 128, 3, 128);  // ResNet conv3_x.
+BM_CORE_CONV2D(32, 14, 14, 256, 1, 1024);  // ResNet bottleneck expand.
+BM_CORE_CONV2D(1, 224, 224, 3, 7, 64);    // First layer, inference.
+
+// ----------------------------------------------------------------------------
+// Coefficient-wise ops: items are output elements.
+
+void UnaryHelper(int iters, const string& op, int n) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, op, RandomConstant(g, TensorShape({n})));
+  RunCpu(iters, g, n, 2LL * n * sizeof(float));
+}
+
+void BiasAddHelper(int iters, int rows, int cols) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Binary(g, "Add", RandomConstant(g, TensorShape({rows, cols})),
+                      RandomConstant(g, TensorShape({cols})));
+  const int64 n = static_cast<int64>(rows) * cols;
+  RunCpu(iters, g, n, (2 * n + cols) * sizeof(float));
+}
+
+void BinaryHelper(int iters, const string& op, int n) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Binary(g, op, RandomConstant(g, TensorShape({n})),
+                      RandomConstant(g, TensorShape({n})));
+  RunCpu(iters, g, n, 3LL * n * sizeof(float));
+}
+
+void BM_Core_Cwise_Add_1M(int iters) { BinaryHelper(iters, "Add", 1 << 20); }
+void BM_Core_Cwise_Mul_1M(int iters) { BinaryHelper(iters, "Mul", 1 << 20); }
+void BM_Core_Cwise_Tanh_1M(int iters) { UnaryHelper(iters, "Tanh", 1 << 20); }
+void BM_Core_Cwise_Sigmoid_1M(int iters) {
+  UnaryHelper(iters, "Sigmoid", 1 << 20);
+}
+void BM_Core_Cwise_Relu_1M(int iters) { UnaryHelper(iters, "Relu", 1 << 20); }
+void BM_Core_Cwise_BroadcastAdd_512_4096(int iters) {
+  BiasAddHelper(iters, 512, 4096);
+}
+BENCHMARK(BM_Core_Cwise_Add_1M);
+BENCHMARK(BM_Core_Cwise_Mul_1M);
+BENCHMARK(BM_Core_Cwise_Tanh_1M);
+BENCHMARK(BM_Core_Cwise_Sigmoid_1M);
+BENCHMARK(BM_Core_Cwise_Relu_1M);
+BENCHMARK(BM_Core_Cwise_BroadcastAdd_512_4096);
+
+// ----------------------------------------------------------------------------
+// Reductions: items are input elements.
+
+void ReduceHelper(int iters, const string& op, int rows, int cols, int axis) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Reduce(g, op, RandomConstant(g, TensorShape({rows, cols})),
+                      Int32Vector(g, {axis}), false);
+  const int64 n = static_cast<int64>(rows) * cols;
+  RunCpu(iters, g, n, n * sizeof(float));
+}
+
+#define BM_CORE_REDUCE(OP, R, C, AXIS)                          \
+  void BM_Core_Reduce_##OP##_##R##_##C##_##AXIS(int iters) {    \
+    ReduceHelper(iters, #OP, R, C, AXIS);                       \
+  }                                                             \
+  BENCHMARK(BM_Core_Reduce_##OP##_##R##_##C##_##AXIS)
+
+BM_CORE_REDUCE(Sum, 1024, 4096, 0);
+BM_CORE_REDUCE(Sum, 1024, 4096, 1);
+BM_CORE_REDUCE(Max, 1024, 4096, 1);
+BM_CORE_REDUCE(Mean, 4096, 128, 1);
+BM_CORE_REDUCE(Sum, 1, 1048576, 1);
+
+// ----------------------------------------------------------------------------
+// Gather: embedding lookup; items are gathered elements.
+
+void GatherHelper(int iters, int vocab, int dim, int num_indices) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int i = 0; i < num_indices; ++i) {
+    indices.vec<int32>()(i) = rnd.Uniform(vocab);
+  }
+  test::graph::Gather(g, RandomConstant(g, TensorShape({vocab, dim})),
+                      test::graph::Constant(g, indices));
+  const int64 n = static_cast<int64>(num_indices) * dim;
+  RunCpu(iters, g, n, 2 * n * sizeof(float) + num_indices * sizeof(int32));
+}
+
+void BM_Core_Gather_100000_64_4096(int iters) {
+  GatherHelper(iters, 100000, 64, 4096);
+}
+void BM_Core_Gather_1000000_256_512(int iters) {
+  GatherHelper(iters, 1000000, 256, 512);
+}
+BENCHMARK(BM_Core_Gather_100000_64_4096);
+BENCHMARK(BM_Core_Gather_1000000_256_512);
+
+// ----------------------------------------------------------------------------
+// Concat: items are output elements.
+
+void ConcatHelper(int iters, int num_inputs, int rows, int cols_per_input,
+                  int concat_dim) {
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<Node*> inputs;
+  for (int i = 0; i < num_inputs; ++i) {
+    inputs.push_back(RandomConstant(g, TensorShape({rows, cols_per_input})));
+  }
+  Tensor dim(DT_INT32, TensorShape({}));
+  dim.scalar<int32>()() = concat_dim;
+  test::graph::Concat(g, test::graph::Constant(g, dim), inputs);
+  const int64 n = static_cast<int64>(num_inputs) * rows * cols_per_input;
+  RunCpu(iters, g, n, 2 * n * sizeof(float));
+}
+
+void BM_Core_Concat_Dim0_4x1024x1024(int iters) {
+  ConcatHelper(iters, 4, 1024, 1024, 0);
+}
+void BM_Core_Concat_Dim1_4x1024x1024(int iters) {
+  ConcatHelper(iters, 4, 1024, 1024, 1);
+}
+void BM_Core_Concat_Dim1_200x1024x8(int iters) {
+  ConcatHelper(iters, 200, 1024, 8, 1);
+}
+BENCHMARK(BM_Core_Concat_Dim0_4x1024x1024);
+BENCHMARK(BM_Core_Concat_Dim1_4x1024x1024);
+BENCHMARK(BM_Core_Concat_Dim1_200x1024x8);
+
+// ----------------------------------------------------------------------------
+// Transpose: items are elements.
+
+void TransposeHelper(int iters, const TensorShape& shape,
+                     const std::vector<int32>& perm) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Transpose")
+                  .Input(RandomConstant(g, shape))
+                  .Input(Int32Vector(g, perm))
+                  .Finalize(g, &ret));
+  RunCpu(iters, g, shape.num_elements(),
+         2 * shape.num_elements() * sizeof(float));
+}
+
+void BM_Core_Transpose_NHWC_to_NCHW(int iters) {
+  TransposeHelper(iters, TensorShape({32, 56, 56, 64}), {0, 3, 1, 2});
+}
+void BM_Core_Transpose_2D_4096_1024(int iters) {
+  TransposeHelper(iters, TensorShape({4096, 1024}), {1, 0});
+}
+BENCHMARK(BM_Core_Transpose_NHWC_to_NCHW);
+BENCHMARK(BM_Core_Transpose_2D_4096_1024);
+
+// ----------------------------------------------------------------------------
+// Softmax: items are logits.
+
+void SoftmaxHelper(int iters, int batch, int classes) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Softmax")
+                  .Input(RandomConstant(g, TensorShape({batch, classes})))
+                  .Finalize(g, &ret));
+  const int64 n = static_cast<int64>(batch) * classes;
+  RunCpu(iters, g, n, 2 * n * sizeof(float));
+}
+
+void BM_Core_Softmax_128_10000(int iters) {
+  SoftmaxHelper(iters, 128, 10000);
+}
+void BM_Core_Softmax_32_100000(int iters) {
+  SoftmaxHelper(iters, 32, 100000);
+}
+BENCHMARK(BM_Core_Softmax_128_10000);
+BENCHMARK(BM_Core_Softmax_32_100000);
+
+// ----------------------------------------------------------------------------
+// ParseExample with dense float features: items are parsed values.
+
+Tensor SerializedFloatExamples(int batch_size, int num_keys,
+                               int values_per_key) {
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  for (int k = 0; k < num_keys; ++k) {
+    Feature& f = features[strings::Printf("feature_%d", k)];
+    for (int v = 0; v < values_per_key; ++v) {
+      f.mutable_float_list()->add_value(1.729f * v);
+    }
+  }
+  string serialized;
+  CHECK(example.SerializeToString(&serialized));
+  Tensor t(DT_STRING, TensorShape({batch_size}));
+  for (int b = 0; b < batch_size; ++b) {
+    t.vec<string>()(b) = serialized;
+  }
+  return t;
+}
+
+void ParseExampleHelper(int iters, int batch_size, int num_keys,
+                        int values_per_key) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor serialized =
+      SerializedFloatExamples(batch_size, num_keys, values_per_key);
+  Tensor names(DT_STRING, TensorShape({batch_size}));
+  std::vector<NodeBuilder::NodeOut> sparse_keys;
+  std::vector<NodeBuilder::NodeOut> dense_keys;
+  std::vector<NodeBuilder::NodeOut> dense_defaults;
+  std::vector<TensorShape> dense_shapes;
+  for (int k = 0; k < num_keys; ++k) {
+    Tensor key(DT_STRING, TensorShape({}));
+    key.scalar<string>()() = strings::Printf("feature_%d", k);
+    dense_keys.emplace_back(test::graph::Constant(g, key));
+    dense_defaults.emplace_back(
+        test::graph::Constant(g, Tensor(DT_FLOAT, TensorShape({0}))));
+    dense_shapes.push_back(TensorShape({values_per_key}));
+  }
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "ParseExample")
+                  .Input(test::graph::Constant(g, serialized))
+                  .Input(test::graph::Constant(g, names))
+                  .Input(sparse_keys)
+                  .Input(dense_keys)
+                  .Input(dense_defaults)
+                  .Attr("sparse_types", DataTypeVector())
+                  .Attr("dense_shapes", dense_shapes)
+                  .Finalize(g, &ret));
+  int64 bytes = 0;
+  for (int b = 0; b < batch_size; ++b) {
+    bytes += serialized.vec<string>()(b).size();
+  }
+  RunCpu(iters, g, static_cast<int64>(batch_size) * num_keys * values_per_key,
+         bytes);
+}
+
+void BM_Core_ParseExample_128_100_1(int iters) {
+  ParseExampleHelper(iters, 128, 100, 1);
+}
+void BM_Core_ParseExample_512_10_64(int iters) {
+  ParseExampleHelper(iters, 512, 10, 64);
+}
+BENCHMARK(BM_Core_ParseExample_128_100_1);
+BENCHMARK(BM_Core_ParseExample_512_10_64);
+
+}  // namespace
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/linalg_ops_common.h"
+#include "tensorflow/core/kernels/small_matrix_linalg_cpu.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -37,6 +38,8 @@ class DeterminantOp : public LinearAlgebraOp<Scalar> {
   using TensorShapes = typename Base::TensorShapes;
   using MatrixMaps = typename Base::MatrixMaps;
   using ConstMatrixMaps = typename Base::ConstMatrixMaps;
+  using ConstScalarPtrs = typename Base::ConstScalarPtrs;
+  using ScalarPtrs = typename Base::ScalarPtrs;
 
   TensorShapes GetOutputMatrixShapes(
       const TensorShapes& input_matrix_shape) const final {
@@ -58,6 +61,25 @@ class DeterminantOp : public LinearAlgebraOp<Scalar> {
                 errors::InvalidArgument("The determinant is not finite."));
     outputs->at(0)(0, 0) = determinant;
   }
+
+  bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const final {
+    return IsSmallMatrixSize(input_matrix_shapes[0].dim_size(0));
+  }
+
+  void ComputeMatrixBatch(OpKernelContext* context, int64 num_matrices,
+                          const TensorShapes& input_matrix_shapes,
+                          const ConstScalarPtrs& inputs,
+                          const ScalarPtrs& outputs) final {
+    SmallMatrixDeterminants(input_matrix_shapes[0].dim_size(0), num_matrices,
+                            inputs[0], outputs[0]);
+    bool finite = true;
+    for (int64 i = 0; i < num_matrices; ++i) {
+      finite &= Eigen::numext::isfinite(outputs[0][i]);
+    }
+    OP_REQUIRES(context, finite,
+                errors::InvalidArgument("The determinant is not finite."));
+  }
 };
 
 REGISTER_LINALG_OP("MatrixDeterminant", (DeterminantOp<float>), float);
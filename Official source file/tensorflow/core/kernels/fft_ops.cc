@@ -17,16 +17,360 @@ limitations under the License.
 
 // See docs in ../ops/fft_ops.cc.
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/fft_ops_plan.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/work_sharder.h"
 
+namespace tensorflow {
+
+namespace {
+
+typedef gtl::InlinedVector<int64, 4> FFTDims;
+
+// Returns the product of dims[begin, end).
+int64 Product(const FFTDims& dims, int begin, int end) {
+  int64 product = 1;
+  for (int i = begin; i < end; ++i) product *= dims[i];
+  return product;
+}
+
+// Splits "shape" into the product of its outer dimensions and its "rank"
+// inner-most dimensions.
+void SplitShape(const TensorShape& shape, int rank, int64* batch,
+                FFTDims* dims) {
+  *batch = 1;
+  for (int i = 0; i < shape.dims() - rank; ++i) *batch *= shape.dim_size(i);
+  dims->clear();
+  for (int i = shape.dims() - rank; i < shape.dims(); ++i) {
+    dims->push_back(shape.dim_size(i));
+  }
+}
+
+// Copies "src", a row-major array of shape [batch] + src_dims, to "dst" of
+// shape [batch] + dst_dims, cropping or zero-padding each inner dimension.
+template <typename T>
+void CopyPadded(int64 batch, const FFTDims& src_dims, const T* src,
+                const FFTDims& dst_dims, T* dst) {
+  const int rank = dst_dims.size();
+  const int64 src_row = src_dims[rank - 1];
+  const int64 dst_row = dst_dims[rank - 1];
+  const int64 copy = std::min(src_row, dst_row);
+  const int64 src_size = Product(src_dims, 0, rank);
+  const int64 dst_rows = Product(dst_dims, 0, rank - 1);
+  for (int64 b = 0; b < batch; ++b) {
+    for (int64 r = 0; r < dst_rows; ++r) {
+      T* out = dst + (b * dst_rows + r) * dst_row;
+      int64 remaining = r;
+      int64 src_offset = 0;
+      int64 src_stride = src_row;
+      bool inside = true;
+      for (int d = rank - 2; d >= 0; --d) {
+        const int64 index = remaining % dst_dims[d];
+        remaining /= dst_dims[d];
+        if (index >= src_dims[d]) {
+          inside = false;
+          break;
+        }
+        src_offset += index * src_stride;
+        src_stride *= src_dims[d];
+      }
+      if (inside) {
+        std::copy_n(src + b * src_size + src_offset, copy, out);
+        std::fill(out + copy, out + dst_row, T(0));
+      } else {
+        std::fill(out, out + dst_row, T(0));
+      }
+    }
+  }
+}
+
+// Transforms every line along the middle dimension of "src", viewed as a
+// row-major [outer, plan.size(), inner] array, and writes the results times
+// "scale" to the same positions of "dst". "src" may equal "dst". Lines are
+// sharded across the intra-op thread pool.
+void TransformLines(OpKernelContext* ctx, const FFTPlan& plan, bool forward,
+                    int64 outer, int64 inner, float scale,
+                    const complex64* src, complex64* dst) {
+  const int64 n = plan.size();
+  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, outer * inner,
+        plan.cost() + 4 * n,
+        [&plan, forward, n, inner, scale, src, dst](int64 start, int64 limit) {
+          std::vector<complex64> line(n);
+          std::vector<complex64> scratch(plan.scratch_size());
+          for (int64 l = start; l < limit; ++l) {
+            const int64 offset = (l / inner) * n * inner + l % inner;
+            for (int64 k = 0; k < n; ++k) line[k] = src[offset + k * inner];
+            if (forward) {
+              plan.Forward(line.data(), scratch.data());
+            } else {
+              plan.Inverse(line.data(), scratch.data());
+            }
+            for (int64 k = 0; k < n; ++k) {
+              dst[offset + k * inner] = line[k] * scale;
+            }
+          }
+        });
+}
+
+// Transforms "src", a row-major array of shape [batch] + dims, along each of
+// the first "num_axes" > 0 dimensions of "dims" and writes the result times
+// "scale" to "dst". "src" may equal "dst".
+void TransformAxes(OpKernelContext* ctx, bool forward, int64 batch,
+                   const FFTDims& dims, int num_axes, float scale,
+                   const complex64* src, complex64* dst) {
+  for (int axis = 0; axis < num_axes; ++axis) {
+    const int64 outer = batch * Product(dims, 0, axis);
+    const int64 inner = Product(dims, axis + 1, dims.size());
+    TransformLines(ctx, *FFTPlan::Get(dims[axis]), forward, outer, inner,
+                   axis == num_axes - 1 ? scale : 1.0f, axis == 0 ? src : dst,
+                   dst);
+  }
+}
+
+// Computes the DFTs of "rows" real rows of length plan.size() and writes the
+// plan.size() / 2 + 1 non-redundant coefficients of each to "spectrum".
+// Rows are transformed in pairs, as the real and imaginary parts of one
+// complex row, and the two spectra are separated using their conjugate
+// symmetry.
+void RealRowsToSpectrum(OpKernelContext* ctx, const FFTPlan& plan,
+                        int64 rows, const float* real, complex64* spectrum) {
+  const int64 n = plan.size();
+  const int64 half = n / 2 + 1;
+  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, (rows + 1) / 2,
+        plan.cost() + 8 * n,
+        [&plan, n, half, rows, real, spectrum](int64 start, int64 limit) {
+          std::vector<complex64> line(n);
+          std::vector<complex64> scratch(plan.scratch_size());
+          for (int64 pair = start; pair < limit; ++pair) {
+            const int64 row = 2 * pair;
+            const bool has_second = row + 1 < rows;
+            const float* x0 = real + row * n;
+            const float* x1 = x0 + n;
+            for (int64 j = 0; j < n; ++j) {
+              line[j] = complex64(x0[j], has_second ? x1[j] : 0.0f);
+            }
+            plan.Forward(line.data(), scratch.data());
+            complex64* y0 = spectrum + row * half;
+            complex64* y1 = y0 + half;
+            for (int64 k = 0; k < half; ++k) {
+              const complex64 z = line[k];
+              const complex64 z_mirror = std::conj(line[k == 0 ? 0 : n - k]);
+              y0[k] = (z + z_mirror) * 0.5f;
+              if (has_second) {
+                // (z - z_mirror) / 2i
+                const complex64 d = (z - z_mirror) * 0.5f;
+                y1[k] = complex64(d.imag(), -d.real());
+              }
+            }
+          }
+        });
+}
+
+// The inverse of RealRowsToSpectrum: rebuilds each row's full conjugate
+// symmetric spectrum from its plan.size() / 2 + 1 coefficients in
+// "spectrum" and writes its inverse DFT times "scale" to "real". Like numpy,
+// ignores the imaginary parts of the DC and Nyquist coefficients.
+void SpectrumToRealRows(OpKernelContext* ctx, const FFTPlan& plan, int64 rows,
+                        float scale, const complex64* spectrum, float* real) {
+  const int64 n = plan.size();
+  const int64 half = n / 2 + 1;
+  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, (rows + 1) / 2,
+        plan.cost() + 8 * n, [&plan, n, half, rows, scale, spectrum, real](
+                                 int64 start, int64 limit) {
+          std::vector<complex64> line(n);
+          std::vector<complex64> scratch(plan.scratch_size());
+          for (int64 pair = start; pair < limit; ++pair) {
+            const int64 row = 2 * pair;
+            const bool has_second = row + 1 < rows;
+            const complex64* y0 = spectrum + row * half;
+            const complex64* y1 = y0 + half;
+            for (int64 k = 0; k < n; ++k) {
+              complex64 a, b;
+              if (k < half) {
+                a = y0[k];
+                if (has_second) b = y1[k];
+              } else {
+                a = std::conj(y0[n - k]);
+                if (has_second) b = std::conj(y1[n - k]);
+              }
+              if (k == 0 || 2 * k == n) {
+                a = complex64(a.real(), 0.0f);
+                b = complex64(b.real(), 0.0f);
+              }
+              // a + i * b
+              line[k] = complex64(a.real() - b.imag(), a.imag() + b.real());
+            }
+            plan.Inverse(line.data(), scratch.data());
+            float* x0 = real + row * n;
+            float* x1 = x0 + n;
+            for (int64 j = 0; j < n; ++j) {
+              x0[j] = line[j].real() * scale;
+              if (has_second) x1[j] = line[j].imag() * scale;
+            }
+          }
+        });
+}
+
+}  // namespace
+
+template <bool Forward, int FFTRank>
+class FFTCPU : public OpKernel {
+ public:
+  static_assert(FFTRank >= 1 && FFTRank <= 3,
+                "Only 1D, 2D and 3D FFTs supported.");
+  explicit FFTCPU(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& in = ctx->input(0);
+    const TensorShape& shape = in.shape();
+    OP_REQUIRES(
+        ctx, shape.dims() >= FFTRank,
+        errors::InvalidArgument("Input must have rank of at least ", FFTRank,
+                                " but got: ", shape.DebugString()));
+    Tensor* out;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, shape, &out));
+    if (shape.num_elements() == 0) {
+      return;
+    }
+    int64 batch;
+    FFTDims dims;
+    SplitShape(shape, FFTRank, &batch, &dims);
+    const float scale = Forward ? 1.0f : 1.0f / Product(dims, 0, FFTRank);
+    TransformAxes(ctx, Forward, batch, dims, FFTRank, scale,
+                  in.flat<complex64>().data(), out->flat<complex64>().data());
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("FFT").Device(DEVICE_CPU), FFTCPU<true, 1>);
+REGISTER_KERNEL_BUILDER(Name("IFFT").Device(DEVICE_CPU), FFTCPU<false, 1>);
+REGISTER_KERNEL_BUILDER(Name("FFT2D").Device(DEVICE_CPU), FFTCPU<true, 2>);
+REGISTER_KERNEL_BUILDER(Name("IFFT2D").Device(DEVICE_CPU), FFTCPU<false, 2>);
+REGISTER_KERNEL_BUILDER(Name("FFT3D").Device(DEVICE_CPU), FFTCPU<true, 3>);
+REGISTER_KERNEL_BUILDER(Name("IFFT3D").Device(DEVICE_CPU), FFTCPU<false, 3>);
+
+// Deprecated kernels.
+REGISTER_KERNEL_BUILDER(Name("BatchFFT").Device(DEVICE_CPU), FFTCPU<true, 1>);
+REGISTER_KERNEL_BUILDER(Name("BatchIFFT").Device(DEVICE_CPU), FFTCPU<false, 1>);
+REGISTER_KERNEL_BUILDER(Name("BatchFFT2D").Device(DEVICE_CPU), FFTCPU<true, 2>);
+REGISTER_KERNEL_BUILDER(Name("BatchIFFT2D").Device(DEVICE_CPU),
+                        FFTCPU<false, 2>);
+REGISTER_KERNEL_BUILDER(Name("BatchFFT3D").Device(DEVICE_CPU), FFTCPU<true, 3>);
+REGISTER_KERNEL_BUILDER(Name("BatchIFFT3D").Device(DEVICE_CPU),
+                        FFTCPU<false, 3>);
+
+// RFFT computes the transforms of the inner-most dimensions of a real input,
+// cropped or zero-padded to "fft_length", keeping only the non-redundant
+// half of the last dimension. IRFFT inverts it.
+template <bool Forward, int FFTRank>
+class RFFTCPU : public OpKernel {
+ public:
+  static_assert(FFTRank >= 1 && FFTRank <= 3,
+                "Only 1D, 2D and 3D FFTs supported.");
+  explicit RFFTCPU(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& in = ctx->input(0);
+    const TensorShape& shape = in.shape();
+    const Tensor& fft_length = ctx->input(1);
+    OP_REQUIRES(
+        ctx, shape.dims() >= FFTRank,
+        errors::InvalidArgument("Input must have rank of at least ", FFTRank,
+                                " but got: ", shape.DebugString()));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsVector(fft_length.shape()) &&
+                    fft_length.dim_size(0) == FFTRank,
+                errors::InvalidArgument("fft_length must be a vector of ",
+                                        FFTRank, " elements but got: ",
+                                        fft_length.shape().DebugString()));
+    FFTDims lengths;
+    auto fft_length_vec = fft_length.vec<int32>();
+    for (int i = 0; i < FFTRank; ++i) {
+      OP_REQUIRES(ctx, fft_length_vec(i) > 0,
+                  errors::InvalidArgument("fft_length must be positive but "
+                                          "got: ",
+                                          fft_length.DebugString()));
+      lengths.push_back(fft_length_vec(i));
+    }
+    FFTDims spectrum_dims = lengths;
+    spectrum_dims.back() = lengths.back() / 2 + 1;
+
+    int64 batch;
+    FFTDims in_dims;
+    SplitShape(shape, FFTRank, &batch, &in_dims);
+    TensorShape batch_shape;
+    for (int i = 0; i < shape.dims() - FFTRank; ++i) {
+      batch_shape.AddDim(shape.dim_size(i));
+    }
+    TensorShape real_shape = batch_shape;
+    for (int64 d : lengths) real_shape.AddDim(d);
+    TensorShape spectrum_shape = batch_shape;
+    for (int64 d : spectrum_dims) spectrum_shape.AddDim(d);
+
+    Tensor* out;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            0, Forward ? spectrum_shape : real_shape, &out));
+    if (batch == 0) {
+      return;
+    }
+    // Holds on to the plan, which FFTPlan::Get may drop from its cache.
+    const std::shared_ptr<const FFTPlan> plan = FFTPlan::Get(lengths.back());
+    const int64 rows = batch * Product(lengths, 0, FFTRank - 1);
+
+    if (Forward) {
+      const float* real = in.flat<float>().data();
+      Tensor padded;
+      if (in_dims != lengths) {
+        OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, real_shape, &padded));
+        CopyPadded(batch, in_dims, real, lengths, padded.flat<float>().data());
+        real = padded.flat<float>().data();
+      }
+      complex64* spectrum = out->flat<complex64>().data();
+      RealRowsToSpectrum(ctx, *plan, rows, real, spectrum);
+      if (FFTRank > 1) {
+        TransformAxes(ctx, true, batch, spectrum_dims, FFTRank - 1, 1.0f,
+                      spectrum, spectrum);
+      }
+    } else {
+      Tensor spectrum;
+      OP_REQUIRES_OK(
+          ctx, ctx->allocate_temp(DT_COMPLEX64, spectrum_shape, &spectrum));
+      complex64* data = spectrum.flat<complex64>().data();
+      CopyPadded(batch, in_dims, in.flat<complex64>().data(), spectrum_dims,
+                 data);
+      if (FFTRank > 1) {
+        TransformAxes(ctx, false, batch, spectrum_dims, FFTRank - 1, 1.0f,
+                      data, data);
+      }
+      SpectrumToRealRows(ctx, *plan, rows, 1.0f / Product(lengths, 0, FFTRank),
+                         data, out->flat<float>().data());
+    }
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("RFFT").Device(DEVICE_CPU), RFFTCPU<true, 1>);
+REGISTER_KERNEL_BUILDER(Name("IRFFT").Device(DEVICE_CPU), RFFTCPU<false, 1>);
+REGISTER_KERNEL_BUILDER(Name("RFFT2D").Device(DEVICE_CPU), RFFTCPU<true, 2>);
+REGISTER_KERNEL_BUILDER(Name("IRFFT2D").Device(DEVICE_CPU), RFFTCPU<false, 2>);
+REGISTER_KERNEL_BUILDER(Name("RFFT3D").Device(DEVICE_CPU), RFFTCPU<true, 3>);
+REGISTER_KERNEL_BUILDER(Name("IRFFT3D").Device(DEVICE_CPU), RFFTCPU<false, 3>);
+
+}  // end namespace tensorflow
+
 #if GOOGLE_CUDA
 #include "tensorflow/core/platform/stream_executor.h"
 
@@ -0,0 +1,170 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/fft_ops_plan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The cache is cleared when it grows past this many plans, so that graphs
+// with many distinct dynamic shapes do not hold on to tables forever.
+const int kMaxCachedPlans = 64;
+
+bool IsPowerOfTwo(int64 n) { return (n & (n - 1)) == 0; }
+
+int Log2(int64 n) {
+  int log = 0;
+  while ((int64{1} << log) < n) ++log;
+  return log;
+}
+
+// Spelled out instead of using std::complex's operator*, which handles
+// infinities and NaNs with a slow library call.
+inline complex64 Mul(const complex64& a, const complex64& b) {
+  return complex64(a.real() * b.real() - a.imag() * b.imag(),
+                   a.real() * b.imag() + a.imag() * b.real());
+}
+
+// exp(-pi i k^2 / n), reducing k^2 modulo 2n first so the angle stays
+// accurate for large k.
+complex64 Chirp(int64 k, int64 n) {
+  const double angle =
+      -M_PI * static_cast<double>((k * k) % (2 * n)) / static_cast<double>(n);
+  return complex64(std::cos(angle), std::sin(angle));
+}
+
+void Conjugate(int64 n, complex64* data) {
+  for (int64 i = 0; i < n; ++i) data[i] = std::conj(data[i]);
+}
+
+}  // namespace
+
+FFTPlan::FFTPlan(int64 n) : n_(n) {
+  CHECK_GT(n, 0);
+  if (IsPowerOfTwo(n)) {
+    const int log_n = Log2(n);
+    bit_reverse_.resize(n);
+    for (int64 i = 0; i < n; ++i) {
+      int64 reversed = 0;
+      for (int b = 0; b < log_n; ++b) {
+        reversed |= ((i >> b) & 1) << (log_n - 1 - b);
+      }
+      bit_reverse_[i] = reversed;
+    }
+    twiddles_.resize(n / 2);
+    for (int64 k = 0; k < n / 2; ++k) {
+      const double angle = -2 * M_PI * k / n;
+      twiddles_[k] = complex64(std::cos(angle), std::sin(angle));
+    }
+    return;
+  }
+
+  // The circular convolution of the chirped input with the conjugate chirp
+  // must not wrap around, so it needs at least 2n - 1 points.
+  const int64 m = int64{1} << Log2(2 * n - 1);
+  conv_plan_.reset(new FFTPlan(m));
+  chirp_.resize(n);
+  for (int64 k = 0; k < n; ++k) chirp_[k] = Chirp(k, n);
+  filter_.assign(m, complex64(0, 0));
+  filter_[0] = std::conj(chirp_[0]);
+  for (int64 k = 1; k < n; ++k) {
+    filter_[k] = filter_[m - k] = std::conj(chirp_[k]);
+  }
+  conv_plan_->Forward(filter_.data(), nullptr);
+  // Fold the 1 / m of the inverse convolution transform into the filter.
+  const float inv_m = 1.0f / m;
+  for (complex64& f : filter_) f *= inv_m;
+}
+
+std::shared_ptr<const FFTPlan> FFTPlan::Get(int64 n) {
+  static mutex* mu = new mutex;
+  static auto* plans =
+      new std::unordered_map<int64, std::shared_ptr<const FFTPlan>>;
+  {
+    mutex_lock l(*mu);
+    auto it = plans->find(n);
+    if (it != plans->end()) return it->second;
+  }
+  // Build outside the lock; if another thread raced us, keep its plan.
+  std::shared_ptr<const FFTPlan> plan(new FFTPlan(n));
+  mutex_lock l(*mu);
+  if (plans->size() >= kMaxCachedPlans) plans->clear();
+  return plans->emplace(n, std::move(plan)).first->second;
+}
+
+int64 FFTPlan::scratch_size() const {
+  return conv_plan_ ? conv_plan_->size() : 0;
+}
+
+int64 FFTPlan::cost() const {
+  if (conv_plan_) return 2 * conv_plan_->cost() + 6 * conv_plan_->size();
+  return 5 * n_ * std::max(1, Log2(n_));
+}
+
+void FFTPlan::Forward(complex64* data, complex64* scratch) const {
+  if (conv_plan_) {
+    Bluestein(data, scratch);
+  } else {
+    Radix2(data);
+  }
+}
+
+void FFTPlan::Inverse(complex64* data, complex64* scratch) const {
+  // conj(DFT(conj(X))) is the unnormalized inverse DFT of X.
+  Conjugate(n_, data);
+  Forward(data, scratch);
+  Conjugate(n_, data);
+}
+
+void FFTPlan::Radix2(complex64* data) const {
+  for (int64 i = 0; i < n_; ++i) {
+    const int64 j = bit_reverse_[i];
+    if (i < j) std::swap(data[i], data[j]);
+  }
+  for (int64 len = 2; len <= n_; len <<= 1) {
+    const int64 half = len / 2;
+    const int64 stride = n_ / len;
+    for (int64 start = 0; start < n_; start += len) {
+      complex64* lo = data + start;
+      complex64* hi = lo + half;
+      for (int64 j = 0; j < half; ++j) {
+        const complex64 v = Mul(hi[j], twiddles_[j * stride]);
+        hi[j] = lo[j] - v;
+        lo[j] += v;
+      }
+    }
+  }
+}
+
+void FFTPlan::Bluestein(complex64* data, complex64* scratch) const {
+  const int64 m = conv_plan_->size();
+  for (int64 k = 0; k < n_; ++k) scratch[k] = Mul(data[k], chirp_[k]);
+  std::fill(scratch + n_, scratch + m, complex64(0, 0));
+  conv_plan_->Forward(scratch, nullptr);
+  for (int64 k = 0; k < m; ++k) scratch[k] = Mul(scratch[k], filter_[k]);
+  conv_plan_->Inverse(scratch, nullptr);
+  for (int64 k = 0; k < n_; ++k) data[k] = Mul(scratch[k], chirp_[k]);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,83 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_FFT_OPS_PLAN_H_
+#define TENSORFLOW_KERNELS_FFT_OPS_PLAN_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Precomputed tables for the unnormalized 1D discrete Fourier transform of
+// one length, used by the CPU FFT kernels.
+//
+// Power-of-2 lengths use an iterative radix-2 transform. Other lengths are
+// computed with Bluestein's algorithm as a circular convolution of
+// power-of-2 length. A plan is immutable once built and may be used by
+// several threads at once; each caller provides its own scratch space.
+class FFTPlan {
+ public:
+  // Requires n > 0.
+  explicit FFTPlan(int64 n);
+
+  // Returns the plan for length "n" from a process-wide cache, building it
+  // on first use.
+  static std::shared_ptr<const FFTPlan> Get(int64 n);
+
+  int64 size() const { return n_; }
+
+  // Number of complex64 elements of scratch space Forward() and Inverse()
+  // need.
+  int64 scratch_size() const;
+
+  // Approximate number of floating point operations of one transform.
+  int64 cost() const;
+
+  // Replaces data[0, n) with its DFT:
+  //   X[k] = sum_j x[j] * exp(-2 pi i j k / n).
+  void Forward(complex64* data, complex64* scratch) const;
+
+  // Replaces data[0, n) with its inverse DFT, without dividing by n:
+  //   x[j] = sum_k X[k] * exp(2 pi i j k / n).
+  void Inverse(complex64* data, complex64* scratch) const;
+
+ private:
+  void Radix2(complex64* data) const;
+  void Bluestein(complex64* data, complex64* scratch) const;
+
+  const int64 n_;
+
+  // Radix-2 plans: the bit-reversal permutation and the twiddle factors
+  // exp(-2 pi i k / n) for k < n / 2.
+  std::vector<int64> bit_reverse_;
+  std::vector<complex64> twiddles_;
+
+  // Bluestein plans: the chirp exp(-pi i k^2 / n) for k < n, the DFT of the
+  // conjugate chirp filter, and the plan of the convolution length.
+  std::vector<complex64> chirp_;
+  std::vector<complex64> filter_;
+  std::unique_ptr<FFTPlan> conv_plan_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FFTPlan);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_FFT_OPS_PLAN_H_
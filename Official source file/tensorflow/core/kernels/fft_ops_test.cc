@@ -0,0 +1,281 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Computes the DFT of the inner-most "rank" dimensions of "in" directly from
+// its definition, accumulating in double precision.
+Tensor NaiveDFT(const Tensor& in, int rank, bool forward) {
+  const TensorShape& shape = in.shape();
+  int64 size = 1;
+  std::vector<int64> dims;
+  for (int i = shape.dims() - rank; i < shape.dims(); ++i) {
+    dims.push_back(shape.dim_size(i));
+    size *= shape.dim_size(i);
+  }
+  const int64 batch = shape.num_elements() / size;
+  const double sign = forward ? -1 : 1;
+  Tensor out(DT_COMPLEX64, shape);
+  auto x = in.flat<complex64>();
+  auto y = out.flat<complex64>();
+  for (int64 b = 0; b < batch; ++b) {
+    for (int64 k = 0; k < size; ++k) {
+      std::complex<double> sum = 0;
+      for (int64 j = 0; j < size; ++j) {
+        double phase = 0;
+        int64 kk = k, jj = j;
+        for (int d = rank - 1; d >= 0; --d) {
+          phase += static_cast<double>((kk % dims[d]) * (jj % dims[d])) /
+                   dims[d];
+          kk /= dims[d];
+          jj /= dims[d];
+        }
+        sum += std::complex<double>(x(b * size + j)) *
+               std::polar(1.0, sign * 2 * M_PI * phase);
+      }
+      if (!forward) sum /= static_cast<double>(size);
+      y(b * size + k) = complex64(sum);
+    }
+  }
+  return out;
+}
+
+// Returns the first n / 2 + 1 entries of each inner-most row of the complex
+// tensor "full", whose inner-most dimension is n.
+Tensor HalfSpectrum(const Tensor& full) {
+  const int64 n = full.dim_size(full.dims() - 1);
+  const int64 half = n / 2 + 1;
+  TensorShape shape = full.shape();
+  shape.set_dim(shape.dims() - 1, half);
+  Tensor out(DT_COMPLEX64, shape);
+  auto x = full.flat_inner_dims<complex64>();
+  auto y = out.flat_inner_dims<complex64>();
+  for (int64 r = 0; r < y.dimension(0); ++r) {
+    for (int64 k = 0; k < half; ++k) y(r, k) = x(r, k);
+  }
+  return out;
+}
+
+Tensor RandomComplex(const TensorShape& shape) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor t(DT_COMPLEX64, shape);
+  auto flat = t.flat<complex64>();
+  for (int64 i = 0; i < flat.size(); ++i) {
+    flat(i) = complex64(rnd.RandFloat() * 2 - 1, rnd.RandFloat() * 2 - 1);
+  }
+  return t;
+}
+
+// Returns a complex tensor with the real parts of "real" and zero imaginary
+// parts.
+Tensor ToComplex(const Tensor& real) {
+  Tensor t(DT_COMPLEX64, real.shape());
+  auto x = real.flat<float>();
+  auto y = t.flat<complex64>();
+  for (int64 i = 0; i < x.size(); ++i) y(i) = complex64(x(i), 0);
+  return t;
+}
+
+class FFTOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& op) {
+    TF_ASSERT_OK(NodeDefBuilder("fft_op", op)
+                     .Input(FakeInput(DT_COMPLEX64))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void MakeRealOp(const string& op, DataType input_type) {
+    TF_ASSERT_OK(NodeDefBuilder("fft_op", op)
+                     .Input(FakeInput(input_type))
+                     .Input(FakeInput(DT_INT32))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Runs "op" of the given rank on random inputs of "shape" and compares
+  // the result to a naive DFT.
+  void CheckComplex(const string& op, int rank, bool forward,
+                    const TensorShape& shape) {
+    MakeOp(op);
+    const Tensor x = RandomComplex(shape);
+    AddInputFromArray<complex64>(
+        shape, gtl::ArraySlice<complex64>(x.flat<complex64>().data(),
+                                          x.NumElements()));
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorNear<complex64>(NaiveDFT(x, rank, forward),
+                                      *GetOutput(0), 1e-4);
+  }
+};
+
+TEST_F(FFTOpTest, FFT) { CheckComplex("FFT", 1, true, TensorShape({3, 16})); }
+
+TEST_F(FFTOpTest, FFTBatchRank2) {
+  CheckComplex("FFT", 1, true, TensorShape({2, 2, 12}));
+}
+
+TEST_F(FFTOpTest, FFTPrimeLength) {
+  CheckComplex("FFT", 1, true, TensorShape({4, 13}));
+}
+
+TEST_F(FFTOpTest, IFFT) {
+  CheckComplex("IFFT", 1, false, TensorShape({5, 10}));
+}
+
+TEST_F(FFTOpTest, FFT2D) {
+  CheckComplex("FFT2D", 2, true, TensorShape({2, 8, 6}));
+}
+
+TEST_F(FFTOpTest, IFFT2D) {
+  CheckComplex("IFFT2D", 2, false, TensorShape({3, 5, 4}));
+}
+
+TEST_F(FFTOpTest, FFT3D) {
+  CheckComplex("FFT3D", 3, true, TensorShape({2, 4, 3, 5}));
+}
+
+TEST_F(FFTOpTest, IFFT3D) {
+  CheckComplex("IFFT3D", 3, false, TensorShape({4, 4, 4}));
+}
+
+TEST_F(FFTOpTest, Empty) {
+  MakeOp("FFT2D");
+  AddInputFromArray<complex64>(TensorShape({0, 4, 4}), {});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(TensorShape({0, 4, 4}), GetOutput(0)->shape());
+}
+
+TEST_F(FFTOpTest, RFFT) {
+  MakeRealOp("RFFT", DT_FLOAT);
+  // Three rows, so that one of them is transformed without a partner.
+  Tensor x(DT_FLOAT, TensorShape({3, 10}));
+  test::FillFn<float>(&x, [](int i) { return std::sin(i * 0.37f) + i % 3; });
+  AddInputFromArray<float>(x.shape(), gtl::ArraySlice<float>(
+                                          x.flat<float>().data(), 30));
+  AddInputFromArray<int32>(TensorShape({1}), {10});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<complex64>(
+      HalfSpectrum(NaiveDFT(ToComplex(x), 1, true)), *GetOutput(0), 1e-4);
+}
+
+TEST_F(FFTOpTest, RFFT2DCropAndPad) {
+  MakeRealOp("RFFT2D", DT_FLOAT);
+  // [2, 3] cropped to [2, 2] and padded to [3, 2].
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor padded(DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&padded, {1, 2, 4, 5, 0, 0});
+  test::ExpectTensorNear<complex64>(
+      HalfSpectrum(NaiveDFT(ToComplex(padded), 2, true)), *GetOutput(0),
+      1e-5);
+}
+
+TEST_F(FFTOpTest, IRFFT3D) {
+  MakeRealOp("IRFFT3D", DT_COMPLEX64);
+  // The spectrum of a real signal of shape [2, 3, 5].
+  Tensor x(DT_FLOAT, TensorShape({2, 3, 5}));
+  test::FillFn<float>(&x, [](int i) { return std::cos(i * 1.3f); });
+  const Tensor spectrum = HalfSpectrum(NaiveDFT(ToComplex(x), 3, true));
+  AddInputFromArray<complex64>(
+      spectrum.shape(),
+      gtl::ArraySlice<complex64>(spectrum.flat<complex64>().data(),
+                                 spectrum.NumElements()));
+  AddInputFromArray<int32>(TensorShape({3}), {2, 3, 5});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(x, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FFTOpTest, IRFFTIgnoresImaginaryDC) {
+  MakeRealOp("IRFFT", DT_COMPLEX64);
+  AddInputFromArray<complex64>(TensorShape({3}),
+                               {{4, 1}, {0, 0}, {0, 2}});
+  AddInputFromArray<int32>(TensorShape({1}), {4});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected, {1, 1, 1, 1});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(FFTOpTest, InvalidFFTLength) {
+  MakeRealOp("RFFT", DT_FLOAT);
+  AddInputFromArray<float>(TensorShape({4}), {1, 2, 3, 4});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString()).contains("fft_length must be positive"))
+      << s;
+}
+
+static Graph* FFTGraph(const string& op, const TensorShape& shape) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, op, test::graph::Constant(g, RandomComplex(shape)));
+  return g;
+}
+
+// Transforms "batch" rows of length "length", e.g. the frames of a
+// spectrogram.
+static void BM_FFT(int iters, int batch, int length) {
+  testing::ItemsProcessed(static_cast<int64>(iters) * batch * length);
+  test::Benchmark("cpu", FFTGraph("FFT", TensorShape({batch, length})))
+      .Run(iters);
+}
+BENCHMARK(BM_FFT)
+    ->ArgPair(1, 1 << 16)
+    ->ArgPair(256, 256)
+    ->ArgPair(256, 400)
+    ->ArgPair(1024, 512)
+    ->ArgPair(1024, 1024);
+
+static void BM_FFT2D(int iters, int batch, int size) {
+  testing::ItemsProcessed(static_cast<int64>(iters) * batch * size * size);
+  test::Benchmark("cpu", FFTGraph("FFT2D", TensorShape({batch, size, size})))
+      .Run(iters);
+}
+BENCHMARK(BM_FFT2D)->ArgPair(1, 512)->ArgPair(16, 128)->ArgPair(64, 100);
+
+static void BM_RFFT(int iters, int batch, int length) {
+  testing::ItemsProcessed(static_cast<int64>(iters) * batch * length);
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor x(DT_FLOAT, TensorShape({batch, length}));
+  x.flat<float>().setRandom();
+  Tensor fft_length(DT_INT32, TensorShape({1}));
+  fft_length.flat<int32>()(0) = length;
+  test::graph::Binary(g, "RFFT", test::graph::Constant(g, x),
+                      test::graph::Constant(g, fft_length));
+  test::Benchmark("cpu", g).Run(iters);
+}
+BENCHMARK(BM_RFFT)->ArgPair(256, 400)->ArgPair(1024, 512);
+
+}  // namespace
+}  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
@@ -89,6 +90,16 @@ Status FIFOQueue::GetElementComponentFromBatch(const FIFOQueue::Tuple& tuple,
                                                PersistentTensor* out_tensor) {
   TensorShape element_shape(tuple[component].shape());
   element_shape.RemoveDim(0);
+  // Share the buffer of the batch if the element stays aligned, so that
+  // splitting a batch does not copy it. DequeueMany copies every element
+  // exactly once, into its output batch.
+  Tensor element;
+  if (element.CopyFrom(tuple[component].Slice(index, index + 1),
+                       element_shape) &&
+      element.IsAligned()) {
+    *out_tensor = PersistentTensor(element);
+    return Status::OK();
+  }
   Tensor* element_access = nullptr;
   TF_RETURN_IF_ERROR(ctx->allocate_persistent(
       tuple[component].dtype(), element_shape, out_tensor, &element_access));
@@ -253,32 +264,19 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
 
                 if (closed_ && queue_size < attempt->elements_requested) {
                   // If we don't have enough for a full dequeue, we have
-                  // to reset the attempt tuple.
-                  if (!attempt->tuple.empty()) {
-                    // Restore already-dequeued elements to the front of the
-                    // queue.
-                    for (int64 i = attempt->tuple[0].dim_size(0) -
-                                   attempt->elements_requested - 1;
-                         i >= 0; --i) {
-                      for (int j = 0; j < num_components(); ++j) {
-                        PersistentTensor element;
-                        Status s = GetElementComponentFromBatch(
-                            attempt->tuple, i, j, attempt->context, &element);
-                        if (!s.ok()) {
-                          attempt->context->SetStatus(
-                              errors::DataLoss("Failed to restore element from "
-                                               "partially-dequeued batch "
-                                               "to FIFOQueue: ",
-                                               s.error_message()));
-                        }
-                        queues_[j].push_front(element);
-                      }
+                  // to reset the attempt.
+                  // Restore already-dequeued elements to the front of the
+                  // queue.
+                  for (int64 i = attempt->tuples.size() - 1; i >= 0; --i) {
+                    for (int j = 0; j < num_components(); ++j) {
+                      queues_[j].push_front(
+                          PersistentTensor(attempt->tuples[i][j]));
                     }
                   }
+                  attempt->tuples.clear();
                   if (allow_small_batch && queues_[0].size() > 0) {
                     // Request all remaining elements in the queue.
                     queue_size = queues_[0].size();
-                    attempt->tuple.clear();
                     attempt->elements_requested = queue_size;
                   } else {
                     if (allow_small_batch) {
@@ -300,36 +298,27 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
 
                 RunResult result = kNoProgress;
                 for (; queue_size > 0; --queue_size) {
-                  if (attempt->tuple.empty()) {
-                    // Only allocate tuple when we have something to dequeue
-                    // so we don't use excessive memory when there are many
-                    // blocked dequeue attempts waiting.
-                    attempt->tuple.reserve(num_components());
-                    for (int i = 0; i < num_components(); ++i) {
-                      const TensorShape shape =
-                          ManyOutShape(i, attempt->elements_requested);
-                      Tensor element;
-                      attempt->context->allocate_temp(component_dtypes_[i],
-                                                      shape, &element);
-                      attempt->tuple.emplace_back(element);
-                    }
-                  }
                   result = kProgress;
+                  // Only take the elements off the queue while holding mu_.
+                  // They are copied into the output batch by done_callback,
+                  // which runs after mu_ is released.
                   Tuple tuple;
                   DequeueLocked(attempt->context, &tuple);
-                  const int64 index = attempt->tuple[0].dim_size(0) -
-                                      attempt->elements_requested;
-                  for (int i = 0; i < num_components(); ++i) {
-                    attempt->context->SetStatus(CopyElementToSlice(
-                        tuple[i], &attempt->tuple[i], index));
-                    if (!attempt->context->status().ok()) return kComplete;
-                  }
-                  tuple.clear();
+                  attempt->tuples.push_back(std::move(tuple));
                   --attempt->elements_requested;
                   if (attempt->elements_requested == 0) {
-                    tuple = attempt->tuple;
-                    attempt->done_callback = [callback, tuple]() {
-                      callback(tuple);
+                    std::shared_ptr<std::vector<Tuple>> elements(
+                        new std::vector<Tuple>);
+                    elements->swap(attempt->tuples);
+                    OpKernelContext* ctx = attempt->context;
+                    attempt->done_callback = [callback, elements, ctx]() {
+                      Tuple batch;
+                      Status s = CopyElementsToBatch(ctx, *elements, &batch);
+                      if (!s.ok()) {
+                        ctx->SetStatus(s);
+                        batch.clear();
+                      }
+                      callback(batch);
                     };
                     return kComplete;
                   }
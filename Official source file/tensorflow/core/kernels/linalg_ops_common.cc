@@ -89,15 +89,23 @@ void LinearAlgebraOp<Scalar>::Compute(OpKernelContext* context) {
   TensorShapes input_matrix_shapes;
   TensorShape batch_shape;
   AnalyzeInputs(context, &inputs, &input_matrix_shapes, &batch_shape);
+  if (!context->status().ok()) return;
 
   TensorShapes output_matrix_shapes;
   TensorOutputs outputs;
   PrepareOutputs(context, input_matrix_shapes, batch_shape, &outputs,
                  &output_matrix_shapes);
+  if (!context->status().ok()) return;
 
   // Process the individual matrix problems in parallel using a threadpool.
-  auto shard = [this, &inputs, &input_matrix_shapes, &outputs,
+  const bool batched = SupportsMatrixBatch(input_matrix_shapes);
+  auto shard = [this, batched, &inputs, &input_matrix_shapes, &outputs,
                 &output_matrix_shapes, context](int64 begin, int64 end) {
+    if (batched) {
+      ComputeTensorSliceBatch(context, begin, end, inputs, input_matrix_shapes,
+                              outputs, output_matrix_shapes);
+      return;
+    }
     for (int64 i = begin; i < end; ++i) {
       ComputeTensorSlice(context, i, inputs, input_matrix_shapes, outputs,
                          output_matrix_shapes);
@@ -229,6 +237,26 @@ void LinearAlgebraOp<Scalar>::ComputeTensorSlice(
   ComputeMatrix(context, matrix_inputs, &matrix_outputs);
 }
 
+template <typename Scalar>
+void LinearAlgebraOp<Scalar>::ComputeTensorSliceBatch(
+    OpKernelContext* context, int64 begin, int64 end,
+    const TensorInputs& inputs, const TensorShapes& input_matrix_shapes,
+    const TensorOutputs& outputs, const TensorShapes& output_matrix_shapes) {
+  if (begin >= end) return;
+  ConstScalarPtrs batch_inputs;
+  for (int i = 0; i < inputs.size(); ++i) {
+    batch_inputs.push_back(inputs[i].flat<Scalar>().data() +
+                           begin * input_matrix_shapes[i].num_elements());
+  }
+  ScalarPtrs batch_outputs;
+  for (int i = 0; i < output_matrix_shapes.size(); ++i) {
+    batch_outputs.push_back(outputs[i]->flat<Scalar>().data() +
+                            begin * output_matrix_shapes[i].num_elements());
+  }
+  ComputeMatrixBatch(context, end - begin, input_matrix_shapes, batch_inputs,
+                     batch_outputs);
+}
+
 // Explicitly instantiate LinearAlgebraOp for the scalar types we expect to use.
 template class LinearAlgebraOp<float>;
 template class LinearAlgebraOp<double>;
@@ -125,6 +125,28 @@ class LinearAlgebraOp : public OpKernel {
                              const ConstMatrixMaps& inputs,
                              MatrixMaps* outputs) = 0;
 
+  using ConstScalarPtrs = gtl::InlinedVector<const Scalar*, 4>;
+  using ScalarPtrs = gtl::InlinedVector<Scalar*, 4>;
+
+  // Returns true if the derived class computes batches of matrices with the
+  // given input shapes in ComputeMatrixBatch instead of one matrix at a time
+  // in ComputeMatrix. By default no shapes are supported.
+  virtual bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const {
+    return false;
+  }
+
+  // Performs the computation for 'num_matrices' consecutive matrices of the
+  // batch at once. inputs[i] and outputs[i] point to the first of these
+  // matrices in the i-th input and output, which hold the matrices one after
+  // another in row major order. Each shard of the batch is passed in a single
+  // call, so implementations can amortize per-matrix overhead and vectorize
+  // across matrices.
+  virtual void ComputeMatrixBatch(OpKernelContext* context, int64 num_matrices,
+                                  const TensorShapes& input_matrix_shapes,
+                                  const ConstScalarPtrs& inputs,
+                                  const ScalarPtrs& outputs) {}
+
  private:
   using TensorInputs = gtl::InlinedVector<Tensor, 4>;
   using TensorOutputs = gtl::InlinedVector<Tensor*, 4>;
@@ -152,6 +174,13 @@ class LinearAlgebraOp : public OpKernel {
                           const TensorOutputs& outputs,
                           const TensorShapes& output_matrix_shapes);
 
+  // Calls ComputeMatrixBatch for the matrices [begin, end) of the batch.
+  void ComputeTensorSliceBatch(OpKernelContext* context, int64 begin,
+                               int64 end, const TensorInputs& inputs,
+                               const TensorShapes& input_matrix_shapes,
+                               const TensorOutputs& outputs,
+                               const TensorShapes& output_matrix_shapes);
+
   void AnalyzeInputs(OpKernelContext* context, TensorInputs* inputs,
                      TensorShapes* input_matrix_shapes,
                      TensorShape* batch_shape);
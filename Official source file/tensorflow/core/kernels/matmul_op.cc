@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/reduced_precision_gemm_cpu.h"
 
 #if GOOGLE_CUDA
 #include "cuda/include/cuda.h"
@@ -109,14 +110,6 @@ bool ExplicitVectorMatrixOptimization(
   }
   return false;
 }
-// Half is not supported.
-template <>
-bool ExplicitVectorMatrixOptimization<Eigen::half>(
-    const Tensor& a, const Tensor& b,
-    const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
-    Tensor* out) {
-  return false;
-}
 
 // On CPUs, we ignore USE_CUBLAS
 template <typename T>
@@ -136,6 +129,32 @@ struct LaunchMatMulCPU {
   }
 };
 
+// Half and bfloat16 operands are converted to float a block at a time inside
+// the GEMM, and products are accumulated in float.
+template <typename T>
+struct LaunchReducedPrecisionMatMulCPU {
+  static void launch(
+      OpKernelContext* ctx, OpKernel* kernel, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      Tensor* out) {
+    ReducedPrecisionMatrixPacker<T> lhs(a.flat<T>().data(), a.dim_size(0),
+                                        a.dim_size(1), dim_pair[0].first == 0);
+    ReducedPrecisionMatrixPacker<T> rhs(b.flat<T>().data(), b.dim_size(0),
+                                        b.dim_size(1), dim_pair[0].second == 1);
+    ReducedPrecisionGemm(ctx->device(), out->dim_size(0), out->dim_size(1),
+                         a.dim_size(dim_pair[0].first), lhs, rhs,
+                         out->flat<T>().data());
+  }
+};
+
+template <>
+struct LaunchMatMulCPU<Eigen::half>
+    : public LaunchReducedPrecisionMatMulCPU<Eigen::half> {};
+
+template <>
+struct LaunchMatMulCPU<bfloat16>
+    : public LaunchReducedPrecisionMatMulCPU<bfloat16> {};
+
 template <typename T, bool USE_CUBLAS>
 struct LaunchMatMul<CPUDevice, T, USE_CUBLAS> : public LaunchMatMulCPU<T> {};
 
@@ -279,6 +298,7 @@ struct MatMulFunctor<CPUDevice, T> {
 TF_CALL_float(REGISTER_CPU);
 TF_CALL_double(REGISTER_CPU);
 TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
 
 TF_CALL_int32(REGISTER_CPU);
 TF_CALL_complex64(REGISTER_CPU);
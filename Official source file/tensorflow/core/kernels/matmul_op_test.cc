@@ -14,20 +14,44 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/half.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+template <typename T>
+static void SetRandom(Tensor* t) {
+  t->flat<T>().setRandom();
+}
+
+// Half and bfloat16 are filled with random floats.
+template <>
+void SetRandom<Eigen::half>(Tensor* t) {
+  Tensor f(DT_FLOAT, t->shape());
+  f.flat<float>().setRandom();
+  FloatToHalf(f.flat<float>().data(), t->flat<Eigen::half>().data(),
+              t->NumElements());
+}
+
+template <>
+void SetRandom<bfloat16>(Tensor* t) {
+  Tensor f(DT_FLOAT, t->shape());
+  f.flat<float>().setRandom();
+  FloatToBFloat16(f.flat<float>().data(), t->flat<bfloat16>().data(),
+                  t->NumElements());
+}
+
 template <typename T>
 static Graph* Matmul(int m, int k, int n, bool transpose_a, bool transpose_b,
                      DataType type) {
   Graph* g = new Graph(OpRegistry::Global());
   Tensor in0(type, transpose_a ? TensorShape({k, m}) : TensorShape({m, k}));
-  in0.flat<T>().setRandom();
+  SetRandom<T>(&in0);
   Tensor in1(type, transpose_b ? TensorShape({n, k}) : TensorShape({k, n}));
-  in1.flat<T>().setRandom();
+  SetRandom<T>(&in1);
   test::graph::Matmul(g, test::graph::Constant(g, in0),
                       test::graph::Constant(g, in1), transpose_a, transpose_b);
   return g;
@@ -44,6 +68,8 @@ static Graph* Matmul(int m, int k, int n, bool transpose_a, bool transpose_b,
 
 #define BM_Matmul(M, K, N, TA, TB)                                       \
   BM_MatmulDev(M, K, N, TA, TB, float, DT_FLOAT, cpu);                   \
+  BM_MatmulDev(M, K, N, TA, TB, Eigen::half, DT_HALF, cpu);              \
+  BM_MatmulDev(M, K, N, TA, TB, bfloat16, DT_BFLOAT16, cpu);             \
   BM_MatmulDev(M, K, N, TA, TB, std::complex<float>, DT_COMPLEX64, cpu); \
   BM_MatmulDev(M, K, N, TA, TB, float, DT_FLOAT, gpu);                   \
   BM_MatmulDev(M, K, N, TA, TB, std::complex<float>, DT_COMPLEX64, gpu); \
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/linalg_ops_common.h"
+#include "tensorflow/core/kernels/small_matrix_linalg_cpu.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -37,10 +38,13 @@ class MatrixInverseOp : public LinearAlgebraOp<Scalar> {
     OP_REQUIRES_OK(context, context->GetAttr("adjoint", &adjoint_));
   }
 
+  using TensorShapes = typename Base::TensorShapes;
   using Matrix = typename Base::Matrix;
   using MatrixMaps = typename Base::MatrixMaps;
   using ConstMatrixMap = typename Base::ConstMatrixMap;
   using ConstMatrixMaps = typename Base::ConstMatrixMaps;
+  using ConstScalarPtrs = typename Base::ConstScalarPtrs;
+  using ScalarPtrs = typename Base::ScalarPtrs;
 
   void ComputeMatrix(OpKernelContext* context, const ConstMatrixMaps& inputs,
                      MatrixMaps* outputs) final {
@@ -71,6 +75,22 @@ class MatrixInverseOp : public LinearAlgebraOp<Scalar> {
     outputs->at(0).noalias() = lu_decomposition.inverse();
   }
 
+  bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const final {
+    return IsSmallMatrixSize(input_matrix_shapes[0].dim_size(0));
+  }
+
+  void ComputeMatrixBatch(OpKernelContext* context, int64 num_matrices,
+                          const TensorShapes& input_matrix_shapes,
+                          const ConstScalarPtrs& inputs,
+                          const ScalarPtrs& outputs) final {
+    const bool invertible =
+        SmallMatrixInverses(input_matrix_shapes[0].dim_size(0), num_matrices,
+                            adjoint_, inputs[0], outputs[0]);
+    OP_REQUIRES(context, invertible,
+                errors::InvalidArgument("Input is not invertible."));
+  }
+
  private:
   bool adjoint_;
 
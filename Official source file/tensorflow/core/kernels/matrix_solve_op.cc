@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/linalg_ops_common.h"
+#include "tensorflow/core/kernels/small_matrix_linalg_cpu.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -42,6 +43,8 @@ class MatrixSolveOp : public LinearAlgebraOp<Scalar> {
   using MatrixMaps = typename Base::MatrixMaps;
   using ConstMatrixMap = typename Base::ConstMatrixMap;
   using ConstMatrixMaps = typename Base::ConstMatrixMaps;
+  using ConstScalarPtrs = typename Base::ConstScalarPtrs;
+  using ScalarPtrs = typename Base::ScalarPtrs;
 
   void ValidateInputMatrixShapes(
       OpKernelContext* context,
@@ -99,6 +102,25 @@ class MatrixSolveOp : public LinearAlgebraOp<Scalar> {
     outputs->at(0) = lu_decomposition.solve(rhs);
   }
 
+  // Systems without right-hand sides are not checked for invertibility, so
+  // they stay on the ComputeMatrix path.
+  bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const final {
+    return IsSmallMatrixSize(input_matrix_shapes[0].dim_size(0)) &&
+           input_matrix_shapes[1].dim_size(1) > 0;
+  }
+
+  void ComputeMatrixBatch(OpKernelContext* context, int64 num_matrices,
+                          const TensorShapes& input_matrix_shapes,
+                          const ConstScalarPtrs& inputs,
+                          const ScalarPtrs& outputs) final {
+    const bool invertible = SmallMatrixSolves(
+        input_matrix_shapes[0].dim_size(0), num_matrices, adjoint_,
+        input_matrix_shapes[1].dim_size(1), inputs[0], inputs[1], outputs[0]);
+    OP_REQUIRES(context, invertible,
+                errors::InvalidArgument("Input matrix is not invertible."));
+  }
+
  private:
   bool adjoint_;
 
@@ -20,6 +20,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/mirror_pad_op.h"
 
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op.h"
@@ -29,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/block_copy_cpu.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/mirror_pad_mode.h"
@@ -119,6 +122,24 @@ class MirrorPadOp : public OpKernel {
     Tensor* output = nullptr;
     OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
 
+    if (std::is_same<Device, Eigen::ThreadPoolDevice>::value) {
+      // Output index i of dimension d holds the input index reflected about
+      // the first or last element, skipping that element if offset_ is 1.
+      std::vector<int64> input_dims(dims);
+      std::vector<BlockCopyRanges> ranges(dims);
+      for (int d = 0; d < dims; ++d) {
+        input_dims[d] = in0.dim_size(d);
+        ranges[d] = MirrorPadRanges(input_dims[d], paddings(d, 0),
+                                    paddings(d, 1), offset_);
+      }
+      BlockCopier<T> copier(input_dims, ranges);
+      if (copier.efficient()) {
+        copier.Run(context->device(), in0.flat<T>().data(), T(),
+                   output->flat<T>().data());
+        return;
+      }
+    }
+
 #define MIRROR_PAD_CASE(i)                                                \
   case i: {                                                               \
     functor::MirrorPad<Device, T, i>()(                                   \
@@ -66,6 +66,11 @@ static void SetConstOp(const string& name, std::initializer_list<int64> dims,
       case DT_HALF:
         tensor.flat<Eigen::half>()(i) = Eigen::half(i / 10.0f);
         break;
+      case DT_BFLOAT16: {
+        const float value = i / 10.0f;
+        FloatToBFloat16(&value, &tensor.flat<bfloat16>()(i), 1);
+        break;
+      }
       default:
         LOG(FATAL) << "Unknown data type " << data_type;
     }
@@ -216,6 +221,18 @@ static void BM_ConvFloat(int iters, int batch, int rows, int cols, int in_depth,
                  strings::StrCat(BS, "_", R, "_", C, "_", ID, "_", OD, "_",    \
                                  KR, "_", KC, "_", STR, "_", PAD, "_f_cpu4")); \
   }                                                                            \
+  static void BM_ConvHalfFwdCPU4_##LABEL(int iters) {                          \
+    BM_ConvFloat(iters, BS, R, C, ID, OD, KR, KC, CONV_OP_FORWARD, 4, STR,     \
+                 PAD, false, DT_HALF,                                          \
+                 strings::StrCat(BS, "_", R, "_", C, "_", ID, "_", OD, "_",    \
+                                 KR, "_", KC, "_", STR, "_", PAD, "_h_cpu4")); \
+  }                                                                            \
+  static void BM_ConvBfloat16FwdCPU4_##LABEL(int iters) {                      \
+    BM_ConvFloat(iters, BS, R, C, ID, OD, KR, KC, CONV_OP_FORWARD, 4, STR,     \
+                 PAD, false, DT_BFLOAT16,                                      \
+                 strings::StrCat(BS, "_", R, "_", C, "_", ID, "_", OD, "_",    \
+                                 KR, "_", KC, "_", STR, "_", PAD, "_b_cpu4")); \
+  }                                                                            \
   static void BM_ConvFloatFwdGPU_##LABEL(int iters) {                          \
     BM_ConvFloat(iters, BS, R, C, ID, OD, KR, KC, CONV_OP_FORWARD, 1, STR,     \
                  PAD, true, DT_FLOAT,                                          \
@@ -230,6 +247,8 @@ static void BM_ConvFloat(int iters, int batch, int rows, int cols, int in_depth,
   }                                                                            \
   BENCHMARK(BM_ConvFloatFwdCPU1_##LABEL);                                      \
   BENCHMARK(BM_ConvFloatFwdCPU4_##LABEL);                                      \
+  BENCHMARK(BM_ConvHalfFwdCPU4_##LABEL);                                       \
+  BENCHMARK(BM_ConvBfloat16FwdCPU4_##LABEL);                                   \
   BENCHMARK(BM_ConvFloatFwdGPU_##LABEL);                                       \
   BENCHMARK(BM_ConvHalfFwdGPU_##LABEL)
 
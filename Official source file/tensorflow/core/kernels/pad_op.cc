@@ -21,7 +21,9 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op.h"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/block_copy_cpu.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -132,6 +135,22 @@ class PadOp : public OpKernel {
                TTypes<int32>::ConstMatrix paddings, Tensor* output) {
     CHECK_EQ(Dims, paddings.dimension(0));
     CHECK_EQ(2, paddings.dimension(1));
+    if (std::is_same<Device, CPUDevice>::value && Dims > 0) {
+      // Output index i of dimension d holds input index i - paddings(d, 0),
+      // or zero outside of the input.
+      std::vector<int64> input_dims(Dims);
+      std::vector<BlockCopyRanges> ranges(Dims);
+      for (int d = 0; d < Dims; ++d) {
+        input_dims[d] = input.dimension(d);
+        ranges[d] = PadRanges(input_dims[d], paddings(d, 0), paddings(d, 1));
+      }
+      BlockCopier<T> copier(input_dims, ranges);
+      if (copier.efficient()) {
+        copier.Run(context->device(), input.data(), T(),
+                   output->flat<T>().data());
+        return;
+      }
+    }
     Eigen::array<std::pair<int32, int32>, Dims> paddings_array;
     for (int i = 0; i < Dims; ++i) {
       paddings_array[i] = std::make_pair(paddings(i, 0), paddings(i, 1));
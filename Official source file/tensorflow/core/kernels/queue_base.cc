@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/queue_base.h"
 
+#include <string.h>
 #include <vector>
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -41,6 +44,15 @@ Status HandleSliceToElement(const Tensor& parent, Tensor* element,
         chip_shape.DebugString());
   }
   auto parent_as_matrix = parent.flat_outer_dims<T>();
+  if (DataTypeCanUseMemcpy(DT)) {
+    const int64 num_elements = element->NumElements();
+    if (num_elements > 0) {
+      memcpy(element->flat<T>().data(),
+             parent_as_matrix.data() + index * num_elements,
+             num_elements * sizeof(T));
+    }
+    return Status::OK();
+  }
   element->flat<T>() = parent_as_matrix.chip(index, 0);
   return Status::OK();
 }
@@ -60,6 +72,14 @@ Status HandleElementToSlice(const Tensor& element, Tensor* parent, int index) {
         chip_shape.DebugString());
   }
   auto parent_as_matrix = parent->flat_outer_dims<T>();
+  if (DataTypeCanUseMemcpy(DT)) {
+    const int64 num_elements = element.NumElements();
+    if (num_elements > 0) {
+      memcpy(parent_as_matrix.data() + index * num_elements,
+             element.flat<T>().data(), num_elements * sizeof(T));
+    }
+    return Status::OK();
+  }
   parent_as_matrix.chip(index, 0) = element.flat<T>();
   return Status::OK();
 }
@@ -410,4 +430,44 @@ Status QueueBase::CopyElementToSlice(const Tensor& element, Tensor* parent,
                                element.dtype());
 }
 
+// Static method
+Status QueueBase::CopyElementsToBatch(OpKernelContext* ctx,
+                                      const std::vector<Tuple>& elements,
+                                      Tuple* batch) {
+  DCHECK(!elements.empty());
+  const int64 batch_size = elements.size();
+  const int num_components = elements[0].size();
+  int64 bytes_per_element = 0;
+  batch->reserve(num_components);
+  for (int i = 0; i < num_components; ++i) {
+    TensorShape shape({batch_size});
+    shape.AppendShape(elements[0][i].shape());
+    Tensor component;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(elements[0][i].dtype(), shape, &component));
+    batch->emplace_back(component);
+    bytes_per_element += elements[0][i].TotalBytes();
+  }
+
+  mutex mu;
+  Status status;
+  auto copy = [&elements, batch, num_components, &mu, &status](int64 begin,
+                                                               int64 end) {
+    for (int64 index = begin; index < end; ++index) {
+      for (int i = 0; i < num_components; ++i) {
+        Status s = CopyElementToSlice(elements[index][i], &(*batch)[i], index);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          status.Update(s);
+          return;
+        }
+      }
+    }
+  };
+  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+        bytes_per_element, copy);
+  return status;
+}
+
 }  // namespace tensorflow
@@ -82,6 +82,13 @@ class QueueBase : public QueueInterface {
   static Status CopyElementToSlice(const Tensor& element, Tensor* parent,
                                    int64 index);
 
+  // Allocates the components of *batch and copies "elements", which all have
+  // the same shapes, into them. The copies are sharded over the intra-op
+  // thread pool. Must not be called while holding mu_.
+  static Status CopyElementsToBatch(OpKernelContext* ctx,
+                                    const std::vector<Tuple>& elements,
+                                    Tuple* batch);
+
  protected:
   enum Action { kEnqueue, kDequeue };
   enum RunResult { kNoProgress, kProgress, kComplete };
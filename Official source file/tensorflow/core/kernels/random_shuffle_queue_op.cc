@@ -15,7 +15,10 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
 #include <deque>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
@@ -424,17 +427,21 @@ void RandomShuffleQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
   }
 }
 
-Status RandomShuffleQueue::MatchesNodeDef(const NodeDef& node_def) {
-  TF_RETURN_IF_ERROR(MatchesNodeDefOp(node_def, "RandomShuffleQueue"));
-  TF_RETURN_IF_ERROR(MatchesNodeDefCapacity(node_def, capacity_));
-
-  int32 min_after_dequeue = -1;
-  TF_RETURN_IF_ERROR(
-      GetNodeAttr(node_def, "min_after_dequeue", &min_after_dequeue));
-  if (min_after_dequeue != min_after_dequeue_) {
+// Checks the attrs that the random shuffle queues add to those of QueueBase.
+static Status MatchesNodeDefShuffleAttrs(const NodeDef& node_def,
+                                         const string& name,
+                                         int32 min_after_dequeue,
+                                         int64 original_seed,
+                                         int64 original_seed2,
+                                         int32 num_shards) {
+  int32 requested_min_after_dequeue = -1;
+  TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "min_after_dequeue",
+                                 &requested_min_after_dequeue));
+  if (requested_min_after_dequeue != min_after_dequeue) {
     return errors::InvalidArgument(
-        "Shared queue '", name_, "' has min_after_dequeue ", min_after_dequeue_,
-        " but requested min_after_dequeue was ", min_after_dequeue, ".");
+        "Shared queue '", name, "' has min_after_dequeue ", min_after_dequeue,
+        " but requested min_after_dequeue was ", requested_min_after_dequeue,
+        ".");
   }
 
   int64 seed = -1;
@@ -442,13 +449,492 @@ Status RandomShuffleQueue::MatchesNodeDef(const NodeDef& node_def) {
   TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "seed", &seed));
   TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "seed2", &seed2));
   if ((seed != 0 || seed2 != 0) &&
-      (seed != original_seed_ || seed2 != original_seed2_)) {
+      (seed != original_seed || seed2 != original_seed2)) {
     return errors::InvalidArgument(
-        "Shared queue '", name_, "' has random seeds (", original_seed_, ", ",
-        original_seed2_, ") but requested seeds are (", seed, ", ", seed2,
+        "Shared queue '", name, "' has random seeds (", original_seed, ", ",
+        original_seed2, ") but requested seeds are (", seed, ", ", seed2,
         ").");
   }
 
+  int32 requested_num_shards = -1;
+  TF_RETURN_IF_ERROR(
+      GetNodeAttr(node_def, "num_shards", &requested_num_shards));
+  if (requested_num_shards != num_shards) {
+    return errors::InvalidArgument(
+        "Shared queue '", name, "' has num_shards ", num_shards,
+        " but requested num_shards was ", requested_num_shards, ".");
+  }
+  return Status::OK();
+}
+
+Status RandomShuffleQueue::MatchesNodeDef(const NodeDef& node_def) {
+  TF_RETURN_IF_ERROR(MatchesNodeDefOp(node_def, "RandomShuffleQueue"));
+  TF_RETURN_IF_ERROR(MatchesNodeDefCapacity(node_def, capacity_));
+  TF_RETURN_IF_ERROR(MatchesNodeDefShuffleAttrs(node_def, name_,
+                                                min_after_dequeue_,
+                                                original_seed_,
+                                                original_seed2_, 1));
+  TF_RETURN_IF_ERROR(MatchesNodeDefTypes(node_def));
+  TF_RETURN_IF_ERROR(MatchesNodeDefShapes(node_def));
+
+  return Status::OK();
+}
+
+// A RandomShuffleQueue whose elements are spread over num_shards
+// independently locked sub-buffers, so that mu_ is held only briefly when
+// many threads enqueue and dequeue at once. mu_ still orders the attempts
+// and guards the element count, but only O(1) work per element happens
+// under it: batches are split into elements before their attempt is queued,
+// and dequeued elements are taken out of their sub-buffers, and copied into
+// the output batch, after mu_ is released.
+//
+// A dequeue takes a uniformly random element of a random sub-buffer, which
+// mixes elements approximately as well as RandomShuffleQueue does as long
+// as each sub-buffer holds many elements. min_after_dequeue is enforced on
+// the total number of elements.
+class ShardedRandomShuffleQueue : public QueueBase {
+ public:
+  ShardedRandomShuffleQueue(int32 capacity, int32 min_after_dequeue,
+                            int32 num_shards, int64 seed, int64 seed2,
+                            const DataTypeVector& component_dtypes,
+                            const std::vector<TensorShape>& component_shapes,
+                            const string& name);
+
+  Status Initialize();  // Must be called before any other method.
+
+  // Implementations of QueueInterface methods --------------------------------
+  void TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
+                  DoneCallback callback) override;
+  void TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
+                      DoneCallback callback) override;
+  void TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) override;
+  void TryDequeueMany(int num_elements, OpKernelContext* ctx,
+                      bool allow_small_batch,
+                      CallbackWithTuple callback) override;
+  Status MatchesNodeDef(const NodeDef& node_def) override;
+
+  int32 size() override {
+    mutex_lock lock(mu_);
+    return num_elements_;
+  }
+
+ private:
+  typedef std::vector<PersistentTensor> Element;
+
+  struct SubBuffer {
+    SubBuffer(int64 seed, int64 seed2, uint64 subsequence);
+
+    mutex mu;
+    std::vector<Element> elements GUARDED_BY(mu);
+    random::PhiloxRandom parent_generator GUARDED_BY(mu);
+    random::SingleSampleAdapter<random::PhiloxRandom> generator GUARDED_BY(mu);
+  };
+
+  ~ShardedRandomShuffleQueue() override {}
+
+  // Moves *element into a random sub-buffer and counts it.
+  void InsertLocked(Element* element) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Takes a random element out of the sub-buffers into *tuple, looking at
+  // sub-buffer *shard first, and sets *shard to a random sub-buffer for the
+  // next call. The caller must have reserved the element by decrementing
+  // num_elements_. Must not be called while holding mu_.
+  void RemoveReserved(OpKernelContext* ctx, uint32* shard, Tuple* tuple);
+
+  static Status GetElementFromBatch(const Tuple& tuple, int64 index,
+                                    OpKernelContext* ctx, Element* element);
+
+  const int32 min_after_dequeue_;
+  const int64 original_seed_;
+  const int64 original_seed2_;
+  std::vector<std::unique_ptr<SubBuffer> > buffers_;
+
+  // The number of elements in buffers_ that no dequeue has reserved.
+  // buffers_ may additionally hold elements reserved by dequeues that have
+  // not taken them out yet.
+  int32 num_elements_ GUARDED_BY(mu_);
+
+  random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
+  random::SingleSampleAdapter<random::PhiloxRandom> generator_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardedRandomShuffleQueue);
+};
+
+ShardedRandomShuffleQueue::SubBuffer::SubBuffer(int64 seed, int64 seed2,
+                                                uint64 subsequence)
+    : parent_generator(seed, seed2), generator(&parent_generator) {
+  // Give every sub-buffer its own part of the seeded stream.
+  parent_generator.Skip(subsequence << 40);
+}
+
+ShardedRandomShuffleQueue::ShardedRandomShuffleQueue(
+    int32 capacity, int32 min_after_dequeue, int32 num_shards, int64 seed,
+    int64 seed2, const DataTypeVector& component_dtypes,
+    const std::vector<TensorShape>& component_shapes, const string& name)
+    : QueueBase(capacity, component_dtypes, component_shapes, name),
+      min_after_dequeue_(min_after_dequeue),
+      original_seed_(seed),
+      original_seed2_(seed2),
+      num_elements_(0),
+      generator_(&parent_generator_) {
+  if (seed == 0 && seed2 == 0) {
+    // If both seeds are unspecified, use completely random seeds.
+    seed = random::New64();
+    seed2 = random::New64();
+  }
+  parent_generator_ = random::PhiloxRandom(seed, seed2);
+  buffers_.reserve(num_shards);
+  for (int32 i = 0; i < num_shards; ++i) {
+    buffers_.emplace_back(new SubBuffer(seed, seed2, i + 1));
+  }
+}
+
+Status ShardedRandomShuffleQueue::Initialize() {
+  if (component_dtypes_.empty()) {
+    return errors::InvalidArgument("Empty component types for queue ", name_);
+  }
+  if (!component_shapes_.empty() &&
+      component_dtypes_.size() != component_shapes_.size()) {
+    return errors::InvalidArgument(
+        "Different number of component types.  ", "Types: ",
+        DataTypeSliceString(component_dtypes_), ", Shapes: ",
+        ShapeListString(component_shapes_));
+  }
+
+  const size_t buffer_size = min_after_dequeue_ / buffers_.size() + 1;
+  for (auto& buffer : buffers_) {
+    mutex_lock lock(buffer->mu);
+    buffer->elements.reserve(buffer_size);
+  }
+  return Status::OK();
+}
+
+void ShardedRandomShuffleQueue::InsertLocked(Element* element) {
+  SubBuffer* buffer = buffers_[generator_() % buffers_.size()].get();
+  {
+    mutex_lock lock(buffer->mu);
+    buffer->elements.push_back(std::move(*element));
+  }
+  ++num_elements_;
+}
+
+void ShardedRandomShuffleQueue::RemoveReserved(OpKernelContext* ctx,
+                                               uint32* shard, Tuple* tuple) {
+  // The reserved element is in some sub-buffer, but others may fill and
+  // drain the sub-buffers while we look, so keep going round until we find
+  // an element.
+  const uint32 num_shards = buffers_.size();
+  for (uint32 i = *shard;; ++i) {
+    SubBuffer* buffer = buffers_[i % num_shards].get();
+    mutex_lock lock(buffer->mu);
+    if (buffer->elements.empty()) continue;
+    const int64 index = buffer->generator() % buffer->elements.size();
+    std::swap(buffer->elements[index], buffer->elements.back());
+    const Element& element = buffer->elements.back();
+    tuple->reserve(num_components());
+    for (int j = 0; j < num_components(); ++j) {
+      tuple->push_back(*element[j].AccessTensor(ctx));
+    }
+    buffer->elements.pop_back();
+    *shard = buffer->generator();
+    return;
+  }
+}
+
+void ShardedRandomShuffleQueue::TryEnqueue(const Tuple& tuple,
+                                           OpKernelContext* ctx,
+                                           DoneCallback callback) {
+  CancellationManager* cm = ctx->cancellation_manager();
+  CancellationToken token = cm->get_cancellation_token();
+  bool already_cancelled;
+  {
+    mutex_lock l(mu_);
+    already_cancelled = !cm->RegisterCallback(
+        token, [this, cm, token]() { Cancel(kEnqueue, cm, token); });
+    if (!already_cancelled) {
+      enqueue_attempts_.emplace_back(
+          1, callback, ctx, cm, token,
+          [tuple, this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+            if (closed_) {
+              attempt->context->SetStatus(errors::Cancelled(
+                  "RandomShuffleQueue '", name_, "' is closed."));
+              return kComplete;
+            }
+            if (num_elements_ < capacity_) {
+              Element element;
+              element.reserve(num_components());
+              for (int i = 0; i < num_components(); ++i) {
+                element.push_back(PersistentTensor(tuple[i]));
+              }
+              InsertLocked(&element);
+              return kComplete;
+            } else {
+              return kNoProgress;
+            }
+          });
+    }
+  }
+  if (!already_cancelled) {
+    FlushUnlocked();
+  } else {
+    ctx->SetStatus(errors::Cancelled("Enqueue operation was cancelled"));
+    callback();
+  }
+}
+
+/* static */
+Status ShardedRandomShuffleQueue::GetElementFromBatch(const Tuple& tuple,
+                                                      int64 index,
+                                                      OpKernelContext* ctx,
+                                                      Element* element) {
+  // Elements leave in random order, so an element sharing the buffer of its
+  // batch would keep the whole batch alive until the last of them is
+  // dequeued. Copy them so that capacity bounds the memory of the queue.
+  element->reserve(tuple.size());
+  for (const Tensor& component : tuple) {
+    TensorShape element_shape(component.shape());
+    element_shape.RemoveDim(0);
+    PersistentTensor copy;
+    Tensor* copy_access = nullptr;
+    TF_RETURN_IF_ERROR(ctx->allocate_persistent(
+        component.dtype(), element_shape, &copy, &copy_access));
+    TF_RETURN_IF_ERROR(CopySliceToElement(component, copy_access, index));
+    element->push_back(copy);
+  }
+  return Status::OK();
+}
+
+void ShardedRandomShuffleQueue::TryEnqueueMany(const Tuple& tuple,
+                                               OpKernelContext* ctx,
+                                               DoneCallback callback) {
+  const int64 batch_size = tuple[0].dim_size(0);
+  if (batch_size == 0) {
+    callback();
+    return;
+  }
+
+  // Split the batch before taking mu_, so that the attempt only has to move
+  // the elements into the sub-buffers.
+  auto elements = std::make_shared<std::vector<Element> >(batch_size);
+  for (int64 index = 0; index < batch_size; ++index) {
+    Status s = GetElementFromBatch(tuple, index, ctx, &(*elements)[index]);
+    if (!s.ok()) {
+      ctx->SetStatus(s);
+      callback();
+      return;
+    }
+  }
+
+  CancellationManager* cm = ctx->cancellation_manager();
+  CancellationToken token = cm->get_cancellation_token();
+  bool already_cancelled;
+  {
+    mutex_lock l(mu_);
+    already_cancelled = !cm->RegisterCallback(
+        token, [this, cm, token]() { Cancel(kEnqueue, cm, token); });
+    if (!already_cancelled) {
+      enqueue_attempts_.emplace_back(
+          batch_size, callback, ctx, cm, token,
+          [elements, this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+            if (closed_) {
+              attempt->context->SetStatus(errors::Cancelled(
+                  "RandomShuffleQueue '", name_, "' is closed."));
+              return kComplete;
+            }
+            RunResult result = kNoProgress;
+            while (num_elements_ < capacity_) {
+              result = kProgress;
+              const int64 index =
+                  elements->size() - attempt->elements_requested;
+              InsertLocked(&(*elements)[index]);
+              --attempt->elements_requested;
+              if (attempt->elements_requested == 0) {
+                return kComplete;
+              }
+            }
+            return result;
+          });
+    }
+  }
+  if (!already_cancelled) {
+    FlushUnlocked();
+  } else {
+    ctx->SetStatus(errors::Cancelled("Enqueue operation was cancelled"));
+    callback();
+  }
+}
+
+void ShardedRandomShuffleQueue::TryDequeue(OpKernelContext* ctx,
+                                           CallbackWithTuple callback) {
+  CancellationManager* cm = ctx->cancellation_manager();
+  CancellationToken token = cm->get_cancellation_token();
+  bool already_cancelled;
+  {
+    mutex_lock l(mu_);
+    already_cancelled = !cm->RegisterCallback(
+        token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
+    if (!already_cancelled) {
+      dequeue_attempts_.emplace_back(
+          1, [callback]() { callback(Tuple()); }, ctx, cm, token,
+          [callback, this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+            int32 queue_size = num_elements_;
+            if (closed_ && queue_size == 0) {
+              attempt->context->SetStatus(errors::OutOfRange(
+                  "RandomShuffleQueue '", name_, "' is closed and has ",
+                  "insufficient elements (requested ", 1, ", current size ",
+                  queue_size, ")"));
+              return kComplete;
+            }
+            if (!closed_) queue_size -= min_after_dequeue_;
+            if (queue_size > 0) {
+              --num_elements_;
+              OpKernelContext* context = attempt->context;
+              uint32 shard = generator_();
+              attempt->done_callback = [callback, context, shard,
+                                        this]() mutable {
+                Tuple tuple;
+                RemoveReserved(context, &shard, &tuple);
+                callback(tuple);
+              };
+              return kComplete;
+            } else {
+              return kNoProgress;
+            }
+          });
+    }
+  }
+  if (!already_cancelled) {
+    FlushUnlocked();
+  } else {
+    ctx->SetStatus(errors::Cancelled("Dequeue operation was cancelled"));
+    callback(Tuple());
+  }
+}
+
+void ShardedRandomShuffleQueue::TryDequeueMany(int num_elements,
+                                               OpKernelContext* ctx,
+                                               bool allow_small_batch,
+                                               CallbackWithTuple callback) {
+  if (!specified_shapes()) {
+    ctx->SetStatus(errors::InvalidArgument(
+        "RandomShuffleQueue's DequeueMany and DequeueUpTo require the "
+        "components to have specified shapes."));
+    callback(Tuple());
+    return;
+  }
+  if (num_elements == 0) {
+    Tuple tuple;
+    tuple.reserve(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      Tensor element;
+      ctx->allocate_temp(component_dtypes_[i], ManyOutShape(i, 0), &element);
+      tuple.emplace_back(element);
+    }
+    callback(tuple);
+    return;
+  }
+
+  // The number of elements the attempt has reserved so far. They stay in
+  // buffers_ until the attempt completes, so they are handed back if the
+  // queue is closed with too few elements or the attempt is cancelled.
+  auto reserved = std::make_shared<int32>(0);
+
+  CancellationManager* cm = ctx->cancellation_manager();
+  CancellationToken token = cm->get_cancellation_token();
+  bool already_cancelled;
+  {
+    mutex_lock l(mu_);
+    already_cancelled = !cm->RegisterCallback(
+        token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
+    if (!already_cancelled) {
+      dequeue_attempts_.emplace_back(
+          num_elements,
+          [callback, reserved, this]() {
+            {
+              mutex_lock l(mu_);
+              num_elements_ += *reserved;
+              *reserved = 0;
+            }
+            callback(Tuple());
+          },
+          ctx, cm, token,
+          [callback, allow_small_batch, reserved, this](Attempt* attempt)
+              EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+                int32 queue_size = num_elements_;
+                if (closed_ && queue_size < attempt->elements_requested) {
+                  const int32 elements_requested =
+                      attempt->elements_requested;
+                  num_elements_ += *reserved;
+                  attempt->elements_requested += *reserved;
+                  *reserved = 0;
+                  if (allow_small_batch && num_elements_ > 0) {
+                    // Request all remaining elements in the queue.
+                    queue_size = num_elements_;
+                    attempt->elements_requested = queue_size;
+                  } else {
+                    if (allow_small_batch) {
+                      // There may be some other attempts containing
+                      // values.  If so, we'll yield and wait for them
+                      // to add elements to the queue.
+                      if (!enqueue_attempts_.empty()) return kProgress;
+                    }
+                    attempt->context->SetStatus(errors::OutOfRange(
+                        "RandomShuffleQueue '", name_, "' is closed and has ",
+                        "insufficient elements (requested ",
+                        elements_requested, ", current size ", queue_size,
+                        ")"));
+                    return kComplete;
+                  }
+                }
+
+                RunResult result = kNoProgress;
+                if (!closed_) queue_size -= min_after_dequeue_;
+                if (queue_size > 0) {
+                  result = kProgress;
+                  const int32 count =
+                      std::min(queue_size, attempt->elements_requested);
+                  num_elements_ -= count;
+                  *reserved += count;
+                  attempt->elements_requested -= count;
+                }
+                if (attempt->elements_requested == 0) {
+                  OpKernelContext* context = attempt->context;
+                  const int32 batch_size = *reserved;
+                  uint32 shard = generator_();
+                  attempt->done_callback = [callback, context, batch_size,
+                                            shard, this]() mutable {
+                    std::vector<Tuple> elements(batch_size);
+                    for (Tuple& element : elements) {
+                      RemoveReserved(context, &shard, &element);
+                    }
+                    Tuple batch;
+                    Status s = CopyElementsToBatch(context, elements, &batch);
+                    if (!s.ok()) {
+                      context->SetStatus(s);
+                      batch.clear();
+                    }
+                    callback(batch);
+                  };
+                  return kComplete;
+                }
+                return result;
+              });
+    }
+  }
+  if (!already_cancelled) {
+    FlushUnlocked();
+  } else {
+    ctx->SetStatus(errors::Cancelled("Dequeue operation was cancelled"));
+    callback(Tuple());
+  }
+}
+
+Status ShardedRandomShuffleQueue::MatchesNodeDef(const NodeDef& node_def) {
+  TF_RETURN_IF_ERROR(MatchesNodeDefOp(node_def, "RandomShuffleQueue"));
+  TF_RETURN_IF_ERROR(MatchesNodeDefCapacity(node_def, capacity_));
+  TF_RETURN_IF_ERROR(MatchesNodeDefShuffleAttrs(
+      node_def, name_, min_after_dequeue_, original_seed_, original_seed2_,
+      static_cast<int32>(buffers_.size())));
   TF_RETURN_IF_ERROR(MatchesNodeDefTypes(node_def));
   TF_RETURN_IF_ERROR(MatchesNodeDefShapes(node_def));
 
@@ -474,12 +960,27 @@ class RandomShuffleQueueOp : public QueueOp {
                                 " must be < capacity ", capacity_));
     OP_REQUIRES_OK(context, context->GetAttr("seed", &seed_));
     OP_REQUIRES_OK(context, context->GetAttr("seed2", &seed2_));
+    OP_REQUIRES_OK(context, context->GetAttr("num_shards", &num_shards_));
 
     OP_REQUIRES_OK(context, context->GetAttr("shapes", &component_shapes_));
   }
 
  protected:
   CreatorCallback GetCreator() const override {
+    if (num_shards_ > 1) {
+      return [this](QueueInterface** ret) {
+        auto* q = new ShardedRandomShuffleQueue(
+            capacity_, min_after_dequeue_, num_shards_, seed_, seed2_,
+            component_types_, component_shapes_, cinfo_.name());
+        Status s = q->Initialize();
+        if (s.ok()) {
+          *ret = q;
+        } else {
+          q->Unref();
+        }
+        return s;
+      };
+    }
     return [this](QueueInterface** ret) {
       auto* q = new RandomShuffleQueue(capacity_, min_after_dequeue_, seed_,
                                        seed2_, component_types_,
@@ -498,6 +999,7 @@ class RandomShuffleQueueOp : public QueueOp {
   int32 min_after_dequeue_;
   int64 seed_;
   int64 seed2_;
+  int32 num_shards_;
   std::vector<TensorShape> component_shapes_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RandomShuffleQueueOp);
@@ -15,11 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/range_sampler.h"
 
-#include <unordered_set>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
-#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -53,7 +57,10 @@ void RangeSampler::SampleBatchGetExpectedCount(
 
 namespace {
 
-// Approximates the expected count of a value in the output of SampleBatch.
+// Approximates the expected count of a value in the output of SampleBatch,
+// replacing each probability p in "counts" with the expected count of a value
+// with that probability.  Takes whole arrays so that the common unique=false
+// case is a single vectorizable loop.
 //
 // If unique=false, then this is (Probability(value) * batch_size)
 //
@@ -63,36 +70,83 @@ namespace {
 // Assuming (falsely) that the number of tries to get a batch of batch_size
 // distinct values is _always_ num_tries, the probability that the value
 // is in a batch is (1 - (1-p)^num_tries)
-static float ExpectedCountHelper(float p, int batch_size, int num_tries) {
+void ExpectedCountHelper(int batch_size, int num_tries,
+                         MutableArraySlice<float> counts) {
+  float* p = counts.data();
+  const int64 n = counts.size();
   if (num_tries == batch_size) {
     // This shortcut will always be taken if unique=false
-    return p * batch_size;
+    for (int64 i = 0; i < n; i++) {
+      p[i] *= batch_size;
+    }
+    return;
   }
   // numerically stable version of (1 - (1-p)^num_tries)
-  return -expm1(num_tries * log1p(-p));
+  for (int64 i = 0; i < n; i++) {
+    p[i] = -expm1(num_tries * log1p(-p[i]));
+  }
 }
 
-}  // namespace
+const int64 kEmptySlot = -1;
+
+// A set of values in [0, kint64max) holding at most "max_size" values, kept
+// in a single open addressing table so that unique sampling allocates once
+// per batch rather than once per value.
+class BoundedValueSet {
+ public:
+  explicit BoundedValueSet(int64 max_size) {
+    int log_capacity = 1;
+    while ((int64{1} << log_capacity) < 2 * max_size) ++log_capacity;
+    shift_ = 64 - log_capacity;
+    slots_.assign(int64{1} << log_capacity, kEmptySlot);
+  }
 
-void RangeSampler::SampleBatchGetExpectedCountAvoid(
-    random::SimplePhilox* rnd, bool unique, MutableArraySlice<int64> batch,
+  // Returns true if "value" was not in the set yet.
+  bool Insert(int64 value) {
+    DCHECK_GE(value, 0);
+    const uint64 mask = slots_.size() - 1;
+    for (uint64 i = (static_cast<uint64>(value) * 0x9E3779B97F4A7C15ull) >>
+                    shift_;
+         ; i = (i + 1) & mask) {
+      if (slots_[i] == value) return false;
+      if (slots_[i] == kEmptySlot) {
+        slots_[i] = value;
+        return true;
+      }
+    }
+  }
+
+ private:
+  int shift_;
+  std::vector<int64> slots_;
+};
+
+// Implements RangeSampler::SampleBatchGetExpectedCountAvoid for any "sampler"
+// with Sample() and Probability() methods, so that samplers can sample a
+// batch without a virtual call per value.
+template <class Sampler>
+void SampleBatchGetExpectedCountAvoidImpl(
+    const Sampler& sampler, int64 range, random::SimplePhilox* rnd,
+    bool unique, MutableArraySlice<int64> batch,
     MutableArraySlice<float> batch_expected_count, ArraySlice<int64> extras,
     MutableArraySlice<float> extras_expected_count,
-    ArraySlice<int64> avoided_values) const {
+    ArraySlice<int64> avoided_values) {
   const int batch_size = batch.size();
   int num_tries;
 
   if (unique) {
-    CHECK_LE(batch_size + avoided_values.size(), range_);
-    std::unordered_set<int64> used(batch_size);
-    used.insert(avoided_values.begin(), avoided_values.end());
+    CHECK_LE(batch_size + avoided_values.size(), range);
+    BoundedValueSet used(batch_size + avoided_values.size());
+    for (const int64 value : avoided_values) {
+      used.Insert(value);
+    }
     int num_picked = 0;
     num_tries = 0;
     while (num_picked < batch_size) {
       num_tries++;
       CHECK_LT(num_tries, kint32max);
-      int64 value = Sample(rnd);
-      if (gtl::InsertIfNotPresent(&used, value)) {
+      int64 value = sampler.Sample(rnd);
+      if (used.Insert(value)) {
         batch[num_picked++] = value;
       }
     }
@@ -100,7 +154,7 @@ void RangeSampler::SampleBatchGetExpectedCountAvoid(
     CHECK_EQ(avoided_values.size(), size_t{0})
         << "avoided_values only supported with unique=true";
     for (int i = 0; i < batch_size; i++) {
-      batch[i] = Sample(rnd);
+      batch[i] = sampler.Sample(rnd);
     }
     num_tries = batch_size;
   }
@@ -108,15 +162,27 @@ void RangeSampler::SampleBatchGetExpectedCountAvoid(
   if (batch_expected_count.size() > 0) {
     CHECK_EQ(batch_size, batch_expected_count.size());
     for (int i = 0; i < batch_size; i++) {
-      batch_expected_count[i] =
-          ExpectedCountHelper(Probability(batch[i]), batch_size, num_tries);
+      batch_expected_count[i] = sampler.Probability(batch[i]);
     }
+    ExpectedCountHelper(batch_size, num_tries, batch_expected_count);
   }
   CHECK_EQ(extras.size(), extras_expected_count.size());
   for (size_t i = 0; i < extras.size(); i++) {
-    extras_expected_count[i] =
-        ExpectedCountHelper(Probability(extras[i]), batch_size, num_tries);
+    extras_expected_count[i] = sampler.Probability(extras[i]);
   }
+  ExpectedCountHelper(batch_size, num_tries, extras_expected_count);
+}
+
+}  // namespace
+
+void RangeSampler::SampleBatchGetExpectedCountAvoid(
+    random::SimplePhilox* rnd, bool unique, MutableArraySlice<int64> batch,
+    MutableArraySlice<float> batch_expected_count, ArraySlice<int64> extras,
+    MutableArraySlice<float> extras_expected_count,
+    ArraySlice<int64> avoided_values) const {
+  SampleBatchGetExpectedCountAvoidImpl(*this, range_, rnd, unique, batch,
+                                       batch_expected_count, extras,
+                                       extras_expected_count, avoided_values);
 }
 
 AllSampler::AllSampler(int64 range) : RangeSampler(range) {}
@@ -196,37 +262,202 @@ void ThreadUnsafeUnigramSampler::Update(ArraySlice<int64> values) {
   }
 }
 
-// Thread-safe unigram sampler
-UnigramSampler::UnigramSampler(int64 range)
-    : RangeSampler(range), unsafe_sampler_(range) {
+namespace {
+
+// Unigram counts, and an alias table to sample from them.
+class UnigramTable {
+ public:
+  explicit UnigramTable(std::vector<int32> counts)
+      : counts_(std::move(counts)),
+        total_(std::accumulate(counts_.begin(), counts_.end(), int64{0})),
+        sampler_(std::vector<float>(counts_.begin(), counts_.end())) {}
+
+  const std::vector<int32>& counts() const { return counts_; }
+  int64 total() const { return total_; }
+
+  int64 Sample(random::SimplePhilox* rnd) const {
+    return sampler_.Sample(rnd);
+  }
+
+ private:
+  const std::vector<int32> counts_;
+  const int64 total_;
+  const random::DistributionSampler sampler_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(UnigramTable);
+};
+
+}  // namespace
+
+// The counts of a table, plus the increments made since the table was built:
+// values_[i] was seen counts_[i] more times.  values_ is sorted.
+class UnigramSampler::Snapshot {
+ public:
+  Snapshot(std::shared_ptr<const UnigramTable> table,
+           std::vector<int64> values, std::vector<int32> counts)
+      : table_(std::move(table)),
+        values_(std::move(values)),
+        counts_(std::move(counts)),
+        cumulative_(counts_.size()) {
+    std::partial_sum(counts_.begin(), counts_.end(), cumulative_.begin());
+    total_ = table_->total() + (cumulative_.empty() ? 0 : cumulative_.back());
+  }
+
+  int64 Sample(random::SimplePhilox* rnd) const {
+    if (values_.empty()) return table_->Sample(rnd);
+    const int64 r = rnd->Uniform64(total_);
+    if (r < table_->total()) return table_->Sample(rnd);
+    const auto it = std::upper_bound(cumulative_.begin(), cumulative_.end(),
+                                     r - table_->total());
+    return values_[it - cumulative_.begin()];
+  }
+
+  float Probability(int64 value) const {
+    int64 count = table_->counts()[value];
+    const auto it = std::lower_bound(values_.begin(), values_.end(), value);
+    if (it != values_.end() && *it == value) {
+      count += counts_[it - values_.begin()];
+    }
+    return static_cast<float>(count) / total_;
+  }
+
+  const std::shared_ptr<const UnigramTable>& table() const { return table_; }
+  const std::vector<int64>& values() const { return values_; }
+  const std::vector<int32>& counts() const { return counts_; }
+  int64 total() const { return total_; }
+
+ private:
+  const std::shared_ptr<const UnigramTable> table_;
+  const std::vector<int64> values_;
+  const std::vector<int32> counts_;
+  std::vector<int64> cumulative_;
+  int64 total_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Snapshot);
+};
+
+UnigramSampler::UnigramSampler(int64 range) : RangeSampler(range) {
   CHECK_LT(range, kint32max);
+  // Every value starts with a count of 1.
+  snapshots_[0].reset(
+      new Snapshot(std::shared_ptr<const UnigramTable>(
+                       new UnigramTable(std::vector<int32>(range, 1))),
+                   {}, {}));
+  current_ = 0;
+  readers_[0] = 0;
+  readers_[1] = 0;
+}
+
+UnigramSampler::~UnigramSampler() {}
+
+const UnigramSampler::Snapshot* UnigramSampler::AcquireSnapshot(
+    int* slot) const {
+  while (true) {
+    const int s = current_.load();
+    readers_[s].fetch_add(1);
+    // If Update() flipped current_ before we registered, it may be rebuilding
+    // slot "s" now; retry with the new current slot.
+    if (current_.load() == s) {
+      *slot = s;
+      return snapshots_[s].get();
+    }
+    readers_[s].fetch_sub(1);
+  }
+}
+
+void UnigramSampler::ReleaseSnapshot(int slot) const {
+  readers_[slot].fetch_sub(1);
 }
 
 int64 UnigramSampler::Sample(random::SimplePhilox* rnd) const {
-  mutex_lock lock(mu_);  // could use reader lock
-  return unsafe_sampler_.Sample(rnd);
+  int slot;
+  const Snapshot* snapshot = AcquireSnapshot(&slot);
+  const int64 value = snapshot->Sample(rnd);
+  ReleaseSnapshot(slot);
+  return value;
 }
 
 float UnigramSampler::Probability(int64 value) const {
-  mutex_lock lock(mu_);  // could use reader lock
-  return unsafe_sampler_.Probability(value);
+  int slot;
+  const Snapshot* snapshot = AcquireSnapshot(&slot);
+  const float p = snapshot->Probability(value);
+  ReleaseSnapshot(slot);
+  return p;
 }
 
-// Overriding at a high level results in far fewer lock acquisitions.
 void UnigramSampler::SampleBatchGetExpectedCountAvoid(
     random::SimplePhilox* rnd, bool unique, MutableArraySlice<int64> batch,
     MutableArraySlice<float> batch_expected_count, ArraySlice<int64> extras,
     MutableArraySlice<float> extras_expected_count,
     ArraySlice<int64> avoided_values) const {
-  mutex_lock lock(mu_);  // could use reader lock
-  unsafe_sampler_.SampleBatchGetExpectedCountAvoid(
-      rnd, unique, batch, batch_expected_count, extras, extras_expected_count,
-      avoided_values);
+  int slot;
+  const Snapshot* snapshot = AcquireSnapshot(&slot);
+  auto release = gtl::MakeCleanup([this, slot] { ReleaseSnapshot(slot); });
+  SampleBatchGetExpectedCountAvoidImpl(*snapshot, range_, rnd, unique, batch,
+                                       batch_expected_count, extras,
+                                       extras_expected_count, avoided_values);
 }
 
 void UnigramSampler::Update(ArraySlice<int64> values) {
   mutex_lock lock(mu_);
-  unsafe_sampler_.Update(values);
+  const int current = current_.load();
+  const Snapshot& old = *snapshots_[current];
+
+  // As in ThreadUnsafeUnigramSampler, the total count stays below kint32max.
+  const int64 num_updates =
+      std::min<int64>(values.size(), kint32max - old.total());
+  std::vector<int64> sorted(values.begin(), values.begin() + num_updates);
+  std::sort(sorted.begin(), sorted.end());
+
+  // Merge the new values into the increments of the old snapshot.
+  std::vector<int64> new_values;
+  std::vector<int32> new_counts;
+  new_values.reserve(old.values().size() + sorted.size());
+  new_counts.reserve(old.values().size() + sorted.size());
+  size_t i = 0;
+  size_t j = 0;
+  while (i < old.values().size() || j < sorted.size()) {
+    int64 value;
+    int32 count = 0;
+    if (j == sorted.size() ||
+        (i < old.values().size() && old.values()[i] <= sorted[j])) {
+      value = old.values()[i];
+      count = old.counts()[i];
+      i++;
+    } else {
+      value = sorted[j];
+    }
+    for (; j < sorted.size() && sorted[j] == value; j++) count++;
+    new_values.push_back(value);
+    new_counts.push_back(count);
+  }
+
+  // Every update copies the increments, and rebuilding the table costs
+  // O(range); folding the increments into the table once there are about
+  // sqrt(range * values.size()) of them balances the two.
+  std::shared_ptr<const UnigramTable> table = old.table();
+  const size_t max_increments = std::max<size_t>(
+      64, static_cast<size_t>(
+              std::sqrt(static_cast<double>(range_) * values.size())));
+  if (new_values.size() > max_increments) {
+    std::vector<int32> counts = table->counts();
+    for (size_t k = 0; k < new_values.size(); k++) {
+      counts[new_values[k]] += new_counts[k];
+    }
+    table.reset(new UnigramTable(std::move(counts)));
+    new_values.clear();
+    new_counts.clear();
+  }
+
+  // Readers that acquired the other slot before the last flip may still be
+  // using it.  They hold it for at most one batch.
+  const int next = 1 - current;
+  while (readers_[next].load() > 0) {
+    std::this_thread::yield();
+  }
+  snapshots_[next].reset(new Snapshot(std::move(table), std::move(new_values),
+                                      std::move(new_counts)));
+  current_.store(next);
 }
 
 FixedUnigramSampler::FixedUnigramSampler(Env* env, int64 range,
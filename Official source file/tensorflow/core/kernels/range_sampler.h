@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_RANGE_SAMPLER_H_
 #define TENSORFLOW_KERNELS_RANGE_SAMPLER_H_
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/lib/random/weighted_picker.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
@@ -175,17 +178,23 @@ class ThreadUnsafeUnigramSampler : public RangeSampler {
   random::WeightedPicker picker_;
 };
 
-// Thread-safe unigram sampler
+// Thread-safe unigram sampler.
+//
+// Sampling never blocks: readers use an immutable snapshot of the counts,
+// and Update() publishes a new snapshot instead of modifying the current
+// one.  A snapshot samples the counts as of its last rebuild from an alias
+// table (random::DistributionSampler), and the increments since then from a
+// short sorted list, so most updates only copy that list.
 class UnigramSampler : public RangeSampler {
  public:
   explicit UnigramSampler(int64 range);
-  ~UnigramSampler() override {}
+  ~UnigramSampler() override;
 
   int64 Sample(random::SimplePhilox* rnd) const override;
 
   float Probability(int64 value) const override;
 
-  // Overriding at a high level results in far fewer lock acquisitions.
+  // Samples the whole batch from one snapshot.
   void SampleBatchGetExpectedCountAvoid(
       random::SimplePhilox* rnd, bool unique,
       gtl::MutableArraySlice<int64> batch,
@@ -198,8 +207,22 @@ class UnigramSampler : public RangeSampler {
   void Update(gtl::ArraySlice<int64> values) override;
 
  private:
-  ThreadUnsafeUnigramSampler unsafe_sampler_ GUARDED_BY(mu_);
-  mutable mutex mu_;
+  class Snapshot;
+
+  // Returns the current snapshot, which stays valid until
+  // ReleaseSnapshot(*slot) is called.
+  const Snapshot* AcquireSnapshot(int* slot) const;
+  void ReleaseSnapshot(int slot) const;
+
+  // Readers use snapshots_[current_].  Update() builds the next snapshot in
+  // the other slot once no reader holds it anymore, then flips current_.
+  std::unique_ptr<const Snapshot> snapshots_[2];
+  std::atomic<int> current_;
+  mutable std::atomic<int> readers_[2];
+
+  mutex mu_;  // Serializes Update().
+
+  TF_DISALLOW_COPY_AND_ASSIGN(UnigramSampler);
 };
 
 // A unigram sampler that uses a fixed unigram distribution read from a
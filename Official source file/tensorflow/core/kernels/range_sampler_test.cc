@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/range_sampler.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/env.h"
@@ -143,6 +144,72 @@ TEST_F(RangeSamplerTest, UnigramHistogram) {
   CheckHistogram(1000, 0.05);
 }
 
+TEST_F(RangeSamplerTest, UnigramProbabilitiesManyUpdates) {
+  // Enough updates that the increments are folded into the alias table
+  // several times.
+  const int range = 1000;
+  sampler_.reset(new UnigramSampler(range));
+  std::vector<int64> counts(range, 1);
+  int64 total = range;
+  random::PhiloxRandom philox(123, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int step = 0; step < 100; step++) {
+    std::vector<int64> values(50);
+    for (int64& value : values) {
+      value = rnd.Uniform(step % 2 == 0 ? range : 37);
+      counts[value]++;
+    }
+    total += values.size();
+    sampler_->Update(values);
+    for (int i = 0; i < range; i++) {
+      ASSERT_EQ(static_cast<float>(counts[i]) / total,
+                sampler_->Probability(i));
+    }
+  }
+  CheckProbabilitiesSumToOne();
+  CheckHistogram(100000, 0.005);
+}
+
+TEST_F(RangeSamplerTest, UnigramConcurrentSampleAndUpdate) {
+  const int range = 100;
+  const int num_samplers = 4;
+  sampler_.reset(new UnigramSampler(range));
+  std::vector<int64> counts(range, 1);
+  int64 total = range;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", num_samplers);
+    for (int t = 0; t < num_samplers; t++) {
+      pool.Schedule([this, t]() {
+        random::PhiloxRandom philox(123, t);
+        random::SimplePhilox rnd(&philox);
+        std::vector<int64> batch(50);
+        std::vector<float> expected(50);
+        for (int i = 0; i < 200; i++) {
+          sampler_->SampleBatchGetExpectedCount(&rnd, t % 2 == 0, &batch,
+                                                &expected, {}, {});
+          for (int j = 0; j < 50; j++) {
+            ASSERT_GE(batch[j], 0);
+            ASSERT_LT(batch[j], range);
+            ASSERT_GT(expected[j], 0);
+          }
+        }
+      });
+    }
+    for (int step = 0; step < 200; step++) {
+      std::vector<int64> values(10);
+      for (int i = 0; i < 10; i++) {
+        values[i] = (step * 7 + i) % range;
+        counts[values[i]]++;
+      }
+      total += values.size();
+      sampler_->Update(values);
+    }
+  }
+  for (int i = 0; i < range; i++) {
+    EXPECT_EQ(static_cast<float>(counts[i]) / total, sampler_->Probability(i));
+  }
+}
+
 static const char kVocabContent[] =
     "w1,1\n"
     "w2,2\n"
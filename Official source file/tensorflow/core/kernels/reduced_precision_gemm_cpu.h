@@ -0,0 +1,290 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_REDUCED_PRECISION_GEMM_CPU_H_
+#define TENSORFLOW_KERNELS_REDUCED_PRECISION_GEMM_CPU_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/half.h"
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Matrix multiplication for operands stored as Eigen::half or bfloat16, with
+// float arithmetic and float accumulation.
+//
+// Operands are read through packers, which convert one block of an operand
+// at a time into a float panel; no float copy of a whole operand is ever
+// made.  A packer provides
+//
+//   // Writes rows [row0, row0 + rows) and columns [col0, col0 + cols) of the
+//   // operand to "dst", row-major, or column-major if col_major() is true.
+//   void Pack(int64 row0, int64 rows, int64 col0, int64 cols,
+//             float* dst) const;
+//   bool col_major() const;
+//
+// The output is split into tiles that are computed in parallel.  Each tile
+// is accumulated in float by multiplying panels of the operands with Eigen,
+// and converted to T once at the end.
+
+namespace reduced_precision_gemm_internal {
+
+inline void ConvertToFloat(const Eigen::half* src, float* dst, int64 size) {
+  HalfToFloat(src, dst, size);
+}
+inline void ConvertToFloat(const bfloat16* src, float* dst, int64 size) {
+  BFloat16ToFloat(src, dst, size);
+}
+inline void ConvertFromFloat(const float* src, Eigen::half* dst, int64 size) {
+  FloatToHalf(src, dst, size);
+}
+inline void ConvertFromFloat(const float* src, bfloat16* dst, int64 size) {
+  FloatToBFloat16(src, dst, size);
+}
+
+typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    RowMajorMatrix;
+typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>
+    ColMajorMatrix;
+
+// Computes out = lhs * rhs, or out += lhs * rhs if "accumulate", for float
+// panels of the given storage orders.  "out" is row-major.
+template <typename LhsMatrix, typename RhsMatrix>
+void MultiplyPanels(const float* lhs, const float* rhs, int64 rows,
+                    int64 depth, int64 cols, bool accumulate, float* out) {
+  Eigen::Map<const LhsMatrix> l(lhs, rows, depth);
+  Eigen::Map<const RhsMatrix> r(rhs, depth, cols);
+  Eigen::Map<RowMajorMatrix> o(out, rows, cols);
+  if (accumulate) {
+    o.noalias() += l * r;
+  } else {
+    o.noalias() = l * r;
+  }
+}
+
+typedef void (*MultiplyPanelsFn)(const float*, const float*, int64, int64,
+                                 int64, bool, float*);
+
+inline MultiplyPanelsFn GetMultiplyPanels(bool lhs_col_major,
+                                          bool rhs_col_major) {
+  if (lhs_col_major) {
+    return rhs_col_major ? &MultiplyPanels<ColMajorMatrix, ColMajorMatrix>
+                         : &MultiplyPanels<ColMajorMatrix, RowMajorMatrix>;
+  }
+  return rhs_col_major ? &MultiplyPanels<RowMajorMatrix, ColMajorMatrix>
+                       : &MultiplyPanels<RowMajorMatrix, RowMajorMatrix>;
+}
+
+// Tile sizes, in elements.  Panels of these sizes stay in the L2 cache.
+const int64 kTileRows = 256;
+const int64 kTileCols = 256;
+const int64 kMinTileCols = 32;
+const int64 kTileDepth = 256;
+
+// With at most this many rows, as in inference with small batches, reading
+// the right operand dominates.  Its panels are then made wide and shallow,
+// up to kMaxPanelSize elements, so that they are read in long runs.
+const int64 kMaxNarrowRows = 16;
+const int64 kMaxPanelSize = 64 << 10;
+const int64 kMinNarrowTileDepth = 32;
+
+}  // namespace reduced_precision_gemm_internal
+
+// Packs blocks of a row-major "rows" x "cols" matrix, or of its transpose if
+// "transposed".
+template <typename T>
+class ReducedPrecisionMatrixPacker {
+ public:
+  ReducedPrecisionMatrixPacker(const T* data, int64 rows, int64 cols,
+                               bool transposed)
+      : data_(data), cols_(cols), transposed_(transposed) {}
+
+  bool col_major() const { return transposed_; }
+
+  void Pack(int64 row0, int64 rows, int64 col0, int64 cols, float* dst) const {
+    using reduced_precision_gemm_internal::ConvertToFloat;
+    // Either way, each line of the panel is contiguous in the matrix.
+    if (!transposed_) {
+      for (int64 r = 0; r < rows; ++r) {
+        ConvertToFloat(data_ + (row0 + r) * cols_ + col0, dst + r * cols,
+                       cols);
+      }
+    } else {
+      for (int64 c = 0; c < cols; ++c) {
+        ConvertToFloat(data_ + (col0 + c) * cols_ + row0, dst + c * rows,
+                       rows);
+      }
+    }
+  }
+
+ private:
+  const T* data_;
+  const int64 cols_;
+  const bool transposed_;
+};
+
+// Packs blocks of the image patch matrix of a 2D convolution over an NHWC
+// "input": row ((b * out_rows) + y) * out_cols + x holds the patch of output
+// pixel (b, y, x), column (fy * filter_cols + fx) * in_depth + d holds input
+// channel d under filter tap (fy, fx), and taps outside the image are zero.
+// Multiplying it by the filter, viewed as a
+// [filter_rows * filter_cols * in_depth, out_depth] matrix, gives the
+// convolution.
+template <typename T>
+class ReducedPrecisionConv2DPatchPacker {
+ public:
+  struct Geometry {
+    int64 in_rows;
+    int64 in_cols;
+    int64 in_depth;
+    int64 filter_rows;
+    int64 filter_cols;
+    int64 stride_rows;
+    int64 stride_cols;
+    int64 pad_rows;
+    int64 pad_cols;
+    int64 out_rows;
+    int64 out_cols;
+  };
+
+  ReducedPrecisionConv2DPatchPacker(const T* input, const Geometry& geometry)
+      : input_(input), g_(geometry) {}
+
+  bool col_major() const { return false; }
+
+  void Pack(int64 row0, int64 rows, int64 col0, int64 cols, float* dst) const {
+    using reduced_precision_gemm_internal::ConvertToFloat;
+    for (int64 r = 0; r < rows; ++r) {
+      const int64 patch = row0 + r;
+      const int64 x = patch % g_.out_cols;
+      const int64 y = (patch / g_.out_cols) % g_.out_rows;
+      const int64 b = patch / (g_.out_cols * g_.out_rows);
+      float* out = dst + r * cols;
+      for (int64 c = col0, end = col0 + cols; c < end;) {
+        const int64 tap = c / g_.in_depth;
+        const int64 d = c - tap * g_.in_depth;
+        const int64 fy = tap / g_.filter_cols;
+        const int64 fx = tap - fy * g_.filter_cols;
+        const int64 iy = y * g_.stride_rows - g_.pad_rows + fy;
+        const int64 ix = x * g_.stride_cols - g_.pad_cols + fx;
+        // Consecutive taps of a filter row read consecutive input pixels, so
+        // find how many of them are all inside or all outside the image.
+        int64 taps;
+        bool inside = false;
+        if (iy < 0 || iy >= g_.in_rows || ix >= g_.in_cols) {
+          taps = g_.filter_cols - fx;
+        } else if (ix < 0) {
+          taps = std::min(-ix, g_.filter_cols - fx);
+        } else {
+          taps = std::min(g_.in_cols - ix, g_.filter_cols - fx);
+          inside = true;
+        }
+        const int64 len = std::min(taps * g_.in_depth - d, end - c);
+        if (inside) {
+          ConvertToFloat(
+              input_ + ((b * g_.in_rows + iy) * g_.in_cols + ix) * g_.in_depth +
+                  d,
+              out, len);
+        } else {
+          std::fill(out, out + len, 0.0f);
+        }
+        out += len;
+        c += len;
+      }
+    }
+  }
+
+ private:
+  const T* input_;
+  const Geometry g_;
+};
+
+// Computes the row-major m x n matrix "out" = lhs * rhs, where "lhs" packs an
+// m x k operand and "rhs" a k x n operand.  Requires m, n, k > 0.
+template <typename T, typename LhsPacker, typename RhsPacker>
+void ReducedPrecisionGemm(DeviceBase* d, int64 m, int64 n, int64 k,
+                          const LhsPacker& lhs, const RhsPacker& rhs, T* out) {
+  using reduced_precision_gemm_internal::ConvertFromFloat;
+  using reduced_precision_gemm_internal::kMaxNarrowRows;
+  using reduced_precision_gemm_internal::kMaxPanelSize;
+  using reduced_precision_gemm_internal::kMinNarrowTileDepth;
+  using reduced_precision_gemm_internal::kMinTileCols;
+  using reduced_precision_gemm_internal::kTileCols;
+  using reduced_precision_gemm_internal::kTileDepth;
+  using reduced_precision_gemm_internal::kTileRows;
+  using reduced_precision_gemm_internal::MultiplyPanelsFn;
+  const auto* worker_threads = d->tensorflow_cpu_worker_threads();
+  const int64 num_threads = worker_threads->num_threads;
+  const int64 tile_rows = std::min(m, kTileRows);
+  const int64 row_tiles = (m + tile_rows - 1) / tile_rows;
+  int64 tile_cols;
+  int64 tile_depth;
+  if (m <= kMaxNarrowRows) {
+    // One column tile per thread, as wide as the panel size allows.
+    tile_cols = std::min((n + num_threads - 1) / num_threads,
+                         kMaxPanelSize / kMinNarrowTileDepth);
+    tile_depth = std::max(kMinNarrowTileDepth, kMaxPanelSize / tile_cols);
+  } else {
+    // Narrow the columns until every thread has a tile.
+    tile_cols = kTileCols;
+    while (tile_cols > kMinTileCols &&
+           row_tiles * ((n + tile_cols - 1) / tile_cols) < num_threads) {
+      tile_cols /= 2;
+    }
+    tile_depth = kTileDepth;
+  }
+  tile_cols = std::min(n, std::max<int64>(tile_cols, 1));
+  tile_depth = std::min(k, tile_depth);
+  const int64 col_tiles = (n + tile_cols - 1) / tile_cols;
+  const MultiplyPanelsFn multiply =
+      reduced_precision_gemm_internal::GetMultiplyPanels(lhs.col_major(),
+                                                         rhs.col_major());
+
+  auto work = [&](int64 begin, int64 end) {
+    std::vector<float> lhs_panel(tile_rows * tile_depth);
+    std::vector<float> rhs_panel(tile_depth * tile_cols);
+    std::vector<float> acc(tile_rows * tile_cols);
+    for (int64 tile = begin; tile < end; ++tile) {
+      const int64 row0 = (tile / col_tiles) * tile_rows;
+      const int64 col0 = (tile % col_tiles) * tile_cols;
+      const int64 rows = std::min(tile_rows, m - row0);
+      const int64 cols = std::min(tile_cols, n - col0);
+      for (int64 depth0 = 0; depth0 < k; depth0 += tile_depth) {
+        const int64 depth = std::min(tile_depth, k - depth0);
+        lhs.Pack(row0, rows, depth0, depth, lhs_panel.data());
+        rhs.Pack(depth0, depth, col0, cols, rhs_panel.data());
+        multiply(lhs_panel.data(), rhs_panel.data(), rows, depth, cols,
+                 depth0 > 0, acc.data());
+      }
+      for (int64 r = 0; r < rows; ++r) {
+        ConvertFromFloat(acc.data() + r * cols, out + (row0 + r) * n + col0,
+                         cols);
+      }
+    }
+  };
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        row_tiles * col_tiles, 2 * tile_rows * tile_cols * k, work);
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_REDUCED_PRECISION_GEMM_CPU_H_
@@ -0,0 +1,239 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/reduced_precision_gemm_cpu.h"
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class TestDevice : public DeviceBase {
+ public:
+  TestDevice() : DeviceBase(Env::Default()), pool_(Env::Default(), "test", 4) {
+    threads_.num_threads = 4;
+    threads_.workers = &pool_;
+    set_tensorflow_cpu_worker_threads(&threads_);
+  }
+
+ private:
+  thread::ThreadPool pool_;
+  CpuWorkerThreads threads_;
+};
+
+float ToFloat(Eigen::half h) { return static_cast<float>(h); }
+float ToFloat(bfloat16 b) {
+  float f;
+  BFloat16ToFloat(&b, &f, 1);
+  return f;
+}
+
+// Relative error of converting a float result to T.
+template <typename T>
+float Epsilon();
+template <>
+float Epsilon<Eigen::half>() {
+  return 1.0f / 1024;
+}
+template <>
+float Epsilon<bfloat16>() {
+  return 1.0f / 128;
+}
+
+template <typename T>
+T FromFloat(float f) {
+  T value;
+  reduced_precision_gemm_internal::ConvertFromFloat(&f, &value, 1);
+  return value;
+}
+
+template <typename T>
+std::vector<T> RandomValues(int64 size, random::SimplePhilox* rnd) {
+  std::vector<float> floats(size);
+  for (float& f : floats) f = rnd->RandFloat() * 2 - 1;
+  std::vector<T> values(size);
+  reduced_precision_gemm_internal::ConvertFromFloat(floats.data(),
+                                                    values.data(), size);
+  return values;
+}
+
+// Checks "out" against products computed in double from "lhs" and "rhs",
+// given as functions of (row, depth) and (depth, col).
+template <typename T, typename LhsFn, typename RhsFn>
+void CheckProduct(int64 m, int64 n, int64 k, const LhsFn& lhs,
+                  const RhsFn& rhs, const std::vector<T>& out) {
+  for (int64 i = 0; i < m; ++i) {
+    for (int64 j = 0; j < n; ++j) {
+      double expected = 0;
+      double magnitude = 0;
+      for (int64 l = 0; l < k; ++l) {
+        const double product = ToFloat(lhs(i, l)) * ToFloat(rhs(l, j));
+        expected += product;
+        magnitude += std::abs(product);
+      }
+      ASSERT_NEAR(expected, ToFloat(out[i * n + j]),
+                  Epsilon<T>() * magnitude + 1e-6)
+          << "m=" << m << " n=" << n << " k=" << k << " at " << i << ", "
+          << j;
+    }
+  }
+}
+
+template <typename T>
+void CheckMatMul(int64 m, int64 n, int64 k, bool transpose_a,
+                 bool transpose_b) {
+  random::PhiloxRandom philox(m * 1000 + n, k);
+  random::SimplePhilox rnd(&philox);
+  const std::vector<T> a = RandomValues<T>(m * k, &rnd);
+  const std::vector<T> b = RandomValues<T>(k * n, &rnd);
+  ReducedPrecisionMatrixPacker<T> lhs(a.data(), transpose_a ? k : m,
+                                      transpose_a ? m : k, transpose_a);
+  ReducedPrecisionMatrixPacker<T> rhs(b.data(), transpose_b ? n : k,
+                                      transpose_b ? k : n, transpose_b);
+  std::vector<T> out(m * n);
+  TestDevice device;
+  ReducedPrecisionGemm(&device, m, n, k, lhs, rhs, out.data());
+  CheckProduct(m, n, k,
+               [&](int64 i, int64 l) {
+                 return transpose_a ? a[l * m + i] : a[i * k + l];
+               },
+               [&](int64 l, int64 j) {
+                 return transpose_b ? b[j * k + l] : b[l * n + j];
+               },
+               out);
+}
+
+template <typename T>
+void CheckAllMatMuls() {
+  // Shapes below, at and above the tile sizes, and vector products.
+  const int64 shapes[][3] = {{1, 1, 1},      {3, 5, 7},     {1, 600, 1000},
+                             {600, 1, 300},  {257, 70, 513}, {64, 300, 64},
+                             {300, 270, 20}};
+  for (const auto& shape : shapes) {
+    for (bool transpose_a : {false, true}) {
+      for (bool transpose_b : {false, true}) {
+        CheckMatMul<T>(shape[0], shape[1], shape[2], transpose_a, transpose_b);
+      }
+    }
+  }
+}
+
+TEST(ReducedPrecisionGemmTest, HalfMatMul) { CheckAllMatMuls<Eigen::half>(); }
+
+TEST(ReducedPrecisionGemmTest, BFloat16MatMul) {
+  CheckAllMatMuls<bfloat16>();
+}
+
+TEST(ReducedPrecisionGemmTest, AccumulatesInFloat) {
+  // Adding ones in half precision would get stuck at 2048.
+  const int64 k = 4096;
+  std::vector<Eigen::half> ones(k, Eigen::half(1.0f));
+  ReducedPrecisionMatrixPacker<Eigen::half> lhs(ones.data(), 1, k, false);
+  ReducedPrecisionMatrixPacker<Eigen::half> rhs(ones.data(), k, 1, false);
+  Eigen::half out;
+  TestDevice device;
+  ReducedPrecisionGemm(&device, 1, 1, k, lhs, rhs, &out);
+  EXPECT_EQ(4096.0f, static_cast<float>(out));
+}
+
+template <typename T>
+void CheckConv2D(int64 batch, int64 in_rows, int64 in_cols, int64 in_depth,
+                 int64 filter_rows, int64 filter_cols, int64 out_depth,
+                 int64 stride, bool same) {
+  typename ReducedPrecisionConv2DPatchPacker<T>::Geometry g;
+  g.in_rows = in_rows;
+  g.in_cols = in_cols;
+  g.in_depth = in_depth;
+  g.filter_rows = filter_rows;
+  g.filter_cols = filter_cols;
+  g.stride_rows = stride;
+  g.stride_cols = stride;
+  if (same) {
+    g.out_rows = (in_rows + stride - 1) / stride;
+    g.out_cols = (in_cols + stride - 1) / stride;
+    g.pad_rows = std::max<int64>(
+                     0, (g.out_rows - 1) * stride + filter_rows - in_rows) /
+                 2;
+    g.pad_cols = std::max<int64>(
+                     0, (g.out_cols - 1) * stride + filter_cols - in_cols) /
+                 2;
+  } else {
+    g.out_rows = (in_rows - filter_rows + stride) / stride;
+    g.out_cols = (in_cols - filter_cols + stride) / stride;
+    g.pad_rows = g.pad_cols = 0;
+  }
+  random::PhiloxRandom philox(in_rows * 100 + in_depth, out_depth);
+  random::SimplePhilox rnd(&philox);
+  const std::vector<T> input =
+      RandomValues<T>(batch * in_rows * in_cols * in_depth, &rnd);
+  const int64 k = filter_rows * filter_cols * in_depth;
+  const std::vector<T> filter = RandomValues<T>(k * out_depth, &rnd);
+
+  const int64 m = batch * g.out_rows * g.out_cols;
+  std::vector<T> out(m * out_depth);
+  ReducedPrecisionConv2DPatchPacker<T> patches(input.data(), g);
+  ReducedPrecisionMatrixPacker<T> filter_matrix(filter.data(), k, out_depth,
+                                                false);
+  TestDevice device;
+  ReducedPrecisionGemm(&device, m, out_depth, k, patches, filter_matrix,
+                       out.data());
+
+  const T zero = FromFloat<T>(0);
+  CheckProduct(m, out_depth, k,
+               [&](int64 i, int64 l) {
+                 const int64 x = i % g.out_cols;
+                 const int64 y = (i / g.out_cols) % g.out_rows;
+                 const int64 b = i / (g.out_cols * g.out_rows);
+                 const int64 d = l % in_depth;
+                 const int64 fx = (l / in_depth) % filter_cols;
+                 const int64 fy = l / (in_depth * filter_cols);
+                 const int64 iy = y * stride - g.pad_rows + fy;
+                 const int64 ix = x * stride - g.pad_cols + fx;
+                 if (iy < 0 || iy >= in_rows || ix < 0 || ix >= in_cols) {
+                   return zero;
+                 }
+                 return input[((b * in_rows + iy) * in_cols + ix) * in_depth +
+                              d];
+               },
+               [&](int64 l, int64 j) { return filter[l * out_depth + j]; },
+               out);
+}
+
+template <typename T>
+void CheckAllConv2Ds() {
+  for (bool same : {false, true}) {
+    CheckConv2D<T>(2, 7, 9, 3, 3, 3, 5, 1, same);
+    CheckConv2D<T>(1, 8, 8, 16, 5, 5, 8, 2, same);
+    CheckConv2D<T>(3, 5, 6, 40, 1, 3, 300, 1, same);
+    CheckConv2D<T>(1, 12, 13, 2, 7, 1, 4, 3, same);
+    CheckConv2D<T>(1, 4, 4, 100, 4, 4, 3, 1, same);
+  }
+}
+
+TEST(ReducedPrecisionGemmTest, HalfConv2D) { CheckAllConv2Ds<Eigen::half>(); }
+
+TEST(ReducedPrecisionGemmTest, BFloat16Conv2D) {
+  CheckAllConv2Ds<bfloat16>();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/reduction_ops.h"
+#include "tensorflow/core/kernels/row_reduction_cpu.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -68,6 +69,30 @@ struct Constants<CPUDevice> {
 };
 #endif
 
+// Reduces every row of a row-major [rows, cols] matrix.  Returns false if
+// the device has no specialized implementation, in which case the caller
+// falls back to functor::ReduceFunctor.
+template <typename Device>
+struct RowReducer {
+  template <typename T, typename Reducer>
+  static bool Reduce(OpKernelContext* ctx, const Reducer& reducer, int64 rows,
+                     int64 cols, const T* in, T* out) {
+    return false;
+  }
+};
+
+// On the CPU, wide rows are also split across threads; see
+// row_reduction_cpu.h.
+template <>
+struct RowReducer<CPUDevice> {
+  template <typename T, typename Reducer>
+  static bool Reduce(OpKernelContext* ctx, const Reducer& reducer, int64 rows,
+                     int64 cols, const T* in, T* out) {
+    ReduceRowsCPU(ctx->device(), reducer, rows, cols, in, out);
+    return true;
+  }
+};
+
 class ReductionHelper {
  public:
   ReductionHelper() : reduce_first_axis_(false) {}
@@ -184,6 +209,14 @@ class ReductionOp : public OpKernel {
       // with identity elements.  Example: tf.reduce_sum(tf.zeros((0, 3)), [0]).
       // Eigen sometimes crashes in this case, so we do it manually.
       Functor::FillIdentity(d, tmp_out.flat<T>(), reducer);
+    } else if (((helper.ndims() == 1 && helper.reduce_first_axis()) ||
+                (helper.ndims() == 2 && !helper.reduce_first_axis())) &&
+               RowReducer<Device>::Reduce(
+                   ctx, reducer, tmp_out.NumElements(),
+                   data.NumElements() / tmp_out.NumElements(),
+                   data.flat<T>().data(), tmp_out.flat<T>().data())) {
+      // Reduced the rows of a matrix, where a reduction to a scalar is the
+      // reduction of a single row.
     } else if ((helper.ndims() == 1) && helper.reduce_first_axis()) {
       // Reduce to a scalar.
       Functor::Reduce(d, helper.out<T, 0>(&tmp_out), helper.in<T, 1>(data),
@@ -219,9 +252,13 @@ class ReductionOp : public OpKernel {
       const int64 unreduced = tmp_out.NumElements();
       const int64 reduced = shuffled.NumElements() / unreduced;
       const Tensor& const_shuffled = shuffled;
-      Functor::Reduce(d, tmp_out.flat<T>(),
-                      const_shuffled.shaped<T, 2>({unreduced, reduced}),
-                      constants.kOne, reducer);
+      if (!RowReducer<Device>::Reduce(ctx, reducer, unreduced, reduced,
+                                      const_shuffled.flat<T>().data(),
+                                      tmp_out.flat<T>().data())) {
+        Functor::Reduce(d, tmp_out.flat<T>(),
+                        const_shuffled.shaped<T, 2>({unreduced, reduced}),
+                        constants.kOne, reducer);
+      }
     }
 
     // Set the real output using the contents of the reduction but the
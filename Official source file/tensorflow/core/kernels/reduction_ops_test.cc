@@ -84,4 +84,50 @@ static void BM_Mean3DToScalarGPU(int iters, int num) {
 }
 BENCHMARK(BM_Mean3DToScalarGPU)->Range(1 << 13, 1 << 20);
 
+// Creates a Graph which reduces a [rows, cols] float matrix along its
+// columns with "reduce", which is a reduction op or ArgMax/ArgMin.
+static Graph* RowReduction(const string& reduce, int rows, int cols) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor data(DT_FLOAT, TensorShape({rows, cols}));
+  data.flat<float>().setRandom();
+  if (reduce == "ArgMax" || reduce == "ArgMin") {
+    Tensor dim(DT_INT32, TensorShape({}));
+    dim.scalar<int32>()() = 1;
+    test::graph::Binary(g, reduce, test::graph::Constant(g, data),
+                        test::graph::Constant(g, dim));
+  } else {
+    Tensor axes(DT_INT32, TensorShape({1}));
+    axes.flat<int32>()(0) = 1;
+    test::graph::Reduce(g, reduce, test::graph::Constant(g, data),
+                        test::graph::Constant(g, axes));
+  }
+  return g;
+}
+
+static void ReduceRows(int iters, const string& device, const string& reduce,
+                       int rows, int cols) {
+  const int64 num = static_cast<int64>(rows) * cols;
+  testing::ItemsProcessed(static_cast<int64>(iters) * num);
+  testing::BytesProcessed(static_cast<int64>(iters) * num * sizeof(float));
+  test::Benchmark(device, RowReduction(reduce, rows, cols)).Run(iters);
+}
+
+// From a single wide row to many narrow ones.
+#define BM_ROW_REDUCTION(REDUCE)                                           \
+  static void BM_##REDUCE##RowsCPU(int iters, int rows, int cols) {        \
+    ReduceRows(iters, "cpu", #REDUCE, rows, cols);                         \
+  }                                                                        \
+  BENCHMARK(BM_##REDUCE##RowsCPU)                                          \
+      ->ArgPair(1, 1 << 20)                                                \
+      ->ArgPair(8, 1 << 17)                                                \
+      ->ArgPair(1024, 1024)                                                \
+      ->ArgPair(1 << 17, 8)                                                \
+      ->ArgPair(1 << 20, 8)
+
+BM_ROW_REDUCTION(Sum);
+BM_ROW_REDUCTION(Mean);
+BM_ROW_REDUCTION(Max);
+BM_ROW_REDUCTION(ArgMax);
+BM_ROW_REDUCTION(ArgMin);
+
 }  // end namespace tensorflow
@@ -0,0 +1,300 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_ROW_REDUCTION_CPU_H_
+#define TENSORFLOW_KERNELS_ROW_REDUCTION_CPU_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Reductions of every row of a row-major [rows, cols] matrix on the CPU,
+// the shape that reductions over the innermost dimensions and ArgMax/ArgMin
+// over the last dimension boil down to.
+//
+// Eigen's reductions along the inner dimension of a ThreadPoolDevice tensor
+// only parallelize across rows, so a few very wide rows run on one thread
+// each.  Here, many rows are sharded across threads, and when there are
+// fewer rows than threads each row is also split into blocks of at least
+// kMinBlockSize elements that are reduced in parallel and then combined.
+//
+// Sum, Mean, Max and Min reduce each shard of rows or block with Eigen's
+// vectorized reductions on the calling thread.  ArgMax and ArgMin of wide
+// rows keep kLanes independent running extrema that the compiler turns into
+// vector compares, and then search for the first index of the extremum only
+// in the first chunk of the row that attains it.  Like Eigen's argmax(),
+// they only replace the running extremum by a strictly greater (or smaller)
+// value, so NaNs are ignored and ties resolve to the first index.
+
+namespace row_reduction_internal {
+
+const int64 kLanes = 16;
+const int64 kChunkSize = 4096;
+const int64 kMinBlockSize = 16 * 1024;
+// Rows narrower than this are reduced by ArgMax and ArgMin in a single
+// scalar pass.
+const int64 kMinVectorizedArgCols = 4 * kLanes;
+
+// Reduces "rows" rows of "cols" elements starting at "in" into "out" with
+// Eigen on the calling thread.
+template <typename T, typename Reducer>
+void ReduceRowsWithEigen(const Reducer& reducer, int64 rows, int64 cols,
+                         const T* in, T* out) {
+  typedef Eigen::TensorMap<
+      Eigen::Tensor<const T, 2, Eigen::RowMajor, Eigen::DenseIndex>,
+      Eigen::Unaligned>
+      Input;
+  typedef Eigen::TensorMap<
+      Eigen::Tensor<T, 1, Eigen::RowMajor, Eigen::DenseIndex>,
+      Eigen::Unaligned>
+      Output;
+#if !defined(EIGEN_HAS_INDEX_LIST)
+  Eigen::array<Eigen::DenseIndex, 1> along_cols;
+  along_cols[0] = 1;
+#else
+  // Lets Eigen know at compile time that the innermost dimension is reduced.
+  Eigen::IndexList<Eigen::type2index<1>> along_cols;
+#endif
+  Output output(out, rows);
+  output.device(Eigen::DefaultDevice()) =
+      Input(in, rows, cols).reduce(along_cols, reducer);
+}
+
+// Reduction of a block of a row, combination of the results of two blocks,
+// and the final value of a row of "cols" elements.  A mean is the sum of
+// its blocks divided at the end.
+template <typename T, typename Reducer>
+T ReduceBlock(const Reducer& reducer, const T* x, int64 n) {
+  T result;
+  ReduceRowsWithEigen(reducer, 1, n, x, &result);
+  return result;
+}
+template <typename T>
+T ReduceBlock(const Eigen::internal::MeanReducer<T>&, const T* x, int64 n) {
+  return ReduceBlock(Eigen::internal::SumReducer<T>(), x, n);
+}
+
+template <typename T, typename Reducer>
+T Combine(const Reducer& reducer, T a, T b) {
+  Reducer r = reducer;
+  r.reduce(b, &a);
+  return a;
+}
+template <typename T>
+T Combine(const Eigen::internal::MeanReducer<T>&, T a, T b) {
+  return a + b;
+}
+
+template <typename T, typename Reducer>
+T Finalize(const Reducer&, T value, int64 cols) {
+  return value;
+}
+template <typename T>
+T Finalize(const Eigen::internal::MeanReducer<T>&, T sum, int64 cols) {
+  return sum / static_cast<T>(cols);
+}
+
+// Returns how many blocks each row is split into.
+inline int64 BlocksPerRow(int64 rows, int64 cols, int num_threads) {
+  if (rows >= num_threads) return 1;
+  const int64 max_blocks = std::max<int64>(1, cols / kMinBlockSize);
+  // A few blocks per thread balance the load.
+  const int64 wanted_blocks = (4 * num_threads + rows - 1) / rows;
+  return std::min(max_blocks, wanted_blocks);
+}
+
+struct Greater {
+  template <typename T>
+  bool operator()(const T& a, const T& b) const {
+    return a > b;
+  }
+};
+struct Less {
+  template <typename T>
+  bool operator()(const T& a, const T& b) const {
+    return a < b;
+  }
+};
+
+// Returns the extremum of "init" and x[0, n) under "Compare".
+template <typename Compare, typename T>
+T Extremum(const T* x, int64 n, T init) {
+  const Compare better;
+  T lanes[kLanes];
+  std::fill(lanes, lanes + kLanes, init);
+  int64 i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (int64 k = 0; k < kLanes; ++k) {
+      lanes[k] = better(x[i + k], lanes[k]) ? x[i + k] : lanes[k];
+    }
+  }
+  T result = init;
+  for (int64 k = 0; k < kLanes; ++k) {
+    if (better(lanes[k], result)) result = lanes[k];
+  }
+  for (; i < n; ++i) {
+    if (better(x[i], result)) result = x[i];
+  }
+  return result;
+}
+
+// The extremum of a block and its first index, or -1 if no element of the
+// block beats the initial value.
+template <typename T>
+struct ArgResult {
+  T value;
+  int64 index;
+};
+
+template <typename Compare, typename T>
+ArgResult<T> ArgReduceBlock(const T* x, int64 n, T init) {
+  const Compare better;
+  ArgResult<T> result = {init, -1};
+  if (n < kMinVectorizedArgCols) {
+    // Written without branches, which random data would mispredict.
+    for (int64 i = 0; i < n; ++i) {
+      const bool is_better = better(x[i], result.value);
+      result.value = is_better ? x[i] : result.value;
+      result.index = is_better ? i : result.index;
+    }
+    return result;
+  }
+  int64 best_chunk = -1;
+  for (int64 begin = 0; begin < n; begin += kChunkSize) {
+    const int64 size = std::min(kChunkSize, n - begin);
+    const T chunk_best = Extremum<Compare>(x + begin, size, result.value);
+    if (better(chunk_best, result.value)) {
+      result.value = chunk_best;
+      best_chunk = begin;
+    }
+  }
+  if (best_chunk >= 0) {
+    const T* chunk = x + best_chunk;
+    const int64 size = std::min(kChunkSize, n - best_chunk);
+    result.index =
+        best_chunk + (std::find(chunk, chunk + size, result.value) - chunk);
+  }
+  return result;
+}
+
+template <typename Compare, typename T>
+void ArgReduceRows(DeviceBase* d, T init, int64 rows, int64 cols,
+                   const T* in, int64* out) {
+  const auto* worker_threads = d->tensorflow_cpu_worker_threads();
+  const int64 blocks = BlocksPerRow(rows, cols, worker_threads->num_threads);
+  if (blocks == 1) {
+    Shard(worker_threads->num_threads, worker_threads->workers, rows,
+          cols * 2 + 10, [&](int64 start, int64 limit) {
+            for (int64 row = start; row < limit; ++row) {
+              const int64 index =
+                  ArgReduceBlock<Compare>(in + row * cols, cols, init).index;
+              out[row] = std::max<int64>(index, 0);
+            }
+          });
+    return;
+  }
+  const int64 block_size = (cols + blocks - 1) / blocks;
+  std::vector<ArgResult<T>> results(rows * blocks);
+  Shard(worker_threads->num_threads, worker_threads->workers, rows * blocks,
+        block_size * 2 + 10, [&](int64 start, int64 limit) {
+          for (int64 unit = start; unit < limit; ++unit) {
+            const int64 row = unit / blocks;
+            const int64 begin = (unit % blocks) * block_size;
+            const int64 size = std::min(block_size, cols - begin);
+            results[unit] =
+                ArgReduceBlock<Compare>(in + row * cols + begin, size, init);
+            if (results[unit].index >= 0) results[unit].index += begin;
+          }
+        });
+  for (int64 row = 0; row < rows; ++row) {
+    ArgResult<T> best = {init, 0};
+    for (int64 b = 0; b < blocks; ++b) {
+      const ArgResult<T>& block = results[row * blocks + b];
+      if (block.index >= 0 && Compare()(block.value, best.value)) best = block;
+    }
+    out[row] = best.index;
+  }
+}
+
+}  // namespace row_reduction_internal
+
+// Writes the reduction of row r of "in" to out[r], for rows >= 1 and
+// cols >= 1.  "reducer" is one of Eigen's reducers.
+template <typename T, typename Reducer>
+void ReduceRowsCPU(DeviceBase* d, const Reducer& reducer, int64 rows,
+                   int64 cols, const T* in, T* out) {
+  using row_reduction_internal::BlocksPerRow;
+  using row_reduction_internal::Combine;
+  using row_reduction_internal::Finalize;
+  using row_reduction_internal::ReduceBlock;
+  using row_reduction_internal::ReduceRowsWithEigen;
+  const auto* worker_threads = d->tensorflow_cpu_worker_threads();
+  const int64 blocks = BlocksPerRow(rows, cols, worker_threads->num_threads);
+  if (blocks == 1) {
+    Shard(worker_threads->num_threads, worker_threads->workers, rows,
+          cols + 10, [&](int64 start, int64 limit) {
+            ReduceRowsWithEigen(reducer, limit - start, cols,
+                                in + start * cols, out + start);
+          });
+    return;
+  }
+  const int64 block_size = (cols + blocks - 1) / blocks;
+  std::vector<T> partials(rows * blocks);
+  Shard(worker_threads->num_threads, worker_threads->workers, rows * blocks,
+        block_size, [&](int64 start, int64 limit) {
+          for (int64 unit = start; unit < limit; ++unit) {
+            const int64 row = unit / blocks;
+            const int64 begin = (unit % blocks) * block_size;
+            const int64 size = std::min(block_size, cols - begin);
+            partials[unit] =
+                ReduceBlock(reducer, in + row * cols + begin, size);
+          }
+        });
+  for (int64 row = 0; row < rows; ++row) {
+    T value = partials[row * blocks];
+    for (int64 b = 1; b < blocks; ++b) {
+      value = Combine(reducer, value, partials[row * blocks + b]);
+    }
+    out[row] = Finalize(reducer, value, cols);
+  }
+}
+
+// Writes the index of the first maximum (minimum) of row r of "in" to
+// out[r], for rows >= 1 and cols >= 1.  The result is 0 if no element is
+// greater (smaller) than the lowest (highest) value of T.
+template <typename T>
+void ArgMaxRowsCPU(DeviceBase* d, int64 rows, int64 cols, const T* in,
+                   int64* out) {
+  row_reduction_internal::ArgReduceRows<row_reduction_internal::Greater>(
+      d, Eigen::NumTraits<T>::lowest(), rows, cols, in, out);
+}
+
+template <typename T>
+void ArgMinRowsCPU(DeviceBase* d, int64 rows, int64 cols, const T* in,
+                   int64* out) {
+  row_reduction_internal::ArgReduceRows<row_reduction_internal::Less>(
+      d, Eigen::NumTraits<T>::highest(), rows, cols, in, out);
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_ROW_REDUCTION_CPU_H_
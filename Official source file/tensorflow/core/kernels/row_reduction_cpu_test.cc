@@ -0,0 +1,207 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/row_reduction_cpu.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using row_reduction_internal::kChunkSize;
+using row_reduction_internal::kMinBlockSize;
+
+class TestDevice : public DeviceBase {
+ public:
+  TestDevice() : DeviceBase(Env::Default()), pool_(Env::Default(), "test", 4) {
+    threads_.num_threads = 4;
+    threads_.workers = &pool_;
+    set_tensorflow_cpu_worker_threads(&threads_);
+  }
+
+ private:
+  thread::ThreadPool pool_;
+  CpuWorkerThreads threads_;
+};
+
+// Shapes with narrow rows, rows of several chunks, and few rows that are
+// split into blocks.
+const int64 kShapes[][2] = {
+    {1, 1},
+    {7, 3},
+    {1000, 8},
+    {33, 100},
+    {3, kChunkSize + 5},
+    {1, 5 * kMinBlockSize + 17},
+    {2, 3 * kMinBlockSize},
+    {5, 2 * kMinBlockSize - 1},
+};
+
+// Random values with few distinct values, so that rows have ties.
+template <typename T>
+std::vector<T> RandomValues(int64 size, random::SimplePhilox* rnd) {
+  std::vector<T> values(size);
+  for (T& v : values) v = static_cast<T>(rnd->Uniform(2001)) - T(1000);
+  return values;
+}
+
+// Reduces every row with Eigen's scalar reducer.
+template <typename T, typename Reducer>
+std::vector<T> ReferenceReduce(int64 rows, int64 cols,
+                               const std::vector<T>& in) {
+  std::vector<T> out(rows);
+  for (int64 row = 0; row < rows; ++row) {
+    Reducer reducer;
+    T accum = reducer.initialize();
+    for (int64 j = 0; j < cols; ++j) {
+      reducer.reduce(in[row * cols + j], &accum);
+    }
+    out[row] = reducer.finalize(accum);
+  }
+  return out;
+}
+
+template <typename T, typename Reducer>
+void CheckReduce(int64 rows, int64 cols, const std::vector<T>& in) {
+  std::vector<T> out(rows);
+  TestDevice device;
+  ReduceRowsCPU(&device, Reducer(), rows, cols, in.data(), out.data());
+  const std::vector<T> expected = ReferenceReduce<T, Reducer>(rows, cols, in);
+  for (int64 row = 0; row < rows; ++row) {
+    if (std::is_integral<T>::value || !std::isfinite(expected[row])) {
+      EXPECT_EQ(expected[row], out[row]) << rows << "x" << cols << " " << row;
+    } else {
+      EXPECT_NEAR(expected[row], out[row],
+                  1e-5 * (1 + std::abs(static_cast<double>(expected[row]))))
+          << rows << "x" << cols << " " << row;
+    }
+  }
+}
+
+template <typename T>
+void CheckArgReduce(int64 rows, int64 cols, const std::vector<T>& in) {
+  std::vector<int64> out(rows);
+  TestDevice device;
+  for (const bool is_max : {true, false}) {
+    if (is_max) {
+      ArgMaxRowsCPU(&device, rows, cols, in.data(), out.data());
+    } else {
+      ArgMinRowsCPU(&device, rows, cols, in.data(), out.data());
+    }
+    for (int64 row = 0; row < rows; ++row) {
+      Eigen::Tuple<int64, T> expected(
+          0, is_max ? Eigen::NumTraits<T>::lowest()
+                    : Eigen::NumTraits<T>::highest());
+      for (int64 j = 0; j < cols; ++j) {
+        const Eigen::Tuple<int64, T> t(j, in[row * cols + j]);
+        if (is_max) {
+          Eigen::internal::ArgMaxTupleReducer<Eigen::Tuple<int64, T>>().reduce(
+              t, &expected);
+        } else {
+          Eigen::internal::ArgMinTupleReducer<Eigen::Tuple<int64, T>>().reduce(
+              t, &expected);
+        }
+      }
+      EXPECT_EQ(expected.first, out[row])
+          << (is_max ? "ArgMax " : "ArgMin ") << rows << "x" << cols << " "
+          << row;
+    }
+  }
+}
+
+template <typename T>
+void CheckAll(int64 rows, int64 cols, const std::vector<T>& in) {
+  CheckReduce<T, Eigen::internal::SumReducer<T>>(rows, cols, in);
+  CheckReduce<T, Eigen::internal::MeanReducer<T>>(rows, cols, in);
+  CheckReduce<T, Eigen::internal::MaxReducer<T>>(rows, cols, in);
+  CheckReduce<T, Eigen::internal::MinReducer<T>>(rows, cols, in);
+  CheckArgReduce<T>(rows, cols, in);
+}
+
+template <typename T>
+void CheckRandom() {
+  for (const auto& shape : kShapes) {
+    random::PhiloxRandom philox(shape[0], shape[1]);
+    random::SimplePhilox rnd(&philox);
+    CheckAll<T>(shape[0], shape[1],
+                RandomValues<T>(shape[0] * shape[1], &rnd));
+  }
+}
+
+TEST(RowReductionCPUTest, Float) { CheckRandom<float>(); }
+TEST(RowReductionCPUTest, Double) { CheckRandom<double>(); }
+TEST(RowReductionCPUTest, Int32) { CheckRandom<int32>(); }
+TEST(RowReductionCPUTest, Int64) { CheckRandom<int64>(); }
+
+TEST(RowReductionCPUTest, ExtremaAtBoundaries) {
+  // A single row is split into two blocks; put the extrema next to the
+  // boundaries of chunks and blocks.
+  const int64 cols = 2 * kMinBlockSize + 3;
+  const int64 block_size = kMinBlockSize + 2;
+  for (const int64 position :
+       {int64{0}, kChunkSize - 1, kChunkSize, block_size - 1, block_size,
+        block_size + kChunkSize, cols - 1}) {
+    std::vector<float> in(cols, 0.0f);
+    in[position] = 1.0f;
+    in[(position + 1) % cols] = -1.0f;
+    CheckAll<float>(1, cols, in);
+    // Ties are resolved to the first index.
+    in[cols - 1 - position / 2] = 1.0f;
+    CheckAll<float>(1, cols, in);
+  }
+}
+
+TEST(RowReductionCPUTest, NonFinite) {
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float lowest = std::numeric_limits<float>::lowest();
+  const int64 cols = kChunkSize + 40;
+  std::vector<std::vector<float>> rows = {
+      std::vector<float>(cols, -inf),
+      std::vector<float>(cols, inf),
+      std::vector<float>(cols, nan),
+      std::vector<float>(cols, lowest),
+      std::vector<float>(cols, 2.0f),
+  };
+  rows[0][cols - 1] = lowest;
+  rows[1][kChunkSize + 1] = 1.0f;
+  rows[2][cols - 3] = 5.0f;
+  rows[4][0] = nan;
+  rows[4][100] = nan;
+  rows[4][kChunkSize + 2] = 3.0f;
+  rows[4][7] = 1.0f;
+  std::vector<float> in;
+  for (const auto& row : rows) in.insert(in.end(), row.begin(), row.end());
+  CheckArgReduce<float>(rows.size(), cols, in);
+  // How Max and Min treat NaNs depends on Eigen's vectorized reductions, so
+  // only the rows without NaNs are checked.
+  in.clear();
+  for (const int row : {0, 1, 3}) {
+    in.insert(in.end(), rows[row].begin(), rows[row].end());
+  }
+  CheckReduce<float, Eigen::internal::MaxReducer<float>>(3, cols, in);
+  CheckReduce<float, Eigen::internal::MinReducer<float>>(3, cols, in);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/linalg_ops_common.h"
+#include "tensorflow/core/kernels/small_matrix_linalg_cpu.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -40,6 +41,8 @@ class SelfAdjointEigOp : public LinearAlgebraOp<Scalar> {
   using MatrixMaps = typename Base::MatrixMaps;
   using ConstMatrixMap = typename Base::ConstMatrixMap;
   using ConstMatrixMaps = typename Base::ConstMatrixMaps;
+  using ConstScalarPtrs = typename Base::ConstScalarPtrs;
+  using ScalarPtrs = typename Base::ScalarPtrs;
 
   TensorShapes GetOutputMatrixShapes(
       const TensorShapes& input_matrix_shapes) const final {
@@ -66,6 +69,24 @@ class SelfAdjointEigOp : public LinearAlgebraOp<Scalar> {
     outputs->at(0).row(0) = es.eigenvalues().transpose();
     outputs->at(0).bottomRows(rows) = es.eigenvectors();
   }
+
+  bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const final {
+    return IsSmallMatrixSize(input_matrix_shapes[0].dim_size(0));
+  }
+
+  void ComputeMatrixBatch(OpKernelContext* context, int64 num_matrices,
+                          const TensorShapes& input_matrix_shapes,
+                          const ConstScalarPtrs& inputs,
+                          const ScalarPtrs& outputs) final {
+    const bool success =
+        SmallSelfAdjointEigs(input_matrix_shapes[0].dim_size(0), num_matrices,
+                             inputs[0], outputs[0]);
+    OP_REQUIRES(context, success,
+                errors::InvalidArgument("Self Adjoint Eigen decomposition was"
+                                        "not successful. "
+                                        "The input might not be valid."));
+  }
 };
 
 REGISTER_LINALG_OP("SelfAdjointEig", (SelfAdjointEigOp<float>), float);
@@ -0,0 +1,392 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_SMALL_MATRIX_LINALG_CPU_H_
+#define TENSORFLOW_KERNELS_SMALL_MATRIX_LINALG_CPU_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "third_party/eigen3/Eigen/Eigenvalues"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Batched linear algebra on many small n-by-n real matrices, for
+// 2 <= n <= kMaxSmallMatrixSize, used by the CPU kernels derived from
+// LinearAlgebraOp.  Every function is instantiated for each such n, so all
+// loops have compile-time bounds and no memory is allocated.
+//
+// LU factorizations with partial pivoting and Cholesky factorizations are
+// vectorized across the batch: groups of kLanes matrices are transposed
+// into arrays in which the kLanes copies of every element are adjacent, and
+// every arithmetic step is a loop over the lanes.  Row pivoting differs
+// between lanes and is done with selects instead of branches.  Padding
+// lanes of the last group hold identity matrices.  Eigendecompositions are
+// iterative and use Eigen's fixed-size solver one matrix at a time.
+//
+// All matrices are row-major and stored one after another.
+
+const int64 kMaxSmallMatrixSize = 8;
+
+// Returns true if n-by-n matrices are handled by the functions below.
+inline bool IsSmallMatrixSize(int64 n) {
+  return n >= 2 && n <= kMaxSmallMatrixSize;
+}
+
+namespace small_matrix_internal {
+
+const int kLanes = 8;
+
+// Loads matrices [first, first + count) of "in", or their transposes, into
+// the lanes of "a" and pads the remaining lanes with identity matrices.
+template <int N, typename Scalar>
+void LoadGroup(const Scalar* in, int64 first, int count, bool transpose,
+               Scalar a[N][N][kLanes]) {
+  for (int l = 0; l < kLanes; ++l) {
+    if (l < count) {
+      const Scalar* m = in + (first + l) * N * N;
+      for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+          a[i][j][l] = transpose ? m[j * N + i] : m[i * N + j];
+        }
+      }
+    } else {
+      for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) a[i][j][l] = Scalar(i == j);
+      }
+    }
+  }
+}
+
+// The LU factorization with partial pivoting of the matrices of a group.
+template <int N, typename Scalar>
+struct LUGroup {
+  // L below the diagonal, with an implicit unit diagonal, and U on and above
+  // it.
+  Scalar lu[N][N][kLanes];
+  // The row swapped with row k in step k, stored as a Scalar so that the
+  // comparisons with it vectorize.
+  Scalar pivot[N][kLanes];
+  // The sign of the permutation.
+  Scalar sign[kLanes];
+  // min_k |u_kk|.  Zero if the matrix is singular.
+  Scalar min_abs_pivot[kLanes];
+};
+
+// Factorizes the matrices loaded in g->lu in place.  Like
+// Eigen::PartialPivLU, the pivot is the first element of largest magnitude
+// in its column, and a column whose pivot is zero is not eliminated.
+template <int N, typename Scalar>
+void Factorize(LUGroup<N, Scalar>* g) {
+  Scalar(&a)[N][N][kLanes] = g->lu;
+  for (int l = 0; l < kLanes; ++l) {
+    g->sign[l] = Scalar(1);
+    g->min_abs_pivot[l] = std::numeric_limits<Scalar>::infinity();
+  }
+  for (int k = 0; k < N; ++k) {
+    Scalar(&pivot)[kLanes] = g->pivot[k];
+    Scalar best[kLanes];
+    for (int l = 0; l < kLanes; ++l) {
+      best[l] = std::abs(a[k][k][l]);
+      pivot[l] = Scalar(k);
+    }
+    for (int r = k + 1; r < N; ++r) {
+      for (int l = 0; l < kLanes; ++l) {
+        const Scalar v = std::abs(a[r][k][l]);
+        const bool larger = v > best[l];
+        best[l] = larger ? v : best[l];
+        pivot[l] = larger ? Scalar(r) : pivot[l];
+      }
+    }
+    // Swaps entire rows, including the multipliers already stored in them.
+    for (int r = k + 1; r < N; ++r) {
+      for (int j = 0; j < N; ++j) {
+        for (int l = 0; l < kLanes; ++l) {
+          const bool swap = pivot[l] == Scalar(r);
+          const Scalar x = a[k][j][l];
+          const Scalar y = a[r][j][l];
+          a[k][j][l] = swap ? y : x;
+          a[r][j][l] = swap ? x : y;
+        }
+      }
+    }
+    Scalar inverse[kLanes];
+    for (int l = 0; l < kLanes; ++l) {
+      g->sign[l] = pivot[l] != Scalar(k) ? -g->sign[l] : g->sign[l];
+      g->min_abs_pivot[l] = std::min(g->min_abs_pivot[l], best[l]);
+      const bool nonzero = best[l] != Scalar(0);
+      inverse[l] = nonzero ? Scalar(1) / (nonzero ? a[k][k][l] : Scalar(1))
+                           : Scalar(0);
+    }
+    for (int r = k + 1; r < N; ++r) {
+      for (int l = 0; l < kLanes; ++l) a[r][k][l] *= inverse[l];
+      for (int j = k + 1; j < N; ++j) {
+        for (int l = 0; l < kLanes; ++l) a[r][j][l] -= a[r][k][l] * a[k][j][l];
+      }
+    }
+  }
+}
+
+// Overwrites the column vectors "b" with the solutions of A x = b, where
+// "g" holds the factorizations of A.
+template <int N, typename Scalar>
+void Solve(const LUGroup<N, Scalar>& g, Scalar b[N][kLanes]) {
+  const Scalar(&a)[N][N][kLanes] = g.lu;
+  for (int k = 0; k < N; ++k) {
+    for (int r = k + 1; r < N; ++r) {
+      for (int l = 0; l < kLanes; ++l) {
+        const bool swap = g.pivot[k][l] == Scalar(r);
+        const Scalar x = b[k][l];
+        const Scalar y = b[r][l];
+        b[k][l] = swap ? y : x;
+        b[r][l] = swap ? x : y;
+      }
+    }
+  }
+  for (int i = 1; i < N; ++i) {
+    for (int j = 0; j < i; ++j) {
+      for (int l = 0; l < kLanes; ++l) b[i][l] -= a[i][j][l] * b[j][l];
+    }
+  }
+  for (int i = N - 1; i >= 0; --i) {
+    for (int j = i + 1; j < N; ++j) {
+      for (int l = 0; l < kLanes; ++l) b[i][l] -= a[i][j][l] * b[j][l];
+    }
+    for (int l = 0; l < kLanes; ++l) b[i][l] /= a[i][i][l];
+  }
+}
+
+// Returns true if no matrix of the first "count" lanes of "g" is singular.
+template <int N, typename Scalar>
+bool AllInvertible(const LUGroup<N, Scalar>& g, int count) {
+  bool invertible = true;
+  for (int l = 0; l < count; ++l) {
+    invertible &= g.min_abs_pivot[l] > Scalar(0);
+  }
+  return invertible;
+}
+
+template <int N, typename Scalar>
+void Determinants(int64 num_matrices, const Scalar* in, Scalar* out) {
+  for (int64 first = 0; first < num_matrices; first += kLanes) {
+    const int count = std::min<int64>(kLanes, num_matrices - first);
+    LUGroup<N, Scalar> g;
+    LoadGroup<N>(in, first, count, false, g.lu);
+    Factorize(&g);
+    Scalar det[kLanes];
+    for (int l = 0; l < kLanes; ++l) det[l] = g.sign[l];
+    for (int k = 0; k < N; ++k) {
+      for (int l = 0; l < kLanes; ++l) det[l] *= g.lu[k][k][l];
+    }
+    std::copy(det, det + count, out + first);
+  }
+}
+
+template <int N, typename Scalar>
+bool Inverses(int64 num_matrices, bool adjoint, const Scalar* in,
+              Scalar* out) {
+  bool invertible = true;
+  for (int64 first = 0; first < num_matrices; first += kLanes) {
+    const int count = std::min<int64>(kLanes, num_matrices - first);
+    LUGroup<N, Scalar> g;
+    LoadGroup<N>(in, first, count, adjoint, g.lu);
+    Factorize(&g);
+    invertible &= AllInvertible(g, count);
+    for (int c = 0; c < N; ++c) {
+      Scalar b[N][kLanes];
+      for (int i = 0; i < N; ++i) {
+        std::fill(b[i], b[i] + kLanes, Scalar(i == c));
+      }
+      Solve(g, b);
+      for (int l = 0; l < count; ++l) {
+        Scalar* m = out + (first + l) * N * N;
+        for (int i = 0; i < N; ++i) m[i * N + c] = b[i][l];
+      }
+    }
+  }
+  return invertible;
+}
+
+template <int N, typename Scalar>
+bool Solves(int64 num_matrices, bool adjoint, int64 num_rhs,
+            const Scalar* matrices, const Scalar* rhs, Scalar* out) {
+  bool invertible = true;
+  for (int64 first = 0; first < num_matrices; first += kLanes) {
+    const int count = std::min<int64>(kLanes, num_matrices - first);
+    LUGroup<N, Scalar> g;
+    LoadGroup<N>(matrices, first, count, adjoint, g.lu);
+    Factorize(&g);
+    invertible &= AllInvertible(g, count);
+    for (int64 c = 0; c < num_rhs; ++c) {
+      Scalar b[N][kLanes];
+      for (int l = 0; l < kLanes; ++l) {
+        const Scalar* m = rhs + (first + std::min(l, count - 1)) * N * num_rhs;
+        for (int i = 0; i < N; ++i) b[i][l] = m[i * num_rhs + c];
+      }
+      Solve(g, b);
+      for (int l = 0; l < count; ++l) {
+        Scalar* m = out + (first + l) * N * num_rhs;
+        for (int i = 0; i < N; ++i) m[i * num_rhs + c] = b[i][l];
+      }
+    }
+  }
+  return invertible;
+}
+
+// Like Eigen::LLT, reads only the lower triangle and fails if a diagonal
+// element of the factor would be the square root of a value <= 0.
+template <int N, typename Scalar>
+bool Choleskys(int64 num_matrices, const Scalar* in, Scalar* out) {
+  bool success = true;
+  for (int64 first = 0; first < num_matrices; first += kLanes) {
+    const int count = std::min<int64>(kLanes, num_matrices - first);
+    Scalar a[N][N][kLanes];
+    LoadGroup<N>(in, first, count, false, a);
+    bool failed[kLanes] = {};
+    for (int j = 0; j < N; ++j) {
+      Scalar d[kLanes];
+      for (int l = 0; l < kLanes; ++l) d[l] = a[j][j][l];
+      for (int k = 0; k < j; ++k) {
+        for (int l = 0; l < kLanes; ++l) d[l] -= a[j][k][l] * a[j][k][l];
+      }
+      for (int l = 0; l < kLanes; ++l) {
+        failed[l] |= d[l] <= Scalar(0);
+        a[j][j][l] = std::sqrt(d[l] > Scalar(0) ? d[l] : Scalar(1));
+      }
+      for (int i = j + 1; i < N; ++i) {
+        for (int k = 0; k < j; ++k) {
+          for (int l = 0; l < kLanes; ++l) {
+            a[i][j][l] -= a[i][k][l] * a[j][k][l];
+          }
+        }
+        for (int l = 0; l < kLanes; ++l) a[i][j][l] /= a[j][j][l];
+      }
+    }
+    for (int l = 0; l < count; ++l) {
+      success &= !failed[l];
+      Scalar* m = out + (first + l) * N * N;
+      for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+          m[i * N + j] = j <= i ? a[i][j][l] : Scalar(0);
+        }
+      }
+    }
+  }
+  return success;
+}
+
+// Writes the eigenvalues of every matrix to the first row of its
+// (N + 1)-by-N output, and the eigenvectors to the columns of the rest.
+template <int N, typename Scalar>
+bool SelfAdjointEigs(int64 num_matrices, const Scalar* in, Scalar* out) {
+  typedef Eigen::Matrix<Scalar, N, N, Eigen::RowMajor> Matrix;
+  typedef Eigen::Matrix<Scalar, N + 1, N, Eigen::RowMajor> Output;
+  bool success = true;
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix<Scalar, N, N>> solver;
+  for (int64 i = 0; i < num_matrices; ++i) {
+    solver.compute(Eigen::Map<const Matrix>(in + i * N * N));
+    success &= solver.info() == Eigen::Success;
+    Eigen::Map<Output> output(out + i * (N + 1) * N);
+    output.row(0) = solver.eigenvalues().transpose();
+    output.template bottomRows<N>() = solver.eigenvectors();
+  }
+  return success;
+}
+
+// Returns FN<N>(...) for the compile-time N equal to n.
+#define TF_SMALL_MATRIX_DISPATCH(FN, n, ...)                  \
+  switch (n) {                                                \
+    case 2:                                                   \
+      return FN<2>(__VA_ARGS__);                              \
+    case 3:                                                   \
+      return FN<3>(__VA_ARGS__);                              \
+    case 4:                                                   \
+      return FN<4>(__VA_ARGS__);                              \
+    case 5:                                                   \
+      return FN<5>(__VA_ARGS__);                              \
+    case 6:                                                   \
+      return FN<6>(__VA_ARGS__);                              \
+    case 7:                                                   \
+      return FN<7>(__VA_ARGS__);                              \
+    case 8:                                                   \
+      return FN<8>(__VA_ARGS__);                              \
+    default:                                                  \
+      LOG(FATAL) << "Unsupported small matrix size " << (n);  \
+  }
+
+}  // namespace small_matrix_internal
+
+// Writes the determinant of every n-by-n matrix of "in" to "out".
+template <typename Scalar>
+void SmallMatrixDeterminants(int64 n, int64 num_matrices, const Scalar* in,
+                             Scalar* out) {
+  TF_SMALL_MATRIX_DISPATCH(small_matrix_internal::Determinants, n,
+                           num_matrices, in, out);
+}
+
+// Writes the inverse of every n-by-n matrix of "in", or of its adjoint, to
+// "out".  Returns false if any matrix has a zero pivot, in which case its
+// result is undefined.
+template <typename Scalar>
+bool SmallMatrixInverses(int64 n, int64 num_matrices, bool adjoint,
+                         const Scalar* in, Scalar* out) {
+  TF_SMALL_MATRIX_DISPATCH(small_matrix_internal::Inverses, n, num_matrices,
+                           adjoint, in, out);
+  return false;
+}
+
+// Writes the solution X of A X = B, or of adjoint(A) X = B, to "out" for
+// every n-by-n matrix A of "matrices" and the corresponding n-by-num_rhs
+// matrix B of "rhs".  Returns false if any A has a zero pivot.
+template <typename Scalar>
+bool SmallMatrixSolves(int64 n, int64 num_matrices, bool adjoint,
+                       int64 num_rhs, const Scalar* matrices,
+                       const Scalar* rhs, Scalar* out) {
+  TF_SMALL_MATRIX_DISPATCH(small_matrix_internal::Solves, n, num_matrices,
+                           adjoint, num_rhs, matrices, rhs, out);
+  return false;
+}
+
+// Writes the lower triangular Cholesky factor of every n-by-n matrix of
+// "in", whose upper triangle is ignored, to "out".  Returns false if any
+// matrix is not positive definite.
+template <typename Scalar>
+bool SmallMatrixCholeskys(int64 n, int64 num_matrices, const Scalar* in,
+                          Scalar* out) {
+  TF_SMALL_MATRIX_DISPATCH(small_matrix_internal::Choleskys, n, num_matrices,
+                           in, out);
+  return false;
+}
+
+// Writes the eigenvalues and eigenvectors of every self-adjoint n-by-n
+// matrix of "in" to the (n + 1)-by-n matrices of "out", as the
+// SelfAdjointEig op does.  Returns false if any decomposition fails.
+template <typename Scalar>
+bool SmallSelfAdjointEigs(int64 n, int64 num_matrices, const Scalar* in,
+                          Scalar* out) {
+  TF_SMALL_MATRIX_DISPATCH(small_matrix_internal::SelfAdjointEigs, n,
+                           num_matrices, in, out);
+  return false;
+}
+
+#undef TF_SMALL_MATRIX_DISPATCH
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_SMALL_MATRIX_LINALG_CPU_H_
@@ -0,0 +1,318 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/small_matrix_linalg_cpu.h"
+
+#include <cmath>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Cholesky"
+#include "third_party/eigen3/Eigen/LU"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// The matrix types of the generic LinearAlgebraOp code path.
+template <typename Scalar>
+using Matrix =
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+template <typename Scalar>
+using ConstMatrixMap = Eigen::Map<const Matrix<Scalar>>;
+
+// Batch sizes with and without a partial group of matrices.
+const int64 kBatchSizes[] = {1, 8, 19};
+
+template <typename Scalar>
+double Tolerance();
+template <>
+double Tolerance<float>() {
+  return 1e-4;
+}
+template <>
+double Tolerance<double>() {
+  return 1e-10;
+}
+
+// Returns "num_matrices" random n-by-m matrices with entries in [-1, 1).
+template <typename Scalar>
+std::vector<Scalar> RandomMatrices(int64 num_matrices, int64 n, int64 m) {
+  random::PhiloxRandom philox(num_matrices, n * 10 + m);
+  random::SimplePhilox rnd(&philox);
+  std::vector<Scalar> values(num_matrices * n * m);
+  for (Scalar& v : values) v = static_cast<Scalar>(rnd.RandDouble() * 2 - 1);
+  return values;
+}
+
+// Returns random symmetric positive definite matrices.
+template <typename Scalar>
+std::vector<Scalar> RandomSPDMatrices(int64 num_matrices, int64 n) {
+  std::vector<Scalar> values = RandomMatrices<Scalar>(num_matrices, n, n);
+  for (int64 i = 0; i < num_matrices; ++i) {
+    Eigen::Map<Matrix<Scalar>> m(&values[i * n * n], n, n);
+    const Matrix<Scalar> a = m;
+    m = a * a.transpose() + Matrix<Scalar>::Identity(n, n) * Scalar(n);
+  }
+  return values;
+}
+
+template <typename Scalar>
+void ExpectNear(const Scalar* expected, const Scalar* actual, int64 size,
+                const string& what) {
+  for (int64 i = 0; i < size; ++i) {
+    EXPECT_NEAR(expected[i], actual[i],
+                Tolerance<Scalar>() * (1 + std::abs(expected[i])))
+        << what << " element " << i;
+  }
+}
+
+template <typename Scalar>
+void CheckDeterminants(int64 n, int64 num_matrices) {
+  const std::vector<Scalar> in = RandomMatrices<Scalar>(num_matrices, n, n);
+  std::vector<Scalar> out(num_matrices);
+  SmallMatrixDeterminants(n, num_matrices, in.data(), out.data());
+  for (int64 i = 0; i < num_matrices; ++i) {
+    const Scalar expected = ConstMatrixMap<Scalar>(&in[i * n * n], n, n)
+                                .partialPivLu()
+                                .determinant();
+    ExpectNear(&expected, &out[i], 1, strings::StrCat("determinant ", n));
+  }
+}
+
+template <typename Scalar>
+void CheckInverses(int64 n, int64 num_matrices, bool adjoint) {
+  const std::vector<Scalar> in = RandomMatrices<Scalar>(num_matrices, n, n);
+  std::vector<Scalar> out(num_matrices * n * n);
+  EXPECT_TRUE(SmallMatrixInverses(n, num_matrices, adjoint, in.data(),
+                                  out.data()));
+  for (int64 i = 0; i < num_matrices; ++i) {
+    const ConstMatrixMap<Scalar> m(&in[i * n * n], n, n);
+    const Matrix<Scalar> expected = adjoint
+                                        ? Matrix<Scalar>(m.adjoint().inverse())
+                                        : Matrix<Scalar>(m.inverse());
+    ExpectNear(expected.data(), &out[i * n * n], n * n,
+               strings::StrCat("inverse ", n, " adjoint ", adjoint));
+  }
+}
+
+template <typename Scalar>
+void CheckSolves(int64 n, int64 num_matrices, int64 num_rhs, bool adjoint) {
+  const std::vector<Scalar> matrices =
+      RandomMatrices<Scalar>(num_matrices, n, n);
+  const std::vector<Scalar> rhs =
+      RandomMatrices<Scalar>(num_matrices, n, num_rhs);
+  std::vector<Scalar> out(num_matrices * n * num_rhs);
+  EXPECT_TRUE(SmallMatrixSolves(n, num_matrices, adjoint, num_rhs,
+                                matrices.data(), rhs.data(), out.data()));
+  for (int64 i = 0; i < num_matrices; ++i) {
+    const ConstMatrixMap<Scalar> m(&matrices[i * n * n], n, n);
+    const ConstMatrixMap<Scalar> b(&rhs[i * n * num_rhs], n, num_rhs);
+    const Matrix<Scalar> expected =
+        adjoint ? Matrix<Scalar>(m.adjoint().partialPivLu().solve(b))
+                : Matrix<Scalar>(m.partialPivLu().solve(b));
+    ExpectNear(expected.data(), &out[i * n * num_rhs], n * num_rhs,
+               strings::StrCat("solve ", n, " adjoint ", adjoint));
+  }
+}
+
+template <typename Scalar>
+void CheckCholeskys(int64 n, int64 num_matrices) {
+  std::vector<Scalar> in = RandomSPDMatrices<Scalar>(num_matrices, n);
+  // The upper triangle must be ignored.
+  for (int64 i = 0; i < num_matrices; ++i) in[i * n * n + n - 1] = 1e6;
+  std::vector<Scalar> out(num_matrices * n * n);
+  EXPECT_TRUE(SmallMatrixCholeskys(n, num_matrices, in.data(), out.data()));
+  for (int64 i = 0; i < num_matrices; ++i) {
+    const ConstMatrixMap<Scalar> m(&in[i * n * n], n, n);
+    const Matrix<Scalar> expected = Eigen::LLT<Matrix<Scalar>>(m).matrixL();
+    ExpectNear(expected.data(), &out[i * n * n], n * n,
+               strings::StrCat("cholesky ", n));
+  }
+}
+
+template <typename Scalar>
+void CheckSelfAdjointEigs(int64 n, int64 num_matrices) {
+  const std::vector<Scalar> in = RandomSPDMatrices<Scalar>(num_matrices, n);
+  std::vector<Scalar> out(num_matrices * (n + 1) * n);
+  EXPECT_TRUE(SmallSelfAdjointEigs(n, num_matrices, in.data(), out.data()));
+  for (int64 i = 0; i < num_matrices; ++i) {
+    const ConstMatrixMap<Scalar> m(&in[i * n * n], n, n);
+    const ConstMatrixMap<Scalar> output(&out[i * (n + 1) * n], n + 1, n);
+    Eigen::SelfAdjointEigenSolver<Matrix<Scalar>> solver(m);
+    ExpectNear(solver.eigenvalues().data(), output.row(0).data(), n,
+               strings::StrCat("eigenvalues ", n));
+    // Eigenvectors are only defined up to their sign.
+    const Matrix<Scalar> vectors = output.bottomRows(n);
+    const Matrix<Scalar> expected = vectors * output.row(0).asDiagonal();
+    const Matrix<Scalar> actual = m * vectors;
+    ExpectNear(expected.data(), actual.data(), n * n,
+               strings::StrCat("eigenvectors ", n));
+  }
+}
+
+template <typename Scalar>
+void CheckAll() {
+  for (int64 n = 2; n <= kMaxSmallMatrixSize; ++n) {
+    for (const int64 num_matrices : kBatchSizes) {
+      CheckDeterminants<Scalar>(n, num_matrices);
+      CheckInverses<Scalar>(n, num_matrices, false);
+      CheckInverses<Scalar>(n, num_matrices, true);
+      CheckSolves<Scalar>(n, num_matrices, 1, false);
+      CheckSolves<Scalar>(n, num_matrices, 3, true);
+      CheckCholeskys<Scalar>(n, num_matrices);
+      CheckSelfAdjointEigs<Scalar>(n, num_matrices);
+    }
+  }
+}
+
+TEST(SmallMatrixLinalgCPUTest, Float) { CheckAll<float>(); }
+TEST(SmallMatrixLinalgCPUTest, Double) { CheckAll<double>(); }
+
+TEST(SmallMatrixLinalgCPUTest, Singular) {
+  const int64 n = 3;
+  const int64 num_matrices = 11;
+  std::vector<double> in = RandomMatrices<double>(num_matrices, n, n);
+  // The third column of matrix 9 is twice its first.
+  for (int64 i = 0; i < n; ++i) {
+    in[9 * n * n + i * n + 2] = 2 * in[9 * n * n + i * n];
+  }
+  // Matrix 10 has a zero row.
+  std::fill(&in[10 * n * n + n], &in[10 * n * n + 2 * n], 0.0);
+  std::vector<double> out(num_matrices * n * n);
+  EXPECT_FALSE(SmallMatrixInverses(n, num_matrices, false, in.data(),
+                                   out.data()));
+  EXPECT_FALSE(SmallMatrixSolves(n, num_matrices, false, n, in.data(),
+                                 in.data(), out.data()));
+  SmallMatrixDeterminants(n, num_matrices, in.data(), out.data());
+  EXPECT_NEAR(0.0, out[9], 1e-12);
+  EXPECT_EQ(0.0, out[10]);
+  // The other matrices are unaffected.
+  for (int64 i = 0; i < 9; ++i) {
+    EXPECT_NEAR(ConstMatrixMap<double>(&in[i * n * n], n, n).determinant(),
+                out[i], 1e-10);
+  }
+  // Without the singular matrices, every matrix is invertible.
+  EXPECT_TRUE(SmallMatrixInverses(n, 9, false, in.data(), out.data()));
+}
+
+TEST(SmallMatrixLinalgCPUTest, NotPositiveDefinite) {
+  const int64 n = 4;
+  std::vector<float> in = RandomSPDMatrices<float>(9, n);
+  std::vector<float> out(in.size());
+  EXPECT_TRUE(SmallMatrixCholeskys(n, 9, in.data(), out.data()));
+  in[8 * n * n + n * n - 1] = -1;
+  EXPECT_FALSE(SmallMatrixCholeskys(n, 9, in.data(), out.data()));
+  EXPECT_TRUE(SmallMatrixCholeskys(n, 8, in.data(), out.data()));
+}
+
+// Benchmarks of the batched fixed-size path against the generic path of
+// LinearAlgebraOp, which decomposes every matrix with a dynamically sized
+// Eigen decomposition.
+
+const int64 kBenchmarkMatrices = 1 << 14;
+
+static void BM_SmallInverse(int iters, int n) {
+  testing::StopTiming();
+  const std::vector<float> in =
+      RandomMatrices<float>(kBenchmarkMatrices, n, n);
+  std::vector<float> out(in.size());
+  testing::ItemsProcessed(static_cast<int64>(iters) * kBenchmarkMatrices);
+  testing::StartTiming();
+  while (--iters >= 0) {
+    SmallMatrixInverses(n, kBenchmarkMatrices, false, in.data(), out.data());
+  }
+}
+BENCHMARK(BM_SmallInverse)->Arg(2)->Arg(3)->Arg(4)->Arg(8);
+
+static void BM_GenericInverse(int iters, int n) {
+  testing::StopTiming();
+  const std::vector<float> in =
+      RandomMatrices<float>(kBenchmarkMatrices, n, n);
+  std::vector<float> out(in.size());
+  testing::ItemsProcessed(static_cast<int64>(iters) * kBenchmarkMatrices);
+  testing::StartTiming();
+  while (--iters >= 0) {
+    for (int64 i = 0; i < kBenchmarkMatrices; ++i) {
+      Eigen::PartialPivLU<Matrix<float>> lu(
+          ConstMatrixMap<float>(&in[i * n * n], n, n));
+      Eigen::Map<Matrix<float>>(&out[i * n * n], n, n).noalias() =
+          lu.inverse();
+    }
+  }
+}
+BENCHMARK(BM_GenericInverse)->Arg(2)->Arg(3)->Arg(4)->Arg(8);
+
+static void BM_SmallDeterminant(int iters, int n) {
+  testing::StopTiming();
+  const std::vector<float> in =
+      RandomMatrices<float>(kBenchmarkMatrices, n, n);
+  std::vector<float> out(kBenchmarkMatrices);
+  testing::ItemsProcessed(static_cast<int64>(iters) * kBenchmarkMatrices);
+  testing::StartTiming();
+  while (--iters >= 0) {
+    SmallMatrixDeterminants(n, kBenchmarkMatrices, in.data(), out.data());
+  }
+}
+BENCHMARK(BM_SmallDeterminant)->Arg(2)->Arg(3)->Arg(4)->Arg(8);
+
+static void BM_GenericDeterminant(int iters, int n) {
+  testing::StopTiming();
+  const std::vector<float> in =
+      RandomMatrices<float>(kBenchmarkMatrices, n, n);
+  std::vector<float> out(kBenchmarkMatrices);
+  testing::ItemsProcessed(static_cast<int64>(iters) * kBenchmarkMatrices);
+  testing::StartTiming();
+  while (--iters >= 0) {
+    for (int64 i = 0; i < kBenchmarkMatrices; ++i) {
+      out[i] = ConstMatrixMap<float>(&in[i * n * n], n, n).determinant();
+    }
+  }
+}
+BENCHMARK(BM_GenericDeterminant)->Arg(2)->Arg(3)->Arg(4)->Arg(8);
+
+static void BM_SmallCholesky(int iters, int n) {
+  testing::StopTiming();
+  const std::vector<float> in = RandomSPDMatrices<float>(kBenchmarkMatrices, n);
+  std::vector<float> out(in.size());
+  testing::ItemsProcessed(static_cast<int64>(iters) * kBenchmarkMatrices);
+  testing::StartTiming();
+  while (--iters >= 0) {
+    SmallMatrixCholeskys(n, kBenchmarkMatrices, in.data(), out.data());
+  }
+}
+BENCHMARK(BM_SmallCholesky)->Arg(2)->Arg(3)->Arg(4)->Arg(8);
+
+static void BM_GenericCholesky(int iters, int n) {
+  testing::StopTiming();
+  const std::vector<float> in = RandomSPDMatrices<float>(kBenchmarkMatrices, n);
+  std::vector<float> out(in.size());
+  testing::ItemsProcessed(static_cast<int64>(iters) * kBenchmarkMatrices);
+  testing::StartTiming();
+  while (--iters >= 0) {
+    for (int64 i = 0; i < kBenchmarkMatrices; ++i) {
+      Eigen::LLT<Matrix<float>> llt(
+          ConstMatrixMap<float>(&in[i * n * n], n, n));
+      Eigen::Map<Matrix<float>>(&out[i * n * n], n, n) = llt.matrixL();
+    }
+  }
+}
+BENCHMARK(BM_GenericCholesky)->Arg(2)->Arg(3)->Arg(4)->Arg(8);
+
+}  // namespace
+}  // namespace tensorflow
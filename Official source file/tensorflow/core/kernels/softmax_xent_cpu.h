@@ -0,0 +1,265 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_SOFTMAX_XENT_CPU_H_
+#define TENSORFLOW_KERNELS_SOFTMAX_XENT_CPU_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/half.h"
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Fused softmax cross entropy for the CPU kernels of
+// SoftmaxCrossEntropyWithLogits and SparseSoftmaxCrossEntropyWithLogits.
+//
+// For every row of logits x with labels p, computes
+//
+//   loss = sum_j p_j * (log(sum_k exp(x_k - m)) - (x_j - m))
+//   backprop_j = exp(x_j - m) / sum_k exp(x_k - m) - p_j
+//
+// where m = max_k x_k, and p is one-hot for sparse labels.  The logits are
+// read twice: the first pass keeps a running maximum and a sum of
+// exponentials rescaled whenever the maximum grows, which is all the loss
+// needs, and the second pass writes the backprop.  No intermediate of the
+// size of the logits is materialized.
+//
+// Rows are split into segments of at most kSegmentSize classes that are
+// reduced in parallel, so a small batch with a huge number of classes still
+// uses every thread.  Within a segment, logits are processed in chunks of
+// kChunkSize elements with Eigen's vectorized exp.  Eigen::half is computed
+// in float.
+
+namespace softmax_xent_internal {
+
+template <typename T>
+struct ComputeType {
+  typedef T type;
+};
+template <>
+struct ComputeType<Eigen::half> {
+  typedef float type;
+};
+
+const int64 kChunkSize = 2048;
+const int64 kSegmentSize = 32 * 1024;
+
+// Returns "size" values of "src" as float or double, converting them into
+// "buffer" if necessary.
+inline const float* Load(const float* src, int64 size, float* buffer) {
+  return src;
+}
+inline const double* Load(const double* src, int64 size, double* buffer) {
+  return src;
+}
+inline const float* Load(const Eigen::half* src, int64 size, float* buffer) {
+  HalfToFloat(src, buffer, size);
+  return buffer;
+}
+
+// Returns where to compute "size" values destined for "dst", and Store()
+// moves them there.
+inline float* StoreBuffer(float* dst, float* buffer) { return dst; }
+inline double* StoreBuffer(double* dst, double* buffer) { return dst; }
+inline float* StoreBuffer(Eigen::half* dst, float* buffer) { return buffer; }
+inline void Store(const float* src, int64 size, float* dst) {}
+inline void Store(const double* src, int64 size, double* dst) {}
+inline void Store(const float* src, int64 size, Eigen::half* dst) {
+  FloatToHalf(src, dst, size);
+}
+
+// Reduction of one segment of a row.
+template <typename Acc>
+struct SegmentStats {
+  Acc max;
+  // sum_j exp(x_j - max).
+  Acc sum_exp;
+  // sum_j p_j and sum_j p_j * (x_j - max); only computed for dense labels.
+  Acc label_sum;
+  Acc label_dot;
+};
+
+// Reduces the "size" logits and, unless null, dense labels of a segment.
+template <typename T>
+SegmentStats<typename ComputeType<T>::type> ReduceSegment(const T* logits,
+                                                          const T* labels,
+                                                          int64 size) {
+  typedef typename ComputeType<T>::type Acc;
+  typedef Eigen::Array<Acc, Eigen::Dynamic, 1> Array;
+  Acc logits_buffer[kChunkSize];
+  Acc labels_buffer[kChunkSize];
+  SegmentStats<Acc> stats = {0, 0, 0, 0};
+  for (int64 begin = 0; begin < size; begin += kChunkSize) {
+    const int64 n = std::min(kChunkSize, size - begin);
+    Eigen::Map<const Array> x(Load(logits + begin, n, logits_buffer), n);
+    const Acc chunk_max = x.maxCoeff();
+    if (begin == 0) {
+      stats.max = chunk_max;
+    } else if (chunk_max > stats.max) {
+      // Rebase the sums accumulated so far on the new maximum.
+      const Acc shift = stats.max - chunk_max;
+      stats.sum_exp *= std::exp(shift);
+      stats.label_dot += stats.label_sum * shift;
+      stats.max = chunk_max;
+    }
+    stats.sum_exp += (x - stats.max).exp().sum();
+    if (labels != nullptr) {
+      Eigen::Map<const Array> p(Load(labels + begin, n, labels_buffer), n);
+      stats.label_sum += p.sum();
+      stats.label_dot += (p * (x - stats.max)).sum();
+    }
+  }
+  return stats;
+}
+
+// Writes the backprop of the "size" logits of a segment, given the maximum
+// and the inverse sum of exponentials of its row.  Subtracts the dense
+// labels unless null, and 1 at "label" if it lies in [0, size).
+template <typename T>
+void SegmentBackprop(const T* logits, const T* labels, int64 label, int64 size,
+                     typename ComputeType<T>::type max,
+                     typename ComputeType<T>::type inv_sum_exp, T* backprop) {
+  typedef typename ComputeType<T>::type Acc;
+  typedef Eigen::Array<Acc, Eigen::Dynamic, 1> Array;
+  Acc logits_buffer[kChunkSize];
+  Acc labels_buffer[kChunkSize];
+  Acc backprop_buffer[kChunkSize];
+  for (int64 begin = 0; begin < size; begin += kChunkSize) {
+    const int64 n = std::min(kChunkSize, size - begin);
+    Eigen::Map<const Array> x(Load(logits + begin, n, logits_buffer), n);
+    Acc* out = StoreBuffer(backprop + begin, backprop_buffer);
+    Eigen::Map<Array> g(out, n);
+    if (labels != nullptr) {
+      Eigen::Map<const Array> p(Load(labels + begin, n, labels_buffer), n);
+      g = (x - max).exp() * inv_sum_exp - p;
+    } else {
+      g = (x - max).exp() * inv_sum_exp;
+    }
+    if (label >= begin && label < begin + n) out[label - begin] -= 1;
+    Store(out, n, backprop + begin);
+  }
+}
+
+// Shared implementation; exactly one of "labels" and "sparse_labels" is
+// non-null.
+template <typename T, typename Index>
+void Compute(DeviceBase* d, int64 batch_size, int64 num_classes,
+             const T* logits, const T* labels, const Index* sparse_labels,
+             T* loss, T* backprop) {
+  typedef typename ComputeType<T>::type Acc;
+  if (batch_size == 0) return;
+  if (num_classes == 0) {
+    std::fill(loss, loss + batch_size, T(0));
+    return;
+  }
+  const int64 segments = (num_classes + kSegmentSize - 1) / kSegmentSize;
+  const int64 segment_size = std::min(num_classes, kSegmentSize);
+
+  const auto* worker_threads = d->tensorflow_cpu_worker_threads();
+  // Each logit costs a subtraction, an exp and a few additions per pass.
+  const int64 cost_per_unit = segment_size * (labels != nullptr ? 24 : 16);
+
+  std::vector<SegmentStats<Acc>> stats(batch_size * segments);
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        batch_size * segments, cost_per_unit, [&](int64 start, int64 limit) {
+          for (int64 unit = start; unit < limit; ++unit) {
+            const int64 row = unit / segments;
+            const int64 begin = (unit % segments) * segment_size;
+            const int64 size = std::min(segment_size, num_classes - begin);
+            const int64 offset = row * num_classes + begin;
+            stats[unit] = ReduceSegment(
+                logits + offset, labels ? labels + offset : nullptr, size);
+          }
+        });
+
+  // Merges the segments of every row.
+  std::vector<Acc> row_max(batch_size);
+  std::vector<Acc> row_inv_sum_exp(batch_size);
+  for (int64 row = 0; row < batch_size; ++row) {
+    const SegmentStats<Acc>* row_stats = &stats[row * segments];
+    Acc max = row_stats[0].max;
+    for (int64 s = 1; s < segments; ++s) {
+      max = std::max(max, row_stats[s].max);
+    }
+    Acc sum_exp = 0;
+    Acc label_sum = 0;
+    Acc label_dot = 0;
+    for (int64 s = 0; s < segments; ++s) {
+      const SegmentStats<Acc>& seg = row_stats[s];
+      const Acc shift = seg.max - max;
+      sum_exp += seg.sum_exp * std::exp(shift);
+      label_sum += seg.label_sum;
+      label_dot += seg.label_dot + seg.label_sum * shift;
+    }
+    const Acc log_sum_exp = std::log(sum_exp);
+    if (labels != nullptr) {
+      loss[row] = static_cast<T>(label_sum * log_sum_exp - label_dot);
+    } else {
+      const Acc x = static_cast<Acc>(
+          logits[row * num_classes + sparse_labels[row]]);
+      loss[row] = static_cast<T>(log_sum_exp - (x - max));
+    }
+    row_max[row] = max;
+    row_inv_sum_exp[row] = Acc(1) / sum_exp;
+  }
+
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        batch_size * segments, cost_per_unit, [&](int64 start, int64 limit) {
+          for (int64 unit = start; unit < limit; ++unit) {
+            const int64 row = unit / segments;
+            const int64 begin = (unit % segments) * segment_size;
+            const int64 size = std::min(segment_size, num_classes - begin);
+            const int64 offset = row * num_classes + begin;
+            const int64 label =
+                sparse_labels ? static_cast<int64>(sparse_labels[row]) - begin
+                              : -1;
+            SegmentBackprop(logits + offset, labels ? labels + offset : nullptr,
+                            label, size, row_max[row], row_inv_sum_exp[row],
+                            backprop + offset);
+          }
+        });
+}
+
+}  // namespace softmax_xent_internal
+
+// Computes the loss and backprop of SoftmaxCrossEntropyWithLogits for
+// row-major [batch_size, num_classes] "logits" and "labels".
+template <typename T>
+void SoftmaxXentCPU(DeviceBase* d, int64 batch_size, int64 num_classes,
+                    const T* logits, const T* labels, T* loss, T* backprop) {
+  softmax_xent_internal::Compute<T, int32>(d, batch_size, num_classes, logits,
+                                           labels, nullptr, loss, backprop);
+}
+
+// Computes the loss and backprop of SparseSoftmaxCrossEntropyWithLogits.
+// Requires every label to be in [0, num_classes).
+template <typename T, typename Index>
+void SparseSoftmaxXentCPU(DeviceBase* d, int64 batch_size, int64 num_classes,
+                          const T* logits, const Index* labels, T* loss,
+                          T* backprop) {
+  softmax_xent_internal::Compute<T, Index>(d, batch_size, num_classes, logits,
+                                           nullptr, labels, loss, backprop);
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_SOFTMAX_XENT_CPU_H_
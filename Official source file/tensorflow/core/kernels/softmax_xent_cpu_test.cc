@@ -0,0 +1,210 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/softmax_xent_cpu.h"
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using softmax_xent_internal::kChunkSize;
+using softmax_xent_internal::kSegmentSize;
+
+class TestDevice : public DeviceBase {
+ public:
+  TestDevice() : DeviceBase(Env::Default()), pool_(Env::Default(), "test", 4) {
+    threads_.num_threads = 4;
+    threads_.workers = &pool_;
+    set_tensorflow_cpu_worker_threads(&threads_);
+  }
+
+ private:
+  thread::ThreadPool pool_;
+  CpuWorkerThreads threads_;
+};
+
+// Absolute error allowed per unit of magnitude of a result.
+template <typename T>
+double Tolerance();
+template <>
+double Tolerance<float>() {
+  return 1e-5;
+}
+template <>
+double Tolerance<double>() {
+  return 1e-12;
+}
+template <>
+double Tolerance<Eigen::half>() {
+  return 2e-3;
+}
+
+// Returns logits that mix random values in [-scale, scale) with a ramp that
+// raises the running maximum of every chunk, so that the rebasing of the
+// sums is exercised.
+template <typename T>
+std::vector<T> MakeLogits(int64 batch_size, int64 num_classes, double scale,
+                          random::SimplePhilox* rnd) {
+  std::vector<T> logits(batch_size * num_classes);
+  for (int64 row = 0; row < batch_size; ++row) {
+    for (int64 j = 0; j < num_classes; ++j) {
+      double x = (rnd->RandDouble() * 2 - 1) * scale;
+      if (row % 2 == 1) x = x / 4 + scale * j / num_classes;
+      logits[row * num_classes + j] = static_cast<T>(x);
+    }
+  }
+  return logits;
+}
+
+// Checks "loss" and "backprop" against values computed in double from
+// "logits" and the labels "label(row, j)".
+template <typename T, typename LabelFn>
+void CheckResults(int64 batch_size, int64 num_classes,
+                  const std::vector<T>& logits, const LabelFn& label,
+                  const std::vector<T>& loss, const std::vector<T>& backprop) {
+  const double tolerance = Tolerance<T>();
+  for (int64 row = 0; row < batch_size; ++row) {
+    const T* x = &logits[row * num_classes];
+    double max = static_cast<double>(x[0]);
+    for (int64 j = 1; j < num_classes; ++j) {
+      max = std::max(max, static_cast<double>(x[j]));
+    }
+    double sum_exp = 0;
+    for (int64 j = 0; j < num_classes; ++j) {
+      sum_exp += std::exp(static_cast<double>(x[j]) - max);
+    }
+    double expected_loss = 0;
+    double loss_magnitude = 1;
+    for (int64 j = 0; j < num_classes; ++j) {
+      const double term = std::log(sum_exp) - (static_cast<double>(x[j]) - max);
+      expected_loss += label(row, j) * term;
+      loss_magnitude += std::abs(label(row, j) * term);
+      const double expected_backprop =
+          std::exp(static_cast<double>(x[j]) - max) / sum_exp - label(row, j);
+      EXPECT_NEAR(static_cast<double>(backprop[row * num_classes + j]),
+                  expected_backprop,
+                  tolerance * (1 + std::abs(label(row, j))))
+          << "row " << row << " class " << j;
+    }
+    EXPECT_NEAR(static_cast<double>(loss[row]), expected_loss,
+                tolerance * loss_magnitude)
+        << "row " << row;
+  }
+}
+
+template <typename T>
+void CheckDense(int64 batch_size, int64 num_classes, double scale) {
+  random::PhiloxRandom philox(batch_size, num_classes);
+  random::SimplePhilox rnd(&philox);
+  const std::vector<T> logits =
+      MakeLogits<T>(batch_size, num_classes, scale, &rnd);
+  // Labels need not be a distribution: some rows are, others sum to about 4.
+  std::vector<T> labels(batch_size * num_classes);
+  for (int64 row = 0; row < batch_size; ++row) {
+    double sum = 0;
+    std::vector<double> p(num_classes);
+    for (double& v : p) sum += v = rnd.RandDouble();
+    for (int64 j = 0; j < num_classes; ++j) {
+      labels[row * num_classes + j] =
+          static_cast<T>(p[j] / (row % 3 == 0 ? num_classes / 8.0 : sum));
+    }
+  }
+  std::vector<T> loss(batch_size);
+  std::vector<T> backprop(batch_size * num_classes);
+  TestDevice device;
+  SoftmaxXentCPU<T>(&device, batch_size, num_classes, logits.data(),
+                    labels.data(), loss.data(), backprop.data());
+  CheckResults(batch_size, num_classes, logits,
+               [&labels, num_classes](int64 row, int64 j) {
+                 return static_cast<double>(labels[row * num_classes + j]);
+               },
+               loss, backprop);
+}
+
+template <typename T, typename Index>
+void CheckSparse(int64 batch_size, int64 num_classes, double scale) {
+  random::PhiloxRandom philox(batch_size, num_classes);
+  random::SimplePhilox rnd(&philox);
+  const std::vector<T> logits =
+      MakeLogits<T>(batch_size, num_classes, scale, &rnd);
+  std::vector<Index> labels(batch_size);
+  for (Index& label : labels) label = rnd.Uniform64(num_classes);
+  std::vector<T> loss(batch_size);
+  std::vector<T> backprop(batch_size * num_classes);
+  TestDevice device;
+  SparseSoftmaxXentCPU<T, Index>(&device, batch_size, num_classes,
+                                 logits.data(), labels.data(), loss.data(),
+                                 backprop.data());
+  CheckResults(batch_size, num_classes, logits,
+               [&labels](int64 row, int64 j) {
+                 return labels[row] == j ? 1.0 : 0.0;
+               },
+               loss, backprop);
+}
+
+// Shapes with rows of one chunk, several chunks and several segments.
+const int64 kShapes[][2] = {
+    {1, 1},
+    {3, 7},
+    {64, 100},
+    {5, kChunkSize + 1},
+    {2, 3 * kChunkSize - 5},
+    {3, kSegmentSize + 3},
+    {2, 3 * kSegmentSize + 1000},
+};
+
+TEST(SoftmaxXentCPUTest, Dense) {
+  for (const auto& shape : kShapes) {
+    CheckDense<float>(shape[0], shape[1], 10);
+    CheckDense<double>(shape[0], shape[1], 10);
+    CheckDense<Eigen::half>(shape[0], shape[1], 4);
+  }
+}
+
+TEST(SoftmaxXentCPUTest, Sparse) {
+  for (const auto& shape : kShapes) {
+    CheckSparse<float, int32>(shape[0], shape[1], 10);
+    CheckSparse<float, int64>(shape[0], shape[1], 10);
+    CheckSparse<double, int64>(shape[0], shape[1], 10);
+    CheckSparse<Eigen::half, int32>(shape[0], shape[1], 4);
+  }
+}
+
+TEST(SoftmaxXentCPUTest, LargeLogits) {
+  // exp() of the logits overflows; only differences from the maximum may be
+  // exponentiated.
+  CheckDense<float>(4, 2 * kSegmentSize + 7, 1e4);
+  CheckSparse<float, int32>(4, 2 * kSegmentSize + 7, 1e4);
+  CheckDense<double>(4, 3 * kChunkSize, 1e6);
+}
+
+TEST(SoftmaxXentCPUTest, NoClasses) {
+  TestDevice device;
+  std::vector<float> loss(3, -1.0f);
+  SoftmaxXentCPU<float>(&device, 3, 0, nullptr, nullptr, loss.data(),
+                        nullptr);
+  for (float l : loss) EXPECT_EQ(0.0f, l);
+}
+
+}  // namespace
+}  // namespace tensorflow
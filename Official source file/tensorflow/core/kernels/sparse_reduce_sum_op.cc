@@ -193,7 +193,8 @@ class SparseReduceSumOp : public OpKernel {
 
     // Each group maps one-on-one onto a value in the reduced tensor.
     // g.group() provides the coordinates of a particular reduced value.
-    sp.Reorder<T>(reduction.reorder_dims);
+    sp.Reorder<T>(reduction.reorder_dims,
+                  ctx->device()->tensorflow_cpu_worker_threads()->workers);
     for (const auto &g : sp.group(reduction.group_by_dims)) {
       group_sum.device(ctx->eigen_cpu_device()) = g.template values<T>().sum();
       const int64 idx = CoordinatesToFlatIndex(g.group(), output_strides);
@@ -236,7 +237,8 @@ class SparseReduceSumSparseOp : public OpKernel {
     ReduceDetails reduction = SparseTensorReduceHelper(
         sp, reduction_axes_t->flat<int32>(), keep_dims_);
 
-    sp.Reorder<T>(reduction.reorder_dims);
+    sp.Reorder<T>(reduction.reorder_dims,
+                  ctx->device()->tensorflow_cpu_worker_threads()->workers);
     // Count nnzs in the output SparseTensor.
     int64 nnz = 0;
     auto iter = sp.group(reduction.group_by_dims);
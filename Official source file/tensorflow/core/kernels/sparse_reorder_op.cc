@@ -70,7 +70,9 @@ class SparseReorderOp : public OpKernel {
       sparse::SparseTensor reordered_sp(tensor::DeepCopy(input_ind),
                                         tensor::DeepCopy(input_val),
                                         input_shape);
-      reordered_sp.Reorder<T>(std_order);
+      reordered_sp.Reorder<T>(
+          std_order,
+          context->device()->tensorflow_cpu_worker_threads()->workers);
       context->set_output(0, reordered_sp.indices());
       context->set_output(1, reordered_sp.values());
     }
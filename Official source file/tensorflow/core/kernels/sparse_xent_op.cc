@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/softmax_xent_cpu.h"
 
 namespace tensorflow {
 
@@ -47,6 +48,37 @@ Status CheckInvalidLabelIndex(const Tensor& labels, int64 max_index) {
   return Status::OK();
 }
 
+template <typename Device, typename T, typename Index>
+struct LaunchSparseXent {
+  static void Launch(OpKernelContext* context, const Tensor& logits,
+                     const Tensor& labels, Tensor* loss_out,
+                     Tensor* back_out) {
+    Tensor scratch;
+    OP_REQUIRES_OK(context, context->allocate_temp(DataTypeToEnum<T>::value,
+                                                   labels.shape(), &scratch));
+    functor::SparseXentFunctor<Device, T, Index> functor;
+    functor(context->eigen_device<Device>(), logits.matrix<T>(),
+            labels.vec<Index>(), scratch.vec<T>(), loss_out->vec<T>(),
+            back_out->matrix<T>());
+  }
+};
+
+// The CPU computes loss and backprop in two fused passes over the logits,
+// without the scratch tensor and the intermediates of SparseXentEigenImpl.
+template <typename T, typename Index>
+struct LaunchSparseXent<CPUDevice, T, Index> {
+  static void Launch(OpKernelContext* context, const Tensor& logits,
+                     const Tensor& labels, Tensor* loss_out,
+                     Tensor* back_out) {
+    OP_REQUIRES_OK(context,
+                   CheckInvalidLabelIndex<Index>(labels, logits.dim_size(1)));
+    SparseSoftmaxXentCPU<T, Index>(
+        context->device(), logits.dim_size(0), logits.dim_size(1),
+        logits.flat<T>().data(), labels.flat<Index>().data(),
+        loss_out->flat<T>().data(), back_out->flat<T>().data());
+  }
+};
+
 template <typename Device, typename T, typename Index>
 class SparseSoftmaxXentWithLogitsOp : public OpKernel {
  public:
@@ -73,10 +105,6 @@ class SparseSoftmaxXentWithLogitsOp : public OpKernel {
                     "Must have at least one class, but got logits shape ",
                     logits.shape().DebugString()));
 
-    Tensor scratch;
-    OP_REQUIRES_OK(context, context->allocate_temp(DataTypeToEnum<T>::value,
-                                                   labels.shape(), &scratch));
-
     Tensor* loss_out = nullptr;
     OP_REQUIRES_OK(context,
                    context->allocate_output(0, labels.shape(), &loss_out));
@@ -85,33 +113,12 @@ class SparseSoftmaxXentWithLogitsOp : public OpKernel {
                    context->allocate_output(1, logits.shape(), &back_out));
 
     if (logits.dim_size(0) > 0) {
-      if (std::is_same<Device, CPUDevice>::value) {
-        OP_REQUIRES_OK(
-            context, CheckInvalidLabelIndex<Index>(labels, logits.dim_size(1)));
-      }
-      functor::SparseXentFunctor<Device, T, Index> functor;
-      functor(context->eigen_device<Device>(), logits.matrix<T>(),
-              labels.vec<Index>(), scratch.vec<T>(), loss_out->vec<T>(),
-              back_out->matrix<T>());
+      LaunchSparseXent<Device, T, Index>::Launch(context, logits, labels,
+                                                 loss_out, back_out);
     }
   }
 };
 
-// Partial specialization for a CPUDevice, that uses the Eigen implementation
-// from XentEigenImpl.
-namespace functor {
-template <typename T, typename Index>
-struct SparseXentFunctor<CPUDevice, T, Index> {
-  void operator()(const CPUDevice& d, typename TTypes<T>::ConstMatrix logits,
-                  typename TTypes<Index>::ConstVec labels,
-                  typename TTypes<T>::Vec scratch, typename TTypes<T>::Vec loss,
-                  typename TTypes<T>::Matrix backprop) {
-    SparseXentEigenImpl<CPUDevice, T, Index>::Compute(d, logits, labels,
-                                                      scratch, loss, backprop);
-  }
-};
-}  // namespace functor
-
 #define REGISTER(Dev, T, Index)                   \
   REGISTER_KERNEL_BUILDER(                        \
       Name("SparseSoftmaxCrossEntropyWithLogits") \
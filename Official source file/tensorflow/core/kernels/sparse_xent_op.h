@@ -145,8 +145,8 @@ struct SparseXentFunctor {
 };
 
 // Eigen code implementing SparseXentFunctor::operator().
-// This code works for both CPU and GPU and is used by the functor
-// specializations for both device types.
+// This code is used by the GPU functor specializations; the CPU kernels use
+// the fused implementation in softmax_xent_cpu.h.
 template <typename Device, typename T, typename Index>
 struct SparseXentEigenImpl {
   static void Compute(const Device& d, typename TTypes<T>::ConstMatrix logits,
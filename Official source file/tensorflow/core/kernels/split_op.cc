@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/kernels/concat_lib_cpu.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -151,6 +152,25 @@ class SplitOpCPU : public SplitOpBase<CPUDevice, T> {
     TensorShape output_shape(input_shape);
     output_shape.set_dim(split_dim, split_dim_output_size);
 
+    // Narrow outputs are copied row block by row block, all at once.
+    const int64 piece_bytes =
+        split_dim_output_size * suffix_dim_size * sizeof(T);
+    if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v()) &&
+        UseBlockedRowCopy(prefix_dim_size, piece_bytes * num_split,
+                          num_split)) {
+      std::vector<char*> pieces(num_split);
+      for (int i = 0; i < num_split; ++i) {
+        Tensor* result = nullptr;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(i, output_shape, &result));
+        pieces[i] = reinterpret_cast<char*>(result->flat<T>().data());
+      }
+      SplitRowsCPU(context->device(), prefix_dim_size,
+                   reinterpret_cast<const char*>(input.flat<T>().data()),
+                   pieces, std::vector<int64>(num_split, piece_bytes));
+      return;
+    }
+
     Eigen::DSizes<Eigen::DenseIndex, 3> indices{0, 0, 0};
     Eigen::DSizes<Eigen::DenseIndex, 3> sizes{
         prefix_dim_size, split_dim_output_size, suffix_dim_size};
@@ -0,0 +1,70 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <functional>
+#include <memory>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Splits a kDim1 x (num_split * dim2) float matrix into "num_split" outputs
+// of kDim1 x dim2 along dimension 1.
+static void BM_SplitNarrowDim1Float(int iters, int num_split, int dim2) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  const int kDim1 = 1024;
+  Tensor split_dim(DT_INT32, TensorShape({}));
+  split_dim.scalar<int32>()() = 1;
+  Tensor input(DT_FLOAT, TensorShape({kDim1, num_split * dim2}));
+  input.flat<float>().setRandom();
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Split")
+                  .Input(test::graph::Constant(g, split_dim))
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("num_split", num_split)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+  testing::BytesProcessed(static_cast<int64>(iters) * kDim1 * dim2 *
+                          num_split * sizeof(float));
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+  testing::UseRealTime();
+}
+
+BENCHMARK(BM_SplitNarrowDim1Float)
+    ->ArgPair(16, 1)
+    ->ArgPair(16, 4)
+    ->ArgPair(16, 32)
+    ->ArgPair(64, 1)
+    ->ArgPair(64, 4)
+    ->ArgPair(64, 32)
+    ->ArgPair(256, 1)
+    ->ArgPair(256, 4)
+    ->ArgPair(256, 32);
+
+}  // namespace
+}  // namespace tensorflow
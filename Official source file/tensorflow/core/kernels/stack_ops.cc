@@ -16,7 +16,12 @@ limitations under the License.
 // See docs in ../ops/data_flow_ops.cc.
 
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
 #include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -30,7 +35,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -42,6 +52,232 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+// A scratch file holding the entries spilled by one Stack.  The reads and
+// writes of a file run one at a time, in the order they were scheduled, on a
+// thread pool shared by all stacks.
+class SpillFile : public std::enable_shared_from_this<SpillFile> {
+ public:
+  // Creates a new file in 'dir'.
+  static Status Create(Env* env, const string& dir,
+                       std::shared_ptr<SpillFile>* result) {
+    const string filename = io::JoinPath(
+        dir, strings::StrCat("stack_spill_", strings::FpToString(
+                                                 random::New64())));
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+    result->reset(new SpillFile(env, filename, std::move(file)));
+    return Status::OK();
+  }
+
+  ~SpillFile() {
+    writer_->Close();
+    reader_.reset();
+    Status s = env_->DeleteFile(filename_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to remove stack spill file " << filename_ << ": "
+                   << s;
+    }
+  }
+
+  // Runs 'fn' after the functions scheduled before it have run.
+  void Schedule(std::function<void()> fn) {
+    bool start = false;
+    {
+      mutex_lock l(mu_);
+      tasks_.push_back(std::move(fn));
+      if (!running_) {
+        running_ = true;
+        start = true;
+      }
+    }
+    if (start) {
+      std::shared_ptr<SpillFile> self = shared_from_this();
+      IOThreadPool()->Schedule([self]() { self->RunTasks(); });
+    }
+  }
+
+  // Appends the data of 'tensor', which must start at byte 'offset' of the
+  // file.  Only called from scheduled functions.
+  Status Write(int64 offset, const Tensor& tensor) {
+    if (offset != size_) {
+      // An earlier write failed.
+      return errors::Internal("Stack spill file ", filename_, " has ", size_,
+                              " bytes, cannot write at offset ", offset);
+    }
+    const StringPiece data = tensor.tensor_data();
+    TF_RETURN_IF_ERROR(writer_->Append(data));
+    TF_RETURN_IF_ERROR(writer_->Flush());
+    size_ += data.size();
+    return Status::OK();
+  }
+
+  // Reads the data of 'tensor', which must be allocated with the right type
+  // and shape, from byte 'offset' of the file.  Only called from scheduled
+  // functions.
+  Status Read(int64 offset, Tensor* tensor) {
+    if (reader_ == nullptr) {
+      TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &reader_));
+    }
+    const StringPiece data = tensor->tensor_data();
+    char* buf = const_cast<char*>(data.data());
+    StringPiece result;
+    TF_RETURN_IF_ERROR(reader_->Read(offset, data.size(), &result, buf));
+    if (result.size() != data.size()) {
+      return errors::DataLoss("Read ", result.size(), " bytes instead of ",
+                              data.size(), " at offset ", offset,
+                              " of stack spill file ", filename_);
+    }
+    if (result.data() != buf) memcpy(buf, result.data(), result.size());
+    return Status::OK();
+  }
+
+ private:
+  SpillFile(Env* env, const string& filename,
+            std::unique_ptr<WritableFile> writer)
+      : env_(env), filename_(filename), writer_(std::move(writer)) {}
+
+  static thread::ThreadPool* IOThreadPool() {
+    static thread::ThreadPool* pool =
+        new thread::ThreadPool(Env::Default(), "stack_spill", 4);
+    return pool;
+  }
+
+  void RunTasks() {
+    while (true) {
+      std::function<void()> fn;
+      {
+        mutex_lock l(mu_);
+        if (tasks_.empty()) {
+          running_ = false;
+          return;
+        }
+        fn = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      fn();
+    }
+  }
+
+  Env* const env_;
+  const string filename_;
+  // Only accessed by the scheduled functions.
+  std::unique_ptr<WritableFile> writer_;
+  std::unique_ptr<RandomAccessFile> reader_;
+  int64 size_ = 0;
+
+  mutex mu_;
+  std::deque<std::function<void()>> tasks_ GUARDED_BY(mu_);
+  bool running_ GUARDED_BY(mu_) = false;
+};
+
+// A stack entry whose data is written to a SpillFile, and read back when the
+// entry is about to be popped.
+class SpilledTensor : public std::enable_shared_from_this<SpilledTensor> {
+ public:
+  typedef std::function<void(const Status&, const Tensor&)> LoadCallback;
+
+  SpilledTensor(std::shared_ptr<SpillFile> file, int64 offset,
+                const Tensor& tensor)
+      : file_(std::move(file)),
+        offset_(offset),
+        dtype_(tensor.dtype()),
+        shape_(tensor.shape()),
+        state_(kWriting),
+        tensor_(tensor) {}
+
+  int64 TotalBytes() const {
+    return shape_.num_elements() * DataTypeSize(dtype_);
+  }
+
+  // Writes the tensor to the file, and releases it once it is written.
+  void StartWrite() {
+    std::shared_ptr<SpilledTensor> self = shared_from_this();
+    file_->Schedule([self]() {
+      Tensor tensor;
+      {
+        mutex_lock l(self->mu_);
+        tensor = self->tensor_;
+      }
+      Status s = self->file_->Write(self->offset_, tensor);
+      mutex_lock l(self->mu_);
+      if (s.ok()) {
+        self->state_ = kOnDisk;
+        self->tensor_ = Tensor();
+      } else {
+        // Keep the tensor in memory.
+        LOG(WARNING) << "Failed to spill a stack entry: " << s;
+        self->state_ = kInMemory;
+      }
+    });
+  }
+
+  // Starts reading the tensor back into memory if it is only on disk.
+  void Prefetch() {
+    {
+      mutex_lock l(mu_);
+      if (state_ != kOnDisk) return;
+      state_ = kLoading;
+    }
+    std::shared_ptr<SpilledTensor> self = shared_from_this();
+    file_->Schedule([self]() {
+      Tensor tensor(cpu_allocator(), self->dtype_, self->shape_);
+      Status s = self->file_->Read(self->offset_, &tensor);
+      std::vector<LoadCallback> waiters;
+      {
+        mutex_lock l(self->mu_);
+        self->state_ = kInMemory;
+        self->status_ = s;
+        if (s.ok()) self->tensor_ = tensor;
+        waiters.swap(self->waiters_);
+      }
+      for (const LoadCallback& done : waiters) {
+        done(s, tensor);
+      }
+    });
+  }
+
+  // Calls 'done' with the tensor once it is in memory.
+  void Load(LoadCallback done) {
+    Prefetch();
+    Tensor tensor;
+    Status s;
+    {
+      mutex_lock l(mu_);
+      if (state_ == kLoading) {
+        waiters_.push_back(std::move(done));
+        return;
+      }
+      tensor = tensor_;
+      s = status_;
+    }
+    done(s, tensor);
+  }
+
+ private:
+  enum State {
+    // The tensor is in memory and being written.
+    kWriting,
+    // The tensor is only in the file.
+    kOnDisk,
+    // The tensor is being read back.
+    kLoading,
+    // The tensor was read back, or could not be written.
+    kInMemory,
+  };
+
+  const std::shared_ptr<SpillFile> file_;
+  const int64 offset_;
+  const DataType dtype_;
+  const TensorShape shape_;
+
+  mutex mu_;
+  State state_ GUARDED_BY(mu_);
+  Tensor tensor_ GUARDED_BY(mu_);
+  // The error of a failed read.
+  Status status_ GUARDED_BY(mu_);
+  std::vector<LoadCallback> waiters_ GUARDED_BY(mu_);
+};
+
 class Stack : public ResourceBase {
  public:
   static std::atomic<int64> stack_counter;
@@ -50,18 +286,41 @@ class Stack : public ResourceBase {
     Tensor tensor;
     AllocatorAttributes alloc_attrs;
     bool swapped_to_cpu;
+    // Whether the entry may be spilled to a scratch file.
+    bool spillable;
+    // Set once the entry is spilled, in which case 'tensor' is empty.
+    std::shared_ptr<SpilledTensor> spill;
+  };
+
+  // Options for spilling the spillable entries of a stack on CPU.
+  struct SpillOptions {
+    Env* env = nullptr;
+    // The directory of the scratch file.
+    string dir;
+    // The spillable entries are kept in memory up to this many bytes,
+    // beyond which the oldest ones are spilled.
+    int64 resident_limit_bytes = 0;
   };
 
   Stack(const DataType& elem_type, const Tensor& handle)
       : elem_type_(elem_type), handle_(handle), closed_(false) {}
 
-  Status Push(const TensorAndAllocation& value) {
+  // If 'spill_options' is not null, spills the oldest spillable entries
+  // once they exceed the resident limit.
+  Status Push(const TensorAndAllocation& value,
+              const SpillOptions* spill_options = nullptr) {
     mutex_lock l(mu_);
     TF_RETURN_IF_ERROR(CheckNotClosed());
     stack_.push_back(value);
+    if (value.spillable) {
+      resident_bytes_ += value.tensor.TotalBytes();
+      if (spill_options != nullptr) MaybeSpillLocked(*spill_options);
+    }
     return Status::OK();
   }
 
+  // If the popped entry was spilled, its tensor must be read back with
+  // value->spill->Load().
   Status Pop(TensorAndAllocation* value) {
     mutex_lock l(mu_);
     TF_RETURN_IF_ERROR(CheckNotClosed());
@@ -72,6 +331,11 @@ class Stack : public ResourceBase {
     }
     *value = stack_.back();
     stack_.pop_back();
+    if (value->spillable && value->spill == nullptr) {
+      resident_bytes_ -= value->tensor.TotalBytes();
+    }
+    if (next_to_spill_ > stack_.size()) next_to_spill_ = stack_.size();
+    if (spill_file_ != nullptr) PrefetchLocked();
     return Status::OK();
   }
 
@@ -89,6 +353,8 @@ class Stack : public ResourceBase {
   void Close() {
     mutex_lock l(mu_);
     stack_.clear();
+    // The file is removed once its pending reads and writes are done.
+    spill_file_.reset();
     closed_ = true;
   }
 
@@ -105,12 +371,71 @@ class Stack : public ResourceBase {
   mutex* mu() { return &mu_; }
   Tensor* handle() { return &handle_; }
 
+  // Spills the oldest spillable entries in memory while they exceed the
+  // resident limit.
+  void MaybeSpillLocked(const SpillOptions& options)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (resident_bytes_ <= options.resident_limit_bytes || spill_disabled_) {
+      return;
+    }
+    if (spill_file_ == nullptr) {
+      resident_limit_bytes_ = options.resident_limit_bytes;
+      Status s = SpillFile::Create(options.env, options.dir, &spill_file_);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to create a stack spill file in "
+                     << options.dir << ": " << s;
+        spill_disabled_ = true;
+        return;
+      }
+    }
+    while (resident_bytes_ > options.resident_limit_bytes &&
+           next_to_spill_ < stack_.size()) {
+      TensorAndAllocation& entry = stack_[next_to_spill_++];
+      if (!entry.spillable || entry.spill != nullptr) continue;
+      const int64 bytes = entry.tensor.TotalBytes();
+      entry.spill.reset(
+          new SpilledTensor(spill_file_, spill_file_size_, entry.tensor));
+      entry.tensor = Tensor();
+      entry.spill->StartWrite();
+      spill_file_size_ += bytes;
+      resident_bytes_ -= bytes;
+    }
+  }
+
+  // Starts reading back the spilled entries that are close to the top of
+  // the stack, so that they are in memory by the time they are popped.
+  void PrefetchLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    // Reading ahead by half the resident limit bounds the memory used by
+    // the prefetched entries, while leaving the reads plenty of time.
+    const int64 window_bytes = resident_limit_bytes_ / 2;
+    int64 bytes = 0;
+    for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+      if (!it->spillable) continue;
+      if (it->spill != nullptr) {
+        it->spill->Prefetch();
+        bytes += it->spill->TotalBytes();
+      } else {
+        bytes += it->tensor.TotalBytes();
+      }
+      if (bytes >= window_bytes) break;
+    }
+  }
+
   mutable mutex mu_;
   DataType elem_type_;
   Tensor handle_;
   bool closed_ GUARDED_BY(mu_);
   std::vector<TensorAndAllocation> stack_ GUARDED_BY(mu_);
 
+  // Total size of the spillable entries that are not spilled.
+  int64 resident_bytes_ GUARDED_BY(mu_) = 0;
+  int64 resident_limit_bytes_ GUARDED_BY(mu_) = 0;
+  // The entries below this index are spilled or not spillable.
+  size_t next_to_spill_ GUARDED_BY(mu_) = 0;
+  std::shared_ptr<SpillFile> spill_file_ GUARDED_BY(mu_);
+  int64 spill_file_size_ GUARDED_BY(mu_) = 0;
+  bool spill_disabled_ GUARDED_BY(mu_) = false;
+
   Status CheckNotClosed() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     if (closed_) {
       const string& stack_name = handle_.vec<string>()(1);
@@ -182,11 +507,35 @@ REGISTER_KERNEL_BUILDER(Name("Stack").Device(DEVICE_CPU), StackOp);
 REGISTER_KERNEL_BUILDER(Name("Stack").Device(DEVICE_GPU).HostMemory("handle"),
                         StackOp);
 
+// On CPU, the entries pushed with swap_memory are spilled to a scratch file
+// in the directory named by the TF_STACK_SPILL_DIR environment variable, if
+// it is set.  Each stack keeps up to TF_STACK_RESIDENT_LIMIT_IN_MB megabytes
+// (default 64) of them in memory.  Returns nullptr if spilling is disabled.
+static Stack::SpillOptions* NewCpuSpillOptions(Env* env) {
+  const char* dir = getenv("TF_STACK_SPILL_DIR");
+  if (dir == nullptr || strcmp(dir, "") == 0) return nullptr;
+  Stack::SpillOptions* options = new Stack::SpillOptions;
+  options->env = env;
+  options->dir = dir;
+  int64 limit_in_mb = 64;
+  const char* limit_str = getenv("TF_STACK_RESIDENT_LIMIT_IN_MB");
+  if (limit_str != nullptr && strcmp(limit_str, "") != 0 &&
+      !strings::safe_strto64(limit_str, &limit_in_mb)) {
+    LOG(WARNING) << "Invalid value for env-var TF_STACK_RESIDENT_LIMIT_IN_MB: "
+                 << limit_str;
+  }
+  options->resident_limit_bytes = limit_in_mb * (1 << 20);
+  return options;
+}
+
 template <typename Device>
 class StackPushOp : public AsyncOpKernel {
  public:
   explicit StackPushOp(OpKernelConstruction* context) : AsyncOpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("swap_memory", &swap_memory_));
+    if (swap_memory_ && std::is_same<Device, CPUDevice>::value) {
+      spill_options_.reset(NewCpuSpillOptions(context->env()));
+    }
   }
 
   void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
@@ -251,8 +600,14 @@ class StackPushOp : public AsyncOpKernel {
       }
     }
 
-    // Execute synchronously if not swapped.
-    OP_REQUIRES_OK(ctx, stack->Push({tensor, alloc_attrs, false}));
+    // Execute synchronously if not swapped.  On CPU, the stack writes the
+    // tensor to its spill file in the background if spilling is enabled.
+    const bool spillable = spill_options_ != nullptr &&
+                           DataTypeCanUseMemcpy(tensor.dtype()) &&
+                           tensor.TotalBytes() > kCopyThreshold &&
+                           stack->IsUsefulToSwap(tensor);
+    OP_REQUIRES_OK(ctx, stack->Push({tensor, alloc_attrs, false, spillable},
+                                    spill_options_.get()));
     ctx->set_output(0, tensor);
     done();
   }
@@ -261,6 +616,7 @@ class StackPushOp : public AsyncOpKernel {
 
  private:
   bool swap_memory_;
+  std::unique_ptr<Stack::SpillOptions> spill_options_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("StackPush").Device(DEVICE_CPU),
@@ -317,7 +673,17 @@ class StackPopOp : public AsyncOpKernel {
       done();
       return;
     }
-    if (value.swapped_to_cpu) {
+    if (value.spill != nullptr) {
+      // Wait for the tensor to be read back from the spill file, which
+      // usually started with an earlier Pop().
+      value.spill->Load([ctx, done](const Status& s, const Tensor& tensor) {
+        ctx->SetStatus(s);
+        if (s.ok()) {
+          ctx->set_output(0, tensor);
+        }
+        done();
+      });
+    } else if (value.swapped_to_cpu) {
       // Asynchronously copy the tensor back from CPU to GPU memory.
       DeviceContext* device_ctxt = ctx->op_device_context();
       Device* device = static_cast<Device*>(ctx->device());
@@ -27,7 +27,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -78,13 +80,35 @@ class SummaryHistoOp : public OpKernel {
   explicit SummaryHistoOp(OpKernelConstruction* context) : OpKernel(context) {}
 
   void Compute(OpKernelContext* c) override {
+    // Approximate cost of finding the bucket of one value.
+    static const int64 kBucketCost = 20;
+
     const Tensor& tags = c->input(0);
     const Tensor& values = c->input(1);
     const auto flat = values.flat<T>();
     OP_REQUIRES(c, IsLegacyScalar(tags.shape()),
                 errors::InvalidArgument("tags must be scalar"));
-    // Build histogram of values in "values" tensor
+    // Build histogram of values in "values" tensor. The buckets of large
+    // tensors are counted in parallel; the sums are then accumulated in
+    // order, so the histogram is exactly the one Add() would build.
     histogram::Histogram histo;
+    mutex mu;
+    auto worker_threads = *(c->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, flat.size(),
+          kBucketCost, [&flat, &histo, &mu](int64 start, int64 limit) {
+            histogram::Histogram partial;
+            for (int64 i = start; i < limit; i++) {
+              const double double_val = static_cast<double>(flat(i));
+              // Reported below.
+              if (Eigen::numext::isnan(double_val) ||
+                  Eigen::numext::isinf(double_val)) {
+                continue;
+              }
+              partial.AddToBuckets(double_val);
+            }
+            mutex_lock l(mu);
+            histo.Merge(partial);
+          });
     for (int64 i = 0; i < flat.size(); i++) {
       const double double_val = static_cast<double>(flat(i));
       if (Eigen::numext::isnan(double_val)) {
@@ -96,7 +120,7 @@ class SummaryHistoOp : public OpKernel {
             "Infinity in summary histogram for: ", name()));
         break;
       }
-      histo.Add(double_val);
+      histo.AddToSums(double_val);
     }
 
     Summary s;
@@ -13,8 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <math.h>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -249,6 +251,45 @@ TEST_F(SummaryHistoOpTest, SimpleHalf) {
       histo.ToString());
 }
 
+TEST_F(SummaryHistoOpTest, LargeMatchesSequentialAdd) {
+  MakeOp(DT_FLOAT);
+
+  // Enough values to be split across threads, spread over many buckets and
+  // both signs.
+  const int kSize = 1 << 18;
+  std::vector<float> values(kSize);
+  histogram::Histogram expected;
+  for (int i = 0; i < kSize; ++i) {
+    values[i] = (i % 2 == 0 ? 1 : -1) * std::ldexp(1.0f + (i % 97) / 97.0f,
+                                                   i % 61 - 30);
+    if (i % 1000 == 0) values[i] = 0;
+    expected.Add(values[i]);
+  }
+  HistogramProto expected_proto;
+  expected.EncodeToProto(&expected_proto, false /* Drop zero buckets */);
+
+  AddInputFromArray<string>(TensorShape({}), {"taghisto"});
+  AddInputFromArray<float>(TensorShape({kSize}), values);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Summary summary;
+  ParseProtoUnlimited(&summary, GetOutput(0)->scalar<string>()());
+  ASSERT_EQ(summary.value_size(), 1);
+  EXPECT_EQ(expected_proto.SerializeAsString(),
+            summary.value(0).histo().SerializeAsString());
+}
+
+TEST_F(SummaryHistoOpTest, Error_Nan) {
+  MakeOp(DT_FLOAT);
+
+  // Feed and run
+  AddInputFromArray<string>(TensorShape({}), {"taghisto"});
+  AddInputFromArray<float>(TensorShape({3}), {1.0, NAN, INFINITY});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString()).contains("Nan in summary histogram"))
+      << s;
+}
+
 TEST_F(SummaryHistoOpTest, Error_WrongDimsTags) {
   MakeOp(DT_FLOAT);
 
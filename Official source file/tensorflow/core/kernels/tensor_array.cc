@@ -16,6 +16,8 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 #include "tensorflow/core/kernels/tensor_array.h"
 
+#include <string.h>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/aggregate_ops_cpu.h"
@@ -104,4 +106,104 @@ Status TensorArray::CopyShapesFrom(TensorArray* rhs) {
   return Status::OK();
 }
 
+Status TensorArray::ReadPacked(int32 N, PersistentTensor* value) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(LockedReturnIfClosed());
+  if (N == 0 || static_cast<size_t>(N) != tensors_.size() ||
+      num_in_buffer_ != N) {
+    return Status::OK();
+  }
+  for (const TensorAndState& t : tensors_) {
+    if (!t.in_buffer) return Status::OK();
+  }
+
+  *value = buffer_;
+  for (TensorAndState& t : tensors_) {
+    if (clear_after_read_) {
+      t.tensor = PersistentTensor();
+      t.cleared = true;
+      LockedReleaseFromBuffer(&t);
+    }
+    t.read = true;
+  }
+  return Status::OK();
+}
+
+Status TensorArray::WriteUnpacked(const Tensor& value, bool* written) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(LockedReturnIfClosed());
+  *written = false;
+  const int64 num_values = value.dim_size(0);
+  if (dynamic_size_ && tensors_.size() < static_cast<size_t>(num_values)) {
+    tensors_.resize(num_values);
+  }
+  if (num_values == 0 || tensors_.size() != static_cast<size_t>(num_values)) {
+    return Status::OK();
+  }
+
+  TensorShape element_shape(value.shape());
+  element_shape.RemoveDim(0);
+  std::vector<Tensor> elements(num_values);
+  for (int64 i = 0; i < num_values; ++i) {
+    const TensorAndState& t = tensors_[i];
+    // An index may take the slice if it is unwritten, or if an aggregating
+    // write would just store the slice over a shape from CopyShapesFrom.
+    if (t.read) return Status::OK();
+    if (t.written &&
+        (!multiple_writes_aggregate_ || t.shape != element_shape ||
+         (t.tensor.IsInitialized() && t.tensor.NumElements() > 0))) {
+      return Status::OK();
+    }
+    if (!elements[i].CopyFrom(value.Slice(i, i + 1), element_shape) ||
+        !elements[i].IsAligned()) {
+      return Status::OK();
+    }
+  }
+
+  for (int64 i = 0; i < num_values; ++i) {
+    TensorAndState& t = tensors_[i];
+    t.tensor = PersistentTensor(elements[i]);
+    t.shape = element_shape;
+    t.written = true;
+    t.in_buffer = true;
+  }
+  buffer_ = PersistentTensor(value);
+  num_in_buffer_ = num_values;
+  *written = true;
+  return Status::OK();
+}
+
+Status TensorArray::LockedWriteToBuffer(OpKernelContext* ctx,
+                                        const int32 index,
+                                        const Tensor& value) {
+  if (!buffer_.IsInitialized()) {
+    TensorShape buffer_shape(element_shape_);
+    buffer_shape.InsertDim(0, tensors_.size());
+    Tensor* unused;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_persistent(dtype_, buffer_shape, &buffer_, &unused));
+  }
+  Tensor element;
+  CHECK(element.CopyFrom(buffer_.AccessTensor(ctx)->Slice(index, index + 1),
+                         element_shape_));
+  StringPiece from = value.tensor_data();
+  if (!from.empty()) {
+    memcpy(const_cast<char*>(element.tensor_data().data()), from.data(),
+           from.size());
+  }
+
+  TensorAndState& t = tensors_[index];
+  t.tensor = PersistentTensor(element);
+  t.shape = element_shape_;
+  t.written = true;
+  t.in_buffer = true;
+  ++num_in_buffer_;
+  return Status::OK();
+}
+
+void TensorArray::LockedReleaseFromBuffer(TensorAndState* t) {
+  t->in_buffer = false;
+  if (--num_in_buffer_ == 0) buffer_ = PersistentTensor();
+}
+
 }  // namespace tensorflow
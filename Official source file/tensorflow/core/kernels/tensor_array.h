@@ -17,8 +17,10 @@ limitations under the License.
 #define TENSORFLOW_KERNELS_TENSOR_ARRAY_H_
 
 #include <limits.h>
+#include <type_traits>
 #include <vector>
 
+#include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -108,6 +110,11 @@ TF_CALL_GPU_NUMBER_TYPES(TENSOR_ARRAY_SET_ZERO_GPU);
 //     All operations on a TensorArray are thread-safe.
 //   * A TensorArray may be preemptively closed, which releases all
 //     memory associated with it.
+//   * A CPU TensorArray of fixed size whose element shape is known up
+//     front copies each written element into a slice of one buffer, so
+//     that packing or concatenating the whole array returns that buffer
+//     without another copy.  Unpacking into an array that holds no
+//     values stores slices of the unpacked Tensor in the same way.
 //
 // These properties together allow the TensorArray to work as a
 // functional object and makes gradient computation easy.  For
@@ -130,9 +137,13 @@ class TensorArray : public ResourceBase {
   // 'N' elements.  While the underlying storage is a std::vector and
   // can hold more than MAX_INT entries, in practice we do not expect
   // users to construct this many Tensors for storage in a TensorArray.
+  //
+  // If 'element_shape' is fully defined and the size is fixed, writes on
+  // the CPU of Tensors with that shape go to slices of one buffer.
   TensorArray(const DataType& dtype, const Tensor& handle, int32 N,
               bool dynamic_size, bool multiple_writes_aggregate, bool is_grad,
-              int32 marked_size, bool clear_after_read)
+              int32 marked_size, bool clear_after_read,
+              const PartialTensorShape& element_shape = PartialTensorShape())
       : dtype_(dtype),
         handle_(handle),
         closed_(false),
@@ -142,7 +153,22 @@ class TensorArray : public ResourceBase {
         clear_after_read_(clear_after_read),
         is_grad_(is_grad),
         marked_size_(marked_size),
-        tensors_(N) {}
+        contiguous_(false),
+        num_in_buffer_(0),
+        tensors_(N) {
+    if (!dynamic_size && !multiple_writes_aggregate &&
+        DataTypeCanUseMemcpy(dtype) &&
+        element_shape.AsTensorShape(&element_shape_)) {
+      // Every slice of the buffer must be aligned to be usable as a Tensor.
+#if EIGEN_MAX_ALIGN_BYTES == 0
+      contiguous_ = true;
+#else
+      contiguous_ = DataTypeSize(dtype) * element_shape_.num_elements() %
+                        EIGEN_MAX_ALIGN_BYTES ==
+                    0;
+#endif
+    }
+  }
 
   // Write PersistentTensor 'value' to index 'index'.
   //
@@ -231,6 +257,19 @@ class TensorArray : public ResourceBase {
     return Status::OK();
   }
 
+  // If the elements at [0, N) are consecutive slices of one buffer, and
+  // N == Size(), reads them all and sets '*value' to the buffer.
+  // Otherwise reads nothing and leaves '*value' uninitialized, and the
+  // caller must read the elements one by one.
+  Status ReadPacked(int32 N, PersistentTensor* value);
+
+  // Writes the slices of 'value' along its first dimension to indices
+  // [0, N), where N == value.dim_size(0) == Size(), as Tensors sharing
+  // the buffer of 'value'.  Sets '*written' only if every index could
+  // take the write and every slice is aligned; otherwise writes nothing
+  // and the caller must write copies of the slices.
+  Status WriteUnpacked(const Tensor& value, bool* written);
+
   DataType ElemType() const { return dtype_; }
 
   string DebugString() override {
@@ -308,6 +347,7 @@ class TensorArray : public ResourceBase {
   void ClearAndMarkClosed() {
     mutex_lock l(mu_);
     tensors_.clear();
+    buffer_ = PersistentTensor();
     closed_ = true;
   }
 
@@ -315,6 +355,8 @@ class TensorArray : public ResourceBase {
   Tensor* handle() { return &handle_; }
 
  private:
+  struct TensorAndState;
+
   Status LockedWrite(OpKernelContext* ctx, const int32 index,
                      PersistentTensor* value) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -327,6 +369,16 @@ class TensorArray : public ResourceBase {
   Status LockedRead(OpKernelContext* ctx, const int32 index,
                     PersistentTensor* value) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Marks 't' as no longer holding a slice of buffer_, and releases buffer_
+  // once no index holds one.
+  void LockedReleaseFromBuffer(TensorAndState* t)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Copies 'value', which has shape element_shape_, into slice 'index' of
+  // buffer_ and stores that slice at 'index'.
+  Status LockedWriteToBuffer(OpKernelContext* ctx, const int32 index,
+                             const Tensor& value) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Status LockedReturnIfClosed() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     if (closed_) {
       return errors::InvalidArgument("TensorArray ", handle_.vec<string>()(1),
@@ -365,12 +417,27 @@ class TensorArray : public ResourceBase {
   // -1 if there has been no unpack or split performed on the TensorArray.
   int32 marked_size_;
 
+  // True if CPU writes of Tensors with shape element_shape_ are copied into
+  // buffer_.
+  bool contiguous_;
+  TensorShape element_shape_;
+
+  // A Tensor whose slices along the first dimension are the Tensors at
+  // the indices marked in_buffer, or uninitialized.
+  PersistentTensor buffer_ GUARDED_BY(mu_);
+  // The number of indices marked in_buffer.
+  int32 num_in_buffer_ GUARDED_BY(mu_);
+
   // TensorAndState is used to keep track of the PersistentTensors
   // stored in the TensorArray, along with their shapes, and a boolean
   // that determines whether they have already been read or not.
   struct TensorAndState {
     TensorAndState()
-        : written(false), read(false), cleared(false), local_copy(false) {}
+        : written(false),
+          read(false),
+          cleared(false),
+          local_copy(false),
+          in_buffer(false) {}
     PersistentTensor tensor;
     TensorShape shape;
     bool written;  // True if a Tensor has been written to the index.
@@ -385,6 +452,9 @@ class TensorArray : public ResourceBase {
     // aggregated value.  This flag marks that such a Tensor is being
     // used.  All future writes will aggregate to the existing local Tensor.
     bool local_copy;
+
+    // True if tensor is the slice at this index of buffer_.
+    bool in_buffer;
   };
   // The list of underlying PersistentTensors and states.
   std::vector<TensorAndState> tensors_ GUARDED_BY(mu_);
@@ -470,11 +540,15 @@ Status TensorArray::LockedWriteOrAggregate(OpKernelContext* ctx,
       TF_RETURN_IF_ERROR(s);
       t.tensor = local_tensor;
       t.local_copy = true;
+      if (t.in_buffer) LockedReleaseFromBuffer(&t);
     }
 
     // We've aggregated the values, so disallow backprop on this
     // TensorArray.
     gradients_disallowed_ = true;
+  } else if (contiguous_ && std::is_same<Device, CPUDevice>::value &&
+             value_t->shape() == element_shape_) {
+    TF_RETURN_IF_ERROR(LockedWriteToBuffer(ctx, index, *value_t));
   } else {
     t.tensor = *value;
     t.shape = value_t->shape();
@@ -525,6 +599,7 @@ Status TensorArray::LockedRead(OpKernelContext* ctx, const int32 index,
   if (clear_after_read_) {
     t.tensor = PersistentTensor();
     t.cleared = true;
+    if (t.in_buffer) LockedReleaseFromBuffer(&t);
   }
   t.read = true;
   return Status::OK();
@@ -87,6 +87,14 @@ Status SetupFlowControlInputs(OpKernelContext* ctx, bool set_output) {
   return Status::OK();
 }
 
+// Returns true if indices is 0, 1, ..., indices.size() - 1.
+bool IsIota(const std::vector<int32>& indices) {
+  for (size_t i = 0; i < indices.size(); ++i) {
+    if (indices[i] != static_cast<int32>(i)) return false;
+  }
+  return true;
+}
+
 // CREATION *******************************************************************
 
 // Virtual class for shared behavior between TensorArrayOp and
@@ -135,6 +143,7 @@ class TensorArrayOp : public TensorArrayCreationOp {
                    context->GetAttr("clear_after_read", &clear_after_read_));
     OP_REQUIRES_OK(context,
                    context->GetAttr("tensor_array_name", &tensor_array_name_));
+    OP_REQUIRES_OK(context, context->GetAttr("element_shape", &element_shape_));
     if (tensor_array_name_ == "") tensor_array_name_ = name();
   }
 
@@ -161,7 +170,7 @@ class TensorArrayOp : public TensorArrayCreationOp {
     TensorArray* tensor_array = new TensorArray(
         dtype_, *tensor_array_output_handle, size, dynamic_size_,
         false /* multiple_writes_aggregate */, false /* is_grad */,
-        -1 /* marked_size */, clear_after_read_);
+        -1 /* marked_size */, clear_after_read_, element_shape_);
 
     TF_RETURN_IF_ERROR(
         rm->Create(handle(0), unique_tensor_array_name, tensor_array));
@@ -176,6 +185,7 @@ class TensorArrayOp : public TensorArrayCreationOp {
   bool dynamic_size_;
   bool clear_after_read_;
   string tensor_array_name_;  // The name used to create the TensorArray.
+  PartialTensorShape element_shape_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(TensorArrayOp);
 };
@@ -479,6 +489,26 @@ class TensorArrayPackOrGatherOp : public OpKernel {
       return;
     }
 
+    // If the whole array is read in order and is stored in one buffer,
+    // return the buffer.
+    if (IsIota(indices)) {
+      PersistentTensor packed;
+      OP_REQUIRES_OK(ctx, tensor_array->ReadPacked(num_indices, &packed));
+      if (packed.IsInitialized()) {
+        const Tensor* packed_t = packed.AccessTensor(ctx);
+        TensorShape value_0_shape(packed_t->shape());
+        value_0_shape.RemoveDim(0);
+        OP_REQUIRES(ctx, element_shape_.IsCompatibleWith(value_0_shape),
+                    errors::InvalidArgument(
+                        "TensorArray was passed element_shape ",
+                        element_shape_.DebugString(),
+                        " which does not match the Tensor at index 0: ",
+                        value_0_shape.DebugString()));
+        ctx->set_output(0, *packed_t);
+        return;
+      }
+    }
+
     // Read all the PersistentTensors into a vector to keep track of
     // their memory.
     Status s = tensor_array->ReadMany<Device, T>(ctx, indices, &values);
@@ -648,6 +678,42 @@ class TensorArrayConcatOp : public OpKernel {
       return;
     }
 
+    // If the whole array is stored in one buffer, return the buffer with
+    // its first two dimensions merged.
+    PersistentTensor packed;
+    OP_REQUIRES_OK(ctx, tensor_array->ReadPacked(array_size, &packed));
+    if (packed.IsInitialized()) {
+      const Tensor* packed_t = packed.AccessTensor(ctx);
+      OP_REQUIRES(
+          ctx, packed_t->dims() > 1,
+          errors::InvalidArgument(
+              "Concat saw a scalar shape at index 0"
+              " but requires at least vectors.  Did you mean to call pack?"));
+      TensorShape output_shape_except0(packed_t->shape());
+      output_shape_except0.RemoveDim(0);
+      const int64 length = output_shape_except0.dim_size(0);
+      output_shape_except0.RemoveDim(0);
+      OP_REQUIRES(
+          ctx, element_shape_except0_.IsCompatibleWith(output_shape_except0),
+          errors::InvalidArgument(
+              "TensorArray was passed element_shape_except0 ",
+              element_shape_except0_.DebugString(),
+              " but index 0 has (excepting dimension 0) shape: ",
+              output_shape_except0.DebugString(), " which does not match."));
+
+      Tensor* lengths_tensor = nullptr;
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({array_size}),
+                                               &lengths_tensor));
+      lengths_tensor->vec<int64>().setConstant(length);
+
+      TensorShape output_shape(output_shape_except0);
+      output_shape.InsertDim(0, array_size * length);
+      Tensor output;
+      CHECK(output.CopyFrom(*packed_t, output_shape));
+      ctx->set_output(0, output);
+      return;
+    }
+
     // Read all the PersistentTensors into a vector to keep track of
     // their memory.
     std::vector<PersistentTensor> values;
@@ -873,6 +939,19 @@ class TensorArrayUnpackOrScatterOp : public OpKernel {
           errors::InvalidArgument("Max scatter index must be <= array size (",
                                   max_index, " vs. ", array_size, ")"));
     }
+    // Unpacking into an array that holds no values stores slices of the
+    // value, which a later Pack returns as a whole, without copying.
+    if (IsIota(write_indices)) {
+      bool written;
+      OP_REQUIRES_OK(ctx, tensor_array->WriteUnpacked(*tensor_value, &written));
+      if (written) {
+        if (LEGACY_UNPACK) {
+          OP_REQUIRES_OK(ctx, tensor_array->SetMarkedSize(array_size));
+        }
+        return;
+      }
+    }
+
     element_shape.RemoveDim(0);
 
     auto tensor_value_t = tensor_value->shaped<T, 3>(
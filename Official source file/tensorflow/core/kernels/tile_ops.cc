@@ -21,6 +21,7 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA
 
+#include <type_traits>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/type_index.h"
+#include "tensorflow/core/kernels/block_copy_cpu.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/macros.h"
@@ -172,6 +174,22 @@ class TileOp : public OpKernel {
                       const gtl::ArraySlice<int32>& multiples_array,
                       Tensor* result) {
     typedef typename EnumToDataType<DT>::Type T;
+    if (std::is_same<Device, CPUDevice>::value) {
+      // Dimension d repeats the input indices multiples_array[d] times.
+      const Tensor& input = context->input(0);
+      std::vector<int64> input_dims(NDIM);
+      std::vector<BlockCopyRanges> ranges(NDIM);
+      for (int d = 0; d < NDIM; ++d) {
+        input_dims[d] = input.dim_size(d);
+        ranges[d] = TileRanges(input_dims[d], multiples_array[d]);
+      }
+      BlockCopier<T> copier(input_dims, ranges);
+      if (copier.efficient()) {
+        copier.Run(context->device(), input.flat<T>().data(), T(),
+                   result->flat<T>().data());
+        return;
+      }
+    }
     Eigen::array<int32, NDIM> broadcast_array;
     for (int i = 0; i < NDIM; ++i) {
       broadcast_array[i] = multiples_array[i];
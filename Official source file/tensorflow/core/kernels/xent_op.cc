@@ -23,12 +23,44 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/softmax_xent_cpu.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+template <typename Device, typename T>
+struct LaunchXent {
+  static void Launch(OpKernelContext* context, const Tensor& logits_in,
+                     const Tensor& labels_in, Tensor* loss_out,
+                     Tensor* back_out) {
+    Tensor scratch;
+    OP_REQUIRES_OK(
+        context, context->allocate_temp(DataTypeToEnum<T>::value,
+                                        TensorShape({logits_in.dim_size(0), 1}),
+                                        &scratch));
+    functor::XentFunctor<Device, T> functor;
+    functor(context->eigen_device<Device>(), logits_in.matrix<T>(),
+            labels_in.matrix<T>(), scratch.matrix<T>(), loss_out->vec<T>(),
+            back_out->matrix<T>());
+  }
+};
+
+// The CPU computes loss and backprop in two fused passes over the logits,
+// without the scratch tensor and the intermediates of XentEigenImpl.
+template <typename T>
+struct LaunchXent<CPUDevice, T> {
+  static void Launch(OpKernelContext* context, const Tensor& logits_in,
+                     const Tensor& labels_in, Tensor* loss_out,
+                     Tensor* back_out) {
+    SoftmaxXentCPU<T>(context->device(), logits_in.dim_size(0),
+                      logits_in.dim_size(1), logits_in.flat<T>().data(),
+                      labels_in.flat<T>().data(), loss_out->flat<T>().data(),
+                      back_out->flat<T>().data());
+  }
+};
+
 template <typename Device, typename T>
 class SoftmaxXentWithLogitsOp : public OpKernel {
  public:
@@ -50,12 +82,6 @@ class SoftmaxXentWithLogitsOp : public OpKernel {
 
     // loss is 1-D (one per example), and size is batch_size.
 
-    Tensor scratch;
-    OP_REQUIRES_OK(
-        context, context->allocate_temp(DataTypeToEnum<T>::value,
-                                        TensorShape({logits_in.dim_size(0), 1}),
-                                        &scratch));
-
     Tensor* loss_out = nullptr;
     OP_REQUIRES_OK(context,
                    context->allocate_output(
@@ -64,28 +90,10 @@ class SoftmaxXentWithLogitsOp : public OpKernel {
     OP_REQUIRES_OK(context,
                    context->allocate_output(1, logits_in.shape(), &back_out));
 
-    functor::XentFunctor<Device, T> functor;
-    functor(context->eigen_device<Device>(), logits_in.matrix<T>(),
-            labels_in.matrix<T>(), scratch.matrix<T>(), loss_out->vec<T>(),
-            back_out->matrix<T>());
-  }
-};
-
-// Partial specialization for a CPUDevice, that uses the Eigen implementation
-// from XentEigenImpl.
-namespace functor {
-template <typename T>
-struct XentFunctor<CPUDevice, T> {
-  void operator()(const CPUDevice& d, typename TTypes<T>::ConstMatrix logits,
-                  typename TTypes<T>::ConstMatrix labels,
-                  typename TTypes<T>::Matrix scratch,
-                  typename TTypes<T>::Vec loss,
-                  typename TTypes<T>::Matrix backprop) {
-    XentEigenImpl<CPUDevice, T>::Compute(d, logits, labels, scratch, loss,
-                                         backprop);
+    LaunchXent<Device, T>::Launch(context, logits_in, labels_in, loss_out,
+                                  back_out);
   }
 };
-}  // namespace functor
 
 #define REGISTER_CPU(T)                                         \
   REGISTER_KERNEL_BUILDER(Name("SoftmaxCrossEntropyWithLogits") \
@@ -58,4 +58,7 @@ BM_XentDev(16, 10000, cpu);
 BM_XentDev(32, 10000, cpu);
 BM_XentDev(64, 10000, cpu);
 
+/// Few rows with many classes, as in large-vocabulary output layers
+BM_XentDev(8, 500000, cpu);
+
 }  // end namespace tensorflow
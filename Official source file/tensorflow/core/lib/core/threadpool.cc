@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/threadpool.h"
 
+#include <atomic>
+#include <chrono>
+
 #define EIGEN_USE_THREADS
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/platform/context.h"
@@ -27,8 +30,16 @@ limitations under the License.
 namespace tensorflow {
 namespace thread {
 
+struct ThreadPool::Counters {
+  // Number of StartCollectingStats() calls not yet stopped.
+  std::atomic<int> num_collectors{0};
+  std::atomic<int64> closures_run{0};
+  std::atomic<int64> busy_nanos{0};
+};
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
+  typedef ThreadPool::Counters Counters;
   struct TaskImpl {
     std::function<void()> f;
     Context context;
@@ -41,10 +52,14 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  Counters* const counters_;  // Not owned.
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name, Counters* counters)
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        counters_(counters) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
     return env_->StartThread(thread_options_, name_, [=]() {
@@ -70,6 +85,9 @@ struct EigenEnvironment {
 
   void ExecuteTask(const Task& t) {
     WithContext wc(t.f->context);
+    const bool collect_stats =
+        counters_->num_collectors.load(std::memory_order_relaxed) > 0;
+    const int64 start_nanos = collect_stats ? NowNanos() : 0;
     if (t.f->trace_id != 0) {
       port::Tracing::ScopedActivity region(
           port::Tracing::EventCategory::kRunClosure, t.f->trace_id);
@@ -77,14 +95,25 @@ struct EigenEnvironment {
     } else {
       t.f->f();
     }
+    if (!collect_stats) return;
+    counters_->closures_run.fetch_add(1, std::memory_order_relaxed);
+    counters_->busy_nanos.fetch_add(NowNanos() - start_nanos,
+                                    std::memory_order_relaxed);
+  }
+
+  static int64 NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
   }
 };
 
 struct ThreadPool::Impl : Eigen::ThreadPoolTempl<EigenEnvironment> {
   Impl(Env* env, const ThreadOptions& thread_options, const string& name,
-       int num_threads)
+       int num_threads, EigenEnvironment::Counters* counters)
       : Eigen::ThreadPoolTempl<EigenEnvironment>(
-            num_threads, EigenEnvironment(env, thread_options, name)) {}
+            num_threads,
+            EigenEnvironment(env, thread_options, name, counters)) {}
 
   void ParallelFor(int64 total, int64 cost_per_unit,
                    std::function<void(int64, int64)> fn) {
@@ -107,8 +136,9 @@ ThreadPool::ThreadPool(Env* env, const string& name, int num_threads)
 ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                        const string& name, int num_threads) {
   CHECK_GE(num_threads, 1);
-  impl_.reset(
-      new ThreadPool::Impl(env, thread_options, "tf_" + name, num_threads));
+  counters_.reset(new Counters);
+  impl_.reset(new ThreadPool::Impl(env, thread_options, "tf_" + name,
+                                   num_threads, counters_.get()));
 }
 
 ThreadPool::~ThreadPool() {}
@@ -127,5 +157,22 @@ int ThreadPool::NumThreads() const { return impl_->NumThreads(); }
 
 int ThreadPool::CurrentThreadId() const { return impl_->CurrentThreadId(); }
 
+ThreadPool::Stats ThreadPool::GetStats() const {
+  Stats stats;
+  stats.closures_run = counters_->closures_run.load(std::memory_order_relaxed);
+  stats.busy_nanos = counters_->busy_nanos.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void ThreadPool::StartCollectingStats() {
+  counters_->num_collectors.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ThreadPool::StopCollectingStats() {
+  const int previous =
+      counters_->num_collectors.fetch_sub(1, std::memory_order_relaxed);
+  CHECK_GT(previous, 0) << "StopCollectingStats() without a matching start";
+}
+
 }  // namespace thread
 }  // namespace tensorflow
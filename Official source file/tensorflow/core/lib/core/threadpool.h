@@ -67,9 +67,31 @@ class ThreadPool {
   // thread in the pool. Returns -1 otherwise.
   int CurrentThreadId() const;
 
+  // Cumulative counters of the work done by the pool while stats were being
+  // collected.  The utilization of the pool over an interval in which stats
+  // are collected can be computed from the difference of two snapshots.
+  struct Stats {
+    // Number of closures run, including the shards of ParallelFor.
+    int64 closures_run = 0;
+    // Total time the pool's threads spent running closures.
+    int64 busy_nanos = 0;
+  };
+  Stats GetStats() const;
+
+  // Closures that start between StartCollectingStats() and the matching
+  // StopCollectingStats() are counted in GetStats().  Calls may be nested,
+  // e.g. by concurrent traced steps.  Outside of them, running a closure
+  // does not read the clock.
+  void StartCollectingStats();
+  void StopCollectingStats();
+
   struct Impl;
+  struct Counters;
 
  private:
+  // Declared before impl_ so that the threads are joined before the
+  // counters they update are destroyed.
+  std::unique_ptr<Counters> counters_;
   std::unique_ptr<Impl> impl_;
   TF_DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
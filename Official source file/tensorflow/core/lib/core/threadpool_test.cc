@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <atomic>
 
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
@@ -82,6 +83,34 @@ TEST(ThreadPool, ParallelFor) {
 }
 #endif
 
+TEST(ThreadPool, Stats) {
+  ThreadPool pool(Env::Default(), "test", 4);
+  const int kWorkItems = 10;
+  {
+    // Nothing is counted unless stats are being collected.
+    BlockingCounter done(kWorkItems);
+    for (int i = 0; i < kWorkItems; i++) {
+      pool.Schedule([&done]() { done.DecrementCount(); });
+    }
+    done.Wait();
+  }
+  EXPECT_EQ(0, pool.GetStats().closures_run);
+
+  pool.StartCollectingStats();
+  const ThreadPool::Stats start = pool.GetStats();
+  for (int i = 0; i < kWorkItems; i++) {
+    pool.Schedule([]() { Env::Default()->SleepForMicroseconds(1000); });
+  }
+  // The counters are updated after each closure returns.
+  while (pool.GetStats().closures_run - start.closures_run < kWorkItems) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+  const ThreadPool::Stats end = pool.GetStats();
+  EXPECT_EQ(kWorkItems, end.closures_run - start.closures_run);
+  EXPECT_GE(end.busy_nanos - start.busy_nanos, kWorkItems * 1000 * 1000);
+  pool.StopCollectingStats();
+}
+
 static void BM_Sequential(int iters) {
   ThreadPool pool(Env::Default(), "test", kNumThreads);
   // Decrement count sequentially until 0.
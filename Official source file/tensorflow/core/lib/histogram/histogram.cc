@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include <float.h>
 #include <math.h>
+#include <string.h>
+#include <algorithm>
 #include <vector>
 #include "tensorflow/core/framework/summary.pb.h"
 
@@ -50,6 +52,77 @@ static gtl::ArraySlice<double> InitDefaultBuckets() {
   return *default_bucket_limits;
 }
 
+namespace {
+
+// Finds the default bucket of a value without a binary search over all of
+// the ~1500 bucket limits.
+//
+// The key of a positive double is its exponent followed by its leading
+// kMantissaBits mantissa bits. All doubles with the same key lie within a
+// factor of 2^(1/16) < 1.05 of each other, less than the 10% growth of the
+// default buckets, so at most one bucket limit separates them. The table
+// maps each key to the bucket of the smallest value with that key, and the
+// search finishes after comparing against at most two limits.
+class DefaultBucketIndex {
+ public:
+  static const DefaultBucketIndex& Get() {
+    static DefaultBucketIndex* index = new DefaultBucketIndex;
+    return *index;
+  }
+
+  // Returns the index of the bucket "value" falls into, or -1 if "value" is
+  // zero, tiny, huge or not finite, and needs a binary search instead.
+  int Find(double value, gtl::ArraySlice<double> limits) const {
+    const uint64 key = Key(fabs(value));
+    if (key < min_key_ || key > max_key_) return -1;
+    int b = value < 0 ? negative_[key - min_key_] : positive_[key - min_key_];
+    while (limits[b] <= value) ++b;
+    return b;
+  }
+
+ private:
+  static const int kMantissaBits = 4;
+
+  DefaultBucketIndex() {
+    const gtl::ArraySlice<double> limits = InitDefaultBuckets();
+    // The limits are -DBL_MAX, -1e20..-1e-12, 0, 1e-12..1e20, DBL_MAX.
+    min_key_ = Key(limits[limits.size() / 2 + 1]);
+    max_key_ = Key(limits[limits.size() - 2]);
+    for (uint64 key = min_key_; key <= max_key_; ++key) {
+      positive_.push_back(UpperBound(limits, Smallest(key)));
+      negative_.push_back(UpperBound(limits, -Smallest(key + 1)));
+    }
+  }
+
+  static uint64 Key(double magnitude) {
+    uint64 bits;
+    memcpy(&bits, &magnitude, sizeof(bits));
+    return bits >> (52 - kMantissaBits);
+  }
+
+  // Returns the smallest double with the given key.
+  static double Smallest(uint64 key) {
+    const uint64 bits = key << (52 - kMantissaBits);
+    double magnitude;
+    memcpy(&magnitude, &bits, sizeof(magnitude));
+    return magnitude;
+  }
+
+  static int UpperBound(gtl::ArraySlice<double> limits, double value) {
+    return std::upper_bound(limits.begin(), limits.end(), value) -
+           limits.begin();
+  }
+
+  uint64 min_key_;
+  uint64 max_key_;
+  // Indexed by key - min_key_: the bucket of the smallest positive value
+  // with that key, and of the largest negative value without it.
+  std::vector<int> positive_;
+  std::vector<int> negative_;
+};
+
+}  // namespace
+
 Histogram::Histogram() : bucket_limits_(InitDefaultBuckets()) { Clear(); }
 
 // Create a histogram with a custom set of bucket limits,
@@ -101,18 +174,44 @@ void Histogram::Clear() {
 }
 
 void Histogram::Add(double value) {
-  int b =
-      std::upper_bound(bucket_limits_.begin(), bucket_limits_.end(), value) -
-      bucket_limits_.begin();
+  AddToBuckets(value);
+  AddToSums(value);
+}
 
-  buckets_[b] += 1.0;
+void Histogram::AddToBuckets(double value) {
+  buckets_[BucketIndex(value)] += 1.0;
   if (min_ > value) min_ = value;
   if (max_ < value) max_ = value;
   num_++;
+}
+
+void Histogram::AddToSums(double value) {
   sum_ += value;
   sum_squares_ += (value * value);
 }
 
+void Histogram::Merge(const Histogram& other) {
+  DCHECK_EQ(bucket_limits_.size(), other.bucket_limits_.size());
+  if (min_ > other.min_) min_ = other.min_;
+  if (max_ < other.max_) max_ = other.max_;
+  num_ += other.num_;
+  sum_ += other.sum_;
+  sum_squares_ += other.sum_squares_;
+  for (size_t i = 0; i < buckets_.size(); i++) {
+    buckets_[i] += other.buckets_[i];
+  }
+}
+
+int Histogram::BucketIndex(double value) const {
+  if (custom_bucket_limits_.empty()) {
+    const int b = DefaultBucketIndex::Get().Find(value, bucket_limits_);
+    if (b >= 0) return b;
+  }
+  return std::upper_bound(bucket_limits_.begin(), bucket_limits_.end(),
+                          value) -
+         bucket_limits_.begin();
+}
+
 double Histogram::Median() const { return Percentile(50.0); }
 
 // Linearly map the variable x from [x0, x1] unto [y0, y1]
@@ -54,6 +54,21 @@ class Histogram {
   void Clear();
   void Add(double value);
 
+  // Add() is AddToBuckets() followed by AddToSums(). AddToBuckets() updates
+  // the bucket counts, the count, min and max; AddToSums() updates the sum
+  // and the sum of squares.
+  //
+  // Splitting them lets callers count buckets for disjoint parts of a large
+  // input in parallel and Merge() the partial histograms, while still
+  // accumulating the sums in input order, so that they round exactly as a
+  // sequence of Add() calls would.
+  void AddToBuckets(double value);
+  void AddToSums(double value);
+
+  // Adds the values of "other" to this histogram.
+  // REQUIRES: "other" has the same bucket limits as this histogram.
+  void Merge(const Histogram& other);
+
   // Save the current state of the histogram to "*proto".  If
   // "preserve_zero_buckets" is false, only non-zero bucket values and
   // ranges are saved, and the bucket boundaries of zero-valued buckets
@@ -97,6 +112,10 @@ class Histogram {
 
   double Remap(double x, double x0, double x1, double y0, double y1) const;
 
+  // Returns the index of the bucket "value" falls into, i.e. of the first
+  // bucket limit greater than "value".
+  int BucketIndex(double value) const;
+
   TF_DISALLOW_COPY_AND_ASSIGN(Histogram);
 };
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include <float.h>
+#include <math.h>
+#include <vector>
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
@@ -112,6 +114,57 @@ TEST(Histogram, Basic) {
   Validate(h);
 }
 
+TEST(Histogram, DefaultBucketsMatchBinarySearch) {
+  // A histogram with custom limits equal to the default ones locates
+  // buckets by binary search instead of the default bucket index.
+  Histogram h;
+  HistogramProto proto;
+  h.EncodeToProto(&proto, true);
+  std::vector<double> limits(proto.bucket_limit().begin(),
+                             proto.bucket_limit().end());
+  Histogram custom(limits);
+
+  // Skip -DBL_MAX and DBL_MAX, whose neighbors may not be finite.
+  for (size_t i = 1; i + 1 < limits.size(); i++) {
+    for (double v : {limits[i], nextafter(limits[i], -DBL_MAX),
+                     nextafter(limits[i], DBL_MAX), limits[i] * 1.03}) {
+      h.Add(v);
+      custom.Add(v);
+    }
+  }
+  for (int i = -2000; i < 2000; i++) {
+    h.Add(ldexp(1.0 + (i & 15) / 16.0, i / 10));
+    custom.Add(ldexp(1.0 + (i & 15) / 16.0, i / 10));
+  }
+
+  HistogramProto h_proto;
+  h.EncodeToProto(&h_proto, true);
+  HistogramProto custom_proto;
+  custom.EncodeToProto(&custom_proto, true);
+  EXPECT_EQ(h_proto.DebugString(), custom_proto.DebugString());
+}
+
+TEST(Histogram, Merge) {
+  Histogram all;
+  Histogram part1;
+  Histogram part2;
+  for (int i = -50; i < 100; i++) {
+    all.Add(i * 1.5);
+    Histogram* part = i % 3 == 0 ? &part1 : &part2;
+    part->AddToBuckets(i * 1.5);
+  }
+  for (int i = -50; i < 100; i++) {
+    part1.AddToSums(i * 1.5);
+  }
+  part1.Merge(part2);
+
+  HistogramProto all_proto;
+  all.EncodeToProto(&all_proto, false);
+  HistogramProto merged_proto;
+  part1.EncodeToProto(&merged_proto, false);
+  EXPECT_EQ(all_proto.DebugString(), merged_proto.DebugString());
+}
+
 TEST(ThreadSafeHistogram, Basic) {
   // Fill a normal histogram.
   Histogram h;
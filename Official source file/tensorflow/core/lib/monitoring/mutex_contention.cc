@@ -0,0 +1,126 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/monitoring/mutex_contention.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/lib/monitoring/metric_def.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/mutex_contention.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+namespace {
+
+using ContentionMetricDef = MetricDef<MetricKind::kCumulative, int64, 1>;
+
+// Returns the sampled statistics of the top "max_sites" sites, scaled to
+// estimate the totals over all acquisitions.
+std::vector<port::MutexContentionSite> TopSites(int max_sites) {
+  std::vector<port::MutexContentionSite> sites =
+      port::GetMutexContentionSites();
+  if (sites.size() > static_cast<size_t>(max_sites)) {
+    sites.resize(std::max(max_sites, 0));
+  }
+  const int64 scale = std::max(port::MutexContentionSamplingPeriod(), 1);
+  for (port::MutexContentionSite& site : sites) {
+    site.acquisitions *= scale;
+    site.contended_acquisitions *= scale;
+    site.wait_nanos *= scale;
+    site.hold_nanos *= scale;
+  }
+  return sites;
+}
+
+// Metric definitions and their registrations; never deleted.
+struct ContentionMetrics {
+  explicit ContentionMetrics(int max_sites)
+      : acquisitions("/tensorflow/core/mutex/acquisitions",
+                     "Estimated number of mutex acquisitions.", "site"),
+        contended_acquisitions(
+            "/tensorflow/core/mutex/contended_acquisitions",
+            "Estimated number of mutex acquisitions that had to wait.",
+            "site"),
+        wait_nanos("/tensorflow/core/mutex/wait_nanos",
+                   "Estimated time spent waiting to acquire mutexes.", "site"),
+        hold_nanos("/tensorflow/core/mutex/hold_nanos",
+                   "Estimated time mutexes were held.", "site") {
+    Register(&acquisitions, max_sites,
+             [](const port::MutexContentionSite& s) { return s.acquisitions; });
+    Register(&contended_acquisitions, max_sites,
+             [](const port::MutexContentionSite& s) {
+               return s.contended_acquisitions;
+             });
+    Register(&wait_nanos, max_sites,
+             [](const port::MutexContentionSite& s) { return s.wait_nanos; });
+    Register(&hold_nanos, max_sites,
+             [](const port::MutexContentionSite& s) { return s.hold_nanos; });
+  }
+
+  void Register(const ContentionMetricDef* def, int max_sites,
+                int64 (*value)(const port::MutexContentionSite&)) {
+    handles.push_back(CollectionRegistry::Default()->Register(
+        def, [def, max_sites, value](MetricCollectorGetter getter) {
+          auto metric_collector = getter.Get(def);
+          for (const auto& site : TopSites(max_sites)) {
+            metric_collector.CollectValue(
+                {port::MutexContentionSiteName(site.pc)}, value(site));
+          }
+        }));
+  }
+
+  const ContentionMetricDef acquisitions;
+  const ContentionMetricDef contended_acquisitions;
+  const ContentionMetricDef wait_nanos;
+  const ContentionMetricDef hold_nanos;
+  std::vector<std::unique_ptr<CollectionRegistry::RegistrationHandle>>
+      handles;
+};
+
+}  // namespace
+
+void ExportMutexContention(int max_sites) {
+  static ContentionMetrics* metrics = new ContentionMetrics(max_sites);
+  (void)metrics;
+}
+
+string MutexContentionReport(int max_sites) {
+  if (!port::MutexContentionProfilingEnabled()) {
+    return "Mutex contention profiling is not enabled; build with "
+           "-DTF_MUTEX_CONTENTION_PROFILING.\n";
+  }
+  string report = strings::Printf(
+      "Mutex contention, sampling 1 in %d acquisitions:\n"
+      "%12s %12s %14s %14s  %s\n",
+      port::MutexContentionSamplingPeriod(), "wait ms", "hold ms",
+      "acquisitions", "contended", "site");
+  for (const auto& site : TopSites(max_sites)) {
+    strings::Appendf(&report, "%12.3f %12.3f %14lld %14lld  %s\n",
+                     site.wait_nanos / 1e6, site.hold_nanos / 1e6,
+                     static_cast<long long>(site.acquisitions),
+                     static_cast<long long>(site.contended_acquisitions),
+                     port::MutexContentionSiteName(site.pc).c_str());
+  }
+  return report;
+}
+
+}  // namespace monitoring
+}  // namespace tensorflow
@@ -0,0 +1,45 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_LIB_MONITORING_MUTEX_CONTENTION_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_LIB_MONITORING_MUTEX_CONTENTION_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+// Registers the mutex contention statistics of the process (see
+// platform/mutex_contention.h) with the default CollectionRegistry, as
+// cumulative metrics labeled by acquisition site:
+//
+//   /tensorflow/core/mutex/acquisitions
+//   /tensorflow/core/mutex/contended_acquisitions
+//   /tensorflow/core/mutex/wait_nanos
+//   /tensorflow/core/mutex/hold_nanos
+//
+// Values are scaled by the sampling period, so they estimate the totals
+// over all acquisitions.  Only the "max_sites" sites with the most wait
+// time are exported.  Calling this again has no effect.
+void ExportMutexContention(int max_sites = 100);
+
+// Returns a table of the "max_sites" acquisition sites with the most wait
+// time, in decreasing order, for logging or debugging.
+string MutexContentionReport(int max_sites);
+
+}  // namespace monitoring
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_LIB_MONITORING_MUTEX_CONTENTION_H_
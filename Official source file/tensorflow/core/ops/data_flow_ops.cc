@@ -224,6 +224,7 @@ REGISTER_OP("RandomShuffleQueue")
     .Attr("min_after_dequeue: int = 0")
     .Attr("seed: int = 0")
     .Attr("seed2: int = 0")
+    .Attr("num_shards: int >= 1 = 1")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
     .SetIsStateful()
@@ -245,6 +246,10 @@ min_after_dequeue: Dequeue will block unless there would be this
 seed: If either seed or seed2 is set to be non-zero, the random number
   generator is seeded by the given seed.  Otherwise, a random seed is used.
 seed2: A second seed to avoid seed collision.
+num_shards: If greater than 1, elements are kept in this many independently
+  locked buffers, which reduces contention between many concurrent enqueues
+  and dequeues. Each dequeue then picks from one buffer, so elements are
+  shuffled approximately rather than uniformly over the whole queue.
 container: If non-empty, this queue is placed in the given container.
         Otherwise, a default container is used.
 shared_name: If non-empty, this queue will be shared under the given name
@@ -545,7 +550,8 @@ Push an element onto the stack.
 handle: The handle to a stack.
 elem: The tensor to be pushed onto the stack.
 output: The same tensor as the input 'elem'.
-swap_memory: Swap `elem` to CPU. Default to false.
+swap_memory: Swap `elem` to CPU. Default to false. On CPU, spill `elem` to a
+  scratch file if the TF_STACK_SPILL_DIR environment variable is set.
 )doc");
 
 REGISTER_OP("StackPop")
@@ -578,6 +584,7 @@ REGISTER_OP("TensorArray")
     .Attr("dynamic_size: bool = false")
     .Attr("clear_after_read: bool = true")
     .Attr("tensor_array_name: string = ''")
+    .Attr("element_shape: shape = { unknown_rank: true }")
     .Output("handle: Ref(string)")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) {
@@ -601,6 +608,10 @@ clear_after_read: If true (default), Tensors in the TensorArray are cleared
 tensor_array_name: Overrides the name used for the temporary tensor_array
   resource. Default value is the name of the 'TensorArray' op (which
   is guaranteed unique).
+element_shape: The shape of every element, if known. If it is fully
+  specified and dynamic_size is false, elements are written into one
+  contiguous buffer on the CPU, which Pack and Concat return without
+  copying.
 )doc");
 
 REGISTER_OP("TensorArrayGrad")
@@ -1122,6 +1133,116 @@ size: The number of incomplete elements (i.e. those with some of their value
 
 // --------------------------------------------------------------------------
 
+REGISTER_OP("Batch")
+    .Input("in_tensors: T")
+    .Output("batched_tensors: T")
+    .Output("batch_index: int64")
+    .Output("id: int64")
+    .Attr("max_batch_size: int >= 1")
+    .Attr("batch_timeout_micros: int >= 0")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("T: list(type) >= 1")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      for (int i = 0; i < c->num_inputs(); ++i) {
+        ShapeHandle in;
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(i), 1, &in));
+        ShapeHandle out;
+        TF_RETURN_IF_ERROR(c->ReplaceDim(in, 0, c->UnknownDim(), &out));
+        c->set_output(i, out);
+      }
+      c->set_output(c->num_inputs(),
+                    c->Matrix(InferenceContext::kUnknownDim, 3));
+      c->set_output(c->num_inputs() + 1, c->Scalar());
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Batches the inputs of concurrent executions of this op.
+
+Each execution adds its in_tensors, which must agree in their 0th dimension,
+to the open batch of a batcher shared by the executions.  The batch is
+closed once it holds max_batch_size rows, when an input does not fit in it
+or does not match its shape outside the 0th dimension, or
+batch_timeout_micros after its first input was added.
+
+The execution whose input opened the batch then outputs the inputs of every
+execution in the batch concatenated along the 0th dimension, and a
+batch_index describing them.  Every other execution in the batch outputs
+Tensors with 0 rows and an empty batch_index.  Running the computation on
+batched_tensors and passing its result to Unbatch with the same batch_index
+and id therefore computes the rows of every execution in one step, and
+returns them to the execution they came from.
+
+in_tensors: The tensors to batch.  Each must have at least one dimension.
+batched_tensors: The concatenated in_tensors of the batch, or Tensors with 0
+  rows.
+batch_index: A matrix with one row per execution in the batch, holding its
+  id and the range [start, end) of its rows in batched_tensors.  Has 0 rows
+  when batched_tensors does.
+id: A scalar identifying this execution.
+max_batch_size: The maximum number of rows in a batch.  Inputs with more
+  rows fail.
+batch_timeout_micros: How long a batch may stay open before it is closed
+  even if it is not full.  If 0, every input forms its own batch.
+container: If non-empty, this batcher is placed in the given container.
+  Otherwise, a default container is used.
+shared_name: If non-empty, this batcher will be shared under the given name
+  across multiple sessions.  All of them must use the same T,
+  max_batch_size and batch_timeout_micros.
+)doc");
+
+REGISTER_OP("Unbatch")
+    .Input("batched_tensor: T")
+    .Input("batch_index: int64")
+    .Input("id: int64")
+    .Output("unbatched_tensor: T")
+    .Attr("timeout_micros: int >= 1 = 60000000")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("T: type")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle batched;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &batched));
+      ShapeHandle batch_index;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &batch_index));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(batch_index, 1), 3, &unused));
+      ShapeHandle unused_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused_shape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->ReplaceDim(batched, 0, c->UnknownDim(), &out));
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Returns the rows of a batched result that belong to one execution of Batch.
+
+batched_tensor, batch_index and id are the result of a computation on the
+batched_tensors output of Batch, and the batch_index and id outputs of the
+same Batch execution.  If batch_index is non-empty, this op outputs the rows
+of batched_tensor that belong to id, and hands the rows of every other
+execution in the batch to the Unbatch executions waiting for them.
+Otherwise it waits until it is handed the rows that belong to id.
+
+batched_tensor: The result of a computation on batched_tensors, with the
+  same rows.
+batch_index: The batch_index output of Batch.
+id: The id output of Batch.
+unbatched_tensor: The rows of batched_tensor that belong to id.
+timeout_micros: How long rows handed to an execution that has not arrived
+  yet are kept, and how long an execution waits for its rows before it
+  fails.  Rows for a cancelled execution are dropped as soon as they arrive.
+container: If non-empty, this unbatcher is placed in the given container.
+  Otherwise, a default container is used.
+shared_name: If non-empty, this unbatcher will be shared under the given
+  name across multiple sessions.  All of them must use the same
+  timeout_micros.
+)doc");
+
+// --------------------------------------------------------------------------
+
 REGISTER_OP("LookupTableFind")
     .Input("table_handle: Ref(string)")
     .Input("keys: Tin")
@@ -982,7 +982,7 @@ REGISTER_OP("MatMul")
     .Output("product: T")
     .Attr("transpose_a: bool = false")
     .Attr("transpose_b: bool = false")
-    .Attr("T: {half, float, double, int32, complex64, complex128}")
+    .Attr("T: {half, bfloat16, float, double, int32, complex64, complex128}")
     .SetShapeFn(shape_inference::MatMulShape)
     .Doc(R"doc(
 Multiply the matrix "a" by the matrix "b".
@@ -2017,6 +2017,191 @@ output: A complex64 tensor of the same shape as `input`. The inner-most 3
   dimensions of `input` are replaced with their inverse 3D Fourier Transform.
 )doc");
 
+namespace {
+
+// Shape function of the RFFT and IRFFT ops: replaces the inner-most "rank"
+// dimensions of the input with the constant value of fft_length, halved
+// (plus one) in the last dimension for the forward transform.
+Status RFFTShape(InferenceContext* c, const bool forward, const int rank) {
+  ShapeHandle out;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), rank, &out));
+
+  ShapeHandle unused_shape;
+  DimensionHandle unused_dim;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused_shape));
+  TF_RETURN_IF_ERROR(
+      c->WithValue(c->Dim(unused_shape, 0), rank, &unused_dim));
+
+  const Tensor* fft_length = c->input_tensor(1);
+  for (int i = 0; i < rank; ++i) {
+    DimensionHandle dim = c->UnknownDim();
+    if (fft_length != nullptr) {
+      int64 length = fft_length->vec<int32>()(i);
+      if (length < 0) {
+        return errors::InvalidArgument(
+            "fft_length must be non-negative, but fft_length[", i, "] is ",
+            length);
+      }
+      if (forward && i == rank - 1) length = length / 2 + 1;
+      dim = c->MakeDim(length);
+    }
+    TF_RETURN_IF_ERROR(c->ReplaceDim(out, i - rank, dim, &out));
+  }
+  c->set_output(0, out);
+  return Status::OK();
+}
+
+}  // namespace
+
+REGISTER_OP("RFFT")
+    .Input("input: float")
+    .Input("fft_length: int32")
+    .Output("output: complex64")
+    .SetShapeFn([](InferenceContext* c) { return RFFTShape(c, true, 1); })
+    .Doc(R"doc(
+Compute the 1-dimensional discrete Fourier Transform of a real-valued signal
+over the inner-most dimension of `input`.
+
+Since the DFT of a real signal is Hermitian-symmetric, `RFFT` only returns the
+`fft_length / 2 + 1` unique components of the FFT: the zero-frequency term,
+followed by the `fft_length / 2` positive-frequency terms.
+
+Along the axis `RFFT` is computed on, if `fft_length` is smaller than the
+corresponding dimension of `input`, the dimension is cropped. If it is larger,
+the dimension is padded with zeros.
+
+input: A float32 tensor.
+fft_length: An int32 tensor of shape [1]. The FFT length.
+output: A complex64 tensor of the same rank as `input`. The inner-most
+  dimension of `input` is replaced with the `fft_length / 2 + 1` unique
+  frequency components of its 1D Fourier Transform.
+)doc");
+
+REGISTER_OP("IRFFT")
+    .Input("input: complex64")
+    .Input("fft_length: int32")
+    .Output("output: float")
+    .SetShapeFn([](InferenceContext* c) { return RFFTShape(c, false, 1); })
+    .Doc(R"doc(
+Compute the inverse 1-dimensional discrete Fourier Transform of a real-valued
+signal over the inner-most dimension of `input`.
+
+The inner-most dimension of `input` is assumed to be the result of `RFFT`: the
+`fft_length / 2 + 1` unique components of the DFT of a real-valued signal.
+
+Along the axis `IRFFT` is computed on, if `fft_length / 2 + 1` is smaller
+than the corresponding dimension of `input`, the dimension is cropped. If it is
+larger, the dimension is padded with zeros.
+
+input: A complex64 tensor.
+fft_length: An int32 tensor of shape [1]. The FFT length.
+output: A float32 tensor of the same rank as `input`. The inner-most
+  dimension of `input` is replaced with the `fft_length` samples of its inverse
+  1D Fourier Transform.
+)doc");
+
+REGISTER_OP("RFFT2D")
+    .Input("input: float")
+    .Input("fft_length: int32")
+    .Output("output: complex64")
+    .SetShapeFn([](InferenceContext* c) { return RFFTShape(c, true, 2); })
+    .Doc(R"doc(
+Compute the 2-dimensional discrete Fourier Transform of a real-valued signal
+over the inner-most 2 dimensions of `input`.
+
+Since the DFT of a real signal is Hermitian-symmetric, `RFFT2D` only returns the
+`fft_length / 2 + 1` unique components of the FFT for the inner-most dimension
+of `output`: the zero-frequency term, followed by the `fft_length / 2`
+positive-frequency terms.
+
+Along each axis `RFFT2D` is computed on, if `fft_length` is smaller than the
+corresponding dimension of `input`, the dimension is cropped. If it is larger,
+the dimension is padded with zeros.
+
+input: A float32 tensor.
+fft_length: An int32 tensor of shape [2]. The FFT length for each dimension.
+output: A complex64 tensor of the same rank as `input`. The inner-most 2
+  dimensions of `input` are replaced with their 2D Fourier Transform. The
+  inner-most dimension contains `fft_length / 2 + 1` unique frequency
+  components.
+)doc");
+
+REGISTER_OP("IRFFT2D")
+    .Input("input: complex64")
+    .Input("fft_length: int32")
+    .Output("output: float")
+    .SetShapeFn([](InferenceContext* c) { return RFFTShape(c, false, 2); })
+    .Doc(R"doc(
+Compute the inverse 2-dimensional discrete Fourier Transform of a real-valued
+signal over the inner-most 2 dimensions of `input`.
+
+The inner-most 2 dimensions of `input` are assumed to be the result of `RFFT2D`:
+The inner-most dimension contains the `fft_length / 2 + 1` unique components of
+the DFT of a real-valued signal.
+
+Along each axis `IRFFT2D` is computed on, if `fft_length` (or
+`fft_length / 2 + 1` for the inner-most dimension) is smaller than the
+corresponding dimension of `input`, the dimension is cropped. If it is larger,
+the dimension is padded with zeros.
+
+input: A complex64 tensor.
+fft_length: An int32 tensor of shape [2]. The FFT length for each dimension.
+output: A float32 tensor of the same rank as `input`. The inner-most 2
+  dimensions of `input` are replaced with the `fft_length` samples of their
+  inverse 2D Fourier Transform.
+)doc");
+
+REGISTER_OP("RFFT3D")
+    .Input("input: float")
+    .Input("fft_length: int32")
+    .Output("output: complex64")
+    .SetShapeFn([](InferenceContext* c) { return RFFTShape(c, true, 3); })
+    .Doc(R"doc(
+Compute the 3-dimensional discrete Fourier Transform of a real-valued signal
+over the inner-most 3 dimensions of `input`.
+
+Since the DFT of a real signal is Hermitian-symmetric, `RFFT3D` only returns the
+`fft_length / 2 + 1` unique components of the FFT for the inner-most dimension
+of `output`: the zero-frequency term, followed by the `fft_length / 2`
+positive-frequency terms.
+
+Along each axis `RFFT3D` is computed on, if `fft_length` is smaller than the
+corresponding dimension of `input`, the dimension is cropped. If it is larger,
+the dimension is padded with zeros.
+
+input: A float32 tensor.
+fft_length: An int32 tensor of shape [3]. The FFT length for each dimension.
+output: A complex64 tensor of the same rank as `input`. The inner-most 3
+  dimensions of `input` are replaced with their 3D Fourier Transform. The
+  inner-most dimension contains `fft_length / 2 + 1` unique frequency
+  components.
+)doc");
+
+REGISTER_OP("IRFFT3D")
+    .Input("input: complex64")
+    .Input("fft_length: int32")
+    .Output("output: float")
+    .SetShapeFn([](InferenceContext* c) { return RFFTShape(c, false, 3); })
+    .Doc(R"doc(
+Compute the inverse 3-dimensional discrete Fourier Transform of a real-valued
+signal over the inner-most 3 dimensions of `input`.
+
+The inner-most 3 dimensions of `input` are assumed to be the result of `RFFT3D`:
+The inner-most dimension contains the `fft_length / 2 + 1` unique components of
+the DFT of a real-valued signal.
+
+Along each axis `IRFFT3D` is computed on, if `fft_length` (or
+`fft_length / 2 + 1` for the inner-most dimension) is smaller than the
+corresponding dimension of `input`, the dimension is cropped. If it is larger,
+the dimension is padded with zeros.
+
+input: A complex64 tensor.
+fft_length: An int32 tensor of shape [3]. The FFT length for each dimension.
+output: A float32 tensor of the same rank as `input`. The inner-most 3
+  dimensions of `input` are replaced with the `fft_length` samples of their
+  inverse 3D real Fourier Transform.
+)doc");
+
 // --------------------------------------------------------------------------
 
 REGISTER_OP("Cross")
@@ -107,6 +107,38 @@ TEST(MathOpsTest, FFT_ShapeFn) {
   }
 }
 
+TEST(MathOpsTest, RFFT_ShapeFn) {
+  for (const auto* op_name : {"RFFT", "IRFFT"}) {
+    ShapeInferenceTestOp op(op_name);
+    op.input_tensors.resize(2);
+    INFER_OK(op, "?;?", "?");
+    INFER_ERROR("Shape must be at least rank 1 but is rank 0", op, "[];?");
+    INFER_ERROR("Shape must be rank 1 but is rank 0", op, "?;[]");
+    INFER_ERROR("Dimension must be 1 but is 2", op, "?;[2]");
+    INFER_OK(op, "[3,?];[1]", "[d0_0,?]");
+
+    Tensor fft_length_t = test::AsTensor<int32>({10});
+    op.input_tensors[1] = &fft_length_t;
+    INFER_OK(op, "[3,?];[1]",
+             string(op_name) == "RFFT" ? "[d0_0,6]" : "[d0_0,10]");
+
+    fft_length_t = test::AsTensor<int32>({0});
+    INFER_OK(op, "[3,?];[1]",
+             string(op_name) == "RFFT" ? "[d0_0,1]" : "[d0_0,0]");
+
+    fft_length_t = test::AsTensor<int32>({-2});
+    INFER_ERROR("fft_length must be non-negative, but fft_length[0] is -2", op,
+                "[3,?];[1]");
+  }
+
+  ShapeInferenceTestOp op("RFFT2D");
+  op.input_tensors.resize(2);
+  Tensor fft_length_t = test::AsTensor<int32>({4, -1});
+  op.input_tensors[1] = &fft_length_t;
+  INFER_ERROR("fft_length must be non-negative, but fft_length[1] is -1", op,
+              "[3,?,?];[2]");
+}
+
 TEST(MathOpsTest, Segment_ShapeFn) {
   // Tests SegmentReductionShapeFn.
   for (const auto* op_name : {"SegmentMax", "SegmentMean", "SegmentMin",
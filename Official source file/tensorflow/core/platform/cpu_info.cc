@@ -0,0 +1,80 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cpu_info.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TF_CPU_INFO_X86 1
+#include <cpuid.h>
+#endif
+
+namespace tensorflow {
+namespace port {
+
+#ifdef TF_CPU_INFO_X86
+
+namespace {
+
+struct CPUFeatures {
+  bool avx = false;
+  bool avx2 = false;
+  bool f16c = false;
+  bool fma = false;
+
+  CPUFeatures() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return;
+    // The AVX family is only usable if the OS saves the YMM registers on
+    // context switches, which it reports through XCR0.
+    const bool osxsave = (ecx >> 27) & 1;
+    if (!osxsave || !((ecx >> 28) & 1)) return;
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 6) != 6) return;
+    avx = true;
+    f16c = (ecx >> 29) & 1;
+    fma = (ecx >> 12) & 1;
+    if (__get_cpuid_max(0, nullptr) >= 7) {
+      __cpuid_count(7, 0, eax, ebx, ecx, edx);
+      avx2 = (ebx >> 5) & 1;
+    }
+  }
+};
+
+}  // namespace
+
+bool TestCPUFeature(CPUFeature feature) {
+  static const CPUFeatures* features = new CPUFeatures;
+  switch (feature) {
+    case AVX:
+      return features->avx;
+    case AVX2:
+      return features->avx2;
+    case F16C:
+      return features->f16c;
+    case FMA:
+      return features->fma;
+  }
+  return false;
+}
+
+#else  // TF_CPU_INFO_X86
+
+bool TestCPUFeature(CPUFeature feature) { return false; }
+
+#endif  // TF_CPU_INFO_X86
+
+}  // namespace port
+}  // namespace tensorflow
@@ -28,6 +28,18 @@ static const bool kLittleEndian = true;
 // software can change it dynamically.
 int NumSchedulableCPUs();
 
+// Instruction set extensions that kernels may dispatch on at runtime.
+enum CPUFeature {
+  AVX = 0,
+  AVX2 = 1,
+  F16C = 2,
+  FMA = 3,
+};
+
+// Returns true if the CPU this process runs on, and the operating system,
+// support "feature".  Always false on non-x86 platforms.
+bool TestCPUFeature(CPUFeature feature);
+
 }  // namespace port
 }  // namespace tensorflow
 
@@ -45,6 +45,8 @@ class LOCKABLE mutex : public std::mutex {
   void unlock() RELEASE() { std::mutex::unlock(); }
 };
 
+#ifndef TF_MUTEX_CONTENTION_PROFILING
+
 class SCOPED_LOCKABLE mutex_lock : public std::unique_lock<std::mutex> {
  public:
   mutex_lock(class mutex& m) ACQUIRE(m) : std::unique_lock<std::mutex>(m) {}
@@ -55,6 +57,47 @@ class SCOPED_LOCKABLE mutex_lock : public std::unique_lock<std::mutex> {
   ~mutex_lock() RELEASE() {}
 };
 
+#else  // TF_MUTEX_CONTENTION_PROFILING
+
+// Instrumented mutex_lock, used when building with
+// -DTF_MUTEX_CONTENTION_PROFILING.  A sampled fraction of the acquisitions
+// record their wait and hold times against the code location that
+// constructed the mutex_lock.  See platform/mutex_contention.h for how to
+// read the statistics.
+//
+// The constructors are forced inline so that the location recorded by
+// ProfiledLock() is the acquisition site rather than this header.
+class SCOPED_LOCKABLE mutex_lock : public std::unique_lock<std::mutex> {
+ public:
+  __attribute__((always_inline)) mutex_lock(class mutex& m) ACQUIRE(m)
+      : std::unique_lock<std::mutex>(m, std::defer_lock) {
+    ProfiledLock();
+  }
+  // Try-locks never wait, so they are not profiled.
+  mutex_lock(class mutex& m, std::try_to_lock_t t) ACQUIRE(m)
+      : std::unique_lock<std::mutex>(m, t) {}
+  mutex_lock(mutex_lock&& ml) noexcept
+      : std::unique_lock<std::mutex>(std::move(ml)),
+        site_(ml.site_),
+        acquired_nanos_(ml.acquired_nanos_) {
+    ml.site_ = nullptr;
+  }
+  ~mutex_lock() RELEASE() {
+    if (site_ != nullptr) ProfiledRelease();
+  }
+
+ private:
+  // Locks the mutex, recording the wait if this acquisition is sampled.
+  __attribute__((noinline)) void ProfiledLock();
+  // Records the hold time of a sampled acquisition.
+  void ProfiledRelease();
+
+  void* site_ = nullptr;  // Statistics of the sampled acquisition site.
+  int64 acquired_nanos_ = 0;
+};
+
+#endif  // TF_MUTEX_CONTENTION_PROFILING
+
 // Catch bug where variable name is omitted, e.g. mutex_lock (mu);
 #define mutex_lock(x) static_assert(0, "mutex_lock_decl_missing_var_name");
 
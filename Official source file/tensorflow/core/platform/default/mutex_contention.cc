@@ -0,0 +1,218 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/mutex_contention.h"
+
+#include <stdio.h>
+
+#include "tensorflow/core/platform/mutex.h"
+
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+#include <dlfcn.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include "tensorflow/core/platform/demangle.h"
+#endif  // TF_MUTEX_CONTENTION_PROFILING
+
+namespace tensorflow {
+namespace port {
+
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+
+namespace {
+
+// Statistics of one acquisition site.  Sites live in a fixed-size,
+// insert-only open-addressing table so that recording never takes a lock.
+struct Site {
+  std::atomic<const void*> pc{nullptr};
+  std::atomic<int64> acquisitions{0};
+  std::atomic<int64> contended_acquisitions{0};
+  std::atomic<int64> wait_nanos{0};
+  std::atomic<int64> hold_nanos{0};
+};
+
+const int kMaxSites = 4096;  // Must be a power of 2.
+
+Site* Sites() {
+  static Site* sites = new Site[kMaxSites];
+  return sites;
+}
+
+// Returns the entry for "pc", or nullptr if the table is full.
+Site* FindOrInsertSite(const void* pc) {
+  Site* sites = Sites();
+  const uint64 hash =
+      (reinterpret_cast<uintptr_t>(pc) * 0x9E3779B97F4A7C15ull) >> 32;
+  for (int probe = 0; probe < kMaxSites; ++probe) {
+    Site* site = &sites[(hash + probe) & (kMaxSites - 1)];
+    const void* current = site->pc.load(std::memory_order_acquire);
+    if (current == pc) return site;
+    if (current == nullptr) {
+      if (site->pc.compare_exchange_strong(current, pc,
+                                           std::memory_order_acq_rel) ||
+          current == pc) {
+        return site;
+      }
+    }
+  }
+  return nullptr;
+}
+
+std::atomic<int> sampling_period{100};
+
+bool ShouldSample() {
+  static thread_local int countdown = 0;
+  const int period = sampling_period.load(std::memory_order_relaxed);
+  if (period <= 0) return false;
+  if (--countdown > 0) return false;
+  countdown = period;
+  return true;
+}
+
+int64 NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+bool MutexContentionProfilingEnabled() { return true; }
+
+void SetMutexContentionSamplingPeriod(int period) {
+  sampling_period.store(period, std::memory_order_relaxed);
+}
+
+int MutexContentionSamplingPeriod() {
+  return sampling_period.load(std::memory_order_relaxed);
+}
+
+std::vector<MutexContentionSite> GetMutexContentionSites() {
+  std::vector<MutexContentionSite> result;
+  Site* sites = Sites();
+  for (int i = 0; i < kMaxSites; ++i) {
+    const Site& site = sites[i];
+    MutexContentionSite s;
+    s.pc = site.pc.load(std::memory_order_acquire);
+    s.acquisitions = site.acquisitions.load(std::memory_order_relaxed);
+    if (s.pc == nullptr || s.acquisitions == 0) continue;
+    s.contended_acquisitions =
+        site.contended_acquisitions.load(std::memory_order_relaxed);
+    s.wait_nanos = site.wait_nanos.load(std::memory_order_relaxed);
+    s.hold_nanos = site.hold_nanos.load(std::memory_order_relaxed);
+    result.push_back(s);
+  }
+  std::sort(result.begin(), result.end(),
+            [](const MutexContentionSite& a, const MutexContentionSite& b) {
+              return a.wait_nanos > b.wait_nanos;
+            });
+  return result;
+}
+
+void ResetMutexContentionSites() {
+  Site* sites = Sites();
+  for (int i = 0; i < kMaxSites; ++i) {
+    sites[i].acquisitions.store(0, std::memory_order_relaxed);
+    sites[i].contended_acquisitions.store(0, std::memory_order_relaxed);
+    sites[i].wait_nanos.store(0, std::memory_order_relaxed);
+    sites[i].hold_nanos.store(0, std::memory_order_relaxed);
+  }
+}
+
+string MutexContentionSiteName(const void* pc) {
+  char buf[32];
+  Dl_info info;
+  if (dladdr(pc, &info) != 0) {
+    if (info.dli_sname != nullptr) {
+      snprintf(buf, sizeof(buf), "+0x%zx",
+               static_cast<size_t>(static_cast<const char*>(pc) -
+                                   static_cast<const char*>(info.dli_saddr)));
+      return Demangle(info.dli_sname) + buf;
+    }
+    // Only exported symbols are in the dynamic symbol table, so local
+    // functions, and every function of a binary linked without -rdynamic,
+    // have no name here.  The offset in the module can be symbolized
+    // offline with addr2line.
+    if (info.dli_fname != nullptr) {
+      snprintf(buf, sizeof(buf), "+0x%zx",
+               static_cast<size_t>(static_cast<const char*>(pc) -
+                                   static_cast<const char*>(info.dli_fbase)));
+      return string(info.dli_fname) + buf;
+    }
+  }
+  snprintf(buf, sizeof(buf), "%p", pc);
+  return buf;
+}
+
+#else  // TF_MUTEX_CONTENTION_PROFILING
+
+bool MutexContentionProfilingEnabled() { return false; }
+
+void SetMutexContentionSamplingPeriod(int period) {}
+
+int MutexContentionSamplingPeriod() { return 0; }
+
+std::vector<MutexContentionSite> GetMutexContentionSites() { return {}; }
+
+void ResetMutexContentionSites() {}
+
+string MutexContentionSiteName(const void* pc) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%p", pc);
+  return buf;
+}
+
+#endif  // TF_MUTEX_CONTENTION_PROFILING
+
+}  // namespace port
+
+#ifdef TF_MUTEX_CONTENTION_PROFILING
+
+void mutex_lock::ProfiledLock() {
+  if (!port::ShouldSample()) {
+    lock();
+    return;
+  }
+  // Called from the inlined constructor, so the return address lies at the
+  // acquisition site.
+  port::Site* site = port::FindOrInsertSite(__builtin_return_address(0));
+  int64 wait_nanos = 0;
+  const bool contended = !try_lock();
+  if (contended) {
+    const int64 start_nanos = port::NowNanos();
+    lock();
+    wait_nanos = port::NowNanos() - start_nanos;
+  }
+  if (site == nullptr) return;
+  site->acquisitions.fetch_add(1, std::memory_order_relaxed);
+  if (contended) {
+    site->contended_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    site->wait_nanos.fetch_add(wait_nanos, std::memory_order_relaxed);
+  }
+  site_ = site;
+  acquired_nanos_ = port::NowNanos();
+}
+
+void mutex_lock::ProfiledRelease() {
+  if (!owns_lock()) return;
+  static_cast<port::Site*>(site_)->hold_nanos.fetch_add(
+      port::NowNanos() - acquired_nanos_, std::memory_order_relaxed);
+}
+
+#endif  // TF_MUTEX_CONTENTION_PROFILING
+
+}  // namespace tensorflow
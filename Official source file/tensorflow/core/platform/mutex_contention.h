@@ -0,0 +1,77 @@
+/* Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_PLATFORM_MUTEX_CONTENTION_H_
+#define TENSORFLOW_PLATFORM_MUTEX_CONTENTION_H_
+
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
+// Contention profiling for mutex_lock.
+//
+// When TensorFlow is built with -DTF_MUTEX_CONTENTION_PROFILING, e.g.
+//
+//   bazel build --config=mutex_contention ...
+//
+// which also links with -rdynamic so that acquisition sites can be named,
+// every mutex_lock acquisition is sampled with a per-thread period, and the
+// time spent waiting for the mutex and holding it is accumulated per
+// acquisition site, i.e. per code location that constructs a mutex_lock.
+// Hold times of locks released early with unlock() are not recorded, and
+// hold times include the time spent waiting on condition variables.
+//
+// In other builds the functions below are no-ops and report no sites.
+// lib/monitoring/mutex_contention.h exports these statistics as metrics.
+
+namespace tensorflow {
+namespace port {
+
+// Statistics of the sampled acquisitions made at one site.
+struct MutexContentionSite {
+  // Code address of the acquisition site.
+  const void* pc = nullptr;
+  // Number of sampled acquisitions, and how many of them had to wait.
+  int64 acquisitions = 0;
+  int64 contended_acquisitions = 0;
+  // Total time spent waiting for and holding the mutex.
+  int64 wait_nanos = 0;
+  int64 hold_nanos = 0;
+};
+
+// Returns true if this binary was built with TF_MUTEX_CONTENTION_PROFILING.
+bool MutexContentionProfilingEnabled();
+
+// Samples one out of every "period" acquisitions on each thread; 0 stops
+// sampling.  Defaults to 100.
+void SetMutexContentionSamplingPeriod(int period);
+int MutexContentionSamplingPeriod();
+
+// Returns the statistics of all sites with sampled acquisitions, sorted by
+// decreasing wait time.
+std::vector<MutexContentionSite> GetMutexContentionSites();
+
+// Clears the statistics of all sites.
+void ResetMutexContentionSites();
+
+// Returns a human-readable name for the acquisition site at "pc": the
+// exported function containing it and the offset in that function, or else
+// the module containing it and the offset in that module.
+string MutexContentionSiteName(const void* pc);
+
+}  // namespace port
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_PLATFORM_MUTEX_CONTENTION_H_
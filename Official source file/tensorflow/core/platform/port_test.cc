@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <condition_variable>
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
@@ -32,6 +33,13 @@ TEST(Port, AlignedMalloc) {
   }
 }
 
+TEST(Port, TestCPUFeature) {
+  // The AVX extensions are only reported together with AVX itself.
+  if (TestCPUFeature(AVX2) || TestCPUFeature(F16C) || TestCPUFeature(FMA)) {
+    EXPECT_TRUE(TestCPUFeature(AVX));
+  }
+}
+
 TEST(ConditionVariable, WaitForMilliseconds_Timeout) {
   mutex m;
   mutex_lock l(m);
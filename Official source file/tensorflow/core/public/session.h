@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_PUBLIC_SESSION_H_
 #define TENSORFLOW_PUBLIC_SESSION_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -151,6 +152,24 @@ class Session {
                      const std::vector<string>& target_node_names,
                      std::vector<Tensor>* outputs, RunMetadata* run_metadata);
 
+  /// \brief Like `Run` with `RunOptions`, but returns without waiting for
+  /// the step to finish, and calls `done` with the status of the step once
+  /// `outputs` and `run_metadata` have been filled.  `done` may be called
+  /// before `RunAsync` returns, and may run on one of the session's
+  /// inter-op threads, so it must not block.
+  ///
+  /// `outputs` and `run_metadata` must remain valid until `done` is called.
+  /// Unlike `Run`, `RunAsync` does not hold a thread while the step runs,
+  /// so a few threads can keep many steps in flight.
+  /// NOTE: This API is still experimental and may change.
+  virtual void RunAsync(const RunOptions& run_options,
+                        const std::vector<std::pair<string, Tensor> >& inputs,
+                        const std::vector<string>& output_tensor_names,
+                        const std::vector<string>& target_node_names,
+                        std::vector<Tensor>* outputs,
+                        RunMetadata* run_metadata,
+                        std::function<void(const Status&)> done);
+
   /// \brief Sets up a graph for partial execution. All future feeds and
   /// fetches are specified by `input_names` and `output_names`. Returns
   /// `handle` that can be used to perform a sequence of partial feeds and
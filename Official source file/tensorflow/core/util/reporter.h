@@ -75,6 +75,11 @@ class TestReporter {
   Status Benchmark(int64 iters, double cpu_time, double wall_time,
                    double throughput);
 
+  // Attach a named numeric value (e.g. "bytes_per_second") to the
+  // benchmark entry; stored in BenchmarkEntry.extras.
+  // Only does something if the reporting env flag is set.
+  Status SetProperty(const string& name, double value);
+
   ~TestReporter() { Close(); }  // Autoclose in destructor.
 
  private:
@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_UTIL_SPARSE_SPARSE_TENSOR_H_
 #define TENSORFLOW_UTIL_SPARSE_SPARSE_TENSOR_H_
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <limits>
+#include <numeric>
 
 #include <vector>
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -25,12 +29,15 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/sparse/dim_comparator.h"
 #include "tensorflow/core/util/sparse/group_iterator.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace sparse {
@@ -93,8 +100,10 @@ class SparseTensor {
   const VarDimArray order() const { return order_; }
 
   // Resorts the indices and values according to the dimensions in order.
+  // If 'workers' is not null, large tensors are sorted in parallel on it.
   template <typename T>
-  void Reorder(const VarDimArray& order);
+  void Reorder(const VarDimArray& order,
+               thread::ThreadPool* workers = nullptr);
 
   // Returns a group iterable that can be used for clumping indices
   // and values according to the group indices of interest.
@@ -167,6 +176,138 @@ class SparseTensor {
     return gtl::InlinedVector<int64, 8>(shape.dims(), -1);
   }
 
+  // Runs fn(0), ..., fn(num_blocks - 1), in parallel on 'workers' if it is
+  // not null.
+  static void ParallelFor(thread::ThreadPool* workers, int64 num_blocks,
+                          const std::function<void(int64)>& fn) {
+    if (workers == nullptr || num_blocks <= 1) {
+      for (int64 b = 0; b < num_blocks; ++b) fn(b);
+      return;
+    }
+    // A cost high enough for every block to get its own shard.
+    Shard(workers->NumThreads(), workers, num_blocks, 1 << 20,
+          [&fn](int64 start, int64 limit) {
+            for (int64 b = start; b < limit; ++b) fn(b);
+          });
+  }
+
+  // Returns how many blocks to split 'n' entries into for ParallelFor().
+  static int64 NumBlocks(thread::ThreadPool* workers, int64 n) {
+    static const int64 kMinBlockSize = 1 << 14;
+    if (workers == nullptr) return 1;
+    return std::max<int64>(
+        1, std::min<int64>(workers->NumThreads(), n / kMinBlockSize));
+  }
+
+  // Stores in 'keys' the offset of each index in the dense tensor whose
+  // dimensions are the dimensions of shape() in 'order'.  Sorting the keys
+  // sorts the indices by 'order'.  Sets 'num_key_bits' to the number of
+  // bits needed by the keys.  Returns false if the dense tensor has more
+  // than kint64max elements or if an index is out of bounds.
+  bool LinearizeIndices(const VarDimArray& order, thread::ThreadPool* workers,
+                        std::vector<int64>* keys, int* num_key_bits) const {
+    int64 num_elements = 1;
+    for (const int64 d : order) {
+      const int64 dim_size = shape_.dim_size(d);
+      if (dim_size == 0 || num_elements > kint64max / dim_size) return false;
+      num_elements *= dim_size;
+    }
+    *num_key_bits = Log2Ceiling64(num_elements);
+
+    const int64 n = num_entries();
+    keys->resize(n);
+    auto ix_t = ix_.matrix<int64>();
+    std::atomic<bool> in_bounds(true);
+    const int64 num_blocks = NumBlocks(workers, n);
+    const int64 block_size = (n + num_blocks - 1) / num_blocks;
+    ParallelFor(workers, num_blocks, [&](int64 b) {
+      const int64 limit = std::min(n, (b + 1) * block_size);
+      for (int64 i = b * block_size; i < limit; ++i) {
+        int64 key = 0;
+        for (const int64 d : order) {
+          const int64 dim_size = shape_.dim_size(d);
+          const int64 index = ix_t(i, d);
+          if (!FastBoundsCheck(index, dim_size)) {
+            in_bounds = false;
+            return;
+          }
+          key = key * dim_size + index;
+        }
+        (*keys)[i] = key;
+      }
+    });
+    return in_bounds;
+  }
+
+  // Sorts 'perm' by the corresponding 'keys', which must be non-negative
+  // and less than 2^num_key_bits, with a least significant digit first
+  // radix sort.  Each pass counts the digits of every block of entries in
+  // parallel, then moves the entries of every block to their place in
+  // parallel.  The sort is stable, so 'keys' and 'perm' end up sorted
+  // lexicographically.
+  static void RadixSort(int num_key_bits, thread::ThreadPool* workers,
+                        std::vector<int64>* keys, std::vector<int64>* perm) {
+    static const int kRadixBits = 8;
+    static const int kRadix = 1 << kRadixBits;
+    const int64 n = keys->size();
+    if (n < kRadix) {
+      std::vector<std::pair<int64, int64>> pairs(n);
+      for (int64 i = 0; i < n; ++i) pairs[i] = {(*keys)[i], (*perm)[i]};
+      std::sort(pairs.begin(), pairs.end());
+      for (int64 i = 0; i < n; ++i) {
+        (*keys)[i] = pairs[i].first;
+        (*perm)[i] = pairs[i].second;
+      }
+      return;
+    }
+
+    const int64 num_blocks = NumBlocks(workers, n);
+    const int64 block_size = (n + num_blocks - 1) / num_blocks;
+    std::vector<int64> tmp_keys(n);
+    std::vector<int64> tmp_perm(n);
+    std::vector<int64> offsets(num_blocks * kRadix);
+    for (int shift = 0; shift < num_key_bits; shift += kRadixBits) {
+      const std::vector<int64>& in_keys = *keys;
+      std::fill(offsets.begin(), offsets.end(), 0);
+      ParallelFor(workers, num_blocks, [&](int64 b) {
+        int64* counts = &offsets[b * kRadix];
+        const int64 limit = std::min(n, (b + 1) * block_size);
+        for (int64 i = b * block_size; i < limit; ++i) {
+          ++counts[(in_keys[i] >> shift) & (kRadix - 1)];
+        }
+      });
+
+      // Turn the counts into the position of the first entry of each
+      // digit and block, ordered by digit and then by block.
+      int64 total = 0;
+      bool single_digit = false;
+      for (int digit = 0; digit < kRadix; ++digit) {
+        const int64 digit_start = total;
+        for (int64 b = 0; b < num_blocks; ++b) {
+          const int64 count = offsets[b * kRadix + digit];
+          offsets[b * kRadix + digit] = total;
+          total += count;
+        }
+        if (total - digit_start == n) single_digit = true;
+      }
+      // All the keys have the same digit, so the pass would not move them.
+      if (single_digit) continue;
+
+      const std::vector<int64>& in_perm = *perm;
+      ParallelFor(workers, num_blocks, [&](int64 b) {
+        int64* next = &offsets[b * kRadix];
+        const int64 limit = std::min(n, (b + 1) * block_size);
+        for (int64 i = b * block_size; i < limit; ++i) {
+          const int64 pos = next[(in_keys[i] >> shift) & (kRadix - 1)]++;
+          tmp_keys[pos] = in_keys[i];
+          tmp_perm[pos] = in_perm[i];
+        }
+      });
+      keys->swap(tmp_keys);
+      perm->swap(tmp_perm);
+    }
+  }
+
   // Helper for IndicesValid()
   inline Status IndexValid(const TTypes<int64>::ConstMatrix& ix_t,
                            int n) const {
@@ -261,63 +402,81 @@ class SparseTensor {
 };
 
 // This operation updates the indices and values Tensor rows, so it is
-// an in-place algorithm.  It requires O(N log N) time and O(N)
-// temporary space.
+// an in-place algorithm.  When all the indices are within shape(), it
+// sorts them as linear offsets into the dense tensor with a parallel radix
+// sort in O(N) time; otherwise it compares the indices dimension by
+// dimension in O(N log N) time, so that IndicesValid() can report the
+// first bad index.  It requires O(N) temporary space.
 template <typename T>
-void SparseTensor::Reorder(const VarDimArray& order) {
+void SparseTensor::Reorder(const VarDimArray& order,
+                           thread::ThreadPool* workers) {
   CHECK_EQ(DataTypeToEnum<T>::v(), dtype())
       << "Reorder requested with the wrong datatype";
   CHECK_EQ(order.size(), dims_) << "Order length must be SparseTensor rank";
   auto ix_t = ix_.matrix<int64>();
   auto vals_t = vals_.vec<T>();
 
-  std::vector<int64> reorder(num_entries());
+  const int64 n = num_entries();
+  std::vector<int64> reorder(n);
   std::iota(reorder.begin(), reorder.end(), 0);
 
   // Sort to get order of indices
-  switch (order.size()) {
+  std::vector<int64> keys;
+  int num_key_bits = 0;
+  if (LinearizeIndices(order, workers, &keys, &num_key_bits)) {
+    RadixSort(num_key_bits, workers, &keys, &reorder);
+  } else {
+    switch (order.size()) {
 #define CASE_SORT(ORDER_SIZE)                                    \
   case ORDER_SIZE: {                                             \
     FixedDimComparator<ORDER_SIZE> sorter(ix_t, order, shape()); \
     std::sort(reorder.begin(), reorder.end(), sorter);           \
     break;                                                       \
   }
-    CASE_SORT(0);
-    CASE_SORT(1);
-    CASE_SORT(2);
-    CASE_SORT(3);
-    CASE_SORT(4);
-    CASE_SORT(5);
+      CASE_SORT(0);
+      CASE_SORT(1);
+      CASE_SORT(2);
+      CASE_SORT(3);
+      CASE_SORT(4);
+      CASE_SORT(5);
 #undef CASE_SORT
-    default: {
-      DimComparator sorter(ix_t, order, shape());
-      std::sort(reorder.begin(), reorder.end(), sorter);
+      default: {
+        DimComparator sorter(ix_t, order, shape());
+        std::sort(reorder.begin(), reorder.end(), sorter);
+      }
     }
   }
-
-  // We have a forward reordering, but what we'll need is a
-  // permutation (the inverse).  This can be calculated with O(1)
-  // additional
-  // and O(n) time (INVPERM) but we just do the simple thing here.
-  std::vector<size_t> permutation(reorder.size());
-  for (std::size_t n = 0; n < reorder.size(); ++n) {
-    permutation[reorder[n]] = n;
-  }
-
-  // Update indices & values by converting the permutations to
-  // a product of transpositions.  Iterate over the cycles in the
-  // permutation, and convert each of those into a product of
-  // transpositions (swaps):
-  //   https://en.wikipedia.org/wiki/Cyclic_permutation
-  // This is N swaps, 2*N comparisons.
-  for (std::size_t n = 0; n + 1 < permutation.size(); ++n) {
-    while (n != permutation[n]) {
-      std::size_t r = permutation[n];
-      std::swap_ranges(&(ix_t(n, 0)), &(ix_t(n + 1, 0)), &(ix_t(r, 0)));
-      std::swap(vals_t(n), vals_t(r));
-      std::swap(permutation[n], permutation[r]);
+  std::vector<int64>().swap(keys);
+
+  // Gather the entries in their new order, then move them back so that
+  // the update stays in place.
+  Tensor sorted_ix(DT_INT64, ix_.shape());
+  Tensor sorted_vals(vals_.dtype(), vals_.shape());
+  auto sorted_ix_t = sorted_ix.matrix<int64>();
+  auto sorted_vals_t = sorted_vals.vec<T>();
+  const int64 num_blocks = NumBlocks(workers, n);
+  const int64 block_size = (n + num_blocks - 1) / num_blocks;
+  ParallelFor(workers, num_blocks, [&](int64 b) {
+    const int64 start = b * block_size;
+    const int64 limit = std::min(n, start + block_size);
+    for (int64 i = start; i < limit; ++i) {
+      const int64 r = reorder[i];
+      if (dims_ > 0) std::copy_n(&ix_t(r, 0), dims_, &sorted_ix_t(i, 0));
+      sorted_vals_t(i) = std::move(vals_t(r));
     }
-  }
+  });
+  ParallelFor(workers, num_blocks, [&](int64 b) {
+    const int64 start = b * block_size;
+    const int64 limit = std::min(n, start + block_size);
+    if (start >= limit) return;
+    if (dims_ > 0) {
+      std::copy_n(&sorted_ix_t(start, 0), (limit - start) * dims_,
+                  &ix_t(start, 0));
+    }
+    for (int64 i = start; i < limit; ++i) {
+      vals_t(i) = std::move(sorted_vals_t(i));
+    }
+  });
 
   order_ = gtl::InlinedVector<int64, 8>(order.begin(), order.end());
 }
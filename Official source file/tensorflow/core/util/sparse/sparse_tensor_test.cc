@@ -22,8 +22,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -246,6 +249,45 @@ TEST(SparseTensorTest, SortingWorksCorrectly) {
   }
 }
 
+TEST(SparseTensorTest, ParallelSortingWorksCorrectly) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  // Enough entries for one block per thread, so radix passes in which every
+  // key has the same digit are skipped based on the counts of all blocks.
+  const int N = 100000;
+  const int NDIM = 3;
+
+  Tensor ix(DT_INT64, TensorShape({N, NDIM}));
+  Tensor vals(DT_INT64, TensorShape({N}));
+  // 2^60 elements, so the linearized indices need several radix passes.
+  TensorShape shape({1 << 20, 1 << 20, 1 << 20});
+  auto ix_t = ix.matrix<int64>();
+  auto vals_t = vals.vec<int64>();
+
+  // Each value identifies its index, which is distinct from the others.
+  auto expected_index = [](int64 v, int d) -> int64 {
+    return ((v >> (6 * d)) & 63) << (7 * d);
+  };
+  for (int64 i = 0; i < N; ++i) {
+    const int64 v = (i * 7919) % N;
+    vals_t(i) = v;
+    for (int d = 0; d < NDIM; ++d) ix_t(i, d) = expected_index(v, d);
+  }
+  SparseTensor st(ix, vals, shape);
+
+  for (const std::vector<int64>& order :
+       std::vector<std::vector<int64>>{{0, 1, 2}, {2, 1, 0}, {1, 2, 0}}) {
+    st.Reorder<int64>(order, &pool);
+    TF_EXPECT_OK(st.IndicesValid());
+    auto st_ix_t = st.indices().matrix<int64>();
+    auto st_vals_t = st.values().vec<int64>();
+    for (int64 i = 0; i < N; ++i) {
+      for (int d = 0; d < NDIM; ++d) {
+        ASSERT_EQ(expected_index(st_vals_t(i), d), st_ix_t(i, d));
+      }
+    }
+  }
+}
+
 TEST(SparseTensorTest, ValidateIndicesFindsInvalid) {
   int N = 2;
   const int NDIM = 3;
@@ -625,7 +667,8 @@ TEST(SparseTensorTest, Dim0SparseTensorToDenseTensor) {
   EXPECT_EQ(dense.scalar<int32>()(), 5);
 }
 
-static void BM_SparseReorderFloat(int iters, int N32, int NDIM32) {
+static void SparseReorderFloat(int iters, int N32, int NDIM32,
+                               thread::ThreadPool* workers) {
   random::PhiloxRandom philox(301, 17);
   random::SimplePhilox rnd(&philox);
   const int64 NDIM = static_cast<int64>(NDIM32);
@@ -657,10 +700,20 @@ static void BM_SparseReorderFloat(int iters, int N32, int NDIM32) {
     SparseTensor st(ix, vals, shape, order);
 
     testing::StartTiming();
-    st.Reorder<float>(reorder);
+    st.Reorder<float>(reorder, workers);
   }
 }
 
+static void BM_SparseReorderFloat(int iters, int N32, int NDIM32) {
+  SparseReorderFloat(iters, N32, NDIM32, nullptr);
+}
+
+static void BM_SparseReorderFloatParallel(int iters, int N32, int NDIM32) {
+  thread::ThreadPool pool(Env::Default(), "bench",
+                          port::NumSchedulableCPUs());
+  SparseReorderFloat(iters, N32, NDIM32, &pool);
+}
+
 static void BM_SparseReorderString(int iters, int N32, int NDIM32) {
   random::PhiloxRandom philox(301, 17);
   random::SimplePhilox rnd(&philox);
@@ -712,6 +765,13 @@ BENCHMARK(BM_SparseReorderFloat)->ArgPair(100, 3);
 BENCHMARK(BM_SparseReorderFloat)->ArgPair(1000, 3);
 BENCHMARK(BM_SparseReorderFloat)->ArgPair(10000, 3);
 BENCHMARK(BM_SparseReorderFloat)->ArgPair(100000, 3);
+BENCHMARK(BM_SparseReorderFloat)->ArgPair(10000000, 2);
+BENCHMARK(BM_SparseReorderFloat)->ArgPair(10000000, 3);
+
+BENCHMARK(BM_SparseReorderFloatParallel)->ArgPair(100000, 2);
+BENCHMARK(BM_SparseReorderFloatParallel)->ArgPair(100000, 3);
+BENCHMARK(BM_SparseReorderFloatParallel)->ArgPair(10000000, 2);
+BENCHMARK(BM_SparseReorderFloatParallel)->ArgPair(10000000, 3);
 
 BENCHMARK(BM_SparseReorderString)->ArgPair(10, 2);
 BENCHMARK(BM_SparseReorderString)->ArgPair(100, 2);
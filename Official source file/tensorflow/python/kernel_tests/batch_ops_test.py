@@ -0,0 +1,153 @@
+# Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+"""Tests for Batch and Unbatch ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import time
+
+import numpy as np
+import tensorflow as tf
+
+from tensorflow.python.ops import gen_data_flow_ops
+
+
+class BatchOpsTest(tf.test.TestCase):
+
+  def _runConcurrently(self, sess, fetches, feeds):
+    results = [None] * len(feeds)
+
+    def run(i):
+      results[i] = sess.run(fetches, feed_dict=feeds[i])
+
+    threads = [self.checkedThread(target=run, args=(i,))
+               for i in range(len(feeds))]
+    for t in threads:
+      t.start()
+    for t in threads:
+      t.join()
+    return results
+
+  def testBatchAndUnbatch(self):
+    with self.test_session() as sess:
+      inp = tf.placeholder(tf.int32, shape=[1])
+      batched, index, id_t = gen_data_flow_ops.batch(
+          [inp], max_batch_size=2, batch_timeout_micros=36000000000)
+      result = gen_data_flow_ops.unbatch(batched[0] * 10, index, id_t)
+
+      results = self._runConcurrently(
+          sess, [batched[0], result], [{inp: [1]}, {inp: [2]}])
+
+      # Both inputs are in one batch, which only one of the runs computes.
+      batch_sizes = sorted(len(r[0]) for r in results)
+      self.assertEqual([0, 2], batch_sizes)
+      self.assertAllEqual([10], results[0][1])
+      self.assertAllEqual([20], results[1][1])
+
+  def testBatchMultipleComponentsAndBatches(self):
+    with self.test_session() as sess:
+      x = tf.placeholder(tf.float32, shape=[None, 3])
+      y = tf.placeholder(tf.float32, shape=[None])
+      batched, index, id_t = gen_data_flow_ops.batch(
+          [x, y], max_batch_size=4, batch_timeout_micros=100000)
+      self.assertEqual([None, 3], batched[0].get_shape().as_list())
+      self.assertEqual([None, 3], index.get_shape().as_list())
+      result = gen_data_flow_ops.unbatch(
+          tf.reduce_sum(batched[0], 1) + batched[1], index, id_t)
+
+      feeds = []
+      expected = []
+      for i in range(8):
+        rows = i % 3 + 1
+        x_val = np.full([rows, 3], i, dtype=np.float32)
+        y_val = np.arange(rows, dtype=np.float32)
+        feeds.append({x: x_val, y: y_val})
+        expected.append(3 * i + y_val)
+      results = self._runConcurrently(sess, result, feeds)
+      for i in range(8):
+        self.assertAllEqual(expected[i], results[i])
+
+  def testBatchTimeout(self):
+    with self.test_session() as sess:
+      inp = tf.placeholder(tf.int32, shape=[None])
+      batched, index, id_t = gen_data_flow_ops.batch(
+          [inp], max_batch_size=10, batch_timeout_micros=10000)
+      result = gen_data_flow_ops.unbatch(batched[0] + 1, index, id_t)
+
+      batched_val, index_val, result_val = sess.run(
+          [batched[0], index, result], feed_dict={inp: [5, 6]})
+      self.assertAllEqual([5, 6], batched_val)
+      self.assertAllEqual([[0, 2]], index_val[:, 1:])
+      self.assertAllEqual([6, 7], result_val)
+
+  def testBatchInputLargerThanMaxBatchSize(self):
+    with self.test_session() as sess:
+      inp = tf.placeholder(tf.int32, shape=[None])
+      batched, _, _ = gen_data_flow_ops.batch(
+          [inp], max_batch_size=2, batch_timeout_micros=0)
+      with self.assertRaisesOpError("exceeds max_batch_size 2"):
+        sess.run(batched, feed_dict={inp: [1, 2, 3]})
+
+  def testSharedBatcherWithDifferentMaxBatchSize(self):
+    with self.test_session() as sess:
+      inp = tf.placeholder(tf.int32, shape=[1])
+      batched_a, _, _ = gen_data_flow_ops.batch(
+          [inp], max_batch_size=2, batch_timeout_micros=0, shared_name="B")
+      batched_b, _, _ = gen_data_flow_ops.batch(
+          [inp], max_batch_size=3, batch_timeout_micros=0, shared_name="B")
+      sess.run(batched_a, feed_dict={inp: [1]})
+      with self.assertRaisesOpError("Shared batcher 'B' has max_batch_size 2"):
+        sess.run(batched_b, feed_dict={inp: [1]})
+
+  def testUnbatchWaitTimesOut(self):
+    with self.test_session() as sess:
+      result = gen_data_flow_ops.unbatch(
+          tf.zeros([0], tf.int32), tf.zeros([0, 3], tf.int64),
+          tf.constant(7, tf.int64), timeout_micros=10000)
+      with self.assertRaisesOpError("did not receive the rows of id 7"):
+        sess.run(result)
+
+  def testUndeliveredSliceIsDropped(self):
+    with self.test_session() as sess:
+      # Hands the rows of id 5 to an execution that never arrives in time.
+      deliver = gen_data_flow_ops.unbatch(
+          tf.constant([50, 70]), tf.constant([[5, 0, 1], [7, 1, 2]], tf.int64),
+          tf.constant(7, tf.int64), timeout_micros=10000, shared_name="U")
+      wait = gen_data_flow_ops.unbatch(
+          tf.zeros([0], tf.int32), tf.zeros([0, 3], tf.int64),
+          tf.constant(5, tf.int64), timeout_micros=10000, shared_name="U")
+      self.assertAllEqual([70], sess.run(deliver))
+      time.sleep(0.5)
+      with self.assertRaisesOpError("did not receive the rows of id 5"):
+        sess.run(wait)
+
+  def testSharedUnbatcherWithDifferentTimeout(self):
+    with self.test_session() as sess:
+      batched = tf.constant([1])
+      index = tf.constant([[3, 0, 1]], tf.int64)
+      id_t = tf.constant(3, tf.int64)
+      result_a = gen_data_flow_ops.unbatch(
+          batched, index, id_t, timeout_micros=1000, shared_name="U")
+      result_b = gen_data_flow_ops.unbatch(
+          batched, index, id_t, timeout_micros=2000, shared_name="U")
+      sess.run(result_a)
+      with self.assertRaisesOpError("Shared unbatcher 'U' has timeout_micros"):
+        sess.run(result_b)
+
+
+if __name__ == "__main__":
+  tf.test.main()
@@ -417,6 +417,15 @@ class ConcatOpTest(tf.test.TestCase):
       self.assertEqual(2 * n + 2, after - before)
       print("graph = ", [x.name for x in g.get_operations()])
 
+  def testConcatManyNarrowInputs(self):
+    # Narrow inputs are concatenated in blocks of rows on the CPU.
+    for dtype in [np.float32, np.int8, np.int64]:
+      widths = np.random.randint(1, 9, size=200)
+      inputs = [(np.random.rand(1024, w) * 100).astype(dtype) for w in widths]
+      with self.test_session(use_gpu=False):
+        result = tf.concat(1, [tf.constant(x) for x in inputs]).eval()
+      self.assertAllEqual(np.concatenate(inputs, axis=1), result)
+
   def testConcatLargeTensors(self):
     # CPU-only test, because it fails on GPUs with <= 4GB memory.
     with tf.device("/cpu:0"):
@@ -29,17 +29,19 @@ VALID_FFT_RANKS = (1, 2, 3)
 class FFTOpsTest(tf.test.TestCase):
 
   def _Compare(self, x, rank):
-    if tf.test.is_gpu_available():
-      # GPU/Forward
+    for use_gpu in [False, True]:
+      if use_gpu and not tf.test.is_gpu_available():
+        continue
+      # Forward
       self.assertAllClose(
           self._npFFT(x, rank),
-          self._tfFFT(x, rank, use_gpu=True),
+          self._tfFFT(x, rank, use_gpu=use_gpu),
           rtol=1e-4,
           atol=1e-4)
-      # GPU/Backward
+      # Backward
       self.assertAllClose(
           self._npIFFT(x, rank),
-          self._tfIFFT(x, rank, use_gpu=True),
+          self._tfIFFT(x, rank, use_gpu=use_gpu),
           rtol=1e-4,
           atol=1e-4)
 
@@ -111,12 +113,11 @@ class FFTOpsTest(tf.test.TestCase):
       raise ValueError("invalid rank")
 
   def testEmpty(self):
-    if tf.test.is_gpu_available():
-      for rank in VALID_FFT_RANKS:
-        for dims in xrange(rank, rank + 3):
-          x = np.zeros((0,) * dims).astype(np.complex64)
-          self.assertEqual(x.shape, self._tfFFT(x, rank).shape)
-          self.assertEqual(x.shape, self._tfIFFT(x, rank).shape)
+    for rank in VALID_FFT_RANKS:
+      for dims in xrange(rank, rank + 3):
+        x = np.zeros((0,) * dims).astype(np.complex64)
+        self.assertEqual(x.shape, self._tfFFT(x, rank).shape)
+        self.assertEqual(x.shape, self._tfIFFT(x, rank).shape)
 
   def testBasic(self):
     for rank in VALID_FFT_RANKS:
@@ -138,38 +139,98 @@ class FFTOpsTest(tf.test.TestCase):
       for dims in xrange(rank, rank + 3):
         self._Compare(gen((4,) * dims), rank)
 
+  def testNonPowerOfTwo(self):
+    np.random.seed(12345)
+    for rank in VALID_FFT_RANKS:
+      for size in (1, 3, 5, 6, 7):
+        shape = (2,) + (size,) * rank
+        x = (np.random.uniform(size=shape) +
+             np.random.uniform(size=shape) * 1j).astype(np.complex64)
+        self._Compare(x, rank)
+
   def testError(self):
-    if tf.test.is_gpu_available():
-      for rank in VALID_FFT_RANKS:
-        for dims in xrange(0, rank):
-          x = np.zeros((1,) * dims).astype(np.complex64)
-          with self.assertRaisesWithPredicateMatch(
-              ValueError,
-              "Shape must be .*rank {}.*".format(rank)):
-            self._tfFFT(x, rank)
-          with self.assertRaisesWithPredicateMatch(
-              ValueError,
-              "Shape must be .*rank {}.*".format(rank)):
-            self._tfIFFT(x, rank)
+    for rank in VALID_FFT_RANKS:
+      for dims in xrange(0, rank):
+        x = np.zeros((1,) * dims).astype(np.complex64)
+        with self.assertRaisesWithPredicateMatch(
+            ValueError,
+            "Shape must be .*rank {}.*".format(rank)):
+          self._tfFFT(x, rank)
+        with self.assertRaisesWithPredicateMatch(
+            ValueError,
+            "Shape must be .*rank {}.*".format(rank)):
+          self._tfIFFT(x, rank)
 
   def testGrad_Simple(self):
-    if tf.test.is_gpu_available():
-      for rank in VALID_FFT_RANKS:
-        for dims in xrange(rank, rank + 2):
-          re = np.ones(shape=(4,) * dims, dtype=np.float32) / 10.0
-          im = np.zeros(shape=(4,) * dims, dtype=np.float32)
-          self._checkGrad(self._tfFFTForRank(rank), re, im, use_gpu=True)
-          self._checkGrad(self._tfIFFTForRank(rank), re, im, use_gpu=True)
+    for rank in VALID_FFT_RANKS:
+      for dims in xrange(rank, rank + 2):
+        re = np.ones(shape=(4,) * dims, dtype=np.float32) / 10.0
+        im = np.zeros(shape=(4,) * dims, dtype=np.float32)
+        self._checkGrad(self._tfFFTForRank(rank), re, im, use_gpu=True)
+        self._checkGrad(self._tfIFFTForRank(rank), re, im, use_gpu=True)
 
   def testGrad_Random(self):
-    if tf.test.is_gpu_available():
-      np.random.seed(54321)
-      for rank in VALID_FFT_RANKS:
-        for dims in xrange(rank, rank + 2):
-          re = np.random.rand(*((3,) * dims)).astype(np.float32) * 2 - 1
-          im = np.random.rand(*((3,) * dims)).astype(np.float32) * 2 - 1
-          self._checkGrad(self._tfFFTForRank(rank), re, im, use_gpu=True)
-          self._checkGrad(self._tfIFFTForRank(rank), re, im, use_gpu=True)
+    np.random.seed(54321)
+    for rank in VALID_FFT_RANKS:
+      for dims in xrange(rank, rank + 2):
+        re = np.random.rand(*((3,) * dims)).astype(np.float32) * 2 - 1
+        im = np.random.rand(*((3,) * dims)).astype(np.float32) * 2 - 1
+        self._checkGrad(self._tfFFTForRank(rank), re, im, use_gpu=True)
+        self._checkGrad(self._tfIFFTForRank(rank), re, im, use_gpu=True)
+
+
+class RFFTOpsTest(tf.test.TestCase):
+
+  def _tfRFFTForRank(self, rank):
+    return {1: tf.rfft, 2: tf.rfft2d, 3: tf.rfft3d}[rank]
+
+  def _tfIRFFTForRank(self, rank):
+    return {1: tf.irfft, 2: tf.irfft2d, 3: tf.irfft3d}[rank]
+
+  def _Compare(self, x, rank, fft_length):
+    axes = tuple(range(-rank, 0))
+    with self.test_session(use_gpu=False):
+      y = self._tfRFFTForRank(rank)(x, fft_length)
+      self.assertAllClose(
+          np.fft.rfftn(x, s=fft_length, axes=axes), y.eval(),
+          rtol=1e-4, atol=1e-4)
+      spectrum = np.fft.rfftn(x, s=fft_length, axes=axes).astype(np.complex64)
+      self.assertAllClose(
+          np.fft.irfftn(spectrum, s=fft_length, axes=axes),
+          self._tfIRFFTForRank(rank)(spectrum, fft_length).eval(),
+          rtol=1e-4, atol=1e-4)
+
+  def testRandom(self):
+    np.random.seed(12345)
+    for rank in VALID_FFT_RANKS:
+      for size in (1, 2, 5, 6, 8):
+        for batch in ((), (3,), (2, 2)):
+          x = np.random.uniform(size=batch + (size,) * rank)
+          self._Compare(x.astype(np.float32), rank, [size] * rank)
+
+  def testCropAndPad(self):
+    np.random.seed(12345)
+    for rank in VALID_FFT_RANKS:
+      x = np.random.uniform(size=(2,) + (6,) * rank).astype(np.float32)
+      self._Compare(x, rank, [4] * rank)
+      self._Compare(x, rank, [9] * rank)
+
+  def testShape(self):
+    x = tf.placeholder(tf.float32, shape=[5, 10, 7])
+    self.assertEqual([5, 10, 4], tf.rfft(x, [7]).get_shape().as_list())
+    self.assertEqual([5, 8, 5], tf.rfft2d(x, [8, 8]).get_shape().as_list())
+    spectrum = tf.placeholder(tf.complex64, shape=[5, 10, 4])
+    self.assertEqual([5, 10, 7],
+                     tf.irfft(spectrum, [7]).get_shape().as_list())
+
+  def testError(self):
+    with self.test_session(use_gpu=False):
+      x = np.zeros((2, 4), dtype=np.float32)
+      with self.assertRaisesOpError("fft_length must be positive"):
+        tf.rfft(x, [0]).eval()
+      with self.assertRaisesWithPredicateMatch(ValueError,
+                                               "Shape must be .*rank 2.*"):
+        tf.rfft2d(np.zeros((4,), dtype=np.float32), [4, 4])
 
 
 if __name__ == "__main__":
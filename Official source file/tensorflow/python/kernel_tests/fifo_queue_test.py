@@ -412,6 +412,25 @@ class FIFOQueueTest(tf.test.TestCase):
       enqueue_op.run()
       self.assertAllEqual(dequeued_t.eval(), elems)
 
+  def testEnqueueManyThenDequeueAndDequeueMany(self):
+    with self.test_session() as sess:
+      # Elements of 3 floats are not aligned within the enqueued batch, while
+      # elements of 16 floats are.
+      q = tf.FIFOQueue(10, (tf.float32, tf.float32), ((3,), (16,)))
+      small = np.arange(30, dtype=np.float32).reshape(10, 3)
+      large = np.arange(160, dtype=np.float32).reshape(10, 16)
+      enqueue_op = q.enqueue_many((small, large))
+      dequeued_t = q.dequeue()
+      dequeued_many_t = q.dequeue_many(9)
+
+      enqueue_op.run()
+      first_small, first_large = sess.run(dequeued_t)
+      self.assertAllEqual(small[0], first_small)
+      self.assertAllEqual(large[0], first_large)
+      rest_small, rest_large = sess.run(dequeued_many_t)
+      self.assertAllEqual(small[1:], rest_small)
+      self.assertAllEqual(large[1:], rest_large)
+
   def testEnqueueWrongShape(self):
     q = tf.FIFOQueue(10, (tf.int32, tf.int32), ((), (2)))
 
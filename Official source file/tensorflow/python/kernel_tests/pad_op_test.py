@@ -93,6 +93,15 @@ class PadOpTest(tf.test.TestCase):
         if np_inputs.dtype == np.float32:
           self._testGradient(np_inputs, paddings, mode=mode)
 
+  def testLargeSpatialPadding(self):
+    # Large enough for the CPU kernels to pad with block copies.
+    x = np.random.rand(2, 30, 40, 16).astype(np.float32)
+    for paddings in ([[0, 0], [3, 4], [5, 2], [0, 0]],
+                     [[1, 1], [0, 0], [7, 7], [0, 0]],
+                     [[0, 0], [2, 2], [2, 2], [1, 0]]):
+      for mode in ("CONSTANT", "REFLECT", "SYMMETRIC"):
+        self._testPad(x, paddings, mode=mode)
+
   def testInputDims(self):
     with self.test_session(use_gpu=True):
       with self.assertRaises(ValueError):
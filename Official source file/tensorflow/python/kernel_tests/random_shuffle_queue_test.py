@@ -20,6 +20,7 @@ from __future__ import print_function
 
 import random
 import re
+import threading
 import time
 
 import numpy as np
@@ -508,6 +509,67 @@ class RandomShuffleQueueTest(tf.test.TestCase):
         thread.join()
       self.assertItemsEqual(elems, dequeued_elems)
 
+  def testShardedParallelEnqueueManyAndDequeueMany(self):
+    with self.test_session() as sess:
+      q = tf.RandomShuffleQueue(100, 10, tf.float32, shapes=(), num_shards=4)
+      elems = [10.0 * x for x in range(100)]
+      enqueue_op = q.enqueue_many((elems,))
+      dequeued_t = q.dequeue_many(50)
+      close_op = q.close()
+
+      # Enqueue 100 items on each of 10 threads into a queue that only
+      # holds 100, while 20 threads dequeue 50 items each.
+      dequeued_elems = []
+
+      def enqueue():
+        sess.run(enqueue_op)
+
+      def dequeue():
+        dequeued_elems.extend(sess.run(dequeued_t))
+      enqueue_threads = [self.checkedThread(target=enqueue)
+                         for _ in range(10)]
+      dequeue_threads = [self.checkedThread(target=dequeue)
+                         for _ in range(20)]
+      for thread in enqueue_threads + dequeue_threads:
+        thread.start()
+      for thread in enqueue_threads:
+        thread.join()
+      # The last dequeues need the queue to be closed to ignore
+      # min_after_dequeue.
+      close_op.run()
+      for thread in dequeue_threads:
+        thread.join()
+      self.assertItemsEqual(elems * 10, dequeued_elems)
+
+  def testShardedDequeueUpToFromClosedQueueReturnsRemainder(self):
+    with self.test_session() as sess:
+      q = tf.RandomShuffleQueue(10, 2, tf.float32, shapes=(), num_shards=3)
+      elems = [10.0, 20.0, 30.0, 40.0, 50.0]
+      q.enqueue_many((elems,)).run()
+      dequeued_t = q.dequeue_up_to(3)
+      q.close().run()
+
+      results = sess.run(dequeued_t).tolist()
+      self.assertEqual(3, len(results))
+      results.extend(sess.run(dequeued_t).tolist())
+      self.assertItemsEqual(elems, results)
+      with self.assertRaisesRegexp(tf.errors.OutOfRangeError,
+                                   "is closed and has insufficient"):
+        sess.run(dequeued_t)
+
+  def testShardedCancelledDequeueManyHandsBackReservedElements(self):
+    with self.test_session() as sess:
+      q = tf.RandomShuffleQueue(10, 0, tf.float32, shapes=(), num_shards=3)
+      q.enqueue_many(([10.0, 20.0, 30.0, 40.0, 50.0],)).run()
+      size_t = q.size()
+
+      # The DequeueMany reserves all 5 elements, then blocks for 5 more
+      # until the timeout cancels it.
+      with self.assertRaises(tf.errors.DeadlineExceededError):
+        sess.run(q.dequeue_many(10),
+                 options=tf.RunOptions(timeout_in_ms=100))
+      self.assertEqual(5, size_t.eval())
+
   def testBlockingDequeueMany(self):
     with self.test_session() as sess:
       q = tf.RandomShuffleQueue(10, 0, tf.float32, ((),))
@@ -1142,6 +1204,14 @@ class RandomShuffleQueueTest(tf.test.TestCase):
       with self.assertRaisesOpError("random seeds"):
         q_h_2.queue_ref.eval()
 
+      q_i_1 = tf.RandomShuffleQueue(
+          10, 5, tf.float32, shared_name="q_i")
+      q_i_2 = tf.RandomShuffleQueue(
+          10, 5, tf.float32, shared_name="q_i", num_shards=4)
+      q_i_1.queue_ref.eval()
+      with self.assertRaisesOpError("num_shards"):
+        q_i_2.queue_ref.eval()
+
   def testSelectQueue(self):
     with self.test_session():
       num_queues = 10
@@ -1384,5 +1454,65 @@ class RandomShuffleQueueTest(tf.test.TestCase):
       self.assertItemsEqual(elem, results)
 
 
+
+class RandomShuffleQueueBenchmark(tf.test.Benchmark):
+  """Benchmark concurrent enqueue_many and dequeue_many."""
+
+  def _run(self, num_threads, num_shards, num_iters=200, batch_size=32):
+    """Runs num_threads producers and as many consumers on one queue.
+
+    Args:
+      num_threads: The number of producer threads, and of consumer threads.
+      num_shards: The `num_shards` of the queue.
+      num_iters: The number of batches each thread enqueues or dequeues.
+      batch_size: The number of elements in each batch.
+
+    Returns:
+      The duration of the run in seconds.
+    """
+    graph = tf.Graph()
+    with graph.as_default():
+      q = tf.RandomShuffleQueue(
+          1000, 100, tf.float32, shapes=((64,),), num_shards=num_shards)
+      enqueue_op = q.enqueue_many((tf.zeros((batch_size, 64)),))
+      dequeued_t = q.dequeue_many(batch_size)
+      close_op = q.close()
+    with tf.Session(graph=graph) as session:
+      def produce():
+        for _ in range(num_iters):
+          session.run(enqueue_op)
+
+      def consume():
+        for _ in range(num_iters):
+          session.run(dequeued_t)
+      producers = [threading.Thread(target=produce)
+                   for _ in range(num_threads)]
+      consumers = [threading.Thread(target=consume)
+                   for _ in range(num_threads)]
+      start_time = time.time()
+      for thread in producers + consumers:
+        thread.start()
+      for thread in producers:
+        thread.join()
+      close_op.run()
+      for thread in consumers:
+        thread.join()
+      duration = time.time() - start_time
+    print("%d threads, %d shards: %f secs per batch" %
+          (num_threads, num_shards, duration / num_iters))
+
+    self.report_benchmark(
+        name="random_shuffle_queue_threads_%d_shards_%d" % (num_threads,
+                                                            num_shards),
+        iters=num_iters, wall_time=duration / num_iters)
+
+    return duration
+
+  def benchmarkThreadScaling(self):
+    for num_threads in [1, 4, 16]:
+      for num_shards in [1, 16]:
+        self._run(num_threads, num_shards)
+
+
 if __name__ == "__main__":
   tf.test.main()
@@ -341,6 +341,14 @@ class TileTest(tf.test.TestCase):
     self.assertEqual(result.shape, (10, 0))
     self.assertEqual([10, 0], tiled.get_shape())
 
+  def testLargeOuterTiling(self):
+    # Large enough for the CPU kernel to tile with block copies.
+    inp = np.random.rand(3, 20, 32).astype(np.float32)
+    for multiples in ([2, 3, 1], [1, 1, 4], [4, 1, 2], [1, 5, 1]):
+      with self.test_session(use_gpu=False):
+        result = tf.tile(inp, multiples).eval()
+      self.assertAllEqual(np.tile(inp, multiples), result)
+
   def testTypes(self):
     types_to_test = {
         "bool": (tf.bool, bool),
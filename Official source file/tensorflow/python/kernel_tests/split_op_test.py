@@ -111,6 +111,13 @@ class SplitOpTest(tf.test.TestCase):
       self._RunAndVerify(use_gpu=True)
       self._RunAndVerify(use_gpu=True, large_num_splits=True)
 
+  def testSplitManyNarrowCols(self):
+    # Narrow outputs are split off in blocks of rows on the CPU.
+    for dtype in ["f", "b", "d"]:
+      for width in [1, 3, 4, 32]:
+        inp = (np.random.rand(1024, 200 * width) * 100).astype(dtype)
+        self._compare(inp, 1, 200, use_gpu=False)
+
   def _testGradientsSimple(self, use_gpu):
     inp = np.random.rand(4, 4).astype("f")
     with self.test_session(use_gpu=use_gpu):
@@ -18,6 +18,10 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import contextlib
+import os
+import time
+
 import numpy as np
 import tensorflow as tf
 
@@ -26,6 +30,62 @@ from tensorflow.python.framework import tensor_shape
 from tensorflow.python.ops import gen_data_flow_ops
 
 
+@contextlib.contextmanager
+def _stack_spilling(spill_dir, resident_limit_in_mb):
+  """Enables spilling of CPU stacks for the kernels created in the block."""
+  os.environ["TF_STACK_SPILL_DIR"] = spill_dir
+  os.environ["TF_STACK_RESIDENT_LIMIT_IN_MB"] = str(resident_limit_in_mb)
+  try:
+    yield
+  finally:
+    del os.environ["TF_STACK_SPILL_DIR"]
+    del os.environ["TF_STACK_RESIDENT_LIMIT_IN_MB"]
+
+
+def _spill_file_counter(spill_dir):
+  """Returns a function that adds an op counting the stack spill files.
+
+  The returned function takes a Tensor and returns an op that records how
+  many stack spill files exist in 'spill_dir' each time it runs.  The
+  counts are appended to the returned list.
+  """
+  counts = []
+
+  def count(x):
+    counts.append(len(tf.gfile.Glob(os.path.join(spill_dir, "stack_spill_*"))))
+    return x
+
+  def add_op(x):
+    return tf.py_func(count, [x], x.dtype)
+
+  return add_op, counts
+
+
+def _rnn_gradients(seq_len, batch_size, num_units, swap_memory,
+                   step_hook=None):
+  """Builds the gradients of a simple RNN unrolled with a while loop.
+
+  If 'step_hook' is set, it is called with the step of the loop and the op
+  it returns runs before every step ends.
+  """
+  np.random.seed(7)
+  inputs = tf.constant(
+      np.random.randn(seq_len, batch_size, num_units).astype(np.float32))
+  w = tf.Variable(
+      np.random.randn(num_units, num_units).astype(np.float32) * 0.1)
+  h0 = tf.zeros([batch_size, num_units])
+
+  def body(t, h):
+    hooks = [step_hook(t)] if step_hook is not None else []
+    with tf.control_dependencies(hooks):
+      next_t = t + 1
+    return next_t, tf.tanh(tf.matmul(h, w) + tf.gather(inputs, t))
+
+  _, h = tf.while_loop(lambda t, _: t < seq_len, body, [0, h0],
+                       swap_memory=swap_memory)
+  return w, tf.gradients(tf.reduce_sum(h), [w, h0])
+
+
 class StackOpTest(tf.test.TestCase):
 
   def _testStackPushPop(self, use_gpu):
@@ -136,5 +196,92 @@ class StackOpTest(tf.test.TestCase):
     self._testPushCloseStack(use_gpu=False)
     self._testPushCloseStack(use_gpu=True)
 
+  def testStackWhileSpill(self):
+    spill_dir = os.path.join(self.get_temp_dir(), "stack_spill")
+    tf.gfile.MakeDirs(spill_dir)
+    count_spill_files, spill_file_counts = _spill_file_counter(spill_dir)
+    with self.test_session(use_gpu=False):
+      with _stack_spilling(spill_dir, resident_limit_in_mb=0):
+        n = tf.constant(0)
+        h = gen_data_flow_ops._stack(tf.float32, stack_name="foo")
+
+        def c(x):
+          return tf.less(x, 100)
+        def b(x):
+          a = tf.fill([2000], tf.cast(x, tf.float32))
+          v = gen_data_flow_ops._stack_push(h, a, swap_memory=True)
+          with tf.control_dependencies([v]):
+            return tf.add(x, 1)
+        r = tf.while_loop(c, b, [n])
+
+        v = tf.zeros([2000])
+        def c1(x, y):
+          return tf.greater(x, 0)
+        def b1(x, y):
+          # Every entry is pushed before the first pop, so the spill file
+          # exists while this loop runs.
+          with tf.control_dependencies([count_spill_files(x)]):
+            nx = tf.sub(x, 1)
+          # The entries come back in reverse order.
+          ny = y * 0.5 + gen_data_flow_ops._stack_pop(h, tf.float32)
+          return [nx, ny]
+        _, ry = tf.while_loop(c1, b1, [r, v],
+                              [r.get_shape(), tensor_shape.unknown_shape()])
+        expected = 0.0
+        for i in reversed(range(100)):
+          expected = expected * 0.5 + i
+        self.assertAllClose(np.full([2000], expected), ry.eval())
+    self.assertEqual(100, len(spill_file_counts))
+    self.assertGreater(min(spill_file_counts), 0)
+
+  def testRNNGradientsWithSpill(self):
+    spill_dir = os.path.join(self.get_temp_dir(), "rnn_spill")
+    tf.gfile.MakeDirs(spill_dir)
+    with self.test_session(use_gpu=False) as sess:
+      w, grads = _rnn_gradients(200, 32, 64, swap_memory=False)
+      sess.run(w.initializer)
+      expected = sess.run(grads)
+    count_spill_files, spill_file_counts = _spill_file_counter(spill_dir)
+    with self.test_session(use_gpu=False) as sess:
+      # Each step pushes 8KB tensors, so all but the last few are spilled.
+      with _stack_spilling(spill_dir, resident_limit_in_mb=0):
+        w, grads = _rnn_gradients(200, 32, 64, swap_memory=True,
+                                  step_hook=count_spill_files)
+        sess.run(w.initializer)
+        actual = sess.run(grads)
+    for e, a in zip(expected, actual):
+      self.assertAllClose(e, a)
+    # The entries pushed by the first steps are spilled while later steps
+    # run.
+    self.assertGreater(max(spill_file_counts), 0)
+
+
+class StackSpillBenchmark(tf.test.Benchmark):
+  """Benchmark the gradients of a long RNN with and without spilling."""
+
+  def _run(self, name, spill_dir, num_iters=5):
+    graph = tf.Graph()
+    with graph.as_default():
+      w, grads = _rnn_gradients(2000, 64, 256,
+                                swap_memory=spill_dir is not None)
+    with tf.Session(graph=graph) as session:
+      session.run(w.initializer)
+      session.run(grads)  # warm up.
+      start_time = time.time()
+      for _ in range(num_iters):
+        session.run(grads)
+      duration = time.time() - start_time
+    print("%s: %f secs per step" % (name, duration / num_iters))
+    self.report_benchmark(
+        name=name, iters=num_iters, wall_time=duration / num_iters)
+
+  def benchmarkRNNGradients(self):
+    self._run("rnn_gradients_resident", None)
+    spill_dir = os.path.join(tf.test.get_temp_dir(), "rnn_spill_benchmark")
+    tf.gfile.MakeDirs(spill_dir)
+    with _stack_spilling(spill_dir, resident_limit_in_mb=16):
+      self._run("rnn_gradients_spill", spill_dir)
+
+
 if __name__ == "__main__":
   tf.test.main()
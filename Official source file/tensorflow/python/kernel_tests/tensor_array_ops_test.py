@@ -123,6 +123,34 @@ class TensorArrayCPUTest(tf.test.TestCase):
     self._testTensorArrayWriteConcat(tf.complex128)
     self._testTensorArrayWriteConcat(tf.string)
 
+  def testTensorArrayWritePackWithElementShape(self):
+    with self.test_session(use_gpu=self._use_gpu) as session:
+      values = np.arange(3 * 4 * 16, dtype=np.float32).reshape(3, 4, 16)
+      ta = tensor_array_ops.TensorArray(
+          dtype=tf.float32, size=3, element_shape=[4, 16],
+          clear_after_read=False)
+      for i in range(3):
+        ta = ta.write(i, values[i])
+
+      packed, legacy_packed, concatenated, read = session.run(
+          [ta.pack(), ta._legacy_pack(), ta.concat(), ta.read(1)])
+      self.assertAllEqual(values, packed)
+      self.assertAllEqual(values, legacy_packed)
+      self.assertAllEqual(values.reshape(12, 16), concatenated)
+      self.assertAllEqual(values[1], read)
+
+  def testTensorArrayUnpackPack(self):
+    with self.test_session(use_gpu=self._use_gpu) as session:
+      values = np.arange(5 * 4 * 16, dtype=np.float32).reshape(5, 4, 16)
+      w0 = tensor_array_ops.TensorArray(dtype=tf.float32, size=5).unpack(
+          values)
+      w1 = tensor_array_ops.TensorArray(
+          dtype=tf.float32, size=5)._legacy_unpack(values)
+
+      packed, read = session.run([w0.pack(), w1.read(3)])
+      self.assertAllEqual(values, packed)
+      self.assertAllEqual(values[3], read)
+
   def testTensorArrayLegacyUnpackWrongMajorSizeFails(self):
     with self.test_session():
       ta = tensor_array_ops.TensorArray(
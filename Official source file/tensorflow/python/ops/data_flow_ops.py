@@ -558,7 +558,7 @@ class RandomShuffleQueue(QueueBase):
 
   def __init__(self, capacity, min_after_dequeue, dtypes, shapes=None,
                names=None, seed=None, shared_name=None,
-               name="random_shuffle_queue"):
+               name="random_shuffle_queue", num_shards=1):
     """Create a queue that dequeues elements in a random order.
 
     A `RandomShuffleQueue` has bounded capacity; supports multiple
@@ -583,6 +583,13 @@ class RandomShuffleQueue(QueueBase):
     enqueued. The `min_after_dequeue` argument is ignored after the
     queue has been closed.
 
+    With many threads enqueueing and dequeueing at once, the queue lock
+    can become a bottleneck. Setting `num_shards` greater than 1 spreads
+    the elements over that many independently locked buffers. Each
+    dequeue then picks an element of one randomly chosen buffer, so the
+    order is shuffled approximately rather than uniformly over the whole
+    queue; `min_after_dequeue` still applies to the whole queue.
+
     Args:
       capacity: An integer. The upper bound on the number of elements
         that may be stored in this queue.
@@ -600,6 +607,8 @@ class RandomShuffleQueue(QueueBase):
       shared_name: (Optional.) If non-empty, this queue will be shared under
         the given name across multiple sessions.
       name: Optional name for the queue operation.
+      num_shards: (Optional.) The number of independently locked buffers
+        that hold the elements (described above). Defaults to 1.
     """
     dtypes = _as_type_list(dtypes)
     shapes = _as_shape_list(shapes, dtypes)
@@ -617,7 +626,7 @@ class RandomShuffleQueue(QueueBase):
     queue_ref = gen_data_flow_ops._random_shuffle_queue(
         component_types=dtypes, shapes=shapes, capacity=capacity,
         min_after_dequeue=min_after_dequeue, seed=seed1, seed2=seed2,
-        shared_name=shared_name, name=name)
+        num_shards=num_shards, shared_name=shared_name, name=name)
 
     super(RandomShuffleQueue, self).__init__(dtypes, shapes, names, queue_ref)
 
@@ -1092,6 +1101,11 @@ ops.RegisterShape("BarrierTakeMany")(common_shapes.call_cpp_shape_fn)
 ops.RegisterShape("BarrierClose")(common_shapes.call_cpp_shape_fn)
 ops.RegisterShape("BarrierInsertMany")(common_shapes.call_cpp_shape_fn)
 
+ops.NotDifferentiable("Batch")
+ops.NotDifferentiable("Unbatch")
+ops.RegisterShape("Batch")(common_shapes.call_cpp_shape_fn)
+ops.RegisterShape("Unbatch")(common_shapes.call_cpp_shape_fn)
+
 ops.RegisterShape("GetSessionHandle")(common_shapes.call_cpp_shape_fn)
 ops.RegisterShape("GetSessionTensor")(common_shapes.call_cpp_shape_fn)
 ops.RegisterShape("DeleteSessionTensor")(common_shapes.call_cpp_shape_fn)
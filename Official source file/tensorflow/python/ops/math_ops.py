@@ -122,6 +122,12 @@ Fourier transform functions to your graph.
 @@ifft2d
 @@fft3d
 @@ifft3d
+@@rfft
+@@irfft
+@@rfft2d
+@@irfft2d
+@@rfft3d
+@@irfft3d
 
 ## Reduction
 
@@ -1879,6 +1885,16 @@ ops.RegisterShape("AddN")(common_shapes.call_cpp_shape_fn)
 ops.RegisterShape("Select")(common_shapes.call_cpp_shape_fn)
 
 
+@ops.RegisterShape("RFFT")
+@ops.RegisterShape("IRFFT")
+@ops.RegisterShape("RFFT2D")
+@ops.RegisterShape("IRFFT2D")
+@ops.RegisterShape("RFFT3D")
+@ops.RegisterShape("IRFFT3D")
+def _RFFTShape(op):
+  return common_shapes.call_cpp_shape_fn(op, input_tensors_needed=[1])
+
+
 @ops.RegisterShape("ArgMax")
 @ops.RegisterShape("ArgMin")
 def _ArgOpShape(op):
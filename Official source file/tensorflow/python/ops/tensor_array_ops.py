@@ -64,7 +64,7 @@ class TensorArray(object):
 
   def __init__(self, dtype, size=None, dynamic_size=None,
                clear_after_read=None, tensor_array_name=None, handle=None,
-               flow=None, infer_shape=True, name=None):
+               flow=None, infer_shape=True, element_shape=None, name=None):
     """Construct a new TensorArray or wrap an existing TensorArray handle.
 
     A note about the parameter `name`:
@@ -92,6 +92,11 @@ class TensorArray(object):
         `TensorArray.flow`.
       infer_shape: (optional, default: True) If True, shape inference
         is enabled.  In this case, all elements must have the same shape.
+      element_shape: (optional, default: None) A `TensorShape` object
+        specifying the shape of all elements.  If it is fully defined and
+        the size is fixed, elements are written into one contiguous buffer
+        on the CPU, so `pack` and `concat` of the whole array do not copy.
+        Ignored if handle is provided.
       name: A name for the operation (optional).
 
     Raises:
@@ -125,6 +130,12 @@ class TensorArray(object):
     # write adds the shape of the tensor it writes, and all subsequent
     # writes checks for shape equality.
     self._elem_shape = []
+    if element_shape is None:
+      element_shape = tensor_shape.unknown_shape()
+    else:
+      element_shape = tensor_shape.as_shape(element_shape)
+      if infer_shape and element_shape.is_fully_defined():
+        self._elem_shape.append(element_shape)
     with ops.name_scope(name, "TensorArray", [handle, size, flow]) as scope:
       if handle is not None:
         self._handle = handle
@@ -134,12 +145,14 @@ class TensorArray(object):
             self._handle = gen_data_flow_ops._tensor_array(
                 dtype=dtype, size=size, dynamic_size=dynamic_size,
                 clear_after_read=clear_after_read,
-                tensor_array_name=tensor_array_name, name=scope)
+                tensor_array_name=tensor_array_name,
+                element_shape=element_shape, name=scope)
         else:
           self._handle = gen_data_flow_ops._tensor_array(
               dtype=dtype, size=size, dynamic_size=dynamic_size,
               clear_after_read=clear_after_read,
-              tensor_array_name=tensor_array_name, name=scope)
+              tensor_array_name=tensor_array_name,
+              element_shape=element_shape, name=scope)
       if flow is not None:
         self._flow = flow
       else:
@@ -0,0 +1,64 @@
+# Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+"""Flags statistically significant regressions between benchmark runs.
+
+Usage:
+  compare_benchmarks --baseline=a1.txt,a2.txt,a3.txt \
+                     --candidate=b1.txt,b2.txt,b3.txt [--threshold=0.05]
+
+Each file is a text-format TestResults proto as written by
+run_and_gather_logs --test_log_output.  Exits with status 1 if any benchmark
+regressed.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import sys
+
+import tensorflow as tf
+
+from tensorflow.tools.test import compare_benchmarks_lib
+
+
+FLAGS = tf.app.flags.FLAGS
+
+tf.app.flags.DEFINE_string(
+    "baseline", "", """Comma separated TestResults files of the baseline.""")
+tf.app.flags.DEFINE_string(
+    "candidate", "", """Comma separated TestResults files to compare.""")
+tf.app.flags.DEFINE_float(
+    "threshold", 0.05, """Minimum relative slowdown reported as regression.""")
+
+
+def _load(paths):
+  return [compare_benchmarks_lib.load_test_results(p)
+          for p in paths.split(",") if p]
+
+
+def main(unused_args):
+  if not FLAGS.baseline or not FLAGS.candidate:
+    raise ValueError("Both --baseline and --candidate must be given.")
+  comparisons = compare_benchmarks_lib.compare(
+      _load(FLAGS.baseline), _load(FLAGS.candidate), FLAGS.threshold)
+  print(compare_benchmarks_lib.format_comparisons(comparisons))
+  if any(c.regression for c in comparisons):
+    sys.exit(1)
+
+
+if __name__ == "__main__":
+  tf.app.run()
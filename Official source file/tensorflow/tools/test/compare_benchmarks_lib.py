@@ -0,0 +1,148 @@
+# Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+"""Library for comparing two sets of benchmark TestResults.
+
+Each side of the comparison is a list of TestResults (as written by
+run_and_gather_logs), typically several repetitions of the same benchmark
+target.  For every benchmark present on both sides the per-iteration wall
+time is compared with Welch's t-test; a benchmark is flagged as a regression
+if it got slower by more than a relative threshold and, when there are at
+least two repetitions on each side, the difference is significant at the
+95% level.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import collections
+import math
+
+from google.protobuf import text_format
+from tensorflow.core.util import test_log_pb2
+
+# Two-sided 95% critical values of Student's t distribution, indexed by
+# degrees of freedom (1-based).  For larger dof the normal value is used.
+_T_CRITICAL_95 = [
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042]
+_Z_CRITICAL_95 = 1.960
+
+Comparison = collections.namedtuple(
+    "Comparison",
+    ["name", "baseline_mean", "candidate_mean", "relative_change",
+     "t_statistic", "significant", "regression"])
+
+
+def load_test_results(path):
+  """Reads a text-format TestResults proto from `path`."""
+  results = test_log_pb2.TestResults()
+  with open(path, "r") as f:
+    text_format.Merge(f.read(), results)
+  return results
+
+
+def collect_samples(test_results_list):
+  """Returns {benchmark name: [seconds per iteration, ...]}."""
+  samples = collections.defaultdict(list)
+  for results in test_results_list:
+    for entry in results.entries.entry:
+      if entry.iters <= 0:
+        continue
+      samples[entry.name].append(entry.wall_time / entry.iters)
+  return samples
+
+
+def _mean_and_variance(values):
+  n = len(values)
+  mean = sum(values) / n
+  if n < 2:
+    return mean, 0.0
+  return mean, sum((v - mean) ** 2 for v in values) / (n - 1)
+
+
+def _t_critical(dof):
+  index = int(math.floor(dof))
+  if index < 1:
+    return _T_CRITICAL_95[0]
+  if index <= len(_T_CRITICAL_95):
+    return _T_CRITICAL_95[index - 1]
+  return _Z_CRITICAL_95
+
+
+def welch_t_test(baseline, candidate):
+  """Returns (t statistic, significant at 95%) for two lists of samples.
+
+  With fewer than two samples on either side no variance estimate exists;
+  returns (None, True) so that callers fall back to the threshold alone.
+  """
+  if len(baseline) < 2 or len(candidate) < 2:
+    return None, True
+  mean_b, var_b = _mean_and_variance(baseline)
+  mean_c, var_c = _mean_and_variance(candidate)
+  se_b = var_b / len(baseline)
+  se_c = var_c / len(candidate)
+  if se_b + se_c == 0:
+    return (float("inf") if mean_b != mean_c else 0.0), mean_b != mean_c
+  t = (mean_c - mean_b) / math.sqrt(se_b + se_c)
+  # Welch-Satterthwaite approximation of the degrees of freedom.
+  dof = (se_b + se_c) ** 2 / (
+      (se_b ** 2 / (len(baseline) - 1) if se_b else 0.0) +
+      (se_c ** 2 / (len(candidate) - 1) if se_c else 0.0))
+  return t, abs(t) > _t_critical(dof)
+
+
+def compare(baseline_results, candidate_results, threshold=0.05):
+  """Compares two lists of TestResults protos.
+
+  Args:
+    baseline_results: list of TestResults for the reference build.
+    candidate_results: list of TestResults for the build under test.
+    threshold: minimum relative slowdown (0.05 == 5%) to report a regression.
+
+  Returns:
+    A list of Comparison tuples, sorted by name, for every benchmark present
+    in both inputs.
+  """
+  baseline = collect_samples(baseline_results)
+  candidate = collect_samples(candidate_results)
+  comparisons = []
+  for name in sorted(set(baseline) & set(candidate)):
+    mean_b, _ = _mean_and_variance(baseline[name])
+    mean_c, _ = _mean_and_variance(candidate[name])
+    change = (mean_c - mean_b) / mean_b if mean_b > 0 else 0.0
+    t, significant = welch_t_test(baseline[name], candidate[name])
+    comparisons.append(Comparison(
+        name=name, baseline_mean=mean_b, candidate_mean=mean_c,
+        relative_change=change, t_statistic=t, significant=significant,
+        regression=significant and change > threshold))
+  return comparisons
+
+
+def format_comparisons(comparisons):
+  """Returns a human readable table of `comparisons`."""
+  width = max([len("Benchmark")] + [len(c.name) for c in comparisons])
+  lines = ["%-*s %14s %14s %9s %8s" % (width, "Benchmark", "Base(ns)",
+                                       "New(ns)", "Change", "t"),
+           "-" * (width + 49)]
+  for c in comparisons:
+    t = "n/a" if c.t_statistic is None else "%.2f" % c.t_statistic
+    flag = "  REGRESSION" if c.regression else ""
+    lines.append("%-*s %14.0f %14.0f %+8.1f%% %8s%s" % (
+        width, c.name, c.baseline_mean * 1e9, c.candidate_mean * 1e9,
+        c.relative_change * 100, t, flag))
+  return "\n".join(lines)
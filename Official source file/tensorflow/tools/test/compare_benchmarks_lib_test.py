@@ -0,0 +1,74 @@
+# Copyright 2016 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+"""Tests for compare_benchmarks_lib."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import tensorflow as tf
+
+from tensorflow.core.util import test_log_pb2
+from tensorflow.tools.test import compare_benchmarks_lib
+
+
+def _results(times_by_name):
+  results = test_log_pb2.TestResults()
+  for name, seconds in times_by_name.items():
+    entry = results.entries.entry.add()
+    entry.name = name
+    entry.iters = 100
+    entry.wall_time = seconds * 100
+  return results
+
+
+class CompareBenchmarksLibTest(tf.test.TestCase):
+
+  def testSignificantRegressionIsFlagged(self):
+    baseline = [_results({"BM_A": t}) for t in [1.00, 1.01, 0.99, 1.00]]
+    candidate = [_results({"BM_A": t}) for t in [1.20, 1.21, 1.19, 1.20]]
+    comparisons = compare_benchmarks_lib.compare(baseline, candidate)
+    self.assertEqual(1, len(comparisons))
+    self.assertTrue(comparisons[0].significant)
+    self.assertTrue(comparisons[0].regression)
+    self.assertNear(0.2, comparisons[0].relative_change, 1e-6)
+
+  def testNoisyDifferenceIsNotFlagged(self):
+    baseline = [_results({"BM_A": t}) for t in [0.8, 1.2, 0.9, 1.1]]
+    candidate = [_results({"BM_A": t}) for t in [1.3, 0.8, 1.2, 0.9]]
+    comparisons = compare_benchmarks_lib.compare(baseline, candidate)
+    self.assertFalse(comparisons[0].significant)
+    self.assertFalse(comparisons[0].regression)
+
+  def testImprovementIsNotRegression(self):
+    baseline = [_results({"BM_A": t}) for t in [1.00, 1.01, 0.99]]
+    candidate = [_results({"BM_A": t}) for t in [0.50, 0.51, 0.49]]
+    comparisons = compare_benchmarks_lib.compare(baseline, candidate)
+    self.assertTrue(comparisons[0].significant)
+    self.assertFalse(comparisons[0].regression)
+
+  def testSingleRunFallsBackToThreshold(self):
+    comparisons = compare_benchmarks_lib.compare(
+        [_results({"BM_A": 1.0, "BM_B": 1.0, "BM_OnlyOld": 1.0})],
+        [_results({"BM_A": 1.02, "BM_B": 1.5})], threshold=0.05)
+    self.assertEqual(["BM_A", "BM_B"], [c.name for c in comparisons])
+    self.assertIsNone(comparisons[0].t_statistic)
+    self.assertFalse(comparisons[0].regression)
+    self.assertTrue(comparisons[1].regression)
+
+
+if __name__ == "__main__":
+  tf.test.main()